@@ -13,6 +13,9 @@
 #import "UDTape.h"
 #import "UDTapeWindowController.h"
 
+// Set in main(), for the launch timing below
+extern NSTimeInterval UDLaunchStartTime;
+
 @interface AppDelegate : NSObject <NSApplicationDelegate, NSUserInterfaceValidations>
 
 @property (nonatomic, strong) UDUnitConverter *unitConverter;
@@ -23,6 +26,10 @@
 @property (nonatomic, strong) UDTapeWindowController *tapeWindowController;
 @property (nonatomic, strong) UDCalcViewController *calcViewController;
 
+// Seconds from main() to the first run loop turn after the window was
+// shown. Logged when the UDLogLaunchTiming default is set.
+@property (nonatomic, readonly) NSTimeInterval launchToFirstFrame;
+
 @property (nonatomic, weak) IBOutlet NSMenu *convertMenu;
 @property (nonatomic, weak) IBOutlet NSMenu *recentMenu;
 
@@ -9,9 +9,12 @@
 #import "UDCalcButton.h"
 #import "UDSettingsManager.h"
 
+NSTimeInterval UDLaunchStartTime = 0;
+
 @interface AppDelegate ()
 
 @property (strong) IBOutlet NSWindow *window;
+@property (nonatomic, readwrite) NSTimeInterval launchToFirstFrame;
 @end
 
 @implementation AppDelegate
@@ -100,10 +103,21 @@
     if ([UDSettingsManager sharedManager].showTapeWindow) {
         [self showTape:nil];
     }
+
+    // Runs on the next turn, after the window's first display pass
+    [self performSelector:@selector(recordFirstFrame) withObject:nil afterDelay:0];
+}
+
+- (void)recordFirstFrame {
+    self.launchToFirstFrame = [NSProcessInfo processInfo].systemUptime - UDLaunchStartTime;
+    if ([[NSUserDefaults standardUserDefaults] boolForKey:@"UDLogLaunchTiming"]) {
+        NSLog(@"Launch to first frame: %.1f ms", self.launchToFirstFrame * 1000.0);
+    }
 }
 
 - (void)applicationWillTerminate:(NSNotification *)aNotification {
-    // Insert code here to tear down your application
+    // History is written behind; don't lose the last few seconds of it
+    [self.historyManager flush];
 }
 
 
@@ -7,16 +7,26 @@
 
 #import <Foundation/Foundation.h>
 #import "UDValue.h"
+#import "UDFunctions.h"
 
 @class UDOpInfo;
 
 // --- BASE NODE ---
+// Nodes are immutable; -copy returns the receiver.
 @interface UDASTNode : NSObject
+// Hash of the whole subtree, computed once at construction from the
+// children's hashes. Also returned by -hash.
+@property (nonatomic, readonly) NSUInteger structuralHash;
+
 // Returns the precedence of this node.
 // For operators, this delegates to the UDOpInfo.
 // For values (numbers/parens), this returns a "Max" value.
 - (NSInteger)precedence;
 - (NSString *)prettyPrint;
+
+// Exact structural equality: numbers compare bitwise, where -isEqual:
+// allows an epsilon. Trees that are identical compile to the same program.
+- (BOOL)isIdenticalTo:(UDASTNode *)other;
 @end
 
 // --- NUMBER NODE (e.g., 5, 3.14) ---
@@ -32,6 +42,14 @@
 + (instancetype)value:(UDValue)v symbol:(NSString *)sym;
 @end
 
+// --- INPUT VARIABLE NODE (e.g. price) ---
+// Reads input slot `slot` at run time; see +[UDVM executeProgram:columns:columnCount:count:results:].
+@interface UDVariableNode : UDASTNode
+@property (nonatomic, copy, readonly) NSString *name;
+@property (nonatomic, readonly) NSUInteger slot;
++ (instancetype)variable:(NSString *)name slot:(NSUInteger)slot;
+@end
+
 // --- UNARY PREFIX NODE (e.g. -5) ---
 @interface UDUnaryOpNode : UDASTNode
 // REFACTORED: Reference the metadata directly
@@ -63,8 +81,12 @@
 // --- FUNCTION CALL NODE (e.g., sin(30)) ---
 @interface UDFunctionNode : UDASTNode
 @property (nonatomic, readonly) NSString *name;
+// Resolved once at construction; UDFunctionUnknown for a name outside
+// UD_FUNCTIONS, which the compiler rejects.
+@property (nonatomic, readonly) UDFunctionID functionID;
 @property (nonatomic, readonly) NSArray<UDASTNode *> *args;
 
++ (instancetype)function:(UDFunctionID)fid args:(NSArray<UDASTNode *> *)args;
 + (instancetype)func:(NSString *)name args:(NSArray<UDASTNode *> *)args;
 @end
 
@@ -73,3 +95,12 @@
 @property (nonatomic, strong, readonly) UDASTNode *child;
 + (instancetype)wrap:(UDASTNode *)node;
 @end
+
+// --- HASH-CONSING ---
+// Returns one shared instance per distinct tree (see isIdenticalTo:), so
+// equal subtrees share memory and compare by pointer.
+@interface UDASTInterner : NSObject
+@property (nonatomic, readonly) NSUInteger count;
+- (__kindof UDASTNode *)intern:(UDASTNode *)node;
+- (void)removeAllNodes;
+@end
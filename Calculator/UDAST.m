@@ -9,6 +9,17 @@
 #import "UDFrontend.h" // Import your operator info definition here
 #import "UDValueFormatter.h" // Assuming you have this for formatting values
 
+// Structural hash combiner (FNV-1a step over machine words).
+static inline NSUInteger UDHashMix(NSUInteger h, uint64_t word) {
+    return (NSUInteger)(((uint64_t)h ^ word) * 0x100000001b3ULL);
+}
+
+@interface UDASTNode ()
+@property (nonatomic, readwrite) NSUInteger structuralHash;
+// Rebuilds the node over interned children; returns self if none changed.
+- (UDASTNode *)nodeByInterningChildrenWith:(UDASTInterner *)interner;
+@end
+
 // Define a precedence higher than any operator for atomic values (Numbers, Parens)
 static const NSInteger kUDPrecedenceAtomic = 1000;
 
@@ -21,12 +32,21 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
     return [object isKindOfClass:[self class]];
 }
 
+// Computed once by each factory, so nodes are cheap dictionary keys.
 - (NSUInteger)hash {
-    return [self.prettyPrint hash];
+    return self.structuralHash;
+}
+
+- (BOOL)isIdenticalTo:(UDASTNode *)other {
+    return self == other;
+}
+
+- (UDASTNode *)nodeByInterningChildrenWith:(UDASTInterner *)interner {
+    return self;
 }
 
+// Nodes are immutable, so a copy can share the original.
 - (id)copyWithZone:(NSZone *)zone {
-    // Base implementation or Abstract
     return self;
 }
 
@@ -39,6 +59,7 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
 + (instancetype)value:(UDValue)v {
     UDNumberNode *n = [UDNumberNode new];
     n->_value = v;
+    n.structuralHash = UDHashMix(UDHashMix(1, v.type), v.v.intValue);
     return n;
 }
 - (NSInteger)precedence { return kUDPrecedenceAtomic; }
@@ -68,22 +89,12 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
     }
 }
 
-- (NSUInteger)hash {
-    switch (self.value.type) {
-        case UDValueTypeDouble:
-            return [[NSNumber numberWithDouble:UDValueAsDouble(self.value)] hash];
-        case UDValueTypeErr:
-        case UDValueTypeInteger:
-            return [[NSNumber numberWithLongLong:UDValueAsInt(self.value)] hash];
-        default:
-            NSLog(@"hash: unhandled value type %ld", self.value.type);
-            return 0;
-    }
-}
-
-- (id)copyWithZone:(NSZone *)zone {
-    UDNumberNode *copy = [UDNumberNode value:self.value];
-    return copy;
+// Bitwise: unlike -isEqual:, 0.1 + 0.2 and 0.3 are different numbers here.
+- (BOOL)isIdenticalTo:(UDASTNode *)other {
+    if (self == other) return YES;
+    if (![other isKindOfClass:[UDNumberNode class]] || other.structuralHash != self.structuralHash) return NO;
+    UDValue v = ((UDNumberNode *)other).value;
+    return v.type == self.value.type && v.v.intValue == self.value.v.intValue;
 }
 
 @end
@@ -95,7 +106,8 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
 + (instancetype)value:(UDValue)v symbol:(NSString *)sym {
     UDConstantNode *n = [UDConstantNode new];
     n->_value = v;
-    n->_symbol = sym;
+    n->_symbol = [sym copy];
+    n.structuralHash = UDHashMix(UDHashMix(2, sym.hash), v.v.intValue);
     return n;
 }
 - (NSInteger)precedence { return kUDPrecedenceAtomic; }
@@ -107,13 +119,40 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
     return [self.symbol isEqualToString:other.symbol]; // Value is implied by symbol
 }
 
-- (NSUInteger)hash {
-    return [self.symbol hash];
+- (BOOL)isIdenticalTo:(UDASTNode *)other {
+    if (self == other) return YES;
+    if (![other isKindOfClass:[UDConstantNode class]] || other.structuralHash != self.structuralHash) return NO;
+    UDConstantNode *c = (UDConstantNode *)other;
+    return c.value.type == self.value.type && c.value.v.intValue == self.value.v.intValue
+        && [c.symbol isEqualToString:self.symbol];
 }
 
--(id)copyWithZone:(NSZone *)zone {
-    UDConstantNode *copy = [UDConstantNode value:self.value symbol:self.symbol];
-    return copy;
+@end
+
+// ---------------------------------------------------------
+#pragma mark - Variable Node
+// ---------------------------------------------------------
+@implementation UDVariableNode
++ (instancetype)variable:(NSString *)name slot:(NSUInteger)slot {
+    UDVariableNode *n = [UDVariableNode new];
+    n->_name = [name copy];
+    n->_slot = slot;
+    n.structuralHash = UDHashMix(UDHashMix(8, name.hash), slot);
+    return n;
+}
+- (NSInteger)precedence { return kUDPrecedenceAtomic; }
+- (NSString *)prettyPrint { return self.name; }
+
+- (BOOL)isEqual:(id)object {
+    if (![object isKindOfClass:[UDVariableNode class]]) return NO;
+    UDVariableNode *other = (UDVariableNode *)object;
+    return self.slot == other.slot && [self.name isEqualToString:other.name];
+}
+
+- (BOOL)isIdenticalTo:(UDASTNode *)other {
+    if (self == other) return YES;
+    if (![other isKindOfClass:[UDVariableNode class]] || other.structuralHash != self.structuralHash) return NO;
+    return [self isEqual:other];
 }
 
 @end
@@ -126,6 +165,7 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
     UDUnaryOpNode *n = [UDUnaryOpNode new];
     n->_info = info;
     n->_child = c;
+    n.structuralHash = UDHashMix(UDHashMix(3, info.tag), c.structuralHash);
     return n;
 }
 
@@ -148,13 +188,16 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
     return (self.info.tag == other.info.tag) && [self.child isEqual:other.child];
 }
 
-- (NSUInteger)hash {
-    return self.info.tag ^ [self.child hash];
+- (BOOL)isIdenticalTo:(UDASTNode *)other {
+    if (self == other) return YES;
+    if (![other isKindOfClass:[UDUnaryOpNode class]] || other.structuralHash != self.structuralHash) return NO;
+    UDUnaryOpNode *o = (UDUnaryOpNode *)other;
+    return o.info.tag == self.info.tag && [self.child isIdenticalTo:o.child];
 }
 
-- (id)copyWithZone:(NSZone *)zone {
-    UDUnaryOpNode *copy = [UDUnaryOpNode info:self.info child:[self.child copy]];
-    return copy;
+- (UDASTNode *)nodeByInterningChildrenWith:(UDASTInterner *)interner {
+    UDASTNode *c = [interner intern:self.child];
+    return c == self.child ? self : [UDUnaryOpNode info:self.info child:c];
 }
 
 @end
@@ -167,6 +210,7 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
     UDPostfixOpNode *n = [UDPostfixOpNode new];
     n->_info = info;
     n->_child = c;
+    n.structuralHash = UDHashMix(UDHashMix(4, info.tag), c.structuralHash);
     return n;
 }
 
@@ -189,13 +233,16 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
     return (self.info.tag == other.info.tag) && [self.child isEqual:other.child];
 }
 
-- (NSUInteger)hash {
-    return self.info.tag ^ [self.child hash];
+- (BOOL)isIdenticalTo:(UDASTNode *)other {
+    if (self == other) return YES;
+    if (![other isKindOfClass:[UDPostfixOpNode class]] || other.structuralHash != self.structuralHash) return NO;
+    UDPostfixOpNode *o = (UDPostfixOpNode *)other;
+    return o.info.tag == self.info.tag && [self.child isIdenticalTo:o.child];
 }
 
-- (id)copyWithZone:(NSZone *)zone {
-    UDPostfixOpNode *copy = [UDPostfixOpNode info:self.info child:[self.child copy]];
-    return copy;
+- (UDASTNode *)nodeByInterningChildrenWith:(UDASTInterner *)interner {
+    UDASTNode *c = [interner intern:self.child];
+    return c == self.child ? self : [UDPostfixOpNode info:self.info child:c];
 }
 
 @end
@@ -209,6 +256,7 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
     n->_info = info;
     n->_left = l;
     n->_right = r;
+    n.structuralHash = UDHashMix(UDHashMix(UDHashMix(5, info.tag), l.structuralHash), r.structuralHash);
     return n;
 }
 
@@ -256,15 +304,19 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
         [self.right isEqual:other.right];
 }
 
-- (NSUInteger)hash {
-    return self.info.tag ^ [self.left hash] ^ [self.right hash];
+- (BOOL)isIdenticalTo:(UDASTNode *)other {
+    if (self == other) return YES;
+    if (![other isKindOfClass:[UDBinaryOpNode class]] || other.structuralHash != self.structuralHash) return NO;
+    UDBinaryOpNode *o = (UDBinaryOpNode *)other;
+    return o.info.tag == self.info.tag
+        && [self.left isIdenticalTo:o.left]
+        && [self.right isIdenticalTo:o.right];
 }
 
-- (id)copyWithZone:(NSZone *)zone {
-    UDBinaryOpNode *copy = [UDBinaryOpNode info:self.info
-                                           left:[self.left copy]
-                                          right:[self.right copy]];
-    return copy;
+- (UDASTNode *)nodeByInterningChildrenWith:(UDASTInterner *)interner {
+    UDASTNode *l = [interner intern:self.left];
+    UDASTNode *r = [interner intern:self.right];
+    return (l == self.left && r == self.right) ? self : [UDBinaryOpNode info:self.info left:l right:r];
 }
 
 @end
@@ -273,10 +325,22 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
 #pragma mark - Function Node
 // ---------------------------------------------------------
 @implementation UDFunctionNode
++ (instancetype)function:(UDFunctionID)fid args:(NSArray<UDASTNode *> *)args {
+    return [self node:fid name:UDFunctionNameForID(fid) args:args];
+}
+
 + (instancetype)func:(NSString *)name args:(NSArray<UDASTNode *> *)args {
+    return [self node:UDFunctionIDForName(name) name:name args:args];
+}
+
++ (instancetype)node:(UDFunctionID)fid name:(NSString *)name args:(NSArray<UDASTNode *> *)args {
     UDFunctionNode *n = [UDFunctionNode new];
-    n->_name = name;
-    n->_args = args;
+    n->_name = [name copy];
+    n->_functionID = fid;
+    n->_args = [args copy];
+    NSUInteger h = UDHashMix(6, name.hash);
+    for (UDASTNode *arg in args) h = UDHashMix(h, arg.structuralHash);
+    n.structuralHash = h;
     return n;
 }
 
@@ -297,15 +361,27 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
     return [self.name isEqualToString:other.name] && [self.args isEqualToArray:other.args];
 }
 
-- (NSUInteger)hash {
-    return [self.name hash] ^ [self.args hash];
+- (BOOL)isIdenticalTo:(UDASTNode *)other {
+    if (self == other) return YES;
+    if (![other isKindOfClass:[UDFunctionNode class]] || other.structuralHash != self.structuralHash) return NO;
+    UDFunctionNode *o = (UDFunctionNode *)other;
+    if (o.functionID != self.functionID || o.args.count != self.args.count) return NO;
+    if (self.functionID == UDFunctionUnknown && ![o.name isEqualToString:self.name]) return NO;
+    for (NSUInteger i = 0; i < self.args.count; i++) {
+        if (![self.args[i] isIdenticalTo:o.args[i]]) return NO;
+    }
+    return YES;
 }
 
-- (id)copyWithZone:(NSZone *)zone {
-    NSArray *deepCopiedArgs = [[NSArray alloc] initWithArray:self.args copyItems:YES];
-    UDFunctionNode *copy = [UDFunctionNode func:self.name
-                                           args:deepCopiedArgs];
-    return copy;
+- (UDASTNode *)nodeByInterningChildrenWith:(UDASTInterner *)interner {
+    NSMutableArray *args = [NSMutableArray arrayWithCapacity:self.args.count];
+    BOOL changed = NO;
+    for (UDASTNode *arg in self.args) {
+        UDASTNode *a = [interner intern:arg];
+        changed |= (a != arg);
+        [args addObject:a];
+    }
+    return changed ? [UDFunctionNode node:self.functionID name:self.name args:args] : self;
 }
 
 @end
@@ -317,6 +393,7 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
 + (instancetype)wrap:(UDASTNode *)node {
     UDParenNode *n = [UDParenNode new];
     n->_child = node;
+    n.structuralHash = UDHashMix(7, node.structuralHash);
     return n;
 }
 
@@ -333,8 +410,59 @@ static const NSInteger kUDPrecedenceAtomic = 1000;
     return [self.child isEqual:other.child];
 }
 
-- (NSUInteger)hash {
-    return [self.child hash];
+- (BOOL)isIdenticalTo:(UDASTNode *)other {
+    if (self == other) return YES;
+    if (![other isKindOfClass:[UDParenNode class]] || other.structuralHash != self.structuralHash) return NO;
+    return [self.child isIdenticalTo:((UDParenNode *)other).child];
+}
+
+- (UDASTNode *)nodeByInterningChildrenWith:(UDASTInterner *)interner {
+    UDASTNode *c = [interner intern:self.child];
+    return c == self.child ? self : [UDParenNode wrap:c];
+}
+
+@end
+
+// ---------------------------------------------------------
+#pragma mark - Interner
+// ---------------------------------------------------------
+@implementation UDASTInterner {
+    // structuralHash -> canonical nodes with that hash
+    NSMutableDictionary<NSNumber *, NSMutableArray<UDASTNode *> *> *_buckets;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _buckets = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+- (__kindof UDASTNode *)intern:(UDASTNode *)node {
+    if (!node) return nil;
+
+    // Children first: once they are canonical, comparing two candidates
+    // only has to look at this level (isIdenticalTo: stops at equal pointers).
+    UDASTNode *candidate = [node nodeByInterningChildrenWith:self];
+
+    NSNumber *key = @(candidate.structuralHash);
+    NSMutableArray<UDASTNode *> *bucket = _buckets[key];
+    for (UDASTNode *existing in bucket) {
+        if ([existing isIdenticalTo:candidate]) return existing;
+    }
+    if (!bucket) {
+        bucket = [NSMutableArray arrayWithCapacity:1];
+        _buckets[key] = bucket;
+    }
+    [bucket addObject:candidate];
+    _count++;
+    return candidate;
+}
+
+- (void)removeAllNodes {
+    [_buckets removeAllObjects];
+    _count = 0;
 }
 
 @end
@@ -0,0 +1,72 @@
+//
+//  UDASTArena.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "UDAST.h"
+
+// Index of a node inside its arena.
+typedef uint32_t UDASTRef;
+static const UDASTRef UDASTRefNone = UINT32_MAX;
+
+typedef NS_ENUM(uint8_t, UDASTKind) {
+    UDASTKindNumber,    // value
+    UDASTKindConstant,  // value, tag = symbol index
+    UDASTKindUnary,     // tag = UDOp, a = child
+    UDASTKindPostfix,   // tag = UDOp, a = child
+    UDASTKindBinary,    // tag = UDOp, a = left, b = right
+    UDASTKindFunction,  // tag = UDFunctionID, value = name index, a = first slot in args, b = argument count
+    UDASTKindParen,     // a = child
+    UDASTKindVariable   // tag = input slot, value = name index
+};
+
+// Read-only view of the struct-of-arrays columns; one row per node.
+// Valid until the next add or removeAllNodes.
+typedef struct {
+    const uint8_t  *kind;   // UDASTKind
+    const int32_t  *tag;
+    const UDASTRef *a;
+    const UDASTRef *b;
+    const UDValue  *value;
+    const UDASTRef *args;   // function arguments, referenced by a/b ranges
+} UDASTColumns;
+
+// Per-expression node storage. Nodes are plain rows in a few growable
+// arrays rather than objects, children are row indices, and the whole
+// expression is released at once with removeAllNodes.
+@interface UDASTArena : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) UDASTColumns columns;
+
+- (UDASTRef)addNumber:(UDValue)value;
+- (UDASTRef)addConstant:(UDValue)value symbol:(NSString *)symbol;
+- (UDASTRef)addUnary:(NSInteger)op child:(UDASTRef)child;
+- (UDASTRef)addPostfix:(NSInteger)op child:(UDASTRef)child;
+- (UDASTRef)addBinary:(NSInteger)op left:(UDASTRef)left right:(UDASTRef)right;
+- (UDASTRef)addFunction:(UDFunctionID)fid name:(NSString *)name args:(const UDASTRef *)args count:(NSUInteger)count;
+- (UDASTRef)addParen:(UDASTRef)child;
+- (UDASTRef)addVariable:(NSString *)name slot:(NSUInteger)slot;
+
+// Constant symbols, function and variable names, by the index stored in
+// the tag (constants) or value (functions, variables) column.
+- (NSString *)stringAtIndex:(int32_t)index;
+
+// Copies an object tree into the arena. Subtrees imported before (by
+// identity) are reused, so a growing expression only adds its new nodes;
+// the arena holds those nodes weakly. The walk keeps its own stack, so
+// any depth that fits in memory imports. Returns UDASTRefNone for nil.
+- (UDASTRef)importNode:(UDASTNode *)node;
+
+// Object view of a row, for the UI and the tape. Operator nodes get the
+// shared UDOpInfo for their tag. Built bottom-up in row order (a child's
+// row is always below its parent's), so depth is not limited by the C
+// stack.
+- (UDASTNode *)nodeForRef:(UDASTRef)ref;
+
+- (void)removeAllNodes;
+
+@end
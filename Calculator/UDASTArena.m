@@ -0,0 +1,379 @@
+//
+//  UDASTArena.m
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDASTArena.h"
+#import "UDFrontend.h"
+#import <stdlib.h>
+
+// Enough for a typical keypad expression without a single realloc.
+static const NSUInteger kUDASTArenaDefaultCapacity = 32;
+
+// A node's row kind by dynamic dispatch, instead of asking each class in
+// turn; kUDASTKindUnknown for anything the arena cannot hold.
+static const NSInteger kUDASTKindUnknown = -1;
+
+@interface UDASTNode (UDASTArena)
+- (NSInteger)arenaKind;
+@end
+
+@implementation UDASTNode (UDASTArena)
+- (NSInteger)arenaKind { return kUDASTKindUnknown; }
+@end
+@implementation UDNumberNode (UDASTArena)
+- (NSInteger)arenaKind { return UDASTKindNumber; }
+@end
+@implementation UDConstantNode (UDASTArena)
+- (NSInteger)arenaKind { return UDASTKindConstant; }
+@end
+@implementation UDUnaryOpNode (UDASTArena)
+- (NSInteger)arenaKind { return UDASTKindUnary; }
+@end
+@implementation UDPostfixOpNode (UDASTArena)
+- (NSInteger)arenaKind { return UDASTKindPostfix; }
+@end
+@implementation UDBinaryOpNode (UDASTArena)
+- (NSInteger)arenaKind { return UDASTKindBinary; }
+@end
+@implementation UDFunctionNode (UDASTArena)
+- (NSInteger)arenaKind { return UDASTKindFunction; }
+@end
+@implementation UDParenNode (UDASTArena)
+- (NSInteger)arenaKind { return UDASTKindParen; }
+@end
+@implementation UDVariableNode (UDASTArena)
+- (NSInteger)arenaKind { return UDASTKindVariable; }
+@end
+
+// Work item of importNode:. The tree being imported keeps node alive.
+typedef struct {
+    __unsafe_unretained UDASTNode *node;
+    BOOL expanded;              // children pushed
+} UDASTImportFrame;
+
+@implementation UDASTArena {
+    uint8_t *_kind;
+    int32_t *_tag;
+    UDASTRef *_a;
+    UDASTRef *_b;
+    UDValue *_value;
+    NSUInteger _capacity;
+
+    UDASTRef *_args;
+    NSUInteger _argCount;
+    NSUInteger _argCapacity;
+
+    NSMutableArray<NSString *> *_strings;
+    NSMutableDictionary<NSString *, NSNumber *> *_stringIndex;
+
+    // Imported object nodes -> row + 1. Keys are weak, so the map never
+    // keeps a tree alive, and values are plain integers, not NSNumbers.
+    NSMapTable *_imported;
+    UDASTImportFrame *_importStack;
+    NSUInteger _importDepth;
+    NSUInteger _importCapacity;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _capacity = kUDASTArenaDefaultCapacity;
+        _kind  = malloc(_capacity * sizeof(uint8_t));
+        _tag   = malloc(_capacity * sizeof(int32_t));
+        _a     = malloc(_capacity * sizeof(UDASTRef));
+        _b     = malloc(_capacity * sizeof(UDASTRef));
+        _value = malloc(_capacity * sizeof(UDValue));
+        _argCapacity = kUDASTArenaDefaultCapacity;
+        _args  = malloc(_argCapacity * sizeof(UDASTRef));
+        _strings = [NSMutableArray array];
+        _stringIndex = [NSMutableDictionary dictionary];
+        _imported = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality
+                                              valueOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsIntegerPersonality
+                                                  capacity:kUDASTArenaDefaultCapacity];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_kind);
+    free(_tag);
+    free(_a);
+    free(_b);
+    free(_value);
+    free(_args);
+    free(_importStack);
+}
+
+- (UDASTColumns)columns {
+    return (UDASTColumns){ _kind, _tag, _a, _b, _value, _args };
+}
+
+- (void)removeAllNodes {
+    // Keeps the buffers: the next expression reuses them.
+    _count = 0;
+    _argCount = 0;
+    [_strings removeAllObjects];
+    [_stringIndex removeAllObjects];
+    [_imported removeAllObjects];
+}
+
+#pragma mark - Building
+
+- (UDASTRef)add:(UDASTKind)kind tag:(int32_t)tag a:(UDASTRef)a b:(UDASTRef)b value:(UDValue)value {
+    if (_count == _capacity) {
+        _capacity *= 2;
+        _kind  = realloc(_kind,  _capacity * sizeof(uint8_t));
+        _tag   = realloc(_tag,   _capacity * sizeof(int32_t));
+        _a     = realloc(_a,     _capacity * sizeof(UDASTRef));
+        _b     = realloc(_b,     _capacity * sizeof(UDASTRef));
+        _value = realloc(_value, _capacity * sizeof(UDValue));
+    }
+    NSUInteger i = _count++;
+    _kind[i] = kind;
+    _tag[i] = tag;
+    _a[i] = a;
+    _b[i] = b;
+    _value[i] = value;
+    return (UDASTRef)i;
+}
+
+- (int32_t)indexOfString:(NSString *)string {
+    NSNumber *index = _stringIndex[string];
+    if (!index) {
+        index = @(_strings.count);
+        [_strings addObject:string];
+        _stringIndex[string] = index;
+    }
+    return (int32_t)index.intValue;
+}
+
+- (NSString *)stringAtIndex:(int32_t)index {
+    return _strings[index];
+}
+
+- (UDASTRef)addNumber:(UDValue)value {
+    return [self add:UDASTKindNumber tag:0 a:UDASTRefNone b:UDASTRefNone value:value];
+}
+
+- (UDASTRef)addConstant:(UDValue)value symbol:(NSString *)symbol {
+    return [self add:UDASTKindConstant tag:[self indexOfString:symbol ?: @""] a:UDASTRefNone b:UDASTRefNone value:value];
+}
+
+- (UDASTRef)addUnary:(NSInteger)op child:(UDASTRef)child {
+    return [self add:UDASTKindUnary tag:(int32_t)op a:child b:UDASTRefNone value:UDValueMakeInt(0)];
+}
+
+- (UDASTRef)addPostfix:(NSInteger)op child:(UDASTRef)child {
+    return [self add:UDASTKindPostfix tag:(int32_t)op a:child b:UDASTRefNone value:UDValueMakeInt(0)];
+}
+
+- (UDASTRef)addBinary:(NSInteger)op left:(UDASTRef)left right:(UDASTRef)right {
+    return [self add:UDASTKindBinary tag:(int32_t)op a:left b:right value:UDValueMakeInt(0)];
+}
+
+- (UDASTRef)addFunction:(UDFunctionID)fid name:(NSString *)name args:(const UDASTRef *)args count:(NSUInteger)count {
+    while (_argCount + count > _argCapacity) {
+        _argCapacity *= 2;
+        _args = realloc(_args, _argCapacity * sizeof(UDASTRef));
+    }
+    UDASTRef first = (UDASTRef)_argCount;
+    for (NSUInteger i = 0; i < count; i++) _args[_argCount++] = args[i];
+    UDValue nameIndex = UDValueMakeInt([self indexOfString:name ?: UDFunctionNameForID(fid) ?: @""]);
+    return [self add:UDASTKindFunction tag:(int32_t)fid a:first b:(UDASTRef)count value:nameIndex];
+}
+
+- (UDASTRef)addParen:(UDASTRef)child {
+    return [self add:UDASTKindParen tag:0 a:child b:UDASTRefNone value:UDValueMakeInt(0)];
+}
+
+- (UDASTRef)addVariable:(NSString *)name slot:(NSUInteger)slot {
+    UDValue nameIndex = UDValueMakeInt([self indexOfString:name ?: @""]);
+    return [self add:UDASTKindVariable tag:(int32_t)slot a:UDASTRefNone b:UDASTRefNone value:nameIndex];
+}
+
+#pragma mark - Object trees
+
+- (UDASTRef)importedRefOf:(UDASTNode *)node {
+    if (!node) return UDASTRefNone;
+    uintptr_t stored = (uintptr_t)NSMapGet(_imported, (__bridge void *)node);
+    return stored ? (UDASTRef)(stored - 1) : UDASTRefNone;
+}
+
+- (void)pushImport:(UDASTNode *)node {
+    if (!node || [self importedRefOf:node] != UDASTRefNone) return;
+    if (_importDepth == _importCapacity) {
+        _importCapacity = _importCapacity ? _importCapacity * 2 : kUDASTArenaDefaultCapacity;
+        _importStack = realloc(_importStack, _importCapacity * sizeof(UDASTImportFrame));
+    }
+    _importStack[_importDepth++] = (UDASTImportFrame){ node, NO };
+}
+
+// Adds the row for a node whose children are all rows already
+- (UDASTRef)addRowForNode:(UDASTNode *)node kind:(NSInteger)kind {
+    switch (kind) {
+        case UDASTKindNumber:
+            return [self addNumber:((UDNumberNode *)node).value];
+        case UDASTKindConstant: {
+            UDConstantNode *n = (UDConstantNode *)node;
+            return [self addConstant:n.value symbol:n.symbol];
+        }
+        case UDASTKindUnary: {
+            UDUnaryOpNode *n = (UDUnaryOpNode *)node;
+            return [self addUnary:n.info.tag child:[self importedRefOf:n.child]];
+        }
+        case UDASTKindPostfix: {
+            UDPostfixOpNode *n = (UDPostfixOpNode *)node;
+            return [self addPostfix:n.info.tag child:[self importedRefOf:n.child]];
+        }
+        case UDASTKindBinary: {
+            UDBinaryOpNode *n = (UDBinaryOpNode *)node;
+            return [self addBinary:n.info.tag left:[self importedRefOf:n.left] right:[self importedRefOf:n.right]];
+        }
+        case UDASTKindFunction: {
+            UDFunctionNode *n = (UDFunctionNode *)node;
+            NSUInteger count = n.args.count;
+            UDASTRef args[count > 0 ? count : 1];
+            for (NSUInteger i = 0; i < count; i++) args[i] = [self importedRefOf:n.args[i]];
+            return [self addFunction:n.functionID name:n.name args:args count:count];
+        }
+        case UDASTKindParen:
+            return [self addParen:[self importedRefOf:((UDParenNode *)node).child]];
+        case UDASTKindVariable: {
+            UDVariableNode *n = (UDVariableNode *)node;
+            return [self addVariable:n.name slot:n.slot];
+        }
+    }
+    return UDASTRefNone;
+}
+
+- (UDASTRef)importNode:(UDASTNode *)root {
+    if (!root) return UDASTRefNone;
+
+    // Post-order over an explicit stack: a node is visited once to push
+    // its children, and again, with every child a row, to add its own.
+    _importDepth = 0;
+    [self pushImport:root];
+    while (_importDepth > 0) {
+        UDASTImportFrame *frame = &_importStack[_importDepth - 1];
+        UDASTNode *node = frame->node;
+        NSInteger kind = node.arenaKind;
+
+        if (!frame->expanded && [self importedRefOf:node] == UDASTRefNone) {
+            frame->expanded = YES;
+            // frame is not used past here: pushing may move the stack
+            switch (kind) {
+                case UDASTKindUnary:   [self pushImport:((UDUnaryOpNode *)node).child];   break;
+                case UDASTKindPostfix: [self pushImport:((UDPostfixOpNode *)node).child]; break;
+                case UDASTKindParen:   [self pushImport:((UDParenNode *)node).child];     break;
+                case UDASTKindBinary:
+                    // Right first, so the left operand gets the lower row
+                    [self pushImport:((UDBinaryOpNode *)node).right];
+                    [self pushImport:((UDBinaryOpNode *)node).left];
+                    break;
+                case UDASTKindFunction: {
+                    NSArray<UDASTNode *> *args = ((UDFunctionNode *)node).args;
+                    for (NSUInteger i = args.count; i > 0; i--) [self pushImport:args[i - 1]];
+                    break;
+                }
+            }
+            continue;
+        }
+
+        _importDepth--;
+        // A subtree shared within the tree is pushed once per parent
+        if ([self importedRefOf:node] != UDASTRefNone) continue;
+        UDASTRef ref = [self addRowForNode:node kind:kind];
+        if (ref != UDASTRefNone) NSMapInsert(_imported, (__bridge void *)node, (void *)(uintptr_t)(ref + 1));
+    }
+    return [self importedRefOf:root];
+}
+
+static inline UDASTNode *UDBuiltChild(__strong UDASTNode **built, UDASTRef child) {
+    return child == UDASTRefNone ? nil : built[child];
+}
+
+// Builds one row's object from the objects of its children, which are
+// in built by then.
+- (UDASTNode *)nodeForRow:(UDASTRef)ref built:(__strong UDASTNode **)built {
+    UDFrontend *fe = [UDFrontend shared];
+    switch ((UDASTKind)_kind[ref]) {
+        case UDASTKindNumber:
+            return [UDNumberNode value:_value[ref]];
+        case UDASTKindConstant:
+            return [UDConstantNode value:_value[ref] symbol:_strings[_tag[ref]]];
+        case UDASTKindUnary:
+            return [UDUnaryOpNode info:[fe infoForOp:_tag[ref]] child:UDBuiltChild(built, _a[ref])];
+        case UDASTKindPostfix:
+            return [UDPostfixOpNode info:[fe infoForOp:_tag[ref]] child:UDBuiltChild(built, _a[ref])];
+        case UDASTKindBinary:
+            return [UDBinaryOpNode info:[fe infoForOp:_tag[ref]]
+                                   left:UDBuiltChild(built, _a[ref])
+                                  right:UDBuiltChild(built, _b[ref])];
+        case UDASTKindFunction: {
+            NSMutableArray *args = [NSMutableArray arrayWithCapacity:_b[ref]];
+            for (UDASTRef i = 0; i < _b[ref]; i++) {
+                UDASTNode *arg = UDBuiltChild(built, _args[_a[ref] + i]);
+                if (arg) [args addObject:arg];
+            }
+            NSString *name = _strings[(NSUInteger)UDValueAsInt(_value[ref])];
+            return _tag[ref] == UDFunctionUnknown ? [UDFunctionNode func:name args:args]
+                                                  : [UDFunctionNode function:(UDFunctionID)_tag[ref] args:args];
+        }
+        case UDASTKindParen:
+            return [UDParenNode wrap:UDBuiltChild(built, _a[ref])];
+        case UDASTKindVariable:
+            return [UDVariableNode variable:_strings[(NSUInteger)UDValueAsInt(_value[ref])] slot:(NSUInteger)_tag[ref]];
+    }
+    return nil;
+}
+
+- (void)markChildrenOfRow:(UDASTRef)ref in:(uint8_t *)needed {
+    switch ((UDASTKind)_kind[ref]) {
+        case UDASTKindUnary:
+        case UDASTKindPostfix:
+        case UDASTKindParen:
+            if (_a[ref] != UDASTRefNone) needed[_a[ref]] = 1;
+            break;
+        case UDASTKindBinary:
+            if (_a[ref] != UDASTRefNone) needed[_a[ref]] = 1;
+            if (_b[ref] != UDASTRefNone) needed[_b[ref]] = 1;
+            break;
+        case UDASTKindFunction:
+            for (UDASTRef i = 0; i < _b[ref]; i++) {
+                if (_args[_a[ref] + i] != UDASTRefNone) needed[_args[_a[ref] + i]] = 1;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+- (UDASTNode *)nodeForRef:(UDASTRef)ref {
+    if (ref >= _count) return nil;
+
+    // A row is only ever added after its children, so every child sits
+    // below its parent. One pass down from ref marks the rows it reaches;
+    // one pass up builds them, each after all of its children. No
+    // recursion, and a row shared within the tree is built once.
+    NSUInteger rows = (NSUInteger)ref + 1;
+    uint8_t *needed = calloc(rows, sizeof(uint8_t));
+    __strong UDASTNode **built = (__strong UDASTNode **)calloc(rows, sizeof(UDASTNode *));
+    needed[ref] = 1;
+    for (NSUInteger r = rows; r > 0; r--) {
+        if (needed[r - 1]) [self markChildrenOfRow:(UDASTRef)(r - 1) in:needed];
+    }
+    for (NSUInteger r = 0; r < rows; r++) {
+        if (needed[r]) built[r] = [self nodeForRow:(UDASTRef)r built:built];
+    }
+
+    UDASTNode *node = built[ref];
+    for (NSUInteger r = 0; r < rows; r++) built[r] = nil;
+    free(built);
+    free(needed);
+    return node;
+}
+
+@end
@@ -0,0 +1,48 @@
+//
+//  UDBatchEvaluator.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "UDValue.h"
+#import "UDInputBuffer.h"
+
+typedef NS_ENUM(NSInteger, UDBatchInputFormat) {
+    UDBatchInputFormatText,  // "2 + 3 * sqrt(16)", read by UDParser
+    UDBatchInputFormatKeys   // "2 Add 3 Mul 16 Sqrt Eq", replayed through UDCalc
+};
+
+// Evaluates one expression per call with the engine behind the GUI, for
+// the CalculatorBatch tool and other headless callers. The parser, arena
+// and calculator are reused from call to call, so memory stays flat over
+// any number of expressions.
+//
+// Keys are whitespace separated. A key is a run of digits and '.' in the
+// input base, typed one digit at a time, or a UDOp name without its
+// prefix (Add, Sqrt, ParenLeft, ConstPi, Eq, ...). Digits are tried
+// first, so in hex "EE" is the number 0xEE; a name written with a
+// leading ':' (":EE", ":Add") is always a key. A missing trailing Eq is
+// implied.
+//
+// Not thread-safe; UDParallelBatch gives each worker thread its own.
+@interface UDBatchEvaluator : NSObject
+
+@property (nonatomic, assign) UDBatchInputFormat inputFormat;
+
+// Defaults follow a fresh UDCalc: decimal, floating point, radians, and
+// the display's automatic decimal places (-1).
+@property (nonatomic, assign) UDBase base;          // output, and input for keys
+@property (nonatomic, assign) BOOL integerMode;     // programmer-mode arithmetic
+@property (nonatomic, assign) BOOL isRadians;
+@property (nonatomic, assign) NSInteger decimalPlaces;
+
+// A line that does not parse evaluates to an error value.
+- (UDValue)evaluateUTF8:(const char *)line length:(NSUInteger)length;
+- (UDValue)evaluateLine:(NSString *)line;
+
+// The value in the configured base and decimal places.
+- (NSString *)stringForValue:(UDValue)value;
+
+@end
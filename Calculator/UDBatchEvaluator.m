@@ -0,0 +1,195 @@
+//
+//  UDBatchEvaluator.m
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDBatchEvaluator.h"
+#import "UDCalc.h"
+#import "UDCompiler.h"
+#import "UDParser.h"
+#import "UDValueFormatter.h"
+#import "UDVM.h"
+#include <math.h>
+#include <string.h>
+
+typedef struct {
+    const char *name;
+    UDOp op;
+} UDBatchKey;
+
+#define UD_KEY(name) { #name, UDOp##name }
+
+// Every UDOp the keypad sends to UDCalc. Digits and the decimal point are
+// typed as numbers instead.
+static const UDBatchKey kUDBatchKeys[] = {
+    UD_KEY(Add), UD_KEY(Sub), UD_KEY(Mul), UD_KEY(Div), UD_KEY(Eq),
+    UD_KEY(Clear), UD_KEY(Percent), UD_KEY(Negate),
+    UD_KEY(Square), UD_KEY(Cube), UD_KEY(Pow), UD_KEY(PowRev),
+    UD_KEY(Exp), UD_KEY(Pow10), UD_KEY(Pow2),
+    UD_KEY(Invert), UD_KEY(Sqrt), UD_KEY(Cbrt), UD_KEY(YRoot),
+    UD_KEY(Ln), UD_KEY(Log10), UD_KEY(Log2), UD_KEY(LogY),
+    UD_KEY(Factorial), UD_KEY(Sin), UD_KEY(SinInverse), UD_KEY(Cos),
+    UD_KEY(CosInverse), UD_KEY(Tan), UD_KEY(TanInverse), UD_KEY(ConstE), UD_KEY(EE),
+    UD_KEY(Sinh), UD_KEY(SinhInverse), UD_KEY(Cosh), UD_KEY(CoshInverse),
+    UD_KEY(Tanh), UD_KEY(TanhInverse), UD_KEY(ConstPi), UD_KEY(Rand),
+    UD_KEY(MR), UD_KEY(MC), UD_KEY(MAdd), UD_KEY(MSub),
+    UD_KEY(ParenLeft), UD_KEY(ParenRight),
+    UD_KEY(BitwiseAnd), UD_KEY(BitwiseOr), UD_KEY(BitwiseNor), UD_KEY(BitwiseXor),
+    UD_KEY(Shift1Left), UD_KEY(Shift1Right), UD_KEY(ShiftLeft), UD_KEY(ShiftRight),
+    UD_KEY(ByteFlip), UD_KEY(WordFlip), UD_KEY(RotateLeft), UD_KEY(RotateRight),
+    UD_KEY(Comp2), UD_KEY(Comp1),
+};
+
+#undef UD_KEY
+
+static BOOL UDBatchKeyLookup(const char *s, size_t len, UDOp *op) {
+    for (size_t i = 0; i < sizeof(kUDBatchKeys) / sizeof(kUDBatchKeys[0]); i++) {
+        if (strlen(kUDBatchKeys[i].name) == len && memcmp(kUDBatchKeys[i].name, s, len) == 0) {
+            *op = kUDBatchKeys[i].op;
+            return YES;
+        }
+    }
+    return NO;
+}
+
+// Value of a digit in any base up to 16; 16 for anything else
+static inline int UDBatchDigit(char c) {
+    return c >= '0' && c <= '9' ? c - '0'
+         : c >= 'A' && c <= 'F' ? c - 'A' + 10
+         : c >= 'a' && c <= 'f' ? c - 'a' + 10 : 16;
+}
+
+// A run of digits in base and '.', as typed on the keypad
+static BOOL UDBatchIsNumber(const char *s, size_t len, UDBase base) {
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] != '.' && UDBatchDigit(s[i]) >= (int)base) return NO;
+    }
+    return YES;
+}
+
+static inline BOOL UDIsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+@implementation UDBatchEvaluator {
+    UDParser *_parser;
+    UDASTArena *_arena;
+    UDCalc *_calc;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _parser = [[UDParser alloc] init];
+        _arena = [[UDASTArena alloc] init];
+        _base = UDBaseDec;
+        _isRadians = YES;       // as UDCalc starts up
+        _decimalPlaces = -1;    // up to 10, as the display
+    }
+    return self;
+}
+
+// Created on first use: text input never needs it.
+- (UDCalc *)calc {
+    if (!_calc) {
+        _calc = [[UDCalc alloc] init];
+        _calc.mode = self.integerMode ? UDCalcModeProgrammer : UDCalcModeScientific;
+        _calc.inputBase = self.base;
+        _calc.isRadians = self.isRadians;
+    }
+    return _calc;
+}
+
+- (void)setBase:(UDBase)base {
+    _base = base;
+    _calc.inputBase = base;
+}
+
+- (void)setIntegerMode:(BOOL)integerMode {
+    _integerMode = integerMode;
+    _calc.mode = integerMode ? UDCalcModeProgrammer : UDCalcModeScientific;
+}
+
+- (void)setIsRadians:(BOOL)isRadians {
+    _isRadians = isRadians;
+    _calc.isRadians = isRadians;
+}
+
+- (UDValue)evaluateLine:(NSString *)line {
+    const char *utf8 = line.UTF8String ?: "";
+    return [self evaluateUTF8:utf8 length:strlen(utf8)];
+}
+
+- (UDValue)evaluateUTF8:(const char *)line length:(NSUInteger)length {
+    return self.inputFormat == UDBatchInputFormatKeys
+        ? [self evaluateKeys:line length:length]
+        : [self evaluateText:line length:length];
+}
+
+- (UDValue)evaluateText:(const char *)line length:(NSUInteger)length {
+    _parser.integerMode = self.integerMode;
+    _parser.isRadians = self.isRadians;
+
+    UDASTNode *root = [_parser parseUTF8:line length:length];
+    if (!root) return UDValueMakeError(UDValueErrorTypeUnknown);
+
+    // Each expression runs once, so folding would not pay for itself
+    UDProgram *program = [UDCompiler compileProgram:root inArena:_arena withIntegerMode:self.integerMode optimize:NO];
+    UDValue result = [UDVM executeProgram:program];
+    [_arena removeAllNodes];
+    return result;
+}
+
+- (UDValue)evaluateKeys:(const char *)line length:(NSUInteger)length {
+    UDCalc *calc = [self calc];
+    [calc reset];
+
+    const char *p = line, *end = line + length;
+    UDOp last = UDOpNone;
+    while (p < end) {
+        while (p < end && UDIsSpace(*p)) p++;
+        const char *key = p;
+        while (p < end && !UDIsSpace(*p)) p++;
+        size_t len = (size_t)(p - key);
+        if (len == 0) break;
+
+        // Numbers first: in hex, EE and Add are digits. A leading ':'
+        // always means a key name.
+        BOOL named = key[0] == ':';
+        if (!named && UDBatchIsNumber(key, len, self.base)) {
+            for (size_t i = 0; i < len; i++) {
+                if (key[i] == '.') [calc inputDecimal];
+                else [calc inputDigit:UDBatchDigit(key[i])];
+            }
+            last = UDOpNone;
+            continue;
+        }
+
+        UDOp op;
+        if (named ? UDBatchKeyLookup(key + 1, len - 1, &op) : UDBatchKeyLookup(key, len, &op)) {
+            // As UDCalcViewController sends them
+            if (op == UDOpConstPi) [calc inputNumber:UDValueMakeDouble(M_PI)];
+            else if (op == UDOpConstE) [calc inputNumber:UDValueMakeDouble(M_E)];
+            else if (op == UDOpEE) [calc inputEE];
+            else [calc performOperation:op];
+            last = op;
+            continue;
+        }
+        return UDValueMakeError(UDValueErrorTypeUnknown);
+    }
+
+    if (last != UDOpEq) [calc performOperation:UDOpEq];
+    return [calc evaluateCurrentExpression];
+}
+
+- (NSString *)stringForValue:(UDValue)value {
+    return [UDValueFormatter stringForValue:value
+                                       base:self.base
+                    showThousandsSeparators:NO
+                              decimalPlaces:self.decimalPlaces
+                            forceScientific:NO];
+}
+
+@end
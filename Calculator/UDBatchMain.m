@@ -0,0 +1,257 @@
+//
+//  UDBatchMain.m
+//  CalculatorBatch
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+//  Headless evaluator: one expression per input line, one result per
+//  output line, in the same order. Reads a line at a time, so memory does
+//  not grow with the input. With -j, reads blocks of lines and spreads
+//  each block over several cores; output order is kept.
+//
+
+#import <Foundation/Foundation.h>
+#import "UDBatchEvaluator.h"
+#import "UDParallelBatch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Latency histogram: 8 buckets per power of two (about 12% resolution),
+// fixed size whatever the number of lines.
+#define UD_HIST_SUB     8
+#define UD_HIST_BUCKETS (62 * UD_HIST_SUB)
+
+// Lines per parallel block: large enough to keep every core busy, small
+// enough that memory stays bounded.
+#define UD_BLOCK_LINES  65536
+
+static inline unsigned UDHistBucket(uint64_t ns) {
+    if (ns < UD_HIST_SUB) return (unsigned)ns;
+    unsigned e = 63 - (unsigned)__builtin_clzll(ns);
+    return (e - 2) * UD_HIST_SUB + (unsigned)((ns >> (e - 3)) & (UD_HIST_SUB - 1));
+}
+
+static inline uint64_t UDHistLowerBound(unsigned bucket) {
+    if (bucket < UD_HIST_SUB) return bucket;
+    unsigned e = bucket / UD_HIST_SUB + 2;
+    return (uint64_t)(UD_HIST_SUB + bucket % UD_HIST_SUB) << (e - 3);
+}
+
+static uint64_t UDHistPercentile(const uint64_t *hist, uint64_t total, double p) {
+    uint64_t rank = (uint64_t)(p * (double)total), seen = 0;
+    for (unsigned b = 0; b < UD_HIST_BUCKETS; b++) {
+        seen += hist[b];
+        if (seen > rank) return UDHistLowerBound(b);
+    }
+    return UDHistLowerBound(UD_HIST_BUCKETS - 1);
+}
+
+static inline uint64_t UDNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int UDOutOfMemory(void) {
+    fprintf(stderr, "CalculatorBatch: out of memory\n");
+    return 1;
+}
+
+static void UDUsage(FILE *out) {
+    fprintf(out,
+        "usage: CalculatorBatch [-k] [-b base] [-i] [-d places] [-D] [-j workers] [-s] [-q] [file]\n"
+        "  -k         input is keypress tokens (2 Add 3 Eq) instead of text (2 + 3);\n"
+        "             digits win over names, so write :Add or :EE in hex\n"
+        "  -b base    output base 2, 8, 10 or 16; other than 10 implies -i\n"
+        "  -i         integer (programmer mode) arithmetic\n"
+        "  -d places  decimal places, -1 for automatic (default)\n"
+        "  -D         trigonometry in degrees (default radians)\n"
+        "  -j workers evaluate on several threads, 0 for one per core\n"
+        "  -s         report throughput and latency percentiles on stderr\n"
+        "  -q         do not print results\n"
+        "Reads standard input when no file (or -) is given.\n");
+}
+
+int main(int argc, char *argv[]) {
+    @autoreleasepool {
+        UDBatchEvaluator *evaluator = [[UDBatchEvaluator alloc] init];
+        BOOL stats = NO, quiet = NO;
+        long jobs = -1;
+
+        int opt;
+        while ((opt = getopt(argc, argv, "kb:id:Dj:sqh")) != -1) {
+            switch (opt) {
+                case 'k': evaluator.inputFormat = UDBatchInputFormatKeys; break;
+                case 'b': {
+                    int base = atoi(optarg);
+                    if (base != 2 && base != 8 && base != 10 && base != 16) {
+                        fprintf(stderr, "CalculatorBatch: unsupported base %s\n", optarg);
+                        return 2;
+                    }
+                    evaluator.base = (UDBase)base;
+                    if (base != 10) evaluator.integerMode = YES;
+                    break;
+                }
+                case 'i': evaluator.integerMode = YES; break;
+                case 'd': evaluator.decimalPlaces = atoi(optarg); break;
+                case 'D': evaluator.isRadians = NO; break;
+                case 'j': jobs = atol(optarg); if (jobs < 0) jobs = 0; break;
+                case 's': stats = YES; break;
+                case 'q': quiet = YES; break;
+                case 'h': UDUsage(stdout); return 0;
+                default:  UDUsage(stderr); return 2;
+            }
+        }
+
+        FILE *in = stdin;
+        if (optind < argc && strcmp(argv[optind], "-") != 0) {
+            in = fopen(argv[optind], "r");
+            if (!in) {
+                perror(argv[optind]);
+                return 1;
+            }
+        }
+
+        uint64_t *hist = stats ? calloc(UD_HIST_BUCKETS, sizeof(uint64_t)) : NULL;
+        if (stats && !hist) return UDOutOfMemory();
+        uint64_t lines = 0, errors = 0, maxNs = 0;
+        uint64_t started = UDNow();
+
+        char *line = NULL;
+        size_t capacity = 0;
+        ssize_t length;
+        if (jobs >= 0) {
+            UDParallelBatch *batch = [[UDParallelBatch alloc] initWithWorkerCount:(NSUInteger)jobs];
+            batch.inputFormat = evaluator.inputFormat;
+            batch.base = evaluator.base;
+            batch.integerMode = evaluator.integerMode;
+            batch.isRadians = evaluator.isRadians;
+            batch.decimalPlaces = evaluator.decimalPlaces;
+
+            // Non-blank lines of a block are stored back to back, NUL
+            // separated; blank ones are only marked, never evaluated.
+            size_t textCapacity = 1 << 20, textLength = 0;
+            char *text = malloc(textCapacity);
+            BOOL *blank = malloc(UD_BLOCK_LINES * sizeof(BOOL));
+            size_t *offsets = malloc(UD_BLOCK_LINES * sizeof(size_t));
+            const char **starts = malloc(UD_BLOCK_LINES * sizeof(char *));
+            NSUInteger *lengths = malloc(UD_BLOCK_LINES * sizeof(NSUInteger));
+            UDValue *results = malloc(UD_BLOCK_LINES * sizeof(UDValue));
+            uint64_t *latencies = stats ? malloc(UD_BLOCK_LINES * sizeof(uint64_t)) : NULL;
+            if (!text || !blank || !offsets || !starts || !lengths || !results || (stats && !latencies)) {
+                return UDOutOfMemory();
+            }
+
+            BOOL done = NO;
+            while (!done) {
+                NSUInteger count = 0, work = 0;
+                textLength = 0;
+                while (count < UD_BLOCK_LINES) {
+                    if ((length = getline(&line, &capacity, in)) == -1) {
+                        done = YES;
+                        break;
+                    }
+                    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) length--;
+                    blank[count++] = length == 0;
+                    if (length == 0) continue;
+
+                    if (textLength + (size_t)length + 1 > textCapacity) {
+                        while (textLength + (size_t)length + 1 > textCapacity) textCapacity *= 2;
+                        char *grown = realloc(text, textCapacity);
+                        if (!grown) return UDOutOfMemory();
+                        text = grown;
+                    }
+                    memcpy(text + textLength, line, (size_t)length);
+                    text[textLength + (size_t)length] = '\0';
+                    offsets[work] = textLength;
+                    lengths[work] = (NSUInteger)length;
+                    textLength += (size_t)length + 1;
+                    work++;
+                }
+                if (count == 0) break;
+
+                for (NSUInteger i = 0; i < work; i++) starts[i] = text + offsets[i];
+                if (work > 0) {
+                    [batch evaluateUTF8Lines:starts lengths:lengths count:work results:results latencies:latencies];
+                }
+
+                for (NSUInteger i = 0, j = 0; i < count; i++) {
+                    @autoreleasepool {
+                        // Blank lines stay blank so output lines up with input
+                        if (blank[i]) {
+                            if (!quiet) fputc('\n', stdout);
+                            continue;
+                        }
+                        if (stats) {
+                            hist[UDHistBucket(latencies[j])]++;
+                            if (latencies[j] > maxNs) maxNs = latencies[j];
+                        }
+                        lines++;
+                        if (results[j].type == UDValueTypeErr) errors++;
+                        if (!quiet) {
+                            fputs([batch stringForValue:results[j]].UTF8String, stdout);
+                            fputc('\n', stdout);
+                        }
+                        j++;
+                    }
+                }
+            }
+            free(text);
+            free(blank);
+            free(offsets);
+            free(starts);
+            free(lengths);
+            free(results);
+            free(latencies);
+        }
+        while (jobs < 0 && (length = getline(&line, &capacity, in)) != -1) {
+            while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) length--;
+
+            @autoreleasepool {
+                // Blank lines stay blank so output lines up with input
+                if (length == 0) {
+                    if (!quiet) fputc('\n', stdout);
+                    continue;
+                }
+
+                uint64_t t0 = stats ? UDNow() : 0;
+                UDValue result = [evaluator evaluateUTF8:line length:(NSUInteger)length];
+                if (stats) {
+                    uint64_t ns = UDNow() - t0;
+                    hist[UDHistBucket(ns)]++;
+                    if (ns > maxNs) maxNs = ns;
+                }
+
+                lines++;
+                if (result.type == UDValueTypeErr) errors++;
+                if (!quiet) {
+                    fputs([evaluator stringForValue:result].UTF8String, stdout);
+                    fputc('\n', stdout);
+                }
+            }
+        }
+        free(line);
+        if (in != stdin) fclose(in);
+        fflush(stdout);
+
+        if (stats) {
+            double seconds = (double)(UDNow() - started) / 1e9;
+            fprintf(stderr, "expressions  %llu (%llu errors)\n", (unsigned long long)lines, (unsigned long long)errors);
+            fprintf(stderr, "elapsed      %.3f s\n", seconds);
+            fprintf(stderr, "throughput   %.0f expr/s\n", seconds > 0 ? (double)lines / seconds : 0.0);
+            if (lines > 0) {
+                fprintf(stderr, "latency ns   p50 %llu  p90 %llu  p99 %llu  p99.9 %llu  max %llu\n",
+                        (unsigned long long)UDHistPercentile(hist, lines, 0.50),
+                        (unsigned long long)UDHistPercentile(hist, lines, 0.90),
+                        (unsigned long long)UDHistPercentile(hist, lines, 0.99),
+                        (unsigned long long)UDHistPercentile(hist, lines, 0.999),
+                        (unsigned long long)maxNs);
+            }
+            free(hist);
+        }
+    }
+    return 0;
+}
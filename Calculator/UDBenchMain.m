@@ -0,0 +1,772 @@
+//
+//  UDBenchMain.m
+//  CalculatorBench
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+//  Microbenchmarks for each stage of evaluation: operator lookup, keypad
+//  tree building, text parsing, compiling, executing, digit entry, the
+//  stack display and tape, formatting, unit conversion and its history,
+//  and parallel batches. A benchmark runs a calibrated number of
+//  operations per sample; the report gives ns/op percentiles over the
+//  samples and object allocations per op, then the batch speedup over one
+//  worker. Inputs come from a fixed seed, so runs compare.
+//
+//  Results can be saved as JSON (-o) and read back as a baseline (-c):
+//  a benchmark whose median is slower than the baseline's by more than
+//  the threshold, or that allocates more, is flagged as a regression and
+//  the exit status is 1.
+//
+
+#import <Foundation/Foundation.h>
+#import "UDCalc.h"
+#import "UDCompiler.h"
+#import "UDConversionHistoryManager.h"
+#import "UDDecimalConversion.h"
+#import "UDFrontend.h"
+#import "UDInputBuffer.h"
+#import "UDJIT.h"
+#import "UDParallelBatch.h"
+#import "UDParser.h"
+#import "UDRegisterFile.h"
+#import "UDStackModel.h"
+#import "UDTapeLog.h"
+#import "UDUnitConverter.h"
+#import "UDValueFormatter.h"
+#import "UDVM.h"
+#ifdef GNUSTEP
+#import <Foundation/NSDebug.h>
+#endif
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Inputs cycle through this many precomputed values
+#define UD_BENCH_INPUTS 1024
+
+// One operation's result is folded in here so the work cannot be
+// optimized away.
+static volatile double sSink;
+
+typedef void (^UDBenchBody)(NSUInteger n);
+
+@interface UDBenchmark : NSObject
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, copy) UDBenchBody body;   // runs n operations
++ (instancetype)named:(NSString *)name body:(UDBenchBody)body;
+@end
+
+@implementation UDBenchmark
++ (instancetype)named:(NSString *)name body:(UDBenchBody)body {
+    UDBenchmark *benchmark = [[self alloc] init];
+    benchmark.name = name;
+    benchmark.body = body;
+    return benchmark;
+}
+@end
+
+static inline uint64_t UDNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// xorshift: the same inputs on every run
+static uint64_t sSeed = 88172645463325252ULL;
+
+static inline uint64_t UDRandom(void) {
+    sSeed ^= sSeed << 13;
+    sSeed ^= sSeed >> 7;
+    sSeed ^= sSeed << 17;
+    return sSeed;
+}
+
+static int UDCompareDoubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest rank over sorted samples
+static double UDPercentile(const double *sorted, int count, double p) {
+    int rank = (int)ceil(p * count) - 1;
+    return sorted[rank < 0 ? 0 : rank];
+}
+
+#pragma mark - Allocation counting
+
+#ifdef GNUSTEP
+// Objects allocated while gnustep-base's allocation statistics were on
+static uint64_t UDAllocationTotal(void) {
+    uint64_t total = 0;
+    Class *classes = GSDebugAllocationClassList();
+    for (Class *c = classes; c && *c; c++) total += (uint64_t)GSDebugAllocationTotal(*c);
+    free(classes);
+    return total;
+}
+#endif
+
+// Counting slows allocation down, so it is only switched on for a
+// separate, untimed pass. Without gnustep-base there is no counter: NAN.
+static double UDAllocationsPerOp(UDBenchBody body, NSUInteger n) {
+#ifdef GNUSTEP
+    BOOL wasActive = GSDebugAllocationActive(YES);
+    uint64_t before = UDAllocationTotal();
+    @autoreleasepool {
+        body(n);
+    }
+    uint64_t after = UDAllocationTotal();
+    GSDebugAllocationActive(wasActive);
+    return (double)(after - before) / (double)n;
+#else
+    (void)body;
+    (void)n;
+    return NAN;
+#endif
+}
+
+#pragma mark - Measurement
+
+// Grows the batch until one takes at least sampleNs (which also warms
+// caches, the JIT and lazily built tables), then times `samples` batches
+// of that size. Each batch drains its own autorelease pool, so freeing
+// what an operation allocated is part of its cost.
+static NSDictionary *UDMeasure(UDBenchmark *benchmark, int samples, uint64_t sampleNs) {
+    UDBenchBody body = benchmark.body;
+
+    NSUInteger n = 1;
+    for (;;) {
+        uint64_t t0 = UDNow();
+        @autoreleasepool {
+            body(n);
+        }
+        uint64_t elapsed = UDNow() - t0;
+        if (elapsed >= sampleNs || n >= (1ul << 30)) break;
+        if (elapsed < sampleNs / 64) {
+            n *= 8;
+        } else {
+            n = (NSUInteger)((double)n * (double)sampleNs / (double)elapsed * 1.1) + 1;
+        }
+    }
+
+    double *nsPerOp = malloc((size_t)samples * sizeof(double));
+    double sum = 0;
+    for (int s = 0; s < samples; s++) {
+        uint64_t t0 = UDNow();
+        @autoreleasepool {
+            body(n);
+        }
+        nsPerOp[s] = (double)(UDNow() - t0) / (double)n;
+        sum += nsPerOp[s];
+    }
+    qsort(nsPerOp, (size_t)samples, sizeof(double), UDCompareDoubles);
+
+    NSDictionary *ns = @{
+        @"min":  @(nsPerOp[0]),
+        @"p50":  @(UDPercentile(nsPerOp, samples, 0.50)),
+        @"p90":  @(UDPercentile(nsPerOp, samples, 0.90)),
+        @"p99":  @(UDPercentile(nsPerOp, samples, 0.99)),
+        @"max":  @(nsPerOp[samples - 1]),
+        @"mean": @(sum / samples),
+    };
+    free(nsPerOp);
+
+    NSMutableDictionary *result = [@{
+        @"name": benchmark.name,
+        @"opsPerSample": @(n),
+        @"samples": @(samples),
+        @"nsPerOp": ns,
+    } mutableCopy];
+    double allocs = UDAllocationsPerOp(body, MIN(n, (NSUInteger)100000));
+    if (!isnan(allocs)) result[@"allocsPerOp"] = @(allocs);
+    return result;
+}
+
+#pragma mark - Benchmarks
+
+static UDASTNode *UDParseOrDie(UDParser *parser, NSString *text) {
+    UDASTNode *tree = [parser parseString:text];
+    if (!tree) {
+        fprintf(stderr, "CalculatorBench: cannot parse %s\n", text.UTF8String);
+        exit(2);
+    }
+    return tree;
+}
+
+static NSArray<UDBenchmark *> *UDAllBenchmarks(void) {
+    NSMutableArray<UDBenchmark *> *all = [NSMutableArray array];
+
+    // Shared inputs: doubles of mixed magnitude and 64-bit integers
+    double *doubles = malloc(UD_BENCH_INPUTS * sizeof(double));
+    unsigned long long *integers = malloc(UD_BENCH_INPUTS * sizeof(unsigned long long));
+    for (int i = 0; i < UD_BENCH_INPUTS; i++) {
+        doubles[i] = (double)(UDRandom() % 2000000) / 7.0 * pow(10.0, (double)(int)(UDRandom() % 9) - 4);
+        integers[i] = UDRandom() >> (UDRandom() % 64);
+    }
+
+    // --- Frontend ---
+
+    static const UDOp kLookupOps[] = {
+        UDOpAdd, UDOpSub, UDOpMul, UDOpDiv, UDOpPercent, UDOpNegate, UDOpSquare, UDOpPow,
+        UDOpSqrt, UDOpLn, UDOpLog10, UDOpSin, UDOpCos, UDOpTan, UDOpFactorial, UDOpConstPi,
+    };
+    const NSUInteger lookupCount = sizeof(kLookupOps) / sizeof(kLookupOps[0]);
+    UDFrontend *frontend = [UDFrontend shared];
+    [all addObject:[UDBenchmark named:@"frontend.lookup" body:^(NSUInteger n) {
+        double acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            acc += [frontend infoForOp:kLookupOps[i % lookupCount]].precedence;
+        }
+        sSink = acc;
+    }]];
+
+    // --- Keypad: one op is one key of "12 + 3 × 4 − 5 ÷ 6 =" ---
+
+    static const UDOp kKeys[] = {
+        UDOpDigit0 + 1, UDOpDigit0 + 2, UDOpAdd, UDOpDigit0 + 3, UDOpMul, UDOpDigit0 + 4,
+        UDOpSub, UDOpDigit0 + 5, UDOpDiv, UDOpDigit0 + 6, UDOpEq,
+    };
+    const NSUInteger keyCount = sizeof(kKeys) / sizeof(kKeys[0]);
+    UDCalc *calc = [[UDCalc alloc] init];
+    [all addObject:[UDBenchmark named:@"calc.keypad" body:^(NSUInteger n) {
+        for (NSUInteger i = 0; i < n; i++) {
+            UDOp key = kKeys[i % keyCount];
+            if (key <= UDOpDigit9) {
+                [calc inputDigit:key];
+            } else {
+                [calc performOperation:key];
+            }
+        }
+        sSink = UDValueAsDouble(calc.currentInputValue);
+    }]];
+    // 1 + 1 × ... typed key by key with the running result after each key,
+    // restarted every 400 terms
+    UDCalc *longCalc = [[UDCalc alloc] init];
+    longCalc.showsRunningPreview = YES;
+    [all addObject:[UDBenchmark named:@"calc.longexpr" body:^(NSUInteger n) {
+        NSUInteger acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            if (i % 400 == 0) [longCalc reset];
+            [longCalc inputDigit:1];
+            [longCalc performOperation:i % 2 ? UDOpAdd : UDOpMul];
+            acc += longCalc.currentDisplayValue.length;
+        }
+        sSink = acc;
+    }]];
+
+    // --- Compiler and VM, over one mid-sized expression ---
+
+    UDParser *parser = [[UDParser alloc] init];
+    UDASTNode *tree = UDParseOrDie(parser, @"2 + 3 * sin(30) - 4 / (1 + 2)^2 + 7 * 8 - 9 / 3 + sqrt(16) * 5");
+    NSString *text = @"(1 + 2.5) * 3 - sqrt(16) / 4 ^ 2 + sin(30) - 100 + 5% + ln(e) * π";
+    [all addObject:[UDBenchmark named:@"parser.parse" body:^(NSUInteger n) {
+        NSUInteger acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            acc += [parser parseString:text].structuralHash;
+        }
+        sSink = acc;
+    }]];
+    [all addObject:[UDBenchmark named:@"compiler.program" body:^(NSUInteger n) {
+        NSUInteger acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            acc += [UDCompiler compileProgram:tree withIntegerMode:NO].count;
+        }
+        sSink = acc;
+    }]];
+    [all addObject:[UDBenchmark named:@"compiler.instructions" body:^(NSUInteger n) {
+        NSUInteger acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            acc += [UDCompiler compile:tree withIntegerMode:NO].count;
+        }
+        sSink = acc;
+    }]];
+
+    NSArray<UDInstruction *> *instructions = [UDCompiler compile:tree withIntegerMode:NO];
+    [all addObject:[UDBenchmark named:@"vm.execute" body:^(NSUInteger n) {
+        double acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            acc += UDValueAsDouble([UDVM execute:instructions]);
+        }
+        sSink = acc;
+    }]];
+
+    UDProgram *program = [UDCompiler compileProgram:tree withIntegerMode:NO];
+
+    // A keypad chain, ((x + 1) * 2) / 100 repeated: PUSH k; OP pairs back
+    // to back, which the threaded core fuses into superinstructions
+    UDProgram *chain = [UDProgram program];
+    [chain emitPush:UDValueMakeDouble(1.5)];
+    for (int i = 0; i < 64; i++) {
+        [chain emitPush:UDValueMakeDouble(1)];
+        [chain emitOp:UDOpcodeAdd];
+        [chain emitPush:UDValueMakeDouble(2)];
+        [chain emitOp:UDOpcodeMul];
+        [chain emitPush:UDValueMakeDouble(100)];
+        [chain emitOp:UDOpcodeDiv];
+    }
+
+    NSMutableArray<NSArray *> *cores = [NSMutableArray arrayWithObject:@[@"vm.switch", @(UDVMDispatchSwitch)]];
+    if (UDVM.isThreadedDispatchAvailable) [cores addObject:@[@"vm.threaded", @(UDVMDispatchThreaded)]];
+    [cores addObject:@[@"vm.native", @(UDVMDispatchNative)]];
+    for (NSArray *core in cores) {
+        UDVMDispatch dispatch = (UDVMDispatch)[core[1] integerValue];
+        // The JIT is off by default; only the native core runs with it on
+        BOOL jit = dispatch == UDVMDispatchNative;
+        [all addObject:[UDBenchmark named:core[0] body:^(NSUInteger n) {
+            UDJIT.enabled = jit;
+            double acc = 0;
+            for (NSUInteger i = 0; i < n; i++) {
+                acc += UDValueAsDouble([UDVM executeProgram:program dispatch:dispatch]);
+            }
+            sSink = acc;
+            UDJIT.enabled = NO;
+        }]];
+        [all addObject:[UDBenchmark named:[core[0] stringByAppendingString:@".chain"] body:^(NSUInteger n) {
+            UDJIT.enabled = jit;
+            double acc = 0;
+            for (NSUInteger i = 0; i < n; i++) {
+                acc += UDValueAsDouble([UDVM executeProgram:chain dispatch:dispatch]);
+            }
+            sSink = acc;
+            UDJIT.enabled = NO;
+        }]];
+    }
+
+    // 1000 pushes, then 999 adds: every stack slot is live at once
+    UDProgram *deep = [UDProgram program];
+    for (int i = 0; i < 1000; i++) [deep emitPush:UDValueMakeDouble(i)];
+    for (int i = 0; i < 999; i++) [deep emitOp:UDOpcodeAdd];
+    [all addObject:[UDBenchmark named:@"vm.deepstack" body:^(NSUInteger n) {
+        double acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            acc += UDValueAsDouble([UDVM executeProgram:deep dispatch:UDVMDispatchSwitch]);
+        }
+        sSink = acc;
+    }]];
+
+    // sin(... sin(sin(x + 1) + 1) ...), 64 deep: libm calls from native code
+    UDProgram *sines = [UDProgram program];
+    [sines emitLoad:0];
+    for (int i = 0; i < 64; i++) {
+        [sines emitPush:UDValueMakeDouble(1)];
+        [sines emitOp:UDOpcodeAdd];
+        [sines emitOp:UDOpcodeSin];
+    }
+    [all addObject:[UDBenchmark named:@"vm.native.sin" body:^(NSUInteger n) {
+        UDJIT.enabled = YES;
+        double acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            UDValue x = UDValueMakeDouble(doubles[i % UD_BENCH_INPUTS]);
+            acc += UDValueAsDouble([UDVM executeProgram:sines inputs:&x count:1 dispatch:UDVMDispatchNative]);
+        }
+        sSink = acc;
+        UDJIT.enabled = NO;
+    }]];
+
+    // --- Columns: one op is one row of x * 1.2 + 3 ---
+
+    UDProgram *scale = [UDProgram program];
+    [scale emitLoad:0];
+    [scale emitPush:UDValueMakeDouble(1.2)];
+    [scale emitOp:UDOpcodeMul];
+    [scale emitPush:UDValueMakeDouble(3)];
+    [scale emitOp:UDOpcodeAdd];
+    UDVMColumn xColumn = { UDValueTypeDouble, doubles };
+    UDValue *rows = malloc(UD_BENCH_INPUTS * sizeof(UDValue));
+    [all addObject:[UDBenchmark named:@"vm.columns" body:^(NSUInteger n) {
+        double acc = 0;
+        for (NSUInteger done = 0; done < n; done += UD_BENCH_INPUTS) {
+            NSUInteger count = MIN((NSUInteger)UD_BENCH_INPUTS, n - done);
+            [UDVM executeProgram:scale columns:&xColumn columnCount:1 count:count results:rows];
+            acc += UDValueAsDouble(rows[0]);
+        }
+        sSink = acc;
+    }]];
+
+    // --- Decimal to binary: one op is one 17-digit mantissa and exponent ---
+
+    unsigned long long *mantissas = malloc(UD_BENCH_INPUTS * sizeof(unsigned long long));
+    long *exponents = malloc(UD_BENCH_INPUTS * sizeof(long));
+    for (int i = 0; i < UD_BENCH_INPUTS; i++) {
+        mantissas[i] = UDRandom() % 100000000000000000ULL;
+        exponents[i] = (long)(UDRandom() % 80) - 40;
+    }
+    [all addObject:[UDBenchmark named:@"decimal.convert" body:^(NSUInteger n) {
+        double acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            acc += UDDoubleFromDecimal(mantissas[i % UD_BENCH_INPUTS], exponents[i % UD_BENCH_INPUTS], NO);
+        }
+        sSink = acc;
+    }]];
+
+    // --- Digit entry: one op is keying in 123456789.123 and finalizing ---
+
+    UDInputBuffer *buffer = [[UDInputBuffer alloc] init];
+    [all addObject:[UDBenchmark named:@"input.entry" body:^(NSUInteger n) {
+        double acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            [buffer performClearEntry];
+            for (int d = 1; d <= 9; d++) [buffer handleDigit:d];
+            [buffer handleDecimalPoint];
+            for (int d = 1; d <= 3; d++) [buffer handleDigit:d];
+            acc += UDValueAsDouble([buffer finalizeValue]);
+        }
+        sSink = acc;
+    }]];
+
+    // --- Stack display: one op is one x <-> y on a 10000-deep stack and the resync ---
+
+    UDRegisterFile *deepStack = [UDRegisterFile array];
+    for (NSUInteger i = 0; i < 10000; i++) [deepStack pushValue:UDValueMakeDouble(i)];
+    UDStackModel *stackModel = [[UDStackModel alloc] init];
+    UDValue (^literal)(NSUInteger) = ^UDValue(NSUInteger index) {
+        UDValue value = UDValueMakeDouble(0);
+        [deepStack getLiteral:&value atIndex:index];
+        return value;
+    };
+    [stackModel syncWithRegisters:deepStack evaluator:literal];
+    [all addObject:[UDBenchmark named:@"stack.swap" body:^(NSUInteger n) {
+        NSUInteger acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            [deepStack swapTop];
+            [stackModel syncWithRegisters:deepStack evaluator:literal];
+            acc += [stackModel takeChangedRows].count;
+        }
+        sSink = acc;
+    }]];
+    // One op is R↓, x <-> y, R↑ on the same stack, without the display
+    [all addObject:[UDBenchmark named:@"stack.roll" body:^(NSUInteger n) {
+        for (NSUInteger i = 0; i < n; i++) {
+            [deepStack rollDown];
+            [deepStack swapTop];
+            [deepStack rollUp];
+        }
+        sSink = deepStack.version;
+    }]];
+
+    // --- Tape: one op is one entry appended to a full 10000-entry tape ---
+
+    NSMutableArray<NSString *> *equations = [NSMutableArray arrayWithCapacity:UD_BENCH_INPUTS];
+    for (int i = 0; i < UD_BENCH_INPUTS; i++) {
+        [equations addObject:[NSString stringWithFormat:@"%d + 1", i]];
+    }
+    UDTapeLog *tape = [[UDTapeLog alloc] initWithCapacity:10000];
+    for (NSUInteger i = 0; i < 10000; i++) [tape appendEquation:equations[i % UD_BENCH_INPUTS] result:i];
+    [all addObject:[UDBenchmark named:@"tape.append" body:^(NSUInteger n) {
+        for (NSUInteger i = 0; i < n; i++) {
+            [tape appendEquation:equations[i % UD_BENCH_INPUTS] result:doubles[i % UD_BENCH_INPUTS]];
+        }
+        sSink = tape.evictedCount;
+    }]];
+
+    // --- Formatting: decimal doubles, then integers in each base ---
+
+    [all addObject:[UDBenchmark named:@"format.dec" body:^(NSUInteger n) {
+        NSUInteger acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            acc += [UDValueFormatter stringForValue:UDValueMakeDouble(doubles[i % UD_BENCH_INPUTS])
+                                               base:UDBaseDec
+                            showThousandsSeparators:YES
+                                      decimalPlaces:-1
+                                    forceScientific:NO].length;
+        }
+        sSink = acc;
+    }]];
+    // What format.dec replaced: an NSNumberFormatter per value
+    [all addObject:[UDBenchmark named:@"format.dec.reference" body:^(NSUInteger n) {
+        NSUInteger acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            NSNumberFormatter *fmt = [[NSNumberFormatter alloc] init];
+            fmt.numberStyle = NSNumberFormatterDecimalStyle;
+            fmt.usesGroupingSeparator = YES;
+            fmt.minimumFractionDigits = 0;
+            fmt.maximumFractionDigits = 10;
+            acc += [fmt stringFromNumber:@(doubles[i % UD_BENCH_INPUTS])].length;
+        }
+        sSink = acc;
+    }]];
+    NSArray<NSArray *> *bases = @[@[@"format.hex", @(UDBaseHex)], @[@"format.oct", @(UDBaseOct)], @[@"format.bin", @(UDBaseBin)]];
+    for (NSArray *entry in bases) {
+        UDBase base = (UDBase)[entry[1] integerValue];
+        [all addObject:[UDBenchmark named:entry[0] body:^(NSUInteger n) {
+            NSUInteger acc = 0;
+            for (NSUInteger i = 0; i < n; i++) {
+                acc += [UDValueFormatter stringForValue:UDValueMakeInt(integers[i % UD_BENCH_INPUTS])
+                                                   base:base
+                                showThousandsSeparators:NO
+                                          decimalPlaces:-1
+                                        forceScientific:NO].length;
+            }
+            sSink = acc;
+        }]];
+    }
+
+    // --- Unit conversion: one op is one value ---
+
+    UDUnitConverter *converter = [[UDUnitConverter alloc] init];
+    NSUnit *km = [NSUnitLength kilometers], *mi = [NSUnitLength miles];
+    NSUnit *celsius = [NSUnitTemperature celsius], *fahrenheit = [NSUnitTemperature fahrenheit];
+    [all addObject:[UDBenchmark named:@"units.length" body:^(NSUInteger n) {
+        double acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            acc += [converter convertValue:doubles[i % UD_BENCH_INPUTS] fromUnit:km toUnit:mi];
+        }
+        sSink = acc;
+    }]];
+    [all addObject:[UDBenchmark named:@"units.temperature" body:^(NSUInteger n) {
+        double acc = 0;
+        for (NSUInteger i = 0; i < n; i++) {
+            acc += [converter convertValue:doubles[i % UD_BENCH_INPUTS] fromUnit:celsius toUnit:fahrenheit];
+        }
+        sSink = acc;
+    }]];
+
+    // In place, alternating direction so values neither grow nor underflow
+    double *column = malloc(UD_BENCH_INPUTS * sizeof(double));
+    memcpy(column, doubles, UD_BENCH_INPUTS * sizeof(double));
+    [all addObject:[UDBenchmark named:@"units.column" body:^(NSUInteger n) {
+        BOOL forward = YES;
+        for (NSUInteger done = 0; done < n; done += UD_BENCH_INPUTS) {
+            NSUInteger count = MIN((NSUInteger)UD_BENCH_INPUTS, n - done);
+            [converter convertValues:column count:count from:forward ? km : mi to:forward ? mi : km];
+            forward = !forward;
+        }
+        sSink = column[0];
+    }]];
+    // The same with an offset: Celsius and Fahrenheit
+    double *temperatures = malloc(UD_BENCH_INPUTS * sizeof(double));
+    memcpy(temperatures, doubles, UD_BENCH_INPUTS * sizeof(double));
+    [all addObject:[UDBenchmark named:@"units.column.temperature" body:^(NSUInteger n) {
+        BOOL forward = YES;
+        for (NSUInteger done = 0; done < n; done += UD_BENCH_INPUTS) {
+            NSUInteger count = MIN((NSUInteger)UD_BENCH_INPUTS, n - done);
+            [converter convertValues:temperatures count:count from:forward ? celsius : fahrenheit
+                                                                 to:forward ? fahrenheit : celsius];
+            forward = !forward;
+        }
+        sSink = temperatures[0];
+    }]];
+
+    // Conversion history at a cap of 5000: one op is one add, cycling
+    // through every pair of units. Writes are left pending; nothing here
+    // runs the run loop.
+    NSMutableArray<NSDictionary *> *conversions = [NSMutableArray array];
+    for (NSString *cat in [converter availableCategories]) {
+        for (NSUnit *from in [converter unitsForCategory:cat]) {
+            for (NSUnit *to in [converter unitsForCategory:cat]) {
+                [conversions addObject:@{ @"cat": cat, @"from": from, @"to": to }];
+            }
+        }
+    }
+    NSUserDefaults *benchDefaults = [[NSUserDefaults alloc] initWithSuiteName:@"CalculatorBench"];
+    UDConversionHistoryManager *history = [[UDConversionHistoryManager alloc] initWithDefaults:benchDefaults
+                                                                                     converter:converter];
+    history.maxItems = 5000;
+    [all addObject:[UDBenchmark named:@"units.history.add" body:^(NSUInteger n) {
+        NSUInteger count = conversions.count;
+        for (NSUInteger i = 0; i < n; i++) [history addConversion:conversions[i % count]];
+        sSink = history.maxItems;
+    }]];
+
+    // --- Batch: one op is one line, over 1, 2, 4, ... workers up to one per core ---
+
+    static const char *const kBatchExpressions[] = {
+        "2 + 3 * 4", "sqrt(16) / 4 ^ 2", "(1 + 2.5) * 3 - 100", "sin(30) + cos(60)",
+        "ln(e) * π", "5! - 7 / 3", "2 ^ 10 + 3 ^ 5", "1 / (1 + 1 / (1 + 1 / 3))",
+    };
+    const NSUInteger expressionCount = sizeof(kBatchExpressions) / sizeof(kBatchExpressions[0]);
+    const char **batchLines = malloc(UD_BENCH_INPUTS * sizeof(char *));
+    NSUInteger *batchLengths = malloc(UD_BENCH_INPUTS * sizeof(NSUInteger));
+    UDValue *batchResults = malloc(UD_BENCH_INPUTS * sizeof(UDValue));
+    for (int i = 0; i < UD_BENCH_INPUTS; i++) {
+        batchLines[i] = kBatchExpressions[UDRandom() % expressionCount];
+        batchLengths[i] = strlen(batchLines[i]);
+    }
+    NSUInteger cores = MAX(NSProcessInfo.processInfo.activeProcessorCount, (NSUInteger)1);
+    for (NSUInteger workers = 1;; workers = MIN(workers * 2, cores)) {
+        UDParallelBatch *batch = [[UDParallelBatch alloc] initWithWorkerCount:workers];
+        NSString *name = [NSString stringWithFormat:@"batch.parallel.%lu", (unsigned long)workers];
+        [all addObject:[UDBenchmark named:name body:^(NSUInteger n) {
+            double acc = 0;
+            for (NSUInteger done = 0; done < n; done += UD_BENCH_INPUTS) {
+                NSUInteger count = MIN((NSUInteger)UD_BENCH_INPUTS, n - done);
+                [batch evaluateUTF8Lines:batchLines lengths:batchLengths count:count results:batchResults latencies:NULL];
+                acc += UDValueAsDouble(batchResults[0]);
+            }
+            sSink = acc;
+        }]];
+        if (workers == cores) break;
+    }
+
+    return all;
+}
+
+#pragma mark - Baseline
+
+static NSDictionary<NSString *, NSDictionary *> *UDLoadBaseline(const char *path) {
+    NSData *data = [NSData dataWithContentsOfFile:@(path)];
+    NSDictionary *json = data ? [NSJSONSerialization JSONObjectWithData:data options:0 error:NULL] : nil;
+    if (![json isKindOfClass:[NSDictionary class]] || ![json[@"benchmarks"] isKindOfClass:[NSArray class]]) {
+        fprintf(stderr, "CalculatorBench: %s is not a CalculatorBench report\n", path);
+        return nil;
+    }
+    NSMutableDictionary *byName = [NSMutableDictionary dictionary];
+    for (NSDictionary *entry in json[@"benchmarks"]) {
+        if ([entry isKindOfClass:[NSDictionary class]] && [entry[@"name"] isKindOfClass:[NSString class]]) {
+            byName[entry[@"name"]] = entry;
+        }
+    }
+    return byName;
+}
+
+// Sets *verdict to a note for the report; returns YES on a regression.
+static BOOL UDCompare(NSDictionary *result, NSDictionary *base, double threshold, NSString **verdict) {
+    if (!base) {
+        *verdict = @"new";
+        return NO;
+    }
+    double now = [result[@"nsPerOp"][@"p50"] doubleValue];
+    double then = [base[@"nsPerOp"][@"p50"] doubleValue];
+    double change = then > 0 ? (now - then) / then : 0;
+    BOOL slower = change > threshold;
+
+    BOOL moreAllocs = NO;
+    if (result[@"allocsPerOp"] && base[@"allocsPerOp"]) {
+        double delta = [result[@"allocsPerOp"] doubleValue] - [base[@"allocsPerOp"] doubleValue];
+        moreAllocs = delta > 0.5;
+    }
+
+    *verdict = [NSString stringWithFormat:@"%+6.1f%%%@%@", change * 100,
+                slower ? @"  REGRESSION" : (change < -threshold ? @"  faster" : @""),
+                moreAllocs ? @"  MORE ALLOCS" : @""];
+    return slower || moreAllocs;
+}
+
+#pragma mark - Parallel speedup
+
+// Median time per line on one worker over the median on k workers
+static void UDReportSpeedup(FILE *table, NSArray<NSDictionary *> *results) {
+    NSString *prefix = @"batch.parallel.";
+    double single = 0;
+    for (NSDictionary *result in results) {
+        if ([result[@"name"] isEqualToString:[prefix stringByAppendingString:@"1"]]) {
+            single = [result[@"nsPerOp"][@"p50"] doubleValue];
+        }
+    }
+    if (single <= 0) return;
+
+    fprintf(table, "\n%-22s %11s %9s\n", "workers", "speedup", "per core");
+    for (NSDictionary *result in results) {
+        NSString *name = result[@"name"];
+        if (![name hasPrefix:prefix]) continue;
+        double p50 = [result[@"nsPerOp"][@"p50"] doubleValue];
+        int workers = [name substringFromIndex:prefix.length].intValue;
+        double speedup = p50 > 0 ? single / p50 : 0;
+        fprintf(table, "%-22d %10.2fx %8.0f%%\n", workers, speedup, speedup / workers * 100);
+    }
+}
+
+#pragma mark - Main
+
+static void UDUsage(FILE *out) {
+    fprintf(out,
+        "usage: CalculatorBench [-l] [-f filter] [-s samples] [-t ms] [-o file] [-c baseline] [-r percent]\n"
+        "  -l          list benchmarks and exit\n"
+        "  -f filter   only run benchmarks whose name contains filter\n"
+        "  -s samples  timed samples per benchmark (default 30)\n"
+        "  -t ms       minimum duration of one sample (default 10)\n"
+        "  -o file     write results as JSON, - for standard output\n"
+        "  -c baseline compare with a report written by -o; exit 1 on a regression\n"
+        "  -r percent  slowdown of the median counted as a regression (default 10)\n");
+}
+
+int main(int argc, char *argv[]) {
+    @autoreleasepool {
+        const char *filter = NULL, *outPath = NULL, *basePath = NULL;
+        int samples = 30;
+        double sampleMs = 10, threshold = 0.10;
+        BOOL list = NO;
+
+        int opt;
+        while ((opt = getopt(argc, argv, "lf:s:t:o:c:r:h")) != -1) {
+            switch (opt) {
+                case 'l': list = YES; break;
+                case 'f': filter = optarg; break;
+                case 's': samples = atoi(optarg); break;
+                case 't': sampleMs = atof(optarg); break;
+                case 'o': outPath = optarg; break;
+                case 'c': basePath = optarg; break;
+                case 'r': threshold = atof(optarg) / 100.0; break;
+                case 'h': UDUsage(stdout); return 0;
+                default:  UDUsage(stderr); return 2;
+            }
+        }
+        if (samples < 1 || sampleMs <= 0 || threshold < 0) {
+            UDUsage(stderr);
+            return 2;
+        }
+
+        NSDictionary<NSString *, NSDictionary *> *baseline = nil;
+        if (basePath && !(baseline = UDLoadBaseline(basePath))) return 2;
+
+        NSArray<UDBenchmark *> *benchmarks = UDAllBenchmarks();
+        if (list) {
+            for (UDBenchmark *benchmark in benchmarks) printf("%s\n", benchmark.name.UTF8String);
+            return 0;
+        }
+
+        // The table goes to stderr when the JSON takes stdout
+        BOOL jsonToStdout = outPath && strcmp(outPath, "-") == 0;
+        FILE *table = jsonToStdout ? stderr : stdout;
+        fprintf(table, "%-22s %11s %9s %9s %9s %9s %9s%s\n", "benchmark", "ops/sample",
+                "min ns", "p50 ns", "p90 ns", "p99 ns", "allocs", baseline ? "  vs baseline p50" : "");
+
+        NSMutableArray<NSDictionary *> *results = [NSMutableArray array];
+        BOOL regressed = NO;
+        for (UDBenchmark *benchmark in benchmarks) {
+            if (filter && !strstr(benchmark.name.UTF8String, filter)) continue;
+
+            NSDictionary *result = UDMeasure(benchmark, samples, (uint64_t)(sampleMs * 1e6));
+            [results addObject:result];
+
+            NSDictionary *ns = result[@"nsPerOp"];
+            NSString *allocs = result[@"allocsPerOp"]
+                ? [NSString stringWithFormat:@"%.2f", [result[@"allocsPerOp"] doubleValue]] : @"-";
+            NSString *verdict = @"";
+            if (baseline) regressed |= UDCompare(result, baseline[benchmark.name], threshold, &verdict);
+
+            fprintf(table, "%-22s %11lu %9.1f %9.1f %9.1f %9.1f %9s%s%s\n", benchmark.name.UTF8String,
+                    (unsigned long)[result[@"opsPerSample"] unsignedLongValue],
+                    [ns[@"min"] doubleValue], [ns[@"p50"] doubleValue],
+                    [ns[@"p90"] doubleValue], [ns[@"p99"] doubleValue],
+                    allocs.UTF8String, baseline ? "  " : "", verdict.UTF8String);
+            fflush(table);
+        }
+        UDReportSpeedup(table, results);
+
+        if (outPath) {
+            NSDictionary *report = @{
+                @"tool": @"CalculatorBench",
+                @"samples": @(samples),
+                @"sampleMs": @(sampleMs),
+                @"benchmarks": results,
+            };
+            NSData *json = [NSJSONSerialization dataWithJSONObject:report options:NSJSONWritingPrettyPrinted error:NULL];
+            if (jsonToStdout) {
+                fwrite(json.bytes, 1, json.length, stdout);
+                fputc('\n', stdout);
+            } else if (![json writeToFile:@(outPath) atomically:YES]) {
+                perror(outPath);
+                return 2;
+            }
+        }
+
+        if (regressed) {
+            fprintf(stderr, "CalculatorBench: slower than the baseline by more than %.0f%%\n", threshold * 100);
+            return 1;
+        }
+    }
+    return 0;
+}
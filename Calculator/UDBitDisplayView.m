@@ -7,115 +7,156 @@
 
 #import "UDBitDisplayView.h"
 
+// The bits that carry a position label underneath, left to right
+static const int kUDMarkerBits[] = {63, 47, 32, 31, 15, 0};
+enum { kUDMarkerCount = sizeof(kUDMarkerBits) / sizeof(kUDMarkerBits[0]) };
+
+// Glyphs are rendered once and shared by every instance: "0" and "1",
+// then one image per marker label. Drawing a bit is a single image blit
+// instead of laying out a string.
+static NSImage *sBitGlyphs[2];
+static NSImage *sMarkerGlyphs[kUDMarkerCount];
+
+static NSImage *UDRenderGlyph(NSString *text, NSDictionary *attrs) {
+    NSSize size = [text sizeWithAttributes:attrs];
+    NSImage *image = [[NSImage alloc] initWithSize:NSMakeSize(ceil(size.width), ceil(size.height))];
+    [image lockFocus];
+    [text drawAtPoint:NSZeroPoint withAttributes:attrs];
+    [image unlockFocus];
+    return image;
+}
+
+static void UDPrepareGlyphs(void) {
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        // Bits: Smaller font, Gray color
+        NSDictionary *bitAttrs = @{
+            NSFontAttributeName: [NSFont monospacedSystemFontOfSize:10 weight:NSFontWeightRegular],
+            NSForegroundColorAttributeName: [NSColor grayColor]
+        };
+        // Markers (63, 47, etc): Larger font, White color
+        NSDictionary *markerAttrs = @{
+            NSFontAttributeName: [NSFont systemFontOfSize:11 weight:NSFontWeightBold],
+            NSForegroundColorAttributeName: [NSColor whiteColor]
+        };
+
+        sBitGlyphs[0] = UDRenderGlyph(@"0", bitAttrs);
+        sBitGlyphs[1] = UDRenderGlyph(@"1", bitAttrs);
+        for (int m = 0; m < kUDMarkerCount; m++) {
+            sMarkerGlyphs[m] = UDRenderGlyph([NSString stringWithFormat:@"%d", kUDMarkerBits[m]], markerAttrs);
+        }
+    });
+}
+
 @implementation UDBitDisplayView {
-    NSMutableArray<NSValue *> *_bitRects;
+    // Layout for the current bounds size, indexed by bit number.
+    // Recomputed only when the size changes.
+    NSSize _layoutSize;
+    BOOL _hasLayout;
+    NSRect _bitRects[64];       // hit-test and invalidation box per bit
+    NSRect _glyphRects[64];     // where the "0"/"1" glyph lands inside it
+    NSRect _markerRects[kUDMarkerCount];
 }
 
 - (void)setValue:(uint64_t)value {
+    uint64_t changed = _value ^ value;
     _value = value;
-    [self setNeedsDisplay:YES];
+    if (changed == 0) return;
+
+    // Only the boxes of flipped bits need repainting; a marker sits
+    // inside its bit's box, so it is covered too.
+    [self updateLayoutIfNeeded];
+    while (changed) {
+        int bit = __builtin_ctzll(changed);
+        changed &= changed - 1;
+        [self setNeedsDisplayInRect:_bitRects[bit]];
+    }
 }
 
-- (void)drawRect:(NSRect)dirtyRect {
-    [super drawRect:dirtyRect];
+#pragma mark - Layout
 
-    // Draw an explicit dark background so the light text is always visible.
-    [[NSColor blackColor] setFill];
-    NSRectFill(self.bounds);
-    
-    if (!_bitRects) _bitRects = [NSMutableArray array];
-    [_bitRects removeAllObjects];
+- (void)updateLayoutIfNeeded {
+    NSSize size = self.bounds.size;
+    if (_hasLayout && NSEqualSizes(size, _layoutSize)) return;
+    _layoutSize = size;
+    _hasLayout = YES;
+
+    UDPrepareGlyphs();
 
     // CONFIGURATION
-    CGFloat rowHeight = self.bounds.size.height / 2.0;
+    CGFloat rowHeight = size.height / 2.0;
     CGFloat nibbleGap = 8.0;
     // 7 gaps in a row of 8 nibbles (32 bits)
     CGFloat totalGapSpace = 7.0 * nibbleGap;
-    CGFloat availableWidth = self.bounds.size.width - totalGapSpace;
+    CGFloat availableWidth = size.width - totalGapSpace;
     CGFloat bitWidth = availableWidth / 32.0;
-    
-    // --- STYLING UPDATES ---
-    // Bits: Smaller font, Gray color
-    NSDictionary *bitAttrs = @{
-        NSFontAttributeName: [NSFont monospacedSystemFontOfSize:10 weight:NSFontWeightRegular],
-        NSForegroundColorAttributeName: [NSColor grayColor]
-    };
-    
-    // Markers (63, 47, etc): Larger font, White color
-    NSDictionary *markerAttrs = @{
-        NSFontAttributeName: [NSFont systemFontOfSize:11 weight:NSFontWeightBold],
-        NSForegroundColorAttributeName: [NSColor whiteColor]
-    };
-
-    // DRAWING LOOP (63 down to 0)
-    for (int i = 63; i >= 0; i--) {
+
+    NSSize glyphSize = sBitGlyphs[0].size;
+
+    for (int i = 0; i < 64; i++) {
         BOOL isTopRow = (i >= 32);
         int colIndex = isTopRow ? (63 - i) : (31 - i); // 0 is Left-most column
-        
-        // Calculate Gaps
-        int gapCount = colIndex / 4;
-        
+
         // Calculate Position
-        CGFloat x = (colIndex * bitWidth) + (gapCount * nibbleGap);
+        CGFloat x = (colIndex * bitWidth) + ((colIndex / 4) * nibbleGap);
         CGFloat y = isTopRow ? rowHeight : 0;
-        
-        // 1. Draw the Bit (0 or 1)
-        BOOL isSet = (_value >> i) & 1;
-        NSString *bitStr = isSet ? @"1" : @"0";
-        
-        // Calculate text size for centering
-        CGSize bitSize = [bitStr sizeWithAttributes:bitAttrs];
-        
-        // Center vertically in the top portion of the row (leaving space for marker below)
-        CGFloat bitY = y + 12 + (rowHeight - 12 - bitSize.height) / 2;
-        
-        NSRect textRect = NSMakeRect(
-            x + (bitWidth - bitSize.width)/2,
-            bitY,
-            bitSize.width,
-            bitSize.height
-        );
-        [bitStr drawInRect:textRect withAttributes:bitAttrs];
-        
-        // Store Hit-Test Rect
-        NSRect touchRect = NSMakeRect(x, y, bitWidth, rowHeight);
-        [_bitRects addObject:[NSValue valueWithRect:touchRect]];
-        
-        // 2. Draw Markers (63, 47, 32...)
-        BOOL shouldLabel = (i == 63 || i == 47 || i == 32 ||
-                            i == 31 || i == 15 || i == 0);
-        
-        if (shouldLabel) {
-            NSString *label = [NSString stringWithFormat:@"%d", i];
-            CGSize labelSize = [label sizeWithAttributes:markerAttrs];
-            
-            // Draw below the bit, closer to the bottom edge
-            NSRect labelRect = NSMakeRect(
-                x + (bitWidth - labelSize.width)/2,
-                y + 2,
-                labelSize.width,
-                labelSize.height
-            );
-            [label drawInRect:labelRect withAttributes:markerAttrs];
-        }
+
+        _bitRects[i] = NSMakeRect(x, y, bitWidth, rowHeight);
+
+        // Center vertically in the top portion of the row (leaving space for
+        // marker below). Whole points keep the blit from resampling.
+        _glyphRects[i] = NSMakeRect(round(x + (bitWidth - glyphSize.width) / 2),
+                                    round(y + 12 + (rowHeight - 12 - glyphSize.height) / 2),
+                                    glyphSize.width, glyphSize.height);
+    }
+
+    for (int m = 0; m < kUDMarkerCount; m++) {
+        NSRect box = _bitRects[kUDMarkerBits[m]];
+        NSSize labelSize = sMarkerGlyphs[m].size;
+        // Draw below the bit, closer to the bottom edge
+        _markerRects[m] = NSMakeRect(round(NSMinX(box) + (NSWidth(box) - labelSize.width) / 2),
+                                     NSMinY(box) + 2,
+                                     labelSize.width, labelSize.height);
+    }
+}
+
+#pragma mark - Drawing
+
+- (void)drawRect:(NSRect)dirtyRect {
+    [super drawRect:dirtyRect];
+    [self updateLayoutIfNeeded];
+
+    // Draw an explicit dark background so the light text is always visible.
+    [[NSColor blackColor] setFill];
+    NSRectFill(dirtyRect);
+
+    for (int i = 0; i < 64; i++) {
+        if (!NSIntersectsRect(_bitRects[i], dirtyRect)) continue;
+        [sBitGlyphs[(_value >> i) & 1] drawInRect:_glyphRects[i]
+                                          fromRect:NSZeroRect
+                                         operation:NSCompositingOperationSourceOver
+                                          fraction:1.0];
+    }
+
+    for (int m = 0; m < kUDMarkerCount; m++) {
+        if (!NSIntersectsRect(_markerRects[m], dirtyRect)) continue;
+        [sMarkerGlyphs[m] drawInRect:_markerRects[m]
+                            fromRect:NSZeroRect
+                           operation:NSCompositingOperationSourceOver
+                            fraction:1.0];
     }
 }
 
 // HANDLE CLICKS
 - (void)mouseDown:(NSEvent *)event {
     NSPoint point = [self convertPoint:event.locationInWindow fromView:nil];
-    
+
     // Since we introduced gaps, simple division (x / width) no longer works reliably.
-    // Instead, we check the cached rects we generated during drawing.
-    // The _bitRects array is filled in loop order: Index 0 = Bit 63, Index 63 = Bit 0.
-    
-    for (int i = 0; i < _bitRects.count; i++) {
-        NSRect r = [_bitRects[i] rectValue];
-        
+    // Instead, we check the cached rects from the layout, indexed by bit number.
+    [self updateLayoutIfNeeded];
+    for (int bitIndex = 0; bitIndex < 64; bitIndex++) {
         // Check if the click is inside this specific bit's box
-        if (NSPointInRect(point, r)) {
-            int bitIndex = 63 - i; // Map array index back to bit index
-            
+        if (NSPointInRect(point, _bitRects[bitIndex])) {
             BOOL currentBit = (_value >> bitIndex) & 1;
             [self.delegate bitDisplayDidToggleBit:bitIndex toValue:!currentBit];
             return; // Stop looking once found
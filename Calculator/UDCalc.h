@@ -11,6 +11,7 @@
 #import "UDInputBuffer.h"
 
 @class UDCalc;
+@class UDEvaluationMemo;
 
 typedef NS_ENUM(NSInteger, UDCalcMode) {
     UDCalcModeBasic         = 1,
@@ -56,6 +57,10 @@ typedef NS_ENUM(NSInteger, UDSYState) {
 // YES = User is editing the buffer.
 // NO = User just hit an Op/Equals, buffer is "fresh".
 @property (nonatomic, assign) BOOL isTyping;
+// When YES, the display shows the running result of an unfinished infix
+// expression while it waits for an operand ("2 + 3 ×" shows 5), instead of
+// an empty entry. Off by default.
+@property (nonatomic, assign) BOOL showsRunningPreview;
 
 // The "Forest" of trees.
 // Usually holds just 1 item if the equation is done.
@@ -75,11 +80,27 @@ typedef NS_ENUM(NSInteger, UDSYState) {
 - (NSString *)currentDisplayValue;
 - (NSArray<UDNumberNode *> *)currentStackValues; // Returns evaluated numbers for X, Y, Z...
 
+// The same rows without the allocations, for the RPN stack display:
+// bottom first, the last row is X. Values and strings are cached and
+// brought up to date incrementally (see UDStackModel).
+- (NSUInteger)stackRowCount;
+- (UDValue)stackValueAtRow:(NSUInteger)row;
+- (NSString *)stackStringAtRow:(NSUInteger)row;
+// Rows whose contents changed since the last call, X included.
+- (NSIndexSet *)takeChangedStackRows;
+
 // The "Run" Button
 // Compiles the current AST and executes it on the VM.
 - (UDValue)evaluateNode:(UDASTNode *)node;
+// This calculator's subtree values, so a tree grown by one operator costs
+// one opcode. Emptied when the mode, angle unit or integer mode changes.
+@property (nonatomic, readonly) UDEvaluationMemo *evaluationMemo;
 - (UDValue)evaluateCurrentExpression;
 
+// The value "=" would produce now, without changing any state. NO when
+// there is no unfinished infix expression (or in RPN mode).
+- (BOOL)runningPreview:(UDValue *)value;
+
 - (NSString *)stringForValue:(UDValue)value;
 
 - (NSString *)currentValueEncoded;
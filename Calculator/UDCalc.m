@@ -6,22 +6,45 @@
 //
 
 #import "UDCalc.h"
+#import "UDProgramCache.h"
+#import "UDRegisterFile.h"
 #import "UDCompiler.h"
-#import "UDVM.h"
+#import "UDStackModel.h"
 #import "UDValueFormatter.h"
 
 @interface UDCalc ()
 @property (strong, readwrite) NSMutableArray<UDASTNode *> *nodeStack;
 @property (strong) NSMutableArray<NSNumber *> *opStack;
 @property (nonatomic, assign) UDSYState syState;
+// Compiled programs and results for the trees on nodeStack, so redraws
+// and repeated "=" skip compiling and executing.
+@property (nonatomic, strong) UDProgramCache *programCache;
+// Flat storage for the current expression; compiling a grown tree only
+// imports its new nodes. Emptied in one go on reset.
+@property (nonatomic, strong) UDASTArena *expressionArena;
+// Evaluated and formatted rows for the RPN stack display.
+@property (nonatomic, strong) UDStackModel *stackModel;
+// nodeStack, as the ring buffer it is
+@property (nonatomic, readonly) UDRegisterFile *registers;
 @end
 
-@implementation UDCalc
+@implementation UDCalc {
+    // Generation of evaluationMemo; a new one empties it and tells the
+    // stack model its values are stale.
+    uint64_t _evaluationStamp;
+    BOOL _stampIntegerMode;
+    uint64_t _stackModelStamp;
+}
 
 - (instancetype)init {
     self = [super init];
     if (self) {
         self.inputBuffer = [[UDInputBuffer alloc] init];
+        _expressionArena = [[UDASTArena alloc] init];
+        _programCache = [[UDProgramCache alloc] initWithCapacity:64];
+        _programCache.arena = _expressionArena;
+        _evaluationMemo = [[UDEvaluationMemo alloc] init];
+        _stackModel = [[UDStackModel alloc] init];
         _isRadians = YES;
         _encodingMode = UDCalcEncodingModeNone;
         [self reset];
@@ -30,10 +53,11 @@
 }
 
 - (void)reset {
-    _nodeStack = [NSMutableArray array];
+    _nodeStack = [UDRegisterFile array];
     _opStack = [NSMutableArray array];
     _isTyping = NO;
     _syState = UDSYStateIdle;
+    [self.expressionArena removeAllNodes];
     [self.inputBuffer performClearEntry];
 }
 
@@ -42,6 +66,7 @@
         [self.nodeStack removeAllObjects];
         [self.opStack removeAllObjects];
     }
+    [self.expressionArena removeAllNodes];
     [self.inputBuffer performClearEntry];
     self.syState  = UDSYStateIdle;
     self.isTyping = NO;
@@ -62,10 +87,22 @@
         || self.syState == UDSYStateTypingNumber;  // ← add this
 }
 
+- (UDRegisterFile *)registers {
+    return (UDRegisterFile *)_nodeStack;
+}
+
+// Value of the top of stack; a typed number is read from its register
+// without a node or an evaluation.
+- (UDValue)topOfStackValue {
+    UDValue val;
+    if ([self.registers getLiteral:&val atIndex:self.registers.count - 1]) return val;
+    return [self evaluateNode:self.nodeStack.lastObject];
+}
+
 // Helper: update display to show current X without touching the stack
 - (void)sy_refreshDisplayFromStack {
     if (self.nodeStack.count > 0) {
-        UDValue val = [self evaluateNode:self.nodeStack.lastObject];
+        UDValue val = [self topOfStackValue];
         [self.inputBuffer performClearEntry];
         [self.inputBuffer loadConstant:val];
         self.isTyping = NO;   // ← display only, NOT a typing event
@@ -81,11 +118,19 @@
 
 - (void)setMode:(UDCalcMode)newMode {
     _mode = newMode;
+    [self.programCache removeAllEntries];
     if (_mode == UDCalcModeProgrammer) {
         self.inputBuffer.isIntegerMode = YES;
     } else {
         self.inputBuffer.isIntegerMode = NO;
     }
+    [self invalidateEvaluations];
+}
+
+- (void)setIsRadians:(BOOL)isRadians {
+    _isRadians = isRadians;
+    [self.programCache removeAllEntries];
+    [self invalidateEvaluations];
 }
 
 - (UDBase)inputBase {
@@ -94,6 +139,17 @@
 
 - (void)setInputBase:(UDBase)newBase {
     self.inputBuffer.inputBase = newBase;
+    [self.stackModel invalidateStrings];
+}
+
+- (void)setShowThousandsSeparators:(BOOL)showThousandsSeparators {
+    _showThousandsSeparators = showThousandsSeparators;
+    [self.stackModel invalidateStrings];
+}
+
+- (void)setDecimalPlaces:(NSInteger)decimalPlaces {
+    _decimalPlaces = decimalPlaces;
+    [self.stackModel invalidateStrings];
 }
 
 - (void)flushBufferToStack {
@@ -102,7 +158,7 @@
     }
 
     UDValue val = [self.inputBuffer finalizeValue];
-    [self.nodeStack addObject:[UDNumberNode value:val]];
+    [self.registers pushValue:val];
     [self.inputBuffer performClearEntry];
     self.isTyping = NO;
 }
@@ -110,7 +166,7 @@
 - (void)moveBufferToStack {
     if (self.isTyping) {
         UDValue val = [self.inputBuffer finalizeValue];
-        [self.nodeStack addObject:[UDNumberNode value:val]];
+        [self.registers pushValue:val];
         self.isTyping = NO;   // ← buffer is committed, no longer live
     }
 }
@@ -118,10 +174,9 @@
 // put whatever is now on top of stack onto the input buffer
 - (void)moveStackToBuffer:(BOOL)pushOnDigit {
     if (self.nodeStack.count > 0) {
-        UDASTNode *topNode = self.nodeStack.lastObject;
+        UDValue val = [self topOfStackValue];
         [self.nodeStack removeLastObject];
 
-        UDValue val = [self evaluateNode:topNode];
         [self.inputBuffer loadConstant:val];
         self.isTyping = YES;
 
@@ -402,19 +457,11 @@
 
         // Ensure there is always something in X to duplicate
         if (self.nodeStack.count == 0) {
-            [self.nodeStack addObject:[UDNumberNode value:UDValueMakeDouble(0.0)]];
+            [self.registers pushValue:UDValueMakeDouble(0.0)];
         }
 
-        // Duplicate X
-        UDASTNode *topNode = (self.nodeStack.count > 0)
-            ? self.nodeStack.lastObject
-            : [UDNumberNode value:UDValueMakeDouble(0.0)];
-
-        UDASTNode *copy = [topNode conformsToProtocol:@protocol(NSCopying)]
-            ? [topNode copy]
-            : topNode;
-
-        [self.nodeStack addObject:copy];
+        // Duplicate X: the register, sharing its tree (trees are immutable)
+        [self.registers duplicateTop];
         self.syState = UDSYStateRPNResult;
         return;
     }
@@ -428,32 +475,21 @@
 
     if (op == UDOpSwap) {
         [self flushBufferToStack];
-        if (self.nodeStack.count >= 2) {
-            NSInteger n = self.nodeStack.count;
-            [self.nodeStack exchangeObjectAtIndex:(n-1) withObjectAtIndex:(n-2)];
-        }
+        [self.registers swapTop];
         [self sy_refreshDisplayFromStack];
         return;
     }
 
     if (op == UDOpRollDown) {
         [self flushBufferToStack];
-        if (self.nodeStack.count > 1) {
-            UDASTNode *x = self.nodeStack.lastObject;
-            [self.nodeStack removeLastObject];
-            [self.nodeStack insertObject:x atIndex:0];
-        }
+        [self.registers rollDown];
         [self sy_refreshDisplayFromStack];
         return;
     }
 
     if (op == UDOpRollUp) {
         [self flushBufferToStack];
-        if (self.nodeStack.count > 1) {
-            UDASTNode *top = self.nodeStack.firstObject;
-            [self.nodeStack removeObjectAtIndex:0];
-            [self.nodeStack addObject:top];
-        }
+        [self.registers rollUp];
         [self sy_refreshDisplayFromStack];
         return;
     }
@@ -484,7 +520,7 @@
         [self flushBufferToStack];
     } else if (self.nodeStack.count == 0) {
         // Nothing at all — implicit zero
-        [self.nodeStack addObject:[UDNumberNode value:UDValueMakeDouble(0.0)]];
+        [self.registers pushValue:UDValueMakeDouble(0.0)];
     }
 
     if (self.nodeStack.count < 1) return;
@@ -578,10 +614,14 @@
 }
 
 -(UDASTNode *)createNode:(UDOpInfo *)info {
+    return [self createNode:info onStack:self.nodeStack];
+}
+
+- (UDASTNode *)createNode:(UDOpInfo *)info onStack:(NSMutableArray<UDASTNode *> *)stack {
     if (!info || !info.action) return nil;
     
     UDFrontendContext *context = [[UDFrontendContext alloc] init];
-    context.nodeStack = self.nodeStack;
+    context.nodeStack = stack;
     context.isRadians = self.isRadians;
     context.memoryValue = self.memoryRegister;
     
@@ -594,9 +634,63 @@
     if (node) [self.nodeStack addObject:node];
 }
 
+- (void)invalidateEvaluations {
+    _evaluationStamp++;
+    _stampIntegerMode = self.inputBuffer.isIntegerMode;
+    [_evaluationMemo removeAllValues];
+}
+
+// Current generation; a new one if integer mode changed behind our back.
+- (uint64_t)evaluationStamp {
+    if (_evaluationStamp == 0 || self.inputBuffer.isIntegerMode != _stampIntegerMode) [self invalidateEvaluations];
+    return _evaluationStamp;
+}
+
+// Incremental first: a tree that grew by one operator over evaluated
+// children costs one opcode, not a compile of the whole expression.
 - (UDValue)evaluateNode:(UDASTNode *)node {
-    NSArray *bytecode = [UDCompiler compile:node withIntegerMode:self.inputBuffer.isIntegerMode];
-    return [UDVM execute:bytecode];
+    [self evaluationStamp];
+    BOOL integerMode = self.inputBuffer.isIntegerMode;
+
+    UDValue value;
+    if ([UDCompiler evaluateIncrementally:node integerMode:integerMode memo:_evaluationMemo result:&value]) {
+        return value;
+    }
+
+    value = [self.programCache evaluateNode:node integerMode:integerMode];
+    // Lets the next operator over this tree be incremental again. Not an
+    // error, which an operator above would take for one the VM raised.
+    if (node && value.type != UDValueTypeErr) [_evaluationMemo setValue:value forNode:node];
+    return value;
+}
+
+- (BOOL)runningPreview:(UDValue *)value {
+    if (self.isRPNMode || self.opStack.count == 0) return NO;
+
+    // What "=" would reduce, on copies; only the new parents get evaluated
+    NSMutableArray<UDASTNode *> *nodes = [self.nodeStack mutableCopy];
+    NSMutableArray<NSNumber *> *ops = [self.opStack mutableCopy];
+    if (self.isTyping) {
+        [nodes addObject:[UDNumberNode value:[self.inputBuffer finalizeValue]]];
+    } else if (self.syState == UDSYStateAfterOperator) {
+        // "2 × (3 +": the trailing operator has no right operand yet
+        while (ops.count > 0 && [ops.lastObject integerValue] == UDOpParenLeft) [ops removeLastObject];
+        if (ops.count > 0) [ops removeLastObject];
+    }
+
+    while (ops.count > 0) {
+        UDOpInfo *info = [[UDFrontend shared] infoForOp:[ops.lastObject integerValue]];
+        [ops removeLastObject];
+        if (info.tag == UDOpParenLeft) continue;
+        if (info.placement != UDOpPlacementInfix || nodes.count < 2) return NO;
+        UDASTNode *node = [self createNode:info onStack:nodes];
+        if (!node) return NO;
+        [nodes addObject:node];
+    }
+    if (nodes.count == 0) return NO;
+
+    *value = [self evaluateNode:nodes.lastObject];
+    return YES;
 }
 
 - (UDValue)evaluateCurrentExpression {
@@ -617,26 +711,69 @@
 }
 
 - (NSString *)currentDisplayValue {
+    UDValue preview;
+    if (self.showsRunningPreview && self.syState == UDSYStateAfterOperator && [self runningPreview:&preview]) {
+        return [self stringForValue:preview];
+    }
     return [self.inputBuffer displayStringWithThousandsSeparators:self.showThousandsSeparators];
 }
 
 - (NSArray<UDNumberNode *> *)currentStackValues {
-    NSMutableArray<UDNumberNode *> *values = [NSMutableArray array];
-    
-    // Iterate through the entire node stack
-    for (UDASTNode *node in self.nodeStack) {
-        // Resolve the tree (e.g., "3 + 5") into a number (8.0)
-        UDValue val = [self evaluateNode:node];
-        [values addObject:[UDNumberNode value:val]];
+    NSUInteger count = [self stackRowCount];
+    NSMutableArray<UDNumberNode *> *values = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger row = 0; row < count; row++) {
+        [values addObject:[UDNumberNode value:[self stackValueAtRow:row]]];
     }
+    return [values copy];
+}
 
-    if (self.isTyping) {
-        [values addObject:[UDNumberNode value:[self.inputBuffer finalizeValue]]];
-    } else {
-        [values addObject:[UDNumberNode value:UDValueMakeDouble(0.0)]];
-    }
+#pragma mark - Stack rows
+
+// A full sync only when the cheap check fails, so row lookups stay O(1)
+- (void)syncStackModel:(BOOL)force {
+    uint64_t stamp = [self evaluationStamp];
+    if (stamp != _stackModelStamp) {
+        [self.stackModel invalidateValues];
+        _stackModelStamp = stamp;
+    }
+    if (!force && [self.stackModel isInSyncWithRegisters:self.registers]) return;
+    UDRegisterFile *registers = self.registers;
+    [self.stackModel syncWithRegisters:registers evaluator:^UDValue(NSUInteger index) {
+        // A number pushed by a key is read as it is, without making its node
+        UDValue value;
+        if ([registers getLiteral:&value atIndex:index]) return value;
+        return [self evaluateNode:registers[index]];
+    }];
+}
 
-    return [values copy];
+// X: the entry while typing, else 0
+- (UDValue)stackXValue {
+    return self.isTyping ? [self.inputBuffer finalizeValue] : UDValueMakeDouble(0.0);
+}
+
+- (NSUInteger)stackRowCount {
+    [self syncStackModel:NO];
+    return self.stackModel.count + 1;
+}
+
+- (UDValue)stackValueAtRow:(NSUInteger)row {
+    [self syncStackModel:NO];
+    return row < self.stackModel.count ? [self.stackModel valueAtRow:row] : [self stackXValue];
+}
+
+- (NSString *)stackStringAtRow:(NSUInteger)row {
+    [self syncStackModel:NO];
+    if (row >= self.stackModel.count) return [self stringForValue:[self stackXValue]];
+    return [self.stackModel stringAtRow:row formatter:^NSString *(UDValue value) {
+        return [self stringForValue:value];
+    }];
+}
+
+- (NSIndexSet *)takeChangedStackRows {
+    [self syncStackModel:YES];
+    NSMutableIndexSet *rows = [[self.stackModel takeChangedRows] mutableCopy];
+    [rows addIndex:self.stackModel.count];   // X follows every key
+    return rows;
 }
 
 - (NSString *)stringForValue:(UDValue)value {
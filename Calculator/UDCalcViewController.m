@@ -18,6 +18,9 @@ NSString * const UDCalcResultKey = @"UDCalcResultKey";
 
 @interface UDCalcViewController ()
 @property (nonatomic, assign) NSInteger previousEncodingSegment;
+// Filler rows above the stack at the last reload; when they change, every
+// row moves and the table is reloaded whole.
+@property (nonatomic, assign) NSInteger shownStackFillerRows;
 @end
 
 // XIB-designed standard sizes (matching the frame rects in UDCalcView.xib)
@@ -229,6 +232,7 @@ static const CGFloat kRPNDisplayHeight  = 103.0;  /* XIB-designed height for RPN
     self.calc.isBinaryViewShown = settings.showBinaryView;
     self.calc.showThousandsSeparators = settings.showThousandsSeparators;
     self.calc.decimalPlaces = settings.decimalPlaces;
+    self.calc.memoryRegister = settings.memoryRegister;
 
     // Update Segment Control UI to match loaded state
     if (settings.encodingMode == UDCalcEncodingModeNone) {
@@ -273,6 +277,7 @@ static const CGFloat kRPNDisplayHeight  = 103.0;  /* XIB-designed height for RPN
     settings.showBinaryView = self.calc.isBinaryViewShown;
     settings.showThousandsSeparators = self.calc.showThousandsSeparators;
     settings.decimalPlaces = self.calc.decimalPlaces;
+    settings.memoryRegister = self.calc.memoryRegister;
 
     [settings forceSync];
 }
@@ -688,16 +693,15 @@ static const CGFloat kRPNDisplayHeight  = 103.0;  /* XIB-designed height for RPN
 
 // 1. Data Source: How many rows?
 - (NSInteger)numberOfRowsInTableView:(NSTableView *)tableView {
-    NSInteger count = self.calc.currentStackValues.count;
+    NSInteger count = (NSInteger)self.calc.stackRowCount;
     return count + [self calculateFillerRows:tableView forActualRows:count];
 }
 
 // 2. View For Row: What to display?
 - (NSView *)tableView:(NSTableView *)tableView viewForTableColumn:(NSTableColumn *)tableColumn row:(NSInteger)row {
 
-    NSArray<UDNumberNode *> *values = [self.calc currentStackValues];
-
-    NSInteger fillerRowCount = [self calculateFillerRows:tableView forActualRows:values.count];
+    NSInteger count = (NSInteger)self.calc.stackRowCount;
+    NSInteger fillerRowCount = [self calculateFillerRows:tableView forActualRows:count];
     
     // Check if this is a filler row
     if (row < fillerRowCount) {
@@ -731,18 +735,18 @@ static const CGFloat kRPNDisplayHeight  = 103.0;  /* XIB-designed height for RPN
     }
     
     // FETCH DATA
-    // Note: currentStackValues[0] is usually bottom of stack (history).
+    // Note: stack row 0 is the bottom of stack (history).
     // Apple's UI usually puts X (Top of Stack) at the BOTTOM visually.
     // So Row 0 = Deep History. Row Last = X Register.
 
-    if (row < values.count) {
-        UDValue val = values[row].value;
-        cell.textField.stringValue = [self.calc stringForValue:val];
+    if (row < count) {
+        // Formatted once per value, not per redraw
+        cell.textField.stringValue = [self.calc stackStringAtRow:row];
         
         // Styling: The last row is always the X Register (Active) -> Bold
         // If we are typing, the Buffer (handled above) is X.
         // If not typing, the last stack item is X.
-        BOOL isXRegister = (row == values.count - 1);
+        BOOL isXRegister = (row == count - 1);
         
         if (isXRegister) {
             cell.textField.font = [NSFont boldSystemFontOfSize:22];
@@ -764,6 +768,27 @@ static const CGFloat kRPNDisplayHeight  = 103.0;  /* XIB-designed height for RPN
     return cell;
 }
 
+// Only the rows the last key changed are reloaded, and the table lays out
+// only the visible ones, so a deep stack costs what a shallow one does.
+- (void)reloadStackTable {
+    NSTableView *table = self.stackTableView;
+    NSIndexSet *changed = [self.calc takeChangedStackRows];
+    NSInteger count = (NSInteger)self.calc.stackRowCount;
+    NSInteger fillers = [self calculateFillerRows:table forActualRows:count];
+
+    if (fillers > 0 || self.shownStackFillerRows > 0) {
+        // A short stack: rows shift with the fillers, and there are few
+        [table reloadData];
+    } else {
+        if (table.numberOfRows != count) [table noteNumberOfRowsChanged];
+        NSMutableIndexSet *rows = [changed mutableCopy];
+        [rows removeIndexesInRange:NSMakeRange((NSUInteger)count, NSNotFound - (NSUInteger)count)];
+        [table reloadDataForRowIndexes:rows
+                         columnIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, (NSUInteger)table.numberOfColumns)]];
+    }
+    self.shownStackFillerRows = fillers;
+}
+
 #pragma mark - Helper
 
 - (void)updateDisplayIndicators {
@@ -815,7 +840,7 @@ static const CGFloat kRPNDisplayHeight  = 103.0;  /* XIB-designed height for RPN
     
     if (self.calc.isRPNMode) {
         // --- RPN TABLE UPDATE ---
-        [self.stackTableView reloadData];
+        [self reloadStackTable];
 
         // Auto-scroll to the bottom (The X Register)
         NSInteger rowCount = [self.stackTableView numberOfRows];
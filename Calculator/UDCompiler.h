@@ -6,9 +6,50 @@
 //
 
 #import "UDAST.h"
+#import "UDASTArena.h"
 #import "UDInstruction.h"
+#import "UDProgram.h"
 
+// Subtree values left by +[UDCompiler evaluateIncrementally:...], keyed
+// by node identity. Nodes are immutable and may be interned and shared,
+// so their values live here, with the evaluator that computed them,
+// rather than on the nodes; nodes are held weakly. Not thread-safe: one
+// per evaluator. Values only hold for the settings they were computed
+// under, so the owner empties it when those change.
+@interface UDEvaluationMemo : NSObject
+@property (nonatomic, readonly) NSUInteger count;
+- (BOOL)getValue:(UDValue *)value forNode:(UDASTNode *)node;
+- (void)setValue:(UDValue)value forNode:(UDASTNode *)node;
+- (void)removeAllValues;
+@end
+
+// Stateless: every entry point may run on several threads at once, as
+// long as each thread passes its own arena and memo.
 @interface UDCompiler : NSObject
-// The main entry point
+// The main entry point: emits a packed program for UDVM.
++ (UDProgram *)compileProgram:(UDASTNode *)root withIntegerMode:(BOOL)integerMode;
++ (UDProgram *)compileProgram:(UDASTNode *)root withIntegerMode:(BOOL)integerMode optimize:(BOOL)optimize;
+
+// Imports the tree into arena first, reusing subtrees it already holds.
++ (UDProgram *)compileProgram:(UDASTNode *)root inArena:(UDASTArena *)arena withIntegerMode:(BOOL)integerMode optimize:(BOOL)optimize;
+
+// Code generation proper: a post-order walk over the arena columns with an
+// explicit work stack rather than recursive isKindOfClass: dispatch.
++ (UDProgram *)compileArena:(UDASTArena *)arena root:(UDASTRef)root withIntegerMode:(BOOL)integerMode;
+
+// Folds every opcode whose operands are all known at compile time into a
+// single PUSH. Results are bit-identical to running the original program.
++ (UDProgram *)optimizeProgram:(UDProgram *)program;
+
+// Evaluates root without compiling it: each operator runs once, through
+// UDVM, over its operands' values, and every subtree's value is memoized
+// in memo. An expression grown by one operator over memoized children
+// costs that one opcode. Results are those of executing compileProgram:.
+// Returns NO where only a program will do (input variables, unknown
+// operators and functions, error literals, very deep trees), for the
+// caller to compile.
++ (BOOL)evaluateIncrementally:(UDASTNode *)root integerMode:(BOOL)integerMode memo:(UDEvaluationMemo *)memo result:(UDValue *)result;
+
+// Same program, expanded into one UDInstruction object per opcode.
 + (NSArray<UDInstruction *> *)compile:(UDASTNode *)root withIntegerMode:(BOOL)integerMode;
 @end
@@ -9,144 +9,422 @@
 #import "UDFrontend.h"
 #import "UDFrontendContext.h"
 #import "UDConstants.h"
+#import "UDVM.h"
 
 @implementation UDCompiler
 
 + (NSArray<UDInstruction *> *)compile:(UDASTNode *)root withIntegerMode:(BOOL)integerMode {
-    NSMutableArray *program = [NSMutableArray array];
-    [self visitNode:root into:program withIntegerMode:integerMode];
-    return program;
+    return [[self compileProgram:root withIntegerMode:integerMode] instructions];
 }
 
-+ (void)visitNode:(UDASTNode *)node into:(NSMutableArray *)prog withIntegerMode:(BOOL)integerMode {
-    // 1. NUMBER NODE
++ (UDProgram *)compileProgram:(UDASTNode *)root withIntegerMode:(BOOL)integerMode {
+    return [self compileProgram:root withIntegerMode:integerMode optimize:NO];
+}
+
++ (UDProgram *)compileProgram:(UDASTNode *)root withIntegerMode:(BOOL)integerMode optimize:(BOOL)optimize {
+    return [self compileProgram:root inArena:[UDASTArena new] withIntegerMode:integerMode optimize:optimize];
+}
+
++ (UDProgram *)compileProgram:(UDASTNode *)root inArena:(UDASTArena *)arena withIntegerMode:(BOOL)integerMode optimize:(BOOL)optimize {
+    UDASTRef ref = [arena importNode:root];
+    UDProgram *program = [self compileArena:arena root:ref withIntegerMode:integerMode];
+    return optimize ? [self optimizeProgram:program] : program;
+}
+
+#pragma mark - Constant folding
+
+// Works on the emitted bytecode rather than the tree, so parens (which emit
+// nothing) are already gone and the percent rewrite folds like any other
+// sequence. Code is straight-line: when an opcode's operands were all pushed
+// by the instructions right before it, they are exactly the top of the stack,
+// and UDVM evaluates the opcode with its own implementation. An opcode whose
+// result would be an error (divide by zero) stays in the program so the VM
+// still reports it.
++ (UDProgram *)optimizeProgram:(UDProgram *)program {
+    if (program.status == UDProgramStatusRejected) return program;
+
+    typedef struct { UDOpcode opcode; UDValue value; uint32_t slot; } UDFoldSlot;
+
+    const UDInsn *code = program.code;
+    NSUInteger n = program.count;
+
+    UDFoldSlot *slots = malloc((n ? n : 1) * sizeof(UDFoldSlot));
+    NSUInteger len = 0;
+    NSUInteger pushes = 0; // trailing run of PUSH slots
+
+    for (NSUInteger i = 0; i < n; i++) {
+        UDOpcode op = (UDOpcode)code[i].opcode;
+        if (op == UDOpcodePush) {
+            slots[len++] = (UDFoldSlot){ UDOpcodePush, [program constantAtIndex:code[i].operand], 0 };
+            pushes++;
+            continue;
+        }
+
+        NSUInteger arity = [UDVM operandCountForOpcode:op];
+        UDValue operands[2], result;
+        if (arity > 0 && arity <= pushes) {
+            for (NSUInteger j = 0; j < arity; j++) operands[j] = slots[len - arity + j].value;
+            if ([UDVM foldOpcode:op operands:operands result:&result]) {
+                len -= arity;
+                slots[len++] = (UDFoldSlot){ UDOpcodePush, result, 0 };
+                pushes = pushes - arity + 1;
+                continue;
+            }
+        }
+
+        // LOAD keeps its input slot; an input is never known at compile time
+        slots[len++] = (UDFoldSlot){ op, UDValueMakeError(UDValueErrorTypeUnknown), code[i].operand };
+        pushes = 0;
+    }
+
+    UDProgram *folded = [UDProgram programWithCapacity:len];
+    for (NSUInteger i = 0; i < len; i++) {
+        if (slots[i].opcode == UDOpcodePush) [folded emitPush:slots[i].value];
+        else if (slots[i].opcode == UDOpcodeLoad) [folded emitLoad:slots[i].slot];
+        else [folded emitOp:slots[i].opcode];
+    }
+    free(slots);
+    return folded;
+}
+
+#pragma mark - Code generation
+
+static BOOL UDUnaryOpcode(NSInteger tag, BOOL integerMode, UDOpcode *opcode) {
+    if (tag == UDOpNegate) *opcode = integerMode ? UDOpcodeNegI : UDOpcodeNeg;
+    else if (tag == UDOpComp1) *opcode = UDOpcodeBitNot;
+    else return NO;
+    return YES;
+}
+
+static BOOL UDBinaryOpcode(NSInteger tag, BOOL integerMode, UDOpcode *opcode) {
+    if (tag == UDOpAdd) *opcode = integerMode ? UDOpcodeAddI : UDOpcodeAdd;
+    else if (tag == UDOpSub) *opcode = integerMode ? UDOpcodeSubI : UDOpcodeSub;
+    else if (tag == UDOpMul) *opcode = integerMode ? UDOpcodeMulI : UDOpcodeMul;
+    else if (tag == UDOpDiv) *opcode = integerMode ? UDOpcodeDivI : UDOpcodeDiv;
+    else if (tag == UDOpBitwiseAnd) *opcode = UDOpcodeBitAnd;
+    else if (tag == UDOpBitwiseOr) *opcode = UDOpcodeBitOr;
+    else if (tag == UDOpBitwiseXor) *opcode = UDOpcodeBitXor;
+    else if (tag == UDOpShiftLeft) *opcode = UDOpcodeShiftLeft;
+    else if (tag == UDOpShiftRight) *opcode = UDOpcodeShiftRight;
+    else if (tag == UDOpRotateLeft) *opcode = UDOpcodeRotateLeft;
+    else if (tag == UDOpRotateRight) *opcode = UDOpcodeRotateRight;
+    else return NO;
+    return YES;
+}
+
+// Indexed by UDFunctionID; both lists come from UD_FUNCTIONS.
+static const UDOpcode kUDFunctionOpcodes[UDFunctionCount] = {
+#define UD_FUNCTION_OPCODE(name, str, mnemonic) UDOpcode##name,
+    UD_FUNCTIONS(UD_FUNCTION_OPCODE)
+#undef UD_FUNCTION_OPCODE
+};
+
+static BOOL UDFunctionOpcode(NSInteger fid, UDOpcode *opcode) {
+    if (fid < 0 || fid >= UDFunctionCount) return NO;
+    *opcode = kUDFunctionOpcodes[fid];
+    return YES;
+}
+
+// One pending step of the post-order walk.
+typedef enum { UDTaskVisit, UDTaskEmitOp, UDTaskEmitPush } UDTaskKind;
+typedef struct {
+    UDTaskKind kind;
+    UDASTRef ref;       // UDTaskVisit
+    UDOpcode opcode;    // UDTaskEmitOp
+    UDValue value;      // UDTaskEmitPush
+} UDTask;
+
+typedef struct {
+    UDTask *items;
+    NSUInteger count, capacity;
+} UDTaskStack;
+
+static inline void UDTaskPush(UDTaskStack *s, UDTask t) {
+    if (s->count == s->capacity) {
+        s->capacity *= 2;
+        s->items = realloc(s->items, s->capacity * sizeof(UDTask));
+    }
+    s->items[s->count++] = t;
+}
+
+#define VISIT(r)  ((UDTask){ .kind = UDTaskVisit, .ref = (r) })
+#define OP(o)     ((UDTask){ .kind = UDTaskEmitOp, .opcode = (o) })
+#define PUSH(v)   ((UDTask){ .kind = UDTaskEmitPush, .value = (v) })
+
++ (UDProgram *)compileArena:(UDASTArena *)arena root:(UDASTRef)root withIntegerMode:(BOOL)integerMode {
+    UDASTColumns col = arena.columns;
+    UDProgram *prog = [UDProgram programWithCapacity:arena.count + 1];
+
+    UDTaskStack work = { malloc(32 * sizeof(UDTask)), 0, 32 };
+    UDTaskPush(&work, VISIT(root));
+    BOOL unknownFunction = NO;
+
+    // Tasks are pushed in reverse so they pop in emission order.
+    while (work.count > 0) {
+        UDTask t = work.items[--work.count];
+        if (t.kind == UDTaskEmitOp) { [prog emitOp:t.opcode]; continue; }
+        if (t.kind == UDTaskEmitPush) { [prog emitPush:t.value]; continue; }
+
+        UDASTRef r = t.ref;
+        if (r == UDASTRefNone) continue;
+        NSInteger tag = col.tag[r];
+        UDOpcode opcode;
+
+        switch ((UDASTKind)col.kind[r]) {
+            case UDASTKindNumber:
+            case UDASTKindConstant:
+                [prog emitPush:col.value[r]];
+                break;
+
+            case UDASTKindUnary:
+                if (UDUnaryOpcode(tag, integerMode, &opcode)) UDTaskPush(&work, OP(opcode));
+                else NSLog(@"Unhandled unary prefix op: %ld", (long)tag);
+                UDTaskPush(&work, VISIT(col.a[r]));
+                break;
+
+            case UDASTKindPostfix:
+                if (tag == UDOpPercent) {
+                    UDTaskPush(&work, OP(UDOpcodeDiv));
+                    UDTaskPush(&work, PUSH(UDValueMakeDouble(100.0)));
+                } else if (tag == UDOpFactorial) {
+                    UDTaskPush(&work, OP(UDOpcodeFact));
+                }
+                else NSLog(@"Unhandled postfix op: %ld", (long)tag);
+                UDTaskPush(&work, VISIT(col.a[r]));
+                break;
+
+            case UDASTKindBinary: {
+                if (UDBinaryOpcode(tag, integerMode, &opcode)) UDTaskPush(&work, OP(opcode));
+                else NSLog(@"Unhandled binary op: %ld", (long)tag);
+
+                // if the right operand is a postfix with percent operator, and we are looking at a binary op:
+                // e.g. 100 + 5% --> translate into
+                //   100
+                //   + 100 * 0.05
+                UDASTRef right = col.b[r];
+                if ((tag == UDOpAdd || tag == UDOpSub)
+                    && right != UDASTRefNone
+                    && col.kind[right] == UDASTKindPostfix
+                    && col.tag[right] == UDOpPercent) {
+                    UDTaskPush(&work, OP(integerMode ? UDOpcodeMulI : UDOpcodeMul));
+                    UDTaskPush(&work, OP(integerMode ? UDOpcodeDivI : UDOpcodeDiv));
+                    UDTaskPush(&work, PUSH(integerMode ? UDValueMakeInt(100) : UDValueMakeDouble(100.0)));
+                    UDTaskPush(&work, VISIT(col.a[right]));
+                    UDTaskPush(&work, VISIT(col.a[r]));
+                } else {
+                    UDTaskPush(&work, VISIT(right));
+                }
+                UDTaskPush(&work, VISIT(col.a[r]));
+                break;
+            }
+
+            case UDASTKindFunction:
+                if (UDFunctionOpcode(tag, &opcode)) UDTaskPush(&work, OP(opcode));
+                else {
+                    NSLog(@"Unhandled function call %@", [arena stringAtIndex:(int32_t)UDValueAsInt(col.value[r])]);
+                    unknownFunction = YES;
+                }
+                // Arguments in order, so the last one is pushed first.
+                for (UDASTRef i = col.b[r]; i > 0; i--) {
+                    UDTaskPush(&work, VISIT(col.args[col.a[r] + i - 1]));
+                }
+                break;
+
+            case UDASTKindParen:
+                UDTaskPush(&work, VISIT(col.a[r]));
+                break;
+
+            case UDASTKindVariable:
+                [prog emitLoad:(uint32_t)tag];
+                break;
+        }
+    }
+
+    free(work.items);
+
+    // Nothing sensible to run in place of a function we have no opcode for.
+    if (unknownFunction) [prog markRejectedWithError:UDValueErrorTypeUnknown];
+    return prog;
+}
+
+#undef VISIT
+#undef OP
+#undef PUSH
+
+#pragma mark - Incremental evaluation
+
+// Past this depth the recursion hands the tree to the compiler, whose
+// walk uses an explicit stack.
+static const NSUInteger kUDIncrementalMaxDepth = 256;
+
+static inline UDValue UDApply(UDOpcode opcode, UDValue a, UDValue b) {
+    UDValue operands[2] = { a, b };
+    return [UDVM applyOpcode:opcode operands:operands];
+}
+
+// Mirrors compileArena: node for node. Operands are evaluated left to
+// right and an error result stops evaluation, as it stops the program:
+// every error an operator returns is one the VM would have returned
+// from the middle of the program. An error literal is the exception
+// (the VM computes on its payload), so trees holding one are declined.
+static BOOL UDEvaluateMemoized(UDASTNode *node, BOOL integerMode, UDEvaluationMemo *memo, NSUInteger depth, UDValue *result) {
+    if ([memo getValue:result forNode:node]) return YES;
+    if (depth > kUDIncrementalMaxDepth) return NO;
+
+#define OPERAND(n, out) \
+    do { \
+        if (!UDEvaluateMemoized((n), integerMode, memo, depth + 1, (out))) return NO; \
+        if ((out)->type == UDValueTypeErr) { value = *(out); goto done; } \
+    } while (0)
+
+    UDValue value, a, b;
+    UDOpcode opcode;
+
+    // Leaves are not worth a memo
     if ([node isKindOfClass:[UDNumberNode class]]) {
-        UDNumberNode *n = (UDNumberNode *)node;
-        [prog addObject:[UDInstruction push:n.value]]; // Access property directly
+        *result = ((UDNumberNode *)node).value;
+        return result->type != UDValueTypeErr;
     }
     else if ([node isKindOfClass:[UDConstantNode class]]) {
-        UDConstantNode *n = (UDConstantNode *)node;
-        [prog addObject:[UDInstruction push:n.value]];
+        *result = ((UDConstantNode *)node).value;
+        return result->type != UDValueTypeErr;
+    }
+    else if ([node isKindOfClass:[UDParenNode class]]) {
+        OPERAND(((UDParenNode *)node).child, &a);
+        value = a;
     }
     else if ([node isKindOfClass:[UDUnaryOpNode class]]) {
-        UDUnaryOpNode *un = (UDUnaryOpNode *)node;
-        [self visitNode:un.child into:prog withIntegerMode:integerMode];
-
-        if (un.info.tag == UDOpNegate) [prog addObject:[UDInstruction op:integerMode ? UDOpcodeNegI : UDOpcodeNeg]];
-        else if (un.info.tag == UDOpComp1) [prog addObject:[UDInstruction op:UDOpcodeBitNot]];
-        else NSLog(@"Unhandled unary prefix op: %ld", un.info.tag);
+        UDUnaryOpNode *unary = (UDUnaryOpNode *)node;
+        if (!UDUnaryOpcode(unary.info.tag, integerMode, &opcode)) return NO;
+        OPERAND(unary.child, &a);
+        value = UDApply(opcode, a, a);
     }
-    
     else if ([node isKindOfClass:[UDPostfixOpNode class]]) {
-        UDPostfixOpNode *pn = (UDPostfixOpNode *)node;
-        [self visitNode:pn.child into:prog withIntegerMode:integerMode];
-        
-        if (pn.info.tag == UDOpPercent) {
-            [prog addObject:[UDInstruction push:UDValueMakeDouble(100.0)]];
-            [prog addObject:[UDInstruction op:UDOpcodeDiv]];
-        } else if (pn.info.tag == UDOpFactorial) {
-            [prog addObject:[UDInstruction op:UDOpcodeFact]];
-        }
-        else NSLog(@"Unhandled postfix op: %ld", pn.info.tag);
+        UDPostfixOpNode *postfix = (UDPostfixOpNode *)node;
+        NSInteger tag = postfix.info.tag;
+        if (tag != UDOpPercent && tag != UDOpFactorial) return NO;
+        OPERAND(postfix.child, &a);
+        value = tag == UDOpPercent ? UDApply(UDOpcodeDiv, a, UDValueMakeDouble(100.0)) : UDApply(UDOpcodeFact, a, a);
     }
-    
-    // 2. BINARY OPERATOR (Recursively visit Left, then Right, then Op)
     else if ([node isKindOfClass:[UDBinaryOpNode class]]) {
-        UDBinaryOpNode *bin = (UDBinaryOpNode *)node;
-
-        // Recursion First (Post-Order Traversal)
-        [self visitNode:bin.left into:prog withIntegerMode:integerMode];
-
-        // if the right operand is a postfix with percent operator, and we are looking at a binary op:
-        // e.g. 100 + 5% --> translate into
-        //   100
-        //   + 100 * 0.05
-        if ((bin.info.tag == UDOpAdd || bin.info.tag == UDOpSub)
-            && [bin.right isKindOfClass:[UDPostfixOpNode class]]
-            && ((UDPostfixOpNode *)bin.right).info.tag == UDOpPercent) {
-            UDPostfixOpNode *pn = (UDPostfixOpNode *)bin.right;
-            
-            [self visitNode:bin.left into:prog withIntegerMode:integerMode];
-
-            [self visitNode:pn.child into:prog withIntegerMode:integerMode];
-            [prog addObject:[UDInstruction push:integerMode ? UDValueMakeInt(100) : UDValueMakeDouble(100.0)]];
-            [prog addObject:[UDInstruction op:integerMode ? UDOpcodeDivI : UDOpcodeDiv]];
-            [prog addObject:[UDInstruction op:integerMode ? UDOpcodeMulI : UDOpcodeMul]];
+        UDBinaryOpNode *binary = (UDBinaryOpNode *)node;
+        NSInteger tag = binary.info.tag;
+        if (!UDBinaryOpcode(tag, integerMode, &opcode)) return NO;
+        OPERAND(binary.left, &a);
+
+        // 100 + 5% is 100 + 100 * (5 / 100), as compiled
+        UDASTNode *right = binary.right;
+        if ((tag == UDOpAdd || tag == UDOpSub) && [right isKindOfClass:[UDPostfixOpNode class]]
+            && ((UDPostfixOpNode *)right).info.tag == UDOpPercent) {
+            OPERAND(((UDPostfixOpNode *)right).child, &b);
+            b = UDApply(integerMode ? UDOpcodeDivI : UDOpcodeDiv, b, integerMode ? UDValueMakeInt(100) : UDValueMakeDouble(100.0));
+            if (b.type != UDValueTypeErr) b = UDApply(integerMode ? UDOpcodeMulI : UDOpcodeMul, a, b);
+            if (b.type == UDValueTypeErr) { value = b; goto done; }
         } else {
-            [self visitNode:bin.right into:prog withIntegerMode:integerMode];
+            OPERAND(right, &b);
         }
-
-        // Emit Opcode
-        if (bin.info.tag == UDOpAdd) [prog addObject:[UDInstruction op:integerMode? UDOpcodeAddI : UDOpcodeAdd]];
-        else if (bin.info.tag == UDOpSub) [prog addObject:[UDInstruction op:integerMode? UDOpcodeSubI : UDOpcodeSub]];
-        else if (bin.info.tag == UDOpMul) [prog addObject:[UDInstruction op:integerMode? UDOpcodeMulI : UDOpcodeMul]];
-        else if (bin.info.tag == UDOpDiv) [prog addObject:[UDInstruction op:integerMode? UDOpcodeDivI : UDOpcodeDiv]];
-        else if (bin.info.tag == UDOpBitwiseAnd) [prog addObject:[UDInstruction op:UDOpcodeBitAnd]];
-        else if (bin.info.tag == UDOpBitwiseOr) [prog addObject:[UDInstruction op:UDOpcodeBitOr]];
-        else if (bin.info.tag == UDOpBitwiseXor) [prog addObject:[UDInstruction op:UDOpcodeBitXor]];
-        else if (bin.info.tag == UDOpShiftLeft) [prog addObject:[UDInstruction op:UDOpcodeShiftLeft]];
-        else if (bin.info.tag == UDOpShiftRight) [prog addObject:[UDInstruction op:UDOpcodeShiftRight]];
-        else if (bin.info.tag == UDOpRotateLeft) [prog addObject:[UDInstruction op:UDOpcodeRotateLeft]];
-        else if (bin.info.tag == UDOpRotateRight) [prog addObject:[UDInstruction op:UDOpcodeRotateRight]];
-        else NSLog(@"Unhandled binary op: %ld", bin.info.tag);
-    }
-    
-    // 3. FUNCTION CALL
+        value = UDApply(opcode, a, b);
+    }
     else if ([node isKindOfClass:[UDFunctionNode class]]) {
-        UDFunctionNode *func = (UDFunctionNode *)node;
-        // Compile all arguments in order
-        for (UDASTNode *arg in func.args) {
-            [self visitNode:arg into:prog withIntegerMode:integerMode];
-        }
-        // Emit Call
-        
-        NSString *name = func.name;
-        UDOpcode opcode;
+        UDFunctionNode *function = (UDFunctionNode *)node;
+        NSArray<UDASTNode *> *args = function.args;
+        if (!UDFunctionOpcode(function.functionID, &opcode) || args.count > 2
+            || args.count != [UDVM operandCountForOpcode:opcode]) return NO;
+        UDValue operands[2] = { UDValueMakeDouble(0), UDValueMakeDouble(0) };
+        for (NSUInteger i = 0; i < args.count; i++) OPERAND(args[i], &operands[i]);
+        value = [UDVM applyOpcode:opcode operands:operands];
+    }
+    else {
+        return NO;  // Variables read inputs only a program has
+    }
+#undef OPERAND
 
-        if ([name isEqualToString:UDConstPow]) opcode = UDOpcodePow;
-        else if ([name isEqualToString:UDConstSqrt]) opcode = UDOpcodeSqrt;
-        else if ([name isEqualToString:UDConstLn]) opcode = UDOpcodeLn;
-
-        else if ([name isEqualToString:UDConstSin]) opcode = UDOpcodeSin;
-        else if ([name isEqualToString:UDConstSinD]) opcode = UDOpcodeSinD;
-        else if ([name isEqualToString:UDConstASin]) opcode = UDOpcodeASin;
-        else if ([name isEqualToString:UDConstASinD]) opcode = UDOpcodeASinD;
-        else if ([name isEqualToString:UDConstCos]) opcode = UDOpcodeCos;
-        else if ([name isEqualToString:UDConstCosD]) opcode = UDOpcodeCosD;
-        else if ([name isEqualToString:UDConstACos]) opcode = UDOpcodeACos;
-        else if ([name isEqualToString:UDConstACosD]) opcode = UDOpcodeACosD;
-        else if ([name isEqualToString:UDConstTan]) opcode = UDOpcodeTan;
-        else if ([name isEqualToString:UDConstTanD]) opcode = UDOpcodeTanD;
-        else if ([name isEqualToString:UDConstATan]) opcode = UDOpcodeATan;
-        else if ([name isEqualToString:UDConstATanD]) opcode = UDOpcodeATanD;
-
-        else if ([name isEqualToString:UDConstSinH]) opcode = UDOpcodeSinH;
-        else if ([name isEqualToString:UDConstASinH]) opcode = UDOpcodeASinH;
-        else if ([name isEqualToString:UDConstCosH]) opcode = UDOpcodeCosH;
-        else if ([name isEqualToString:UDConstACosH]) opcode = UDOpcodeACosH;
-        else if ([name isEqualToString:UDConstTanH]) opcode = UDOpcodeTanH;
-        else if ([name isEqualToString:UDConstATanH]) opcode = UDOpcodeATanH;
-
-        else if ([name isEqualToString:UDConstLog10]) opcode = UDOpcodeLog10;
-        else if ([name isEqualToString:UDConstLog2]) opcode = UDOpcodeLog2;
-
-        else if ([name isEqualToString:UDConstFact]) opcode = UDOpcodeFact;
-        
-        else if ([name isEqualToString:UDConstFlipB]) opcode = UDOpcodeFlipB;
-        else if ([name isEqualToString:UDConstFlipW]) opcode = UDOpcodeFlipW;
-        
-        else {
-            NSLog(@"Unhandled function call %@", name);
-            opcode = UDOpcodeSqrt;
-        }
+done:
+    [memo setValue:value forNode:node];
+    *result = value;
+    return YES;
+}
+
++ (BOOL)evaluateIncrementally:(UDASTNode *)root integerMode:(BOOL)integerMode memo:(UDEvaluationMemo *)memo result:(UDValue *)result {
+    if (!root || !memo) return NO;
+    return UDEvaluateMemoized(root, integerMode, memo, 0, result);
+}
+@end
+
+#pragma mark - Evaluation memo
+
+// Enough for a long keypad expression before the first resize.
+static const NSUInteger kUDEvaluationMemoDefaultCapacity = 64;
 
-        [prog addObject:[UDInstruction op:opcode]];
+@implementation UDEvaluationMemo {
+    NSMapTable *_slots;     // node -> 1 + index into _values
+    UDValue *_values;
+    NSUInteger _used;
+    NSUInteger _capacity;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _capacity = kUDEvaluationMemoDefaultCapacity;
+        _values = malloc(_capacity * sizeof(UDValue));
+        _slots = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality
+                                           valueOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsIntegerPersonality
+                                               capacity:_capacity];
     }
-    
-    // 4. PARENS
-    else if ([node isKindOfClass:[UDParenNode class]]) {
-        UDParenNode *paren = (UDParenNode *)node;
-        [self visitNode:paren.child into:prog withIntegerMode:integerMode];
+    return self;
+}
+
+- (void)dealloc {
+    free(_values);
+}
+
+- (NSUInteger)count {
+    return NSCountMapTable(_slots);
+}
+
+- (BOOL)getValue:(UDValue *)value forNode:(UDASTNode *)node {
+    uintptr_t slot = (uintptr_t)NSMapGet(_slots, (__bridge void *)node);
+    if (!slot) return NO;
+    *value = _values[slot - 1];
+    return YES;
+}
+
+- (void)setValue:(UDValue)value forNode:(UDASTNode *)node {
+    uintptr_t slot = (uintptr_t)NSMapGet(_slots, (__bridge void *)node);
+    if (slot) {
+        _values[slot - 1] = value;
+        return;
+    }
+    if (_used == _capacity) [self makeRoom];
+    _values[_used++] = value;
+    NSMapInsert(_slots, (__bridge void *)node, (void *)(uintptr_t)_used);
+}
+
+// The slots of nodes that have gone away are reclaimed only when the
+// array is full: live values are packed to the front, and the array
+// doubles only if that frees less than half of it.
+- (void)makeRoom {
+    NSArray<UDASTNode *> *live = NSAllMapTableKeys(_slots);
+    if (live.count > _capacity / 2) {
+        _capacity *= 2;
+        _values = realloc(_values, _capacity * sizeof(UDValue));
+        return;
+    }
+    UDValue *packed = malloc(_capacity * sizeof(UDValue));
+    NSUInteger used = 0;
+    for (UDASTNode *node in live) {
+        packed[used] = _values[(uintptr_t)NSMapGet(_slots, (__bridge void *)node) - 1];
+        NSMapInsert(_slots, (__bridge void *)node, (void *)(uintptr_t)++used);
     }
+    free(_values);
+    _values = packed;
+    _used = used;
 }
+
+- (void)removeAllValues {
+    NSResetMapTable(_slots);
+    _used = 0;
+}
+
 @end
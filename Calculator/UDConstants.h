@@ -6,6 +6,7 @@
 //
 
 #import <Foundation/Foundation.h>
+#import "UDFunctions.h"
 
 extern NSString * const UDConstLength;
 extern NSString * const UDConstArea;
@@ -38,29 +39,7 @@ extern NSString * const UDConstShiftRight;
 extern NSString * const UDConstRotateLeft;
 extern NSString * const UDConstRotateRight;
 
-extern NSString * const UDConstPow;
-extern NSString * const UDConstLn;
-extern NSString * const UDConstSin;
-extern NSString * const UDConstSinD;
-extern NSString * const UDConstASin;
-extern NSString * const UDConstASinD;
-extern NSString * const UDConstCos;
-extern NSString * const UDConstCosD;
-extern NSString * const UDConstACos;
-extern NSString * const UDConstACosD;
-extern NSString * const UDConstTan;
-extern NSString * const UDConstTanD;
-extern NSString * const UDConstATan;
-extern NSString * const UDConstATanD;
-extern NSString * const UDConstSqrt;
-extern NSString * const UDConstSinH;
-extern NSString * const UDConstASinH;
-extern NSString * const UDConstCosH;
-extern NSString * const UDConstACosH;
-extern NSString * const UDConstTanH;
-extern NSString * const UDConstATanH;
-extern NSString * const UDConstLog10;
-extern NSString * const UDConstLog2;
-extern NSString * const UDConstFact;
-extern NSString * const UDConstFlipB;
-extern NSString * const UDConstFlipW;
+// Function names, one per UD_FUNCTIONS entry (UDConstPow ... UDConstFlipW).
+#define UD_FUNCTION_CONST(name, str, mnemonic) extern NSString * const UDConst##name;
+UD_FUNCTIONS(UD_FUNCTION_CONST)
+#undef UD_FUNCTION_CONST
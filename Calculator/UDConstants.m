@@ -6,6 +6,7 @@
 //
 
 #import <Foundation/Foundation.h>
+#import "UDConstants.h"
 
 NSString * const UDConstLength = @"Length";
 NSString * const UDConstArea = @"Area";
@@ -38,34 +39,6 @@ NSString * const UDConstShiftRight = @">>";
 NSString * const UDConstRotateLeft = @"rol";
 NSString * const UDConstRotateRight = @"ror";
 
-NSString * const UDConstPow = @"pow";
-NSString * const UDConstLn = @"ln";
-
-NSString * const UDConstSin = @"sin";
-NSString * const UDConstSinD = @"sinD";
-NSString * const UDConstASin = @"asin";
-NSString * const UDConstASinD = @"asinD";
-NSString * const UDConstCos = @"cos";
-NSString * const UDConstCosD = @"cosD";
-NSString * const UDConstACos = @"acos";
-NSString * const UDConstACosD = @"acosD";
-NSString * const UDConstTan = @"tan";
-NSString * const UDConstTanD = @"tanD";
-NSString * const UDConstATan = @"atan";
-NSString * const UDConstATanD = @"atanD";
-NSString * const UDConstSqrt = @"sqrt";
-
-NSString * const UDConstSinH = @"sinh";
-NSString * const UDConstASinH = @"asinh";
-NSString * const UDConstCosH = @"cosh";
-NSString * const UDConstACosH = @"acosh";
-NSString * const UDConstTanH = @"tanh";
-NSString * const UDConstATanH = @"atanh";
-
-NSString * const UDConstLog10 = @"log_10";
-NSString * const UDConstLog2 = @"log_2";
-
-NSString * const UDConstFact = @"fact";
-
-NSString * const UDConstFlipB = @"flip_b";
-NSString * const UDConstFlipW = @"flip_w";
+#define UD_FUNCTION_CONST(name, str, mnemonic) NSString * const UDConst##name = str;
+UD_FUNCTIONS(UD_FUNCTION_CONST)
+#undef UD_FUNCTION_CONST
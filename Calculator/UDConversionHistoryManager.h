@@ -13,22 +13,38 @@
 @property (nonatomic, strong) UDUnitConverter *unitConverter;
 
 /**
- Returns the current list of conversion dictionaries.
+ Returns the current list of conversion dictionaries, most recent first.
  format: @{ @"cat":..., @"from":..., @"to":... }
+ Served from memory; the defaults are read once, at init. The array is
+ built on the first read after a change and reused until the next one.
  */
 @property (nonatomic, readonly) NSArray<NSDictionary *> *history;
 
+/**
+ Most entries kept; the oldest go first. Defaults to 10. Adding stays
+ O(1) however large this is; only reading history walks the list.
+ */
+@property (nonatomic, assign) NSUInteger maxItems;
+
 - (instancetype)initWithDefaults:(NSUserDefaults *)defaults converter:(UDUnitConverter *)converter;
 
 /**
  Adds a conversion to the top of the history.
- Handles deduplication and limits list size to 10.
+ Handles deduplication and limits list size to maxItems.
+ The defaults are written behind, on a background queue, once a burst of
+ changes has settled.
  */
 - (void)addConversion:(NSDictionary *)conversion;
 
 /**
- Wipes all history from disk.
+ Wipes all history from memory and, written behind, from disk.
  */
 - (void)clearHistory;
 
+/**
+ Writes any pending change to the defaults now and waits for it, e.g.
+ when the app terminates.
+ */
+- (void)flush;
+
 @end
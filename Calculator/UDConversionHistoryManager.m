@@ -11,47 +11,99 @@
 // Constant for the UserDefaults key
 static NSString * const kHistoryKey = @"ConversionHistory";
 static const NSUInteger kMaxHistoryItems = 10;
+// Quiet time after the last change of a burst before it is written out
+static const NSTimeInterval kHistoryWriteDelay = 1.0;
+
+// --- ENTRIES ---
+// Entries form a doubly linked list, most recent first, and are found by
+// dedup key through a dictionary: moving one to the front, adding one and
+// dropping the oldest are all O(1).
+
+@interface UDHistoryEntry : NSObject
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, strong) NSDictionary *entry;        // units as NSUnit
+@property (nonatomic, strong) NSDictionary *serialized;   // units as symbols
+@property (nonatomic, strong) UDHistoryEntry *next;
+@property (nonatomic, unsafe_unretained) UDHistoryEntry *prev;
+@end
+
+@implementation UDHistoryEntry
+@end
 
 @interface UDConversionHistoryManager ()
 @property (nonatomic, strong) NSUserDefaults *defaults;
+
+@property (nonatomic, strong) NSMutableDictionary<NSString *, UDHistoryEntry *> *entries;
+// Built on first request after a change
+@property (nonatomic, strong) NSArray<NSDictionary *> *cachedHistory;
+
+// Serial, so writes land in order
+@property (nonatomic, strong) NSOperationQueue *writeQueue;
+@property (nonatomic, assign) BOOL isDirty;
 @end
 
-@implementation UDConversionHistoryManager
+@implementation UDConversionHistoryManager {
+    UDHistoryEntry *_head;
+    __unsafe_unretained UDHistoryEntry *_tail;
+}
 
 - (instancetype)initWithDefaults:(NSUserDefaults *)defaults converter:(UDUnitConverter *)converter {
     self = [super init];
     if (self) {
         self.defaults = defaults;
         self.unitConverter = converter;
+        _maxItems = kMaxHistoryItems;
+        _entries = [NSMutableDictionary dictionary];
+        _writeQueue = [[NSOperationQueue alloc] init];
+        _writeQueue.maxConcurrentOperationCount = 1;
+        [self load];
     }
     return self;
 }
 
-- (NSArray<NSDictionary *> *)history {
-    // Return immutable copy for safety
+- (void)dealloc {
+    [self releaseList];
+}
+
+#pragma mark - Storage
+
+- (NSString *)keyForCategory:(NSString *)cat from:(NSString *)fromSymbol to:(NSString *)toSymbol {
+    return [NSString stringWithFormat:@"%@\x1f%@\x1f%@", cat, fromSymbol, toSymbol];
+}
+
+- (void)load {
     NSArray *list = [self.defaults arrayForKey:kHistoryKey];
 
+    // Stored most recent first; walk it backwards so each entry goes in
+    // front of the older ones.
     // Filter out bad data (legacy strings) instantly to protect the rest of the app
-    NSMutableArray *cleanList = [NSMutableArray array];
-    for (id item in list) {
-        if ([item isKindOfClass:[NSDictionary class]]) {
-            NSDictionary *dict = (NSDictionary *)item;
-            
-            if ([[dict valueForKey:@"to"] isKindOfClass:[NSString class]] && [[dict valueForKey:@"from"] isKindOfClass:[NSString class]]) {
-                [cleanList addObject:[self deserializeFromHistory:dict]];
-            }
+    for (id item in [list reverseObjectEnumerator]) {
+        if (![item isKindOfClass:[NSDictionary class]]) continue;
+        NSDictionary *dict = (NSDictionary *)item;
+        if (![[dict valueForKey:@"cat"] isKindOfClass:[NSString class]] ||
+            ![[dict valueForKey:@"to"] isKindOfClass:[NSString class]] ||
+            ![[dict valueForKey:@"from"] isKindOfClass:[NSString class]]) {
+            continue;
         }
+
+        NSDictionary *entry = [self deserializeFromHistory:dict];
+        if (!entry) continue;
+        [self putEntry:entry serialized:dict];
     }
-    
-    return [cleanList copy];
+    [self trim];
 }
 
 - (NSDictionary *)deserializeFromHistory:(NSDictionary *)item {
     NSString *cat = [item valueForKey:@"cat"];
+    NSUnit *from = [self.unitConverter unitForSymbol:[item valueForKey:@"from"] ofCategory:cat];
+    NSUnit *to = [self.unitConverter unitForSymbol:[item valueForKey:@"to"] ofCategory:cat];
+    // A unit this build no longer offers
+    if (!from || !to) return nil;
+
     NSDictionary *deserialized = @{
         @"cat": cat,
-        @"from": [self.unitConverter unitForSymbol:[item valueForKey:@"from"] ofCategory:cat],
-        @"to": [self.unitConverter unitForSymbol:[item valueForKey:@"to"] ofCategory:cat]
+        @"from": from,
+        @"to": to
     };
     return deserialized;
 }
@@ -65,34 +117,143 @@ static const NSUInteger kMaxHistoryItems = 10;
     return serialized;
 }
 
-- (void)addConversion:(NSDictionary *)conversion {
-    NSMutableArray *currentHistory = [self.history mutableCopy]; // Use self.history to get clean data
-    if (!currentHistory) currentHistory = [NSMutableArray array];
-
-    // 1. Deduplicate: Remove if already exists
-    [currentHistory removeObject:conversion];
-    
-    // 2. Insert at top
-    [currentHistory insertObject:conversion atIndex:0];
-    
-    // 3. Limit size
-    if (currentHistory.count > kMaxHistoryItems) {
-        [currentHistory removeLastObject];
+// Adds or refreshes an entry and makes it the most recent
+- (void)putEntry:(NSDictionary *)entry serialized:(NSDictionary *)serialized {
+    NSString *key = [self keyForCategory:serialized[@"cat"] from:serialized[@"from"] to:serialized[@"to"]];
+    UDHistoryEntry *item = self.entries[key];
+    if (!item) {
+        item = [UDHistoryEntry new];
+        item.key = key;
+        self.entries[key] = item;
     }
-    
-    // 4. Save
-    NSMutableArray *serializedHistory = [NSMutableArray array];
-    for (NSInteger i = 0; i < currentHistory.count; i++) {
-        [serializedHistory addObject: [self serializeToHistory:currentHistory[i]]];
+    item.entry = entry;
+    item.serialized = serialized;
+    [self moveToFront:item];
+}
+
+- (void)trim {
+    while (self.entries.count > self.maxItems) {
+        UDHistoryEntry *oldest = _tail;
+        [self unlink:oldest];
+        [self.entries removeObjectForKey:oldest.key];
+    }
+    self.cachedHistory = nil;
+}
+
+// Breaks the chain iteratively; releasing a long list from the head
+// would otherwise recurse once per entry.
+- (void)releaseList {
+    while (_head) {
+        UDHistoryEntry *next = _head.next;
+        _head.next = nil;
+        _head = next;
     }
+    _tail = nil;
+}
+
+- (void)unlink:(UDHistoryEntry *)item {
+    UDHistoryEntry *prev = item.prev, *next = item.next;
+    if (prev) prev.next = next; else if (_head == item) _head = next;
+    if (next) next.prev = prev; else if (_tail == item) _tail = prev;
+    item.prev = nil;
+    item.next = nil;
+}
 
-    [self.defaults setObject:serializedHistory forKey:kHistoryKey];
-    [self.defaults synchronize];
+- (void)moveToFront:(UDHistoryEntry *)item {
+    if (_head == item) return;
+    [self unlink:item];
+    item.next = _head;
+    if (_head) _head.prev = item;
+    _head = item;
+    if (!_tail) _tail = item;
+}
+
+#pragma mark - History
+
+- (NSArray<NSDictionary *> *)history {
+    if (!self.cachedHistory) {
+        NSMutableArray *list = [NSMutableArray arrayWithCapacity:self.entries.count];
+        for (UDHistoryEntry *item = _head; item; item = item.next) {
+            [list addObject:item.entry];
+        }
+        // Return immutable copy for safety
+        self.cachedHistory = [list copy];
+    }
+    return self.cachedHistory;
+}
+
+- (void)setMaxItems:(NSUInteger)maxItems {
+    _maxItems = MAX(maxItems, 1);
+    if (self.entries.count > _maxItems) {
+        [self trim];
+        [self scheduleWrite];
+    }
+}
+
+- (void)addConversion:(NSDictionary *)conversion {
+    // 1. Insert at top; an existing entry (deduplicated by key) moves there
+    [self putEntry:[conversion copy] serialized:[self serializeToHistory:conversion]];
+
+    // 2. Limit size
+    [self trim];
+
+    // 3. Save, later
+    [self scheduleWrite];
 }
 
 - (void)clearHistory {
-    [self.defaults removeObjectForKey:kHistoryKey];
-    [self.defaults synchronize];
+    [self.entries removeAllObjects];
+    [self releaseList];
+    self.cachedHistory = nil;
+    [self scheduleWrite];
+}
+
+#pragma mark - Write-behind
+
+// Every change restarts the wait, so a burst is written once, after it
+- (void)scheduleWrite {
+    self.isDirty = YES;
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(scheduledWrite) object:nil];
+    [self performSelector:@selector(scheduledWrite) withObject:nil afterDelay:kHistoryWriteDelay];
+}
+
+- (void)scheduledWrite {
+    [self writeAsync];
+}
+
+// Snapshot here, on the thread that owns the list; write on the queue.
+- (void)writeAsync {
+    if (!self.isDirty) return;
+    self.isDirty = NO;
+
+    NSArray *snapshot = [self serializedHistory];
+    NSUserDefaults *defaults = self.defaults;
+    [self.writeQueue addOperationWithBlock:^{
+        [UDConversionHistoryManager writeHistory:snapshot toDefaults:defaults];
+    }];
+}
+
+- (void)flush {
+    [self writeAsync];
+    // Waits for this write and any still queued
+    [self.writeQueue waitUntilAllOperationsAreFinished];
+}
+
+- (NSArray<NSDictionary *> *)serializedHistory {
+    NSMutableArray *serializedHistory = [NSMutableArray arrayWithCapacity:self.entries.count];
+    for (UDHistoryEntry *item = _head; item; item = item.next) {
+        [serializedHistory addObject:item.serialized];
+    }
+    return serializedHistory;
+}
+
++ (void)writeHistory:(NSArray<NSDictionary *> *)history toDefaults:(NSUserDefaults *)defaults {
+    if (history.count == 0) {
+        [defaults removeObjectForKey:kHistoryKey];
+    } else {
+        [defaults setObject:history forKey:kHistoryKey];
+    }
+    [defaults synchronize];
 }
 
 @end
@@ -0,0 +1,26 @@
+//
+//  UDDecimalConversion.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+
+// Decimal to binary, correctly rounded (to nearest, ties to even) like
+// strtod, without going through a string or libm's pow.
+//
+// Exactly representable operands take one IEEE multiply or divide
+// (Clinger's fast path). Everything else runs the Eisel-Lemire algorithm
+// on a table of 128-bit powers of five, which settles all but a tiny
+// fraction of inputs with two integer multiplications; those few fall
+// back to strtod. No allocation, no shared state.
+
+// The double nearest to +/- mantissa * 10^exponent
+double UDDoubleFromDecimal(unsigned long long mantissa, long exponent, BOOL negative);
+
+// A plain decimal literal: digits, an optional fraction and an optional
+// exponent (1, 0.25, .5, 6.02e23, 1E-9), unsigned and not terminated.
+// Returns NO if the length bytes are anything else. Any number of digits;
+// past 19 significant ones the slow path may be taken.
+BOOL UDDoubleFromDecimalString(const char *str, size_t length, double *result);
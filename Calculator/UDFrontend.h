@@ -47,6 +47,8 @@ typedef UDASTNode* (^UDFrontendAction)(UDFrontendContext *ctx);
                          action:(UDFrontendAction)action;
 @end
 
+// The operator table. It is built once, when shared is first called, and
+// frozen: lookups and the actions they return are safe from any thread.
 @interface UDFrontend : NSObject
 
 + (instancetype)shared;
@@ -27,11 +27,14 @@
 }
 @end
 
-@interface UDFrontend ()
-@property (strong) NSMutableDictionary<NSNumber *, UDOpInfo *> *table;
-@end
+// Every UDOp tag is below this.
+enum { kUDFrontendTableSize = 128 };
 
-@implementation UDFrontend
+@implementation UDFrontend {
+    // Filled once in -init and never written again, so lookups need no
+    // locking from any thread.
+    UDOpInfo *_infos[kUDFrontendTableSize];
+}
 
 + (instancetype)shared {
     static UDFrontend *sharedInstance = nil;
@@ -49,7 +52,7 @@
 }
 
 - (void)buildTable {
-    self.table = [[NSMutableDictionary alloc] init];
+    NSMutableDictionary<NSNumber *, UDOpInfo *> *table = [[NSMutableDictionary alloc] init];
     
     // We need a weak reference to self to use inside the blocks
     // because self -> table -> block -> self would cause a memory leak.
@@ -60,10 +63,10 @@
     // ============================================================
 
     // --- PARENTHESES & MEMORY ---
-    self.table[@(UDOpParenLeft)] = [UDOpInfo infoWithSymbol:@"(" tag:UDOpParenLeft placement:UDOpPlacementPrefix assoc:UDOpAssocNone precedence:0 action:nil];
-    self.table[@(UDOpParenRight)] = [UDOpInfo infoWithSymbol:@")" tag:UDOpParenRight placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:0 action:nil];
+    table[@(UDOpParenLeft)] = [UDOpInfo infoWithSymbol:@"(" tag:UDOpParenLeft placement:UDOpPlacementPrefix assoc:UDOpAssocNone precedence:0 action:nil];
+    table[@(UDOpParenRight)] = [UDOpInfo infoWithSymbol:@")" tag:UDOpParenRight placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:0 action:nil];
     
-    self.table[@(UDOpMR)] = [UDOpInfo infoWithSymbol:@"MR" tag:UDOpMR action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpMR)] = [UDOpInfo infoWithSymbol:@"MR" tag:UDOpMR action:^UDASTNode *(UDFrontendContext *ctx) {
         return [UDConstantNode value:UDValueMakeDouble(ctx.memoryValue) symbol:@"MR"];
     }];
 
@@ -72,10 +75,10 @@
     // ============================================================
     
     // OR (|)
-    self.table[@(UDOpBitwiseOr)] = [UDOpInfo infoWithSymbol:UDConstBitOr tag:UDOpBitwiseOr placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:5 action:[self binaryOp:UDOpBitwiseOr]];
+    table[@(UDOpBitwiseOr)] = [UDOpInfo infoWithSymbol:UDConstBitOr tag:UDOpBitwiseOr placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:5 action:[self binaryOp:UDOpBitwiseOr]];
 
     // NOR (Implemented as ~ (A | B))
-    self.table[@(UDOpBitwiseNor)] = [UDOpInfo infoWithSymbol:@"NOR" tag:UDOpBitwiseNor placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:5 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpBitwiseNor)] = [UDOpInfo infoWithSymbol:@"NOR" tag:UDOpBitwiseNor placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:5 action:^UDASTNode *(UDFrontendContext *ctx) {
         // Pop args
         UDASTNode *right = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
         UDASTNode *left = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
@@ -90,55 +93,55 @@
     }];
 
     // XOR (^)
-    self.table[@(UDOpBitwiseXor)] = [UDOpInfo infoWithSymbol:UDConstBitXor tag:UDOpBitwiseXor placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:10 action:[self binaryOp:UDOpBitwiseXor]];
+    table[@(UDOpBitwiseXor)] = [UDOpInfo infoWithSymbol:UDConstBitXor tag:UDOpBitwiseXor placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:10 action:[self binaryOp:UDOpBitwiseXor]];
 
     // AND (&)
-    self.table[@(UDOpBitwiseAnd)] = [UDOpInfo infoWithSymbol:UDConstBitAnd tag:UDOpBitwiseAnd placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:15 action:[self binaryOp:UDOpBitwiseAnd]];
+    table[@(UDOpBitwiseAnd)] = [UDOpInfo infoWithSymbol:UDConstBitAnd tag:UDOpBitwiseAnd placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:15 action:[self binaryOp:UDOpBitwiseAnd]];
 
     // ============================================================
     // TIER 2: SHIFTS (Precedence 20)
     // ============================================================
 
     // << (Left Shift)
-    self.table[@(UDOpShiftLeft)] = [UDOpInfo infoWithSymbol:@"<<" tag:UDOpShiftLeft placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:20 action:[self binaryOp:UDOpShiftLeft]];
+    table[@(UDOpShiftLeft)] = [UDOpInfo infoWithSymbol:@"<<" tag:UDOpShiftLeft placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:20 action:[self binaryOp:UDOpShiftLeft]];
 
     // >> (Right Shift)
-    self.table[@(UDOpShiftRight)] = [UDOpInfo infoWithSymbol:@">>" tag:UDOpShiftRight placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:20 action:[self binaryOp:UDOpShiftRight]];
+    table[@(UDOpShiftRight)] = [UDOpInfo infoWithSymbol:@">>" tag:UDOpShiftRight placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:20 action:[self binaryOp:UDOpShiftRight]];
 
     // ============================================================
     // TIER 3: STANDARD ARITHMETIC (Precedence 30 - 40)
     // ============================================================
 
     // + (Add)
-    self.table[@(UDOpAdd)] = [UDOpInfo infoWithSymbol:UDConstAdd tag:UDOpAdd placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:30 action:[self binaryOp:UDOpAdd]];
+    table[@(UDOpAdd)] = [UDOpInfo infoWithSymbol:UDConstAdd tag:UDOpAdd placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:30 action:[self binaryOp:UDOpAdd]];
 
     // - (Sub)
-    self.table[@(UDOpSub)] = [UDOpInfo infoWithSymbol:UDConstSub tag:UDOpSub placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:30 action:[self binaryOp:UDOpSub]];
+    table[@(UDOpSub)] = [UDOpInfo infoWithSymbol:UDConstSub tag:UDOpSub placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:30 action:[self binaryOp:UDOpSub]];
 
     // * (Multiply)
-    self.table[@(UDOpMul)] = [UDOpInfo infoWithSymbol:UDConstMul tag:UDOpMul placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:40 action:[self binaryOp:UDOpMul]];
+    table[@(UDOpMul)] = [UDOpInfo infoWithSymbol:UDConstMul tag:UDOpMul placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:40 action:[self binaryOp:UDOpMul]];
 
     // / (Divide)
-    self.table[@(UDOpDiv)] = [UDOpInfo infoWithSymbol:UDConstDiv tag:UDOpDiv placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:40 action:[self binaryOp:UDOpDiv]];
+    table[@(UDOpDiv)] = [UDOpInfo infoWithSymbol:UDConstDiv tag:UDOpDiv placement:UDOpPlacementInfix assoc:UDOpAssocLeft precedence:40 action:[self binaryOp:UDOpDiv]];
 
     // ============================================================
     // TIER 4: PROGRAMMER UNARY (Precedence 50)
     // ============================================================
 
     // Byte Flip
-    self.table[@(UDOpByteFlip)] = [UDOpInfo infoWithSymbol:UDConstFlipB tag:UDOpByteFlip placement:UDOpPlacementPostfix assoc:UDOpAssocRight precedence:50 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpByteFlip)] = [UDOpInfo infoWithSymbol:UDConstFlipB tag:UDOpByteFlip placement:UDOpPlacementPostfix assoc:UDOpAssocRight precedence:50 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *top = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
-        return [UDFunctionNode func:UDConstFlipB args:@[top]];
+        return [UDFunctionNode function:UDFunctionFlipB args:@[top]];
     }];
 
     // Word Flip
-    self.table[@(UDOpWordFlip)] = [UDOpInfo infoWithSymbol:UDConstFlipW tag:UDOpWordFlip placement:UDOpPlacementPostfix assoc:UDOpAssocRight precedence:50 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpWordFlip)] = [UDOpInfo infoWithSymbol:UDConstFlipW tag:UDOpWordFlip placement:UDOpPlacementPostfix assoc:UDOpAssocRight precedence:50 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *top = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
-        return [UDFunctionNode func:UDConstFlipW args:@[top]];
+        return [UDFunctionNode function:UDFunctionFlipW args:@[top]];
     }];
 
     // 1's Complement (~)
-    self.table[@(UDOpComp1)] = [UDOpInfo infoWithSymbol:UDConstBitNeg tag:UDOpComp1 placement:UDOpPlacementPostfix assoc:UDOpAssocRight precedence:50 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpComp1)] = [UDOpInfo infoWithSymbol:UDConstBitNeg tag:UDOpComp1 placement:UDOpPlacementPostfix assoc:UDOpAssocRight precedence:50 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *val = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
         UDOpInfo *info = [weakSelf infoForOp:UDOpComp1];
 
@@ -146,7 +149,7 @@
     }];
 
     // 2's Complement (NEG)
-    self.table[@(UDOpComp2)] = [UDOpInfo infoWithSymbol:UDConstNeg tag:UDOpComp2 placement:UDOpPlacementPostfix assoc:UDOpAssocRight precedence:50 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpComp2)] = [UDOpInfo infoWithSymbol:UDConstNeg tag:UDOpComp2 placement:UDOpPlacementPostfix assoc:UDOpAssocRight precedence:50 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *val = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
         // This is semantically equivalent to standard Negation
         UDOpInfo *negInfo = [weakSelf infoForOp:UDOpNegate];
@@ -159,7 +162,7 @@
     // ============================================================
 
     // Rotate Left (ROL) -> Binary (x ROL 1)
-    self.table[@(UDOpRotateLeft)] = [UDOpInfo infoWithSymbol:UDConstRotateLeft tag:UDOpRotateLeft placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpRotateLeft)] = [UDOpInfo infoWithSymbol:UDConstRotateLeft tag:UDOpRotateLeft placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *val = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
         UDASTNode *one = [UDNumberNode value:UDValueMakeDouble(1)];
         
@@ -168,7 +171,7 @@
     }];
 
     // Rotate Right (ROR) -> Binary (x ROR 1)
-    self.table[@(UDOpRotateRight)] = [UDOpInfo infoWithSymbol:UDConstRotateRight tag:UDOpRotateRight placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpRotateRight)] = [UDOpInfo infoWithSymbol:UDConstRotateRight tag:UDOpRotateRight placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *val = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
         UDASTNode *one = [UDNumberNode value:UDValueMakeDouble(1)];
         
@@ -181,7 +184,7 @@
     // ============================================================
 
     // << 1
-    self.table[@(UDOpShift1Left)] = [UDOpInfo infoWithSymbol:UDConstShiftLeft tag:UDOpShift1Left placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpShift1Left)] = [UDOpInfo infoWithSymbol:UDConstShiftLeft tag:UDOpShift1Left placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *val = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
         UDASTNode *one = [UDNumberNode value:UDValueMakeDouble(1)];
         
@@ -190,7 +193,7 @@
     }];
 
     // >> 1
-    self.table[@(UDOpShift1Right)] = [UDOpInfo infoWithSymbol:UDConstShiftRight tag:UDOpShift1Right placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpShift1Right)] = [UDOpInfo infoWithSymbol:UDConstShiftRight tag:UDOpShift1Right placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *val = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
         UDASTNode *one = [UDNumberNode value:UDValueMakeDouble(1)];
         
@@ -203,7 +206,7 @@
     // ============================================================
     
     // Negate (Unary -)
-    self.table[@(UDOpNegate)] = [UDOpInfo infoWithSymbol:UDConstNeg tag:UDOpNegate placement:UDOpPlacementPrefix assoc:UDOpAssocRight precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpNegate)] = [UDOpInfo infoWithSymbol:UDConstNeg tag:UDOpNegate placement:UDOpPlacementPrefix assoc:UDOpAssocRight precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *top = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
         
         // Fold Constants if possible
@@ -216,7 +219,7 @@
     }];
 
     // % (Percent)
-    self.table[@(UDOpPercent)] = [UDOpInfo infoWithSymbol:UDConstPercent tag:UDOpPercent placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpPercent)] = [UDOpInfo infoWithSymbol:UDConstPercent tag:UDOpPercent placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *current = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
         
         UDOpInfo *info = [weakSelf infoForOp:UDOpPercent];
@@ -224,39 +227,39 @@
     }];
 
     // Standard Math Functions
-    self.table[@(UDOpSquare)] = [UDOpInfo infoWithSymbol:UDConstPow tag:UDOpSquare placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpSquare)] = [UDOpInfo infoWithSymbol:UDConstPow tag:UDOpSquare placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *base = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
-        return [UDFunctionNode func:UDConstPow args:@[base, [UDNumberNode value:UDValueMakeDouble(2)]]];
+        return [UDFunctionNode function:UDFunctionPow args:@[base, [UDNumberNode value:UDValueMakeDouble(2)]]];
     }];
     
-    self.table[@(UDOpCube)] = [UDOpInfo infoWithSymbol:UDConstPow tag:UDOpCube placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpCube)] = [UDOpInfo infoWithSymbol:UDConstPow tag:UDOpCube placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *base = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
-        return [UDFunctionNode func:UDConstPow args:@[base, [UDNumberNode value:UDValueMakeDouble(3)]]];
+        return [UDFunctionNode function:UDFunctionPow args:@[base, [UDNumberNode value:UDValueMakeDouble(3)]]];
     }];
 
     // Power (^)
-    self.table[@(UDOpPow)] = [UDOpInfo infoWithSymbol:UDConstPow tag:UDOpPow placement:UDOpPlacementInfix assoc:UDOpAssocRight precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpPow)] = [UDOpInfo infoWithSymbol:UDConstPow tag:UDOpPow placement:UDOpPlacementInfix assoc:UDOpAssocRight precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *exp = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
         UDASTNode *base = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
-        return [UDFunctionNode func:UDConstPow args:@[base, exp]];
+        return [UDFunctionNode function:UDFunctionPow args:@[base, exp]];
     }];
 
     // Roots
-    self.table[@(UDOpSqrt)] = [UDOpInfo infoWithSymbol:UDConstSqrt tag:UDOpSqrt placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpSqrt)] = [UDOpInfo infoWithSymbol:UDConstSqrt tag:UDOpSqrt placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *arg = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
-        return [UDFunctionNode func:UDConstSqrt args:@[arg]];
+        return [UDFunctionNode function:UDFunctionSqrt args:@[arg]];
     }];
 
-    self.table[@(UDOpCbrt)] = [UDOpInfo infoWithSymbol:UDConstPow tag:UDOpCbrt placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpCbrt)] = [UDOpInfo infoWithSymbol:UDConstPow tag:UDOpCbrt placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *arg = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
         UDASTNode *oneThird = [UDBinaryOpNode info:[weakSelf infoForOp:UDOpDiv] left:[UDNumberNode value:UDValueMakeDouble(1)] right:[UDNumberNode value:UDValueMakeDouble(3)]];
-        return [UDFunctionNode func:UDConstPow args:@[arg, oneThird]];
+        return [UDFunctionNode function:UDFunctionPow args:@[arg, oneThird]];
     }];
 
     // n√x (N-th Root)
     // Input Sequence: Base [Op] Root
     // AST Transformation: pow(Base, 1/Root)
-    self.table[@(UDOpYRoot)] = [UDOpInfo infoWithSymbol:@"ⁿ√x"
+    table[@(UDOpYRoot)] = [UDOpInfo infoWithSymbol:@"ⁿ√x"
                                                       tag:UDOpYRoot
                                                 placement:UDOpPlacementInfix
                                                     assoc:UDOpAssocRight
@@ -276,11 +279,11 @@
         UDASTNode *exponent = [UDBinaryOpNode info:[weakSelf infoForOp:UDOpDiv] left:one right:n];
         
         // 4. Return pow(x, 1/n)
-        return [UDFunctionNode func:UDConstPow args:@[x, exponent]];
+        return [UDFunctionNode function:UDFunctionPow args:@[x, exponent]];
     }];
 
     // 1/x (Invert)
-    self.table[@(UDOpInvert)] = [UDOpInfo infoWithSymbol:UDConstDiv tag:UDOpInvert placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpInvert)] = [UDOpInfo infoWithSymbol:UDConstDiv tag:UDOpInvert placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *arg = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
 
         UDOpInfo *divInfo = [weakSelf infoForOp:UDOpDiv];
@@ -288,7 +291,7 @@
     }];
 
     // Factorial (!)
-    self.table[@(UDOpFactorial)] = [UDOpInfo infoWithSymbol:@"!" tag:UDOpFactorial placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpFactorial)] = [UDOpInfo infoWithSymbol:@"!" tag:UDOpFactorial placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *arg = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
 
         UDOpInfo *info = [weakSelf infoForOp:UDOpFactorial];
@@ -296,97 +299,97 @@
     }];
 
     // Trig & Logs
-    self.table[@(UDOpSin)] = [UDOpInfo infoWithSymbol:@"sin" tag:UDOpSin placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:[self trigOp:UDConstSin]];
-    self.table[@(UDOpCos)] = [UDOpInfo infoWithSymbol:@"cos" tag:UDOpCos placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:[self trigOp:UDConstCos]];
-    self.table[@(UDOpTan)] = [UDOpInfo infoWithSymbol:@"tan" tag:UDOpTan placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:[self trigOp:UDConstTan]];
-    self.table[@(UDOpSinInverse)] = [UDOpInfo infoWithSymbol:@"sin⁻¹"
+    table[@(UDOpSin)] = [UDOpInfo infoWithSymbol:@"sin" tag:UDOpSin placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:[self trigOp:UDFunctionSin degrees:UDFunctionSinD]];
+    table[@(UDOpCos)] = [UDOpInfo infoWithSymbol:@"cos" tag:UDOpCos placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:[self trigOp:UDFunctionCos degrees:UDFunctionCosD]];
+    table[@(UDOpTan)] = [UDOpInfo infoWithSymbol:@"tan" tag:UDOpTan placement:UDOpPlacementPostfix assoc:UDOpAssocNone precedence:60 action:[self trigOp:UDFunctionTan degrees:UDFunctionTanD]];
+    table[@(UDOpSinInverse)] = [UDOpInfo infoWithSymbol:@"sin⁻¹"
                                                          tag:UDOpSinInverse
                                                    placement:UDOpPlacementPostfix
                                                        assoc:UDOpAssocNone
                                                   precedence:60
-                                                      action:[self trigOp:UDConstASin]];
+                                                      action:[self trigOp:UDFunctionASin degrees:UDFunctionASinD]];
 
-    self.table[@(UDOpCosInverse)] = [UDOpInfo infoWithSymbol:@"cos⁻¹"
+    table[@(UDOpCosInverse)] = [UDOpInfo infoWithSymbol:@"cos⁻¹"
                                                          tag:UDOpCosInverse
                                                    placement:UDOpPlacementPostfix
                                                        assoc:UDOpAssocNone
                                                   precedence:60
-                                                      action:[self trigOp:UDConstACos]];
+                                                      action:[self trigOp:UDFunctionACos degrees:UDFunctionACosD]];
 
-    self.table[@(UDOpTanInverse)] = [UDOpInfo infoWithSymbol:@"tan⁻¹"
+    table[@(UDOpTanInverse)] = [UDOpInfo infoWithSymbol:@"tan⁻¹"
                                                          tag:UDOpTanInverse
                                                    placement:UDOpPlacementPostfix
                                                        assoc:UDOpAssocNone
                                                   precedence:60
-                                                      action:[self trigOp:UDConstATan]];
-    self.table[@(UDOpSinh)] = [UDOpInfo infoWithSymbol:@"sinh"
+                                                      action:[self trigOp:UDFunctionATan degrees:UDFunctionATanD]];
+    table[@(UDOpSinh)] = [UDOpInfo infoWithSymbol:@"sinh"
                                                    tag:UDOpSinh
                                              placement:UDOpPlacementPostfix
                                                  assoc:UDOpAssocNone
                                             precedence:60
-                                                action:[self funcOp:UDConstSinH]];
-    self.table[@(UDOpCosh)] = [UDOpInfo infoWithSymbol:@"cosh"
+                                                action:[self funcOp:UDFunctionSinH]];
+    table[@(UDOpCosh)] = [UDOpInfo infoWithSymbol:@"cosh"
                                                    tag:UDOpCosh
                                              placement:UDOpPlacementPostfix
                                                  assoc:UDOpAssocNone
                                             precedence:60
-                                                action:[self funcOp:UDConstCosH]];
-    self.table[@(UDOpTanh)] = [UDOpInfo infoWithSymbol:@"tanh"
+                                                action:[self funcOp:UDFunctionCosH]];
+    table[@(UDOpTanh)] = [UDOpInfo infoWithSymbol:@"tanh"
                                                    tag:UDOpTanh
                                              placement:UDOpPlacementPostfix
                                                  assoc:UDOpAssocNone
                                             precedence:60
-                                                action:[self funcOp:UDConstTanH]];
-    self.table[@(UDOpSinhInverse)] = [UDOpInfo infoWithSymbol:@"sinh⁻¹"
+                                                action:[self funcOp:UDFunctionTanH]];
+    table[@(UDOpSinhInverse)] = [UDOpInfo infoWithSymbol:@"sinh⁻¹"
                                                           tag:UDOpSinhInverse
                                                     placement:UDOpPlacementPostfix
                                                         assoc:UDOpAssocNone
                                                    precedence:60
-                                                       action:[self funcOp:UDConstASinH]];
+                                                       action:[self funcOp:UDFunctionASinH]];
 
-    self.table[@(UDOpCoshInverse)] = [UDOpInfo infoWithSymbol:@"cosh⁻¹"
+    table[@(UDOpCoshInverse)] = [UDOpInfo infoWithSymbol:@"cosh⁻¹"
                                                           tag:UDOpCoshInverse
                                                     placement:UDOpPlacementPostfix
                                                         assoc:UDOpAssocNone
                                                    precedence:60
-                                                       action:[self funcOp:UDConstACosH]];
+                                                       action:[self funcOp:UDFunctionACosH]];
 
-    self.table[@(UDOpTanhInverse)] = [UDOpInfo infoWithSymbol:@"tanh⁻¹"
+    table[@(UDOpTanhInverse)] = [UDOpInfo infoWithSymbol:@"tanh⁻¹"
                                                           tag:UDOpTanhInverse
                                                     placement:UDOpPlacementPostfix
                                                         assoc:UDOpAssocNone
                                                    precedence:60
-                                                       action:[self funcOp:UDConstATanH]];
+                                                       action:[self funcOp:UDFunctionATanH]];
 
     // ============================================================
     // LOGARITHMS
     // ============================================================
 
-    self.table[@(UDOpLn)] = [UDOpInfo infoWithSymbol:@"ln"
+    table[@(UDOpLn)] = [UDOpInfo infoWithSymbol:@"ln"
                                                  tag:UDOpLn
                                            placement:UDOpPlacementPostfix
                                                assoc:UDOpAssocNone
                                           precedence:60
-                                              action:[self funcOp:UDConstLn]];
+                                              action:[self funcOp:UDFunctionLn]];
 
-    self.table[@(UDOpLog10)] = [UDOpInfo infoWithSymbol:@"log₁₀"
+    table[@(UDOpLog10)] = [UDOpInfo infoWithSymbol:@"log₁₀"
                                                     tag:UDOpLog10
                                               placement:UDOpPlacementPostfix
                                                   assoc:UDOpAssocNone
                                              precedence:60
-                                                 action:[self funcOp:UDConstLog10]];
+                                                 action:[self funcOp:UDFunctionLog10]];
 
-    self.table[@(UDOpLog2)] = [UDOpInfo infoWithSymbol:@"log₂"
+    table[@(UDOpLog2)] = [UDOpInfo infoWithSymbol:@"log₂"
                                                    tag:UDOpLog2
                                              placement:UDOpPlacementPostfix
                                                  assoc:UDOpAssocNone
                                             precedence:60
-                                                action:[self funcOp:UDConstLog2]];
+                                                action:[self funcOp:UDFunctionLog2]];
 
     // log_y(x) (Log Base Y)
     // Input Sequence: Value [Op] Base
     // AST Transformation: ln(Value) / ln(Base)
-    self.table[@(UDOpLogY)] = [UDOpInfo infoWithSymbol:@"log_y"
+    table[@(UDOpLogY)] = [UDOpInfo infoWithSymbol:@"log_y"
                                                        tag:UDOpLogY
                                                  placement:UDOpPlacementInfix
                                                      assoc:UDOpAssocRight
@@ -401,8 +404,8 @@
         [ctx.nodeStack removeLastObject];
         
         // 3. Construct Change of Base Formula: ln(x) / ln(y)
-        UDASTNode *lnX = [UDFunctionNode func:UDConstLn args:@[x]];
-        UDASTNode *lnY = [UDFunctionNode func:UDConstLn args:@[y]];
+        UDASTNode *lnX = [UDFunctionNode function:UDFunctionLn args:@[x]];
+        UDASTNode *lnY = [UDFunctionNode function:UDFunctionLn args:@[y]];
         
         // 4. Return Division Node
         // Use Precedence 60 to ensure this entire block is treated as a single unit
@@ -410,9 +413,15 @@
     }];
 
     // Rand
-    self.table[@(UDOpRand)] = [UDOpInfo infoWithSymbol:@"rand" tag:UDOpRand action:^UDASTNode *(UDFrontendContext *ctx) {
+    table[@(UDOpRand)] = [UDOpInfo infoWithSymbol:@"rand" tag:UDOpRand action:^UDASTNode *(UDFrontendContext *ctx) {
         return [UDConstantNode value:UDValueMakeDouble(((double)arc4random()/UINT32_MAX)) symbol:@"rand"];
     }];
+
+    // Freeze
+    for (NSNumber *op in table) {
+        NSAssert(op.integerValue >= 0 && op.integerValue < kUDFrontendTableSize, @"UDOp %@ out of table range", op);
+        _infos[op.integerValue] = table[op];
+    }
 }
 
 #pragma mark - Helpers
@@ -440,24 +449,22 @@
     };
 }
 
-- (UDFrontendAction)funcOp:(NSString *)name {
+- (UDFrontendAction)funcOp:(UDFunctionID)fid {
     return ^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *arg = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
-        return [UDFunctionNode func:name args:@[arg]];
+        return [UDFunctionNode function:fid args:@[arg]];
     };
 }
 
-- (UDFrontendAction)trigOp:(NSString *)name {
+- (UDFrontendAction)trigOp:(UDFunctionID)radians degrees:(UDFunctionID)degrees {
     return ^UDASTNode *(UDFrontendContext *ctx) {
         UDASTNode *arg = [ctx.nodeStack lastObject]; [ctx.nodeStack removeLastObject];
-        NSString *sym = name;
-        if (!ctx.isRadians) sym = [sym stringByAppendingString:@"D"];
-        return [UDFunctionNode func:sym args:@[arg]];
+        return [UDFunctionNode function:ctx.isRadians ? radians : degrees args:@[arg]];
     };
 }
 
 - (UDOpInfo *)infoForOp:(NSInteger)op {
-    return self.table[@(op)];
+    return (op >= 0 && op < kUDFrontendTableSize) ? _infos[op] : nil;
 }
 
 @end
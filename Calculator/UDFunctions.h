@@ -0,0 +1,54 @@
+//
+//  UDFunctions.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+
+// Every function the calculator knows: identifier, name as it appears in
+// the AST and on the tape, and opcode mnemonic. UDConstants, the function
+// opcodes in UDOpcode, UDInstruction's debugDescription and the compiler's
+// lookup table are all expanded from this one list. Opcodes follow the
+// list order, so append rather than reorder.
+#define UD_FUNCTIONS(X) \
+    X(Pow,   @"pow",    "POW") \
+    X(Sqrt,  @"sqrt",   "SQRT") \
+    X(Ln,    @"ln",     "LN") \
+    X(Sin,   @"sin",    "SIN") \
+    X(SinD,  @"sinD",   "SIND") \
+    X(ASin,  @"asin",   "ASIN") \
+    X(ASinD, @"asinD",  "ASIND") \
+    X(Cos,   @"cos",    "COS") \
+    X(CosD,  @"cosD",   "COSD") \
+    X(ACos,  @"acos",   "ACOS") \
+    X(ACosD, @"acosD",  "ACOSD") \
+    X(Tan,   @"tan",    "TAN") \
+    X(TanD,  @"tanD",   "TAND") \
+    X(ATan,  @"atan",   "ATAN") \
+    X(ATanD, @"atanD",  "ATAND") \
+    X(SinH,  @"sinh",   "SINH") \
+    X(ASinH, @"asinh",  "ASINH") \
+    X(CosH,  @"cosh",   "COSH") \
+    X(ACosH, @"acosh",  "ACOSH") \
+    X(TanH,  @"tanh",   "TANH") \
+    X(ATanH, @"atanh",  "ATANH") \
+    X(Log10, @"log_10", "LOG10") \
+    X(Log2,  @"log_2",  "LOG2") \
+    X(Fact,  @"fact",   "FACT") \
+    X(FlipB, @"flip_b", "FLIPB") \
+    X(FlipW, @"flip_w", "FLIPW")
+
+typedef NS_ENUM(NSInteger, UDFunctionID) {
+    UDFunctionUnknown = -1,
+#define UD_FUNCTION_ID(name, str, mnemonic) UDFunction##name,
+    UD_FUNCTIONS(UD_FUNCTION_ID)
+#undef UD_FUNCTION_ID
+    UDFunctionCount
+};
+
+// Name -> ID goes through a dictionary built once; UDFunctionUnknown if
+// the name is not in the list.
+UDFunctionID UDFunctionIDForName(NSString *name);
+NSString *UDFunctionNameForID(UDFunctionID fid);
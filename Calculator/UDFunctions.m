@@ -0,0 +1,31 @@
+//
+//  UDFunctions.m
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDFunctions.h"
+
+static NSString * const kUDFunctionNames[UDFunctionCount] = {
+#define UD_FUNCTION_NAME(name, str, mnemonic) [UDFunction##name] = str,
+    UD_FUNCTIONS(UD_FUNCTION_NAME)
+#undef UD_FUNCTION_NAME
+};
+
+UDFunctionID UDFunctionIDForName(NSString *name) {
+    static NSDictionary<NSString *, NSNumber *> *ids;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        NSMutableDictionary *d = [NSMutableDictionary dictionaryWithCapacity:UDFunctionCount];
+        for (NSInteger i = 0; i < UDFunctionCount; i++) d[kUDFunctionNames[i]] = @(i);
+        ids = [d copy];
+    });
+
+    NSNumber *fid = name ? ids[name] : nil;
+    return fid ? (UDFunctionID)fid.integerValue : UDFunctionUnknown;
+}
+
+NSString *UDFunctionNameForID(UDFunctionID fid) {
+    return (fid >= 0 && fid < UDFunctionCount) ? kUDFunctionNames[fid] : nil;
+}
@@ -7,6 +7,7 @@
 
 #import "UDInputBuffer.h"
 #import "UDValueFormatter.h"
+#import "UDDecimalConversion.h"
 
 // Safety limit to prevent long long overflow (approx 17-18 digits)
 static const long long MAX_DIGITS_LIMIT = 10000000000000000LL;
@@ -215,35 +216,20 @@ static const long long MAX_DIGITS_LIMIT = 10000000000000000LL;
         return UDValueMakeInt(self.mantissaBuffer);
     }
 
-    double value = [self mantissa];
-    
-    long long finalExp = self.exponentBuffer;
+    long finalExp = (long)self.exponentBuffer;
     if (self.isExponentNegative) {
         finalExp = -finalExp;
     }
-    
-    if (finalExp != 0) {
-        value = value * pow(10, (double)finalExp);
-    }
-    
-    return UDValueMakeDouble(value);
+
+    // Digits times a power of ten, rounded once: 0.3 is exactly the double
+    // nearest 3/10, and 1.5e-7 the one nearest 15e-8
+    return UDValueMakeDouble(UDDoubleFromDecimal(self.mantissaBuffer, finalExp - (long)self.decimalShift,
+                                                 self.isMantissaNegative));
 }
 
 - (double)mantissa {
-    // 1. Convert Mantissa Digits
-    double value = (double)self.mantissaBuffer;
-    
-    // 2. Apply Mantissa Sign
-    if (self.isMantissaNegative) {
-        value = -value;
-    }
-    
-    // 3. Apply Decimal Shift (e.g. 123 with shift 2 -> 1.23)
-    if (self.decimalShift > 0) {
-        value = value * pow(10, -((double)self.decimalShift));
-    }
-
-    return value;
+    // Digits with the decimal shift applied (e.g. 123 with shift 2 -> 1.23)
+    return UDDoubleFromDecimal(self.mantissaBuffer, -(long)self.decimalShift, self.isMantissaNegative);
 }
 
 - (NSString *)displayStringWithThousandsSeparators:(BOOL)showThousandsSeparators {
@@ -255,21 +241,15 @@ static const long long MAX_DIGITS_LIMIT = 10000000000000000LL;
                                 forceScientific:NO];
     }
    
-    NSNumberFormatter *fmt = [[NSNumberFormatter alloc] init];
-    fmt.usesGroupingSeparator = showThousandsSeparators;
-    fmt.minimumFractionDigits = 0;
-    fmt.numberStyle = NSNumberFormatterDecimalStyle;
-    fmt.maximumFractionDigits = 15;
-
-    if (_inExponentMode) {
-        double value = [self mantissa];
-
-        return [NSString stringWithFormat:@"%@ e %lld", [fmt stringFromNumber:@(value)], _isExponentNegative ? -_exponentBuffer : _exponentBuffer];
-    } else {
-        UDValue value = [self finalizeValue];
-        
-        return [fmt stringFromNumber:@(UDValueAsDouble(value))];
-    }
+    char buf[UDFormatBufferSize];
+    size_t length = UDFormatDecimal(buf, sizeof(buf), _inExponentMode ? [self mantissa] : UDValueAsDouble([self finalizeValue]),
+                                    showThousandsSeparators, 15);
+    if (_inExponentMode && length > 0) {
+        long long exponent = _isExponentNegative ? -(long long)_exponentBuffer : (long long)_exponentBuffer;
+        int added = snprintf(buf + length, sizeof(buf) - length, " e %lld", exponent);
+        if (added > 0 && (size_t)added < sizeof(buf) - length) length += (size_t)added;
+    }
+    return [[NSString alloc] initWithBytes:buf length:length encoding:NSUTF8StringEncoding];
 }
 
 @end
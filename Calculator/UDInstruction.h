@@ -7,6 +7,7 @@
 
 #import <Foundation/Foundation.h>
 #import "UDValue.h"
+#import "UDFunctions.h"
 
 typedef NS_ENUM(NSInteger, UDOpcode) {
     // double opcodes
@@ -17,6 +18,7 @@ typedef NS_ENUM(NSInteger, UDOpcode) {
     UDOpcodeDiv,
     UDOpcodeNeg,  // unary -
     UDOpcodeCall,  // Call a named function (sin, pow, etc.)
+    UDOpcodeLoad,  // Push input slot `operand` (see UDVariableNode)
 
     // integer opcodes
     UDOpcodeAddI,
@@ -33,40 +35,38 @@ typedef NS_ENUM(NSInteger, UDOpcode) {
     UDOpcodeRotateLeft,
     UDOpcodeRotateRight,
     
-    // functions
-    UDOpcodePow,
-    UDOpcodeSqrt,
-    UDOpcodeLn,
-    UDOpcodeSin,
-    UDOpcodeSinD,
-    UDOpcodeASin,
-    UDOpcodeASinD,
-    UDOpcodeCos,
-    UDOpcodeCosD,
-    UDOpcodeACos,
-    UDOpcodeACosD,
-    UDOpcodeTan,
-    UDOpcodeTanD,
-    UDOpcodeATan,
-    UDOpcodeATanD,
-    UDOpcodeSinH,
-    UDOpcodeASinH,
-    UDOpcodeCosH,
-    UDOpcodeACosH,
-    UDOpcodeTanH,
-    UDOpcodeATanH,
-    UDOpcodeLog10,
-    UDOpcodeLog2,
-    UDOpcodeFact,
-    UDOpcodeFlipB,
-    UDOpcodeFlipW
+    // functions, in UD_FUNCTIONS order
+#define UD_FUNCTION_OPCODE(name, str, mnemonic) UDOpcode##name,
+    UD_FUNCTIONS(UD_FUNCTION_OPCODE)
+#undef UD_FUNCTION_OPCODE
+
+    // superinstructions: fused PUSH k; OP pairs.
+    // Produced by UDVM for its threaded core, never emitted by UDCompiler.
+    // The operand is the constant pool index of k.
+    UDOpcodeAddK,
+    UDOpcodeSubK,
+    UDOpcodeMulK,
+    UDOpcodeDivK,
+    UDOpcodeAddIK,
+    UDOpcodeSubIK,
+    UDOpcodeMulIK,
+    UDOpcodeDivIK,
+    UDOpcodeSquare,      // PUSH 2; POW
+    UDOpcodeShiftLeft1,  // PUSH 1; SHL
+    UDOpcodeShiftRight1, // PUSH 1; SHR
+    UDOpcodeRotateLeft1, // PUSH 1; ROL
+    UDOpcodeRotateRight1,// PUSH 1; ROR
+
+    UDOpcodeHalt,        // end-of-program sentinel for the threaded core
+    UDOpcodeCount
 };
 
 @interface UDInstruction : NSObject
 @property (nonatomic, readonly) UDOpcode opcode;
-@property (nonatomic, readonly) UDValue payload;         // For PUSH
+@property (nonatomic, readonly) UDValue payload;         // For PUSH; the slot (integer) for LOAD
 
 + (instancetype)push:(UDValue)val;
++ (instancetype)load:(NSUInteger)slot;
 + (instancetype)op:(UDOpcode)op;
 
 - (NSString *)debugDescription;
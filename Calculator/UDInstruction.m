@@ -12,6 +12,10 @@
     UDInstruction *i = [UDInstruction new];
     i->_opcode = UDOpcodePush; i->_payload = val; return i;
 }
++ (instancetype)load:(NSUInteger)slot {
+    UDInstruction *i = [UDInstruction new];
+    i->_opcode = UDOpcodeLoad; i->_payload = UDValueMakeInt(slot); return i;
+}
 + (instancetype)op:(UDOpcode)op {
     UDInstruction *i = [UDInstruction new];
     i->_opcode = op; return i;
@@ -28,6 +32,8 @@
             return @"DIV";
         case UDOpcodeNeg:
             return @"NEG";
+        case UDOpcodeLoad:
+            return [NSString stringWithFormat:@"LOAD %llu", _payload.v.intValue];
         case UDOpcodeAddI:
             return @"ADDI";
         case UDOpcodeSubI:
@@ -36,6 +42,9 @@
             return @"MULI";
         case UDOpcodeDivI:
             return @"DIVI";
+#define UD_FUNCTION_MNEMONIC(name, str, mnemonic) case UDOpcode##name: return @mnemonic;
+        UD_FUNCTIONS(UD_FUNCTION_MNEMONIC)
+#undef UD_FUNCTION_MNEMONIC
         default:
             return @"UNKNOWN";
     }
@@ -0,0 +1,45 @@
+//
+//  UDJIT.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "UDProgram.h"
+
+// Machine code for one program. Owns its executable mapping; immutable
+// and safe to run from several threads at once.
+@interface UDJITCode : NSObject
+
+@property (nonatomic, readonly) NSUInteger size;    // bytes mapped
+
+// inputs[i] is what LOAD i reads; at least the program's inputCount values.
+- (UDValue)runWithInputs:(const UDValue *)inputs;
+
+@end
+
+// Native tier for UDVM: translates a verified program into x86-64 code.
+// The operand stack lives in SSE registers (spilled to the native frame
+// around calls) and the transcendental opcodes call libm directly.
+//
+// Covers floating-point programs: double constants and inputs, the four
+// arithmetic operators and their PUSH k forms, negation and every
+// function in UD_FUNCTIONS but the bit flips. Integer and bitwise
+// programs are left to the interpreter.
+@interface UDJIT : NSObject
+
+// x86-64 with writable-then-executable mappings.
+@property (class, nonatomic, readonly) BOOL isSupported;
+
+// Off by default: the native code reproduces the interpreter's divide by
+// zero but no other error path yet. When off, compileProgram: returns nil
+// and UDVM stays in the interpreter. Setting it has no effect unless
+// isSupported.
+@property (class, nonatomic, assign) BOOL enabled;
+
+// nil when the JIT is off or unsupported, the program was not verified,
+// or it uses an opcode outside the covered subset.
++ (UDJITCode *)compileProgram:(UDProgram *)program;
+
+@end
@@ -0,0 +1,431 @@
+//
+//  UDJIT.m
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDJIT.h"
+#import "UDVM.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define UDJIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// double f(const double *constants, const double *inputs, uint32_t *error)
+typedef double (*UDJITFunction)(const double *, const double *, uint32_t *);
+
+// Opcodes that are more than a libm call, with the VM's exact expressions
+// so that both tiers round the same way.
+static double UDJITSinD(double a)  { return sin(a * M_PI / 180.0); }
+static double UDJITASinD(double a) { return asin(a * M_PI / 180.0); }
+static double UDJITCosD(double a)  { return cos(a * M_PI / 180.0); }
+static double UDJITACosD(double a) { return acos(a * M_PI / 180.0); }
+static double UDJITTanD(double a)  { return tan(a * M_PI / 180.0); }
+static double UDJITATanD(double a) { return atan(a * M_PI / 180.0); }
+static double UDJITFact(double a)  { return tgamma(a + 1); }
+static double UDJITSquare(double a) { return UDVMPow(a, 2.0); }
+
+// Unary opcodes that compile to a plain call.
+static double (*const kUDJITUnaryCalls[UDOpcodeCount])(double) = {
+    [UDOpcodeLn]    = log,
+    [UDOpcodeSin]   = sin,   [UDOpcodeSinD]  = UDJITSinD,
+    [UDOpcodeASin]  = asin,  [UDOpcodeASinD] = UDJITASinD,
+    [UDOpcodeCos]   = cos,   [UDOpcodeCosD]  = UDJITCosD,
+    [UDOpcodeACos]  = acos,  [UDOpcodeACosD] = UDJITACosD,
+    [UDOpcodeTan]   = tan,   [UDOpcodeTanD]  = UDJITTanD,
+    [UDOpcodeATan]  = atan,  [UDOpcodeATanD] = UDJITATanD,
+    [UDOpcodeSinH]  = sinh,  [UDOpcodeASinH] = asinh,
+    [UDOpcodeCosH]  = cosh,  [UDOpcodeACosH] = acosh,
+    [UDOpcodeTanH]  = tanh,  [UDOpcodeATanH] = atanh,
+    [UDOpcodeLog10] = log10, [UDOpcodeLog2]  = log2,
+    [UDOpcodeFact]  = UDJITFact,     [UDOpcodeSquare] = UDJITSquare,
+};
+
+#ifdef UDJIT_X86_64
+
+// --- EMITTER ---
+// Native frame: rbx = constants, r13 = inputs, r14 = error flag, and
+// rbp points at one 8-byte home per stack slot. Slot s lives in
+// xmm(2 + s) while it fits, else in its home; xmm0 and xmm1 are scratch
+// (and the call arguments), xmm15 holds zero for the divisor checks.
+// Every SSE register is caller-saved, so live slots go to their homes
+// around each call and come back after it.
+enum { RAX = 0, RBX = 3, RBP = 5, R13 = 13, R14 = 14 };
+enum { kUDJITRegisterSlots = 13, kUDJITZero = 15 };
+
+// SSE2 scalar double opcodes (second byte after 0F)
+enum {
+    kSSEMovLoad = 0x10, kSSEMovStore = 0x11, kSSESqrt = 0x51,
+    kSSEAdd = 0x58, kSSEMul = 0x59, kSSESub = 0x5C, kSSEDiv = 0x5E,
+    kSSEUcomi = 0x2E, kSSEXor = 0x57
+};
+
+typedef struct {
+    uint8_t *bytes;
+    size_t count, capacity;
+} UDJITBuffer;
+
+static void UDJITByte(UDJITBuffer *b, uint8_t x) {
+    if (b->count == b->capacity) {
+        b->capacity = b->capacity ? b->capacity * 2 : 256;
+        b->bytes = realloc(b->bytes, b->capacity);
+    }
+    b->bytes[b->count++] = x;
+}
+
+static void UDJITWord(UDJITBuffer *b, uint32_t x) {
+    for (int i = 0; i < 4; i++) UDJITByte(b, (uint8_t)(x >> (8 * i)));
+}
+
+static void UDJITQuad(UDJITBuffer *b, uint64_t x) {
+    for (int i = 0; i < 8; i++) UDJITByte(b, (uint8_t)(x >> (8 * i)));
+}
+
+// prefix [REX] 0F op /r, register form
+static void UDJITSSE(UDJITBuffer *b, uint8_t prefix, uint8_t op, int reg, int rm) {
+    UDJITByte(b, prefix);
+    uint8_t rex = 0x40 | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+    if (rex != 0x40) UDJITByte(b, rex);
+    UDJITByte(b, 0x0F);
+    UDJITByte(b, op);
+    UDJITByte(b, (uint8_t)(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+}
+
+// prefix [REX] 0F op /r, [base + disp32]. base is never rsp or r12,
+// which would need a SIB byte.
+static void UDJITSSEMem(UDJITBuffer *b, uint8_t prefix, uint8_t op, int reg, int base, int32_t disp) {
+    UDJITByte(b, prefix);
+    uint8_t rex = 0x40 | ((reg & 8) ? 4 : 0) | ((base & 8) ? 1 : 0);
+    if (rex != 0x40) UDJITByte(b, rex);
+    UDJITByte(b, 0x0F);
+    UDJITByte(b, op);
+    UDJITByte(b, (uint8_t)(0x80 | ((reg & 7) << 3) | (base & 7)));
+    UDJITWord(b, (uint32_t)disp);
+}
+
+static void UDJITPush(UDJITBuffer *b, int r) {
+    if (r & 8) UDJITByte(b, 0x41);
+    UDJITByte(b, (uint8_t)(0x50 + (r & 7)));
+}
+
+static void UDJITPop(UDJITBuffer *b, int r) {
+    if (r & 8) UDJITByte(b, 0x41);
+    UDJITByte(b, (uint8_t)(0x58 + (r & 7)));
+}
+
+// mov dst, src (64-bit general registers)
+static void UDJITMove(UDJITBuffer *b, int dst, int src) {
+    UDJITByte(b, (uint8_t)(0x48 | ((src & 8) ? 4 : 0) | ((dst & 8) ? 1 : 0)));
+    UDJITByte(b, 0x89);
+    UDJITByte(b, (uint8_t)(0xC0 | ((src & 7) << 3) | (dst & 7)));
+}
+
+// jcc/jmp rel32 with the displacement left for UDJITPatch; returns its offset.
+static size_t UDJITJump(UDJITBuffer *b, uint8_t cc) {
+    if (cc) { UDJITByte(b, 0x0F); UDJITByte(b, cc); }
+    else UDJITByte(b, 0xE9);
+    UDJITWord(b, 0);
+    return b->count - 4;
+}
+
+static void UDJITPatch(UDJITBuffer *b, size_t at, size_t target) {
+    int32_t rel = (int32_t)((int64_t)target - (int64_t)(at + 4));
+    memcpy(b->bytes + at, &rel, 4);
+}
+
+static inline int UDJITHome(NSUInteger slot) {
+    return slot < kUDJITRegisterSlots ? 2 + (int)slot : -1;
+}
+
+static inline int32_t UDJITFrame(NSUInteger slot) {
+    return (int32_t)(8 * slot);
+}
+
+// Register holding slot s, loading it into scratch if it lives in memory.
+static int UDJITUse(UDJITBuffer *b, NSUInteger slot, int scratch) {
+    int home = UDJITHome(slot);
+    if (home >= 0) return home;
+    UDJITSSEMem(b, 0xF2, kSSEMovLoad, scratch, RBP, UDJITFrame(slot));
+    return scratch;
+}
+
+// Makes slot s hold the value computed in reg.
+static void UDJITDefine(UDJITBuffer *b, NSUInteger slot, int reg) {
+    int home = UDJITHome(slot);
+    if (home == reg) return;
+    if (home >= 0) UDJITSSE(b, 0xF2, kSSEMovLoad, home, reg);
+    else UDJITSSEMem(b, 0xF2, kSSEMovStore, reg, RBP, UDJITFrame(slot));
+}
+
+static void UDJITLoadConstant(UDJITBuffer *b, int reg, uint32_t index) {
+    UDJITSSEMem(b, 0xF2, kSSEMovLoad, reg, RBX, (int32_t)(8 * index));
+}
+
+// Jumps to the error exit when reg is zero. NaN is not zero (parity set).
+static void UDJITCheckDivisor(UDJITBuffer *b, int reg, size_t *errorJumps, NSUInteger *errorCount) {
+    UDJITSSE(b, 0x66, kSSEXor, kUDJITZero, kUDJITZero);
+    UDJITSSE(b, 0x66, kSSEUcomi, reg, kUDJITZero);
+    UDJITByte(b, 0x7A);     // jp over the je
+    UDJITByte(b, 6);
+    errorJumps[(*errorCount)++] = UDJITJump(b, 0x84);
+}
+
+// Calls fn with the slots from first up to the top (one or two of them)
+// in xmm0/xmm1. The result replaces slot first.
+static void UDJITCall(UDJITBuffer *b, const void *fn, NSUInteger first, NSUInteger top) {
+    for (NSUInteger s = 0; s < first; s++) {
+        if (UDJITHome(s) >= 0) UDJITSSEMem(b, 0xF2, kSSEMovStore, UDJITHome(s), RBP, UDJITFrame(s));
+    }
+    int a = UDJITUse(b, first, 0);
+    if (a != 0) UDJITSSE(b, 0xF2, kSSEMovLoad, 0, a);
+    if (top > first) {
+        int r = UDJITUse(b, first + 1, 1);
+        if (r != 1) UDJITSSE(b, 0xF2, kSSEMovLoad, 1, r);
+    }
+
+    UDJITByte(b, 0x48); UDJITByte(b, 0xB8);     // mov rax, fn
+    UDJITQuad(b, (uint64_t)(uintptr_t)fn);
+    UDJITByte(b, 0xFF); UDJITByte(b, 0xD0);     // call rax
+
+    UDJITDefine(b, first, 0);
+    for (NSUInteger s = 0; s < first; s++) {
+        if (UDJITHome(s) >= 0) UDJITSSEMem(b, 0xF2, kSSEMovLoad, UDJITHome(s), RBP, UDJITFrame(s));
+    }
+}
+
+// Translates a verified program. Returns NO for an opcode outside the
+// covered subset; the buffer is then left for the caller to free.
+static BOOL UDJITEmit(UDJITBuffer *b, const UDInsn *code, NSUInteger count, NSUInteger maxDepth) {
+    size_t *errorJumps = malloc((count ? count : 1) * sizeof(size_t));
+    NSUInteger errorCount = 0;
+    NSUInteger sp = 0;
+    BOOL ok = YES;
+
+    // Keeps rsp 16-byte aligned at every call: return address plus four
+    // pushes is 40 bytes, so the frame is an odd multiple of 8.
+    uint32_t frame = (uint32_t)(((8 * maxDepth + 15) & ~(NSUInteger)15) + 8);
+
+    UDJITPush(b, RBP);
+    UDJITPush(b, RBX);
+    UDJITPush(b, R13);
+    UDJITPush(b, R14);
+    UDJITByte(b, 0x48); UDJITByte(b, 0x81); UDJITByte(b, 0xEC); UDJITWord(b, frame);   // sub rsp, frame
+    UDJITByte(b, 0x48); UDJITByte(b, 0x89); UDJITByte(b, 0xE5);                        // mov rbp, rsp
+    UDJITMove(b, RBX, 7);   // rdi
+    UDJITMove(b, R13, 6);   // rsi
+    UDJITMove(b, R14, 2);   // rdx
+
+    for (NSUInteger i = 0; i < count && ok; i++) {
+        UDOpcode op = (UDOpcode)code[i].opcode;
+        uint32_t k = code[i].operand;
+        switch (op) {
+            case UDOpcodePush:
+                UDJITLoadConstant(b, UDJITHome(sp) >= 0 ? UDJITHome(sp) : 0, k);
+                UDJITDefine(b, sp, UDJITHome(sp) >= 0 ? UDJITHome(sp) : 0);
+                sp++;
+                break;
+
+            case UDOpcodeLoad: {
+                int r = UDJITHome(sp) >= 0 ? UDJITHome(sp) : 0;
+                UDJITSSEMem(b, 0xF2, kSSEMovLoad, r, R13, (int32_t)(8 * k));
+                UDJITDefine(b, sp, r);
+                sp++;
+                break;
+            }
+
+            case UDOpcodeCall:
+                break;
+
+            case UDOpcodeAdd: case UDOpcodeSub: case UDOpcodeMul: case UDOpcodeDiv:
+            case UDOpcodeAddK: case UDOpcodeSubK: case UDOpcodeMulK: case UDOpcodeDivK: {
+                BOOL constant = op >= UDOpcodeAddK;
+                NSUInteger left = constant ? sp - 1 : sp - 2;
+                int rb;
+                if (constant) { UDJITLoadConstant(b, 1, k); rb = 1; }
+                else rb = UDJITUse(b, sp - 1, 1);
+                int ra = UDJITUse(b, left, 0);
+
+                UDOpcode base = constant ? (UDOpcode)(op - UDOpcodeAddK + UDOpcodeAdd) : op;
+                uint8_t sse = base == UDOpcodeAdd ? kSSEAdd
+                            : base == UDOpcodeSub ? kSSESub
+                            : base == UDOpcodeMul ? kSSEMul : kSSEDiv;
+                if (sse == kSSEDiv) UDJITCheckDivisor(b, rb, errorJumps, &errorCount);
+                UDJITSSE(b, 0xF2, sse, ra, rb);
+                UDJITDefine(b, left, ra);
+                sp = left + 1;
+                break;
+            }
+
+            case UDOpcodeNeg: {
+                // Flip the sign bit: movq rax, x; btc rax, 63; movq x, rax
+                int r = UDJITUse(b, sp - 1, 0);
+                UDJITByte(b, 0x66); UDJITByte(b, (uint8_t)(0x48 | ((r & 8) ? 4 : 0)));
+                UDJITByte(b, 0x0F); UDJITByte(b, 0x7E); UDJITByte(b, (uint8_t)(0xC0 | ((r & 7) << 3)));
+                UDJITByte(b, 0x48); UDJITByte(b, 0x0F); UDJITByte(b, 0xBA); UDJITByte(b, 0xF8); UDJITByte(b, 63);
+                UDJITByte(b, 0x66); UDJITByte(b, (uint8_t)(0x48 | ((r & 8) ? 4 : 0)));
+                UDJITByte(b, 0x0F); UDJITByte(b, 0x6E); UDJITByte(b, (uint8_t)(0xC0 | ((r & 7) << 3)));
+                UDJITDefine(b, sp - 1, r);
+                break;
+            }
+
+            case UDOpcodeSqrt: {
+                int r = UDJITUse(b, sp - 1, 0);
+                UDJITSSE(b, 0xF2, kSSESqrt, r, r);
+                UDJITDefine(b, sp - 1, r);
+                break;
+            }
+
+            case UDOpcodePow:
+                UDJITCall(b, (const void *)UDVMPow, sp - 2, sp - 1);
+                sp--;
+                break;
+
+            default:
+                if (op < UDOpcodeCount && kUDJITUnaryCalls[op]) {
+                    UDJITCall(b, (const void *)kUDJITUnaryCalls[op], sp - 1, sp - 1);
+                } else {
+                    ok = NO;
+                }
+                break;
+        }
+    }
+
+    if (ok) {
+        int r = UDJITUse(b, sp - 1, 0);
+        if (r != 0) UDJITSSE(b, 0xF2, kSSEMovLoad, 0, r);
+
+        size_t epilogue = b->count;
+        UDJITByte(b, 0x48); UDJITByte(b, 0x81); UDJITByte(b, 0xC4); UDJITWord(b, frame);   // add rsp, frame
+        UDJITPop(b, R14);
+        UDJITPop(b, R13);
+        UDJITPop(b, RBX);
+        UDJITPop(b, RBP);
+        UDJITByte(b, 0xC3);
+
+        // *error = 1; then leave through the epilogue
+        size_t error = b->count;
+        UDJITByte(b, 0x41); UDJITByte(b, 0xC7); UDJITByte(b, 0x86); UDJITWord(b, 0); UDJITWord(b, 1);
+        UDJITPatch(b, UDJITJump(b, 0), epilogue);
+        for (NSUInteger i = 0; i < errorCount; i++) UDJITPatch(b, errorJumps[i], error);
+    }
+
+    free(errorJumps);
+    return ok;
+}
+
+#endif
+
+@implementation UDJITCode {
+    void *_code;
+    UDJITFunction _function;
+    double *_constants;
+    NSUInteger _inputCount;
+}
+
+- (void)dealloc {
+#ifdef UDJIT_X86_64
+    if (_code) munmap(_code, _size);
+#endif
+    free(_constants);
+}
+
+- (UDValue)runWithInputs:(const UDValue *)inputs {
+    double values[_inputCount > 0 ? _inputCount : 1];
+    for (NSUInteger i = 0; i < _inputCount; i++) values[i] = UDValueAsDouble(inputs[i]);
+
+    uint32_t error = 0;
+    double result = _function(_constants, values, &error);
+    return error ? UDValueMakeError(UDValueErrorTypeDivideByZero) : UDValueMakeDouble(result);
+}
+
+@end
+
+static BOOL sUDJITEnabled = NO;
+
+@implementation UDJIT
+
++ (BOOL)isSupported {
+#ifdef UDJIT_X86_64
+    // Some systems refuse executable mappings (SELinux, hardened runtimes);
+    // find out once rather than at every compile.
+    static BOOL supported;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        void *p = mmap(NULL, page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+        if (p != MAP_FAILED) {
+            supported = mprotect(p, page, PROT_READ | PROT_EXEC) == 0;
+            munmap(p, page);
+        }
+    });
+    return supported;
+#else
+    return NO;
+#endif
+}
+
++ (BOOL)enabled {
+    return sUDJITEnabled;
+}
+
++ (void)setEnabled:(BOOL)enabled {
+    sUDJITEnabled = enabled && [self isSupported];
+}
+
++ (UDJITCode *)compileProgram:(UDProgram *)program {
+#ifdef UDJIT_X86_64
+    if (![self enabled] || ![UDVM verifyProgram:program]) return nil;
+
+    const UDInsn *code = program.code;
+    NSUInteger count = program.count;
+
+    // Everything on the native stack is a double. PUSH of an integer and a
+    // program whose result is an input straight through would keep their
+    // type in the interpreter, so they stay there.
+    NSUInteger last = count;
+    for (NSUInteger i = 0; i < count; i++) {
+        if (code[i].opcode == UDOpcodePush && !UDBoxIsDouble(program.constants[code[i].operand])) return nil;
+        if (code[i].opcode != UDOpcodeCall) last = i;
+    }
+    if (last == count || code[last].opcode == UDOpcodeLoad) return nil;
+
+    UDJITBuffer buffer = { NULL, 0, 0 };
+    if (!UDJITEmit(&buffer, code, count, program.maxStackDepth)) {
+        free(buffer.bytes);
+        return nil;
+    }
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = (buffer.count + page - 1) / page * page;
+    void *mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    if (mem == MAP_FAILED) {
+        free(buffer.bytes);
+        return nil;
+    }
+    memcpy(mem, buffer.bytes, buffer.count);
+    free(buffer.bytes);
+    if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, size);
+        return nil;
+    }
+
+    UDJITCode *jit = [[UDJITCode alloc] init];
+    jit->_code = mem;
+    jit->_size = size;
+    jit->_function = (UDJITFunction)mem;
+    jit->_inputCount = program.inputCount;
+    NSUInteger constantCount = program.constantCount;
+    jit->_constants = malloc((constantCount > 0 ? constantCount : 1) * sizeof(double));
+    for (NSUInteger i = 0; i < constantCount; i++) jit->_constants[i] = UDBoxAsDouble(program.constants[i], program.wideConstants);
+    return jit;
+#else
+    return nil;
+#endif
+}
+
+@end
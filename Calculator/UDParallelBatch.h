@@ -0,0 +1,47 @@
+//
+//  UDParallelBatch.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "UDBatchEvaluator.h"
+
+// Evaluates many independent expressions across all cores. Each worker
+// thread owns a UDBatchEvaluator (parser, arena, calculator), so the hot
+// path shares nothing but the frozen operator table.
+//
+// Lines are dealt out as one contiguous range per worker. A worker takes
+// small chunks from the front of its own range; once that is empty it
+// steals the back half of another worker's, so a few slow lines do not
+// leave the other cores idle. Results land at their input index, so the
+// output is in input order whoever evaluated what.
+@interface UDParallelBatch : NSObject
+
+// 0 means one worker per active processor.
+- (instancetype)initWithWorkerCount:(NSUInteger)workerCount;
+
+@property (nonatomic, readonly) NSUInteger workerCount;
+
+// As on UDBatchEvaluator; copied to every worker at the start of a run.
+@property (nonatomic, assign) UDBatchInputFormat inputFormat;
+@property (nonatomic, assign) UDBase base;
+@property (nonatomic, assign) BOOL integerMode;
+@property (nonatomic, assign) BOOL isRadians;
+@property (nonatomic, assign) NSInteger decimalPlaces;
+
+// results[i] is the value of lines[i]. When latencies is not NULL,
+// latencies[i] is the time spent on lines[i] in nanoseconds.
+- (void)evaluateUTF8Lines:(const char *const *)lines
+                  lengths:(const NSUInteger *)lengths
+                    count:(NSUInteger)count
+                  results:(UDValue *)results
+                latencies:(uint64_t *)latencies;
+
+// Formatted results, one per line, in input order.
+- (NSArray<NSString *> *)evaluateLines:(NSArray<NSString *> *)lines;
+
+- (NSString *)stringForValue:(UDValue)value;
+
+@end
@@ -0,0 +1,207 @@
+//
+//  UDParallelBatch.m
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDParallelBatch.h"
+#import "UDValueFormatter.h"
+#include <dispatch/dispatch.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Lines a worker takes from its own range at a time: enough to amortize
+// the atomic, few enough that the tail of a run still balances.
+static const uint64_t kUDParallelChunk = 64;
+
+// Ranges pack begin and end into one word so they can be split with a
+// single compare-and-swap; a run is cut into slices that fit.
+static const NSUInteger kUDParallelMaxSlice = UINT32_MAX;
+
+// One per worker, each on its own cache line so that popping a chunk
+// does not invalidate the line a neighbour is popping from.
+typedef struct {
+    _Atomic uint64_t range;     // begin << 32 | end
+    char pad[64 - sizeof(uint64_t)];
+} UDWorkerRange;
+
+static inline uint64_t UDRangeMake(uint64_t begin, uint64_t end) {
+    return begin << 32 | end;
+}
+
+// Takes up to max items from the front of r; the owner's side.
+static BOOL UDRangePop(UDWorkerRange *r, uint64_t max, uint64_t *begin, uint64_t *end) {
+    uint64_t old = atomic_load_explicit(&r->range, memory_order_relaxed);
+    for (;;) {
+        uint64_t b = old >> 32, e = old & 0xFFFFFFFFu;
+        if (b >= e) return NO;
+        uint64_t nb = e - b > max ? b + max : e;
+        if (atomic_compare_exchange_weak_explicit(&r->range, &old, UDRangeMake(nb, e),
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            *begin = b;
+            *end = nb;
+            return YES;
+        }
+    }
+}
+
+// Takes the back half of r (all of it when one item is left); the thief's side.
+static BOOL UDRangeSteal(UDWorkerRange *r, uint64_t *begin, uint64_t *end) {
+    uint64_t old = atomic_load_explicit(&r->range, memory_order_relaxed);
+    for (;;) {
+        uint64_t b = old >> 32, e = old & 0xFFFFFFFFu;
+        if (b >= e) return NO;
+        uint64_t mid = b + (e - b) / 2;
+        if (atomic_compare_exchange_weak_explicit(&r->range, &old, UDRangeMake(b, mid),
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            *begin = mid;
+            *end = e;
+            return YES;
+        }
+    }
+}
+
+static inline uint64_t UDNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+@implementation UDParallelBatch {
+    NSArray<UDBatchEvaluator *> *_workers;
+    UDWorkerRange *_ranges;
+}
+
+- (instancetype)init {
+    return [self initWithWorkerCount:0];
+}
+
+- (instancetype)initWithWorkerCount:(NSUInteger)workerCount {
+    self = [super init];
+    if (self) {
+        if (workerCount == 0) workerCount = [NSProcessInfo processInfo].activeProcessorCount;
+        if (workerCount == 0) workerCount = 1;
+        _workerCount = workerCount;
+
+        NSMutableArray *workers = [NSMutableArray arrayWithCapacity:workerCount];
+        for (NSUInteger w = 0; w < workerCount; w++) {
+            [workers addObject:[[UDBatchEvaluator alloc] init]];
+        }
+        _workers = [workers copy];
+
+        if (posix_memalign((void **)&_ranges, 64, workerCount * sizeof(UDWorkerRange)) != 0) return nil;
+        memset(_ranges, 0, workerCount * sizeof(UDWorkerRange));
+
+        UDBatchEvaluator *first = _workers[0];
+        _inputFormat = first.inputFormat;
+        _base = first.base;
+        _integerMode = first.integerMode;
+        _isRadians = first.isRadians;
+        _decimalPlaces = first.decimalPlaces;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_ranges);
+}
+
+- (void)configureWorkers {
+    for (UDBatchEvaluator *worker in _workers) {
+        worker.inputFormat = self.inputFormat;
+        worker.base = self.base;
+        worker.integerMode = self.integerMode;
+        worker.isRadians = self.isRadians;
+        worker.decimalPlaces = self.decimalPlaces;
+    }
+}
+
+// Runs body over [0, count) in chunks, each chunk on one worker with that
+// worker's evaluator. Returns once every index has been visited.
+- (void)runCount:(NSUInteger)count body:(void (^)(UDBatchEvaluator *worker, NSUInteger begin, NSUInteger end))body {
+    [self configureWorkers];
+
+    for (NSUInteger offset = 0; offset < count; offset += kUDParallelMaxSlice) {
+        uint64_t slice = MIN(count - offset, kUDParallelMaxSlice);
+        size_t n = (size_t)MIN((uint64_t)_workerCount, slice);
+
+        UDWorkerRange *ranges = _ranges;
+        for (size_t w = 0; w < n; w++) {
+            atomic_store_explicit(&ranges[w].range,
+                                  UDRangeMake(slice * w / n, slice * (w + 1) / n),
+                                  memory_order_relaxed);
+        }
+
+        NSArray<UDBatchEvaluator *> *workers = _workers;
+        dispatch_apply(n, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t w) {
+            UDBatchEvaluator *worker = workers[w];
+            uint64_t b, e;
+            for (;;) {
+                while (UDRangePop(&ranges[w], kUDParallelChunk, &b, &e)) {
+                    @autoreleasepool {
+                        body(worker, (NSUInteger)(offset + b), (NSUInteger)(offset + e));
+                    }
+                }
+
+                // Own range is empty: only this thread refills it, so the
+                // stolen half can be published with a plain store.
+                BOOL stole = NO;
+                for (size_t k = 1; k < n && !stole; k++) {
+                    if (UDRangeSteal(&ranges[(w + k) % n], &b, &e)) {
+                        atomic_store_explicit(&ranges[w].range, UDRangeMake(b, e), memory_order_relaxed);
+                        stole = YES;
+                    }
+                }
+                if (!stole) break;
+            }
+        });
+    }
+}
+
+- (void)evaluateUTF8Lines:(const char *const *)lines
+                  lengths:(const NSUInteger *)lengths
+                    count:(NSUInteger)count
+                  results:(UDValue *)results
+                latencies:(uint64_t *)latencies {
+    [self runCount:count body:^(UDBatchEvaluator *worker, NSUInteger begin, NSUInteger end) {
+        for (NSUInteger i = begin; i < end; i++) {
+            if (latencies) {
+                uint64_t t0 = UDNow();
+                results[i] = [worker evaluateUTF8:lines[i] length:lengths[i]];
+                latencies[i] = UDNow() - t0;
+            } else {
+                results[i] = [worker evaluateUTF8:lines[i] length:lengths[i]];
+            }
+        }
+    }];
+}
+
+- (NSArray<NSString *> *)evaluateLines:(NSArray<NSString *> *)lines {
+    NSUInteger count = lines.count;
+    if (count == 0) return @[];
+
+    __strong NSString **strings = (__strong NSString **)calloc(count, sizeof(NSString *));
+    [self runCount:count body:^(UDBatchEvaluator *worker, NSUInteger begin, NSUInteger end) {
+        for (NSUInteger i = begin; i < end; i++) {
+            strings[i] = [worker stringForValue:[worker evaluateLine:lines[i]]];
+        }
+    }];
+
+    NSArray *result = [NSArray arrayWithObjects:strings count:count];
+    for (NSUInteger i = 0; i < count; i++) strings[i] = nil;
+    free(strings);
+    return result;
+}
+
+- (NSString *)stringForValue:(UDValue)value {
+    return [UDValueFormatter stringForValue:value
+                                       base:self.base
+                    showThousandsSeparators:NO
+                              decimalPlaces:self.decimalPlaces
+                            forceScientific:NO];
+}
+
+@end
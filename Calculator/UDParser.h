@@ -0,0 +1,47 @@
+//
+//  UDParser.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "UDAST.h"
+
+// Parses typed or pasted text straight into an AST, without going through
+// the keypad state machine in UDCalc. Precedence, associativity and the
+// node each operator builds come from UDFrontend's table, so a parsed
+// expression gets the same tree as the same expression keyed in.
+//
+//   2 + 3 * sin(30)      -(1 + 2)^2        100 + 5%
+//   0xFF and ~0b1010     1 << 4 | 0o17     π * 2²
+//
+// Functions take either a parenthesized argument or a bare operand
+// ("sin 30"); names from UD_FUNCTIONS (pow, sinD, flip_b, ...) are also
+// accepted with parenthesized, comma separated arguments.
+//
+// A parser keeps its scratch state between calls; use one per thread.
+@interface UDParser : NSObject
+
+// Snapshot of the settings the keypad frontend reads from its context.
+@property (nonatomic, assign) BOOL isRadians;
+@property (nonatomic, assign) double memoryValue;   // MR
+
+// Literals become integers (programmer mode); a fraction or exponent is
+// then a syntax error.
+@property (nonatomic, assign) BOOL integerMode;
+
+// Names that read an input slot: variables[i] becomes a UDVariableNode
+// for slot i. Operator, function and constant spellings come first, so a
+// variable cannot be called "e" or "sin".
+@property (nonatomic, copy) NSArray<NSString *> *variables;
+
+// Byte offset of the first offending token after a failed parse,
+// NSNotFound after a successful one.
+@property (nonatomic, readonly) NSUInteger errorOffset;
+
+// Returns nil on a syntax error.
+- (UDASTNode *)parseString:(NSString *)text;
+- (UDASTNode *)parseUTF8:(const char *)text length:(NSUInteger)length;
+
+@end
@@ -0,0 +1,442 @@
+//
+//  UDParser.m
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDParser.h"
+#import "UDFrontend.h"
+#import "UDFrontendContext.h"
+#import "UDDecimalConversion.h"
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Deep enough for any expression a person writes, shallow enough for the
+// C stack: every nesting level is a couple of recursive calls.
+static const NSInteger kUDParserMaxDepth = 512;
+
+typedef NS_ENUM(NSInteger, UDTokenKind) {
+    UDTokenEnd,
+    UDTokenNumber,
+    UDTokenWord,        // operator, function or constant spelling
+    UDTokenParenLeft,
+    UDTokenParenRight,
+    UDTokenComma,
+    UDTokenInvalid
+};
+
+typedef NS_ENUM(NSInteger, UDWordKind) {
+    // Seen after an operand
+    UDWordInfix,
+    UDWordPostfix,
+    // Seen where an operand is expected
+    UDWordPrefix,
+    UDWordFunction,
+    UDWordConstant,
+    UDWordNullary
+};
+
+typedef struct {
+    const char *spelling;
+    UDWordKind kind;
+    UDOp op;        // UDFrontend entry that builds the node
+    UDOp binding;   // entry whose precedence applies, UDOpNone for op's own
+} UDParserWord;
+
+// Text spellings of the keypad operators. A spelling may appear once as an
+// operator and once as an operand word ("-" is Sub and Negate).
+static const UDParserWord kUDParserWords[] = {
+    { "+",     UDWordInfix,    UDOpAdd,          UDOpNone },
+    { "-",     UDWordInfix,    UDOpSub,          UDOpNone },
+    { "*",     UDWordInfix,    UDOpMul,          UDOpNone },
+    { "×",     UDWordInfix,    UDOpMul,          UDOpNone },
+    { "/",     UDWordInfix,    UDOpDiv,          UDOpNone },
+    { "÷",     UDWordInfix,    UDOpDiv,          UDOpNone },
+    { "^",     UDWordInfix,    UDOpPow,          UDOpNone },
+    { "yroot", UDWordInfix,    UDOpYRoot,        UDOpNone },
+    { "&",     UDWordInfix,    UDOpBitwiseAnd,   UDOpNone },
+    { "and",   UDWordInfix,    UDOpBitwiseAnd,   UDOpNone },
+    { "|",     UDWordInfix,    UDOpBitwiseOr,    UDOpNone },
+    { "or",    UDWordInfix,    UDOpBitwiseOr,    UDOpNone },
+    { "xor",   UDWordInfix,    UDOpBitwiseXor,   UDOpNone },
+    { "nor",   UDWordInfix,    UDOpBitwiseNor,   UDOpNone },
+    { "<<",    UDWordInfix,    UDOpShiftLeft,    UDOpNone },
+    { ">>",    UDWordInfix,    UDOpShiftRight,   UDOpNone },
+    // The keypad only rotates by one; as text they take a count and bind like shifts
+    { "rol",   UDWordInfix,    UDOpRotateLeft,   UDOpShiftLeft },
+    { "ror",   UDWordInfix,    UDOpRotateRight,  UDOpShiftRight },
+
+    { "%",     UDWordPostfix,  UDOpPercent,      UDOpNone },
+    { "!",     UDWordPostfix,  UDOpFactorial,    UDOpNone },
+    { "²",     UDWordPostfix,  UDOpSquare,       UDOpNone },
+    { "³",     UDWordPostfix,  UDOpCube,         UDOpNone },
+
+    { "-",     UDWordPrefix,   UDOpNegate,       UDOpNone },
+    { "+",     UDWordPrefix,   UDOpNone,         UDOpNegate },
+    { "~",     UDWordPrefix,   UDOpComp1,        UDOpNone },
+    { "not",   UDWordPrefix,   UDOpComp1,        UDOpNone },
+
+    { "sin",    UDWordFunction, UDOpSin,         UDOpNone },
+    { "cos",    UDWordFunction, UDOpCos,         UDOpNone },
+    { "tan",    UDWordFunction, UDOpTan,         UDOpNone },
+    { "asin",   UDWordFunction, UDOpSinInverse,  UDOpNone },
+    { "sin⁻¹",  UDWordFunction, UDOpSinInverse,  UDOpNone },
+    { "acos",   UDWordFunction, UDOpCosInverse,  UDOpNone },
+    { "cos⁻¹",  UDWordFunction, UDOpCosInverse,  UDOpNone },
+    { "atan",   UDWordFunction, UDOpTanInverse,  UDOpNone },
+    { "tan⁻¹",  UDWordFunction, UDOpTanInverse,  UDOpNone },
+    { "sinh",   UDWordFunction, UDOpSinh,        UDOpNone },
+    { "cosh",   UDWordFunction, UDOpCosh,        UDOpNone },
+    { "tanh",   UDWordFunction, UDOpTanh,        UDOpNone },
+    { "asinh",  UDWordFunction, UDOpSinhInverse, UDOpNone },
+    { "sinh⁻¹", UDWordFunction, UDOpSinhInverse, UDOpNone },
+    { "acosh",  UDWordFunction, UDOpCoshInverse, UDOpNone },
+    { "cosh⁻¹", UDWordFunction, UDOpCoshInverse, UDOpNone },
+    { "atanh",  UDWordFunction, UDOpTanhInverse, UDOpNone },
+    { "tanh⁻¹", UDWordFunction, UDOpTanhInverse, UDOpNone },
+    { "ln",     UDWordFunction, UDOpLn,          UDOpNone },
+    { "log",    UDWordFunction, UDOpLog10,       UDOpNone },
+    { "log10",  UDWordFunction, UDOpLog10,       UDOpNone },
+    { "log₁₀",  UDWordFunction, UDOpLog10,       UDOpNone },
+    { "log2",   UDWordFunction, UDOpLog2,        UDOpNone },
+    { "log₂",   UDWordFunction, UDOpLog2,        UDOpNone },
+    { "sqrt",   UDWordFunction, UDOpSqrt,        UDOpNone },
+    { "√",      UDWordFunction, UDOpSqrt,        UDOpNone },
+    { "cbrt",   UDWordFunction, UDOpCbrt,        UDOpNone },
+    { "∛",      UDWordFunction, UDOpCbrt,        UDOpNone },
+
+    { "π",     UDWordConstant, UDOpConstPi,      UDOpNone },
+    { "pi",    UDWordConstant, UDOpConstPi,      UDOpNone },
+    { "e",     UDWordConstant, UDOpConstE,       UDOpNone },
+
+    { "rand",  UDWordNullary,  UDOpRand,         UDOpNone },
+    { "MR",    UDWordNullary,  UDOpMR,           UDOpNone },
+};
+
+// Non-ASCII spellings that stand alone as tokens
+static const char *const kUDParserSymbols[] = { "π", "×", "÷", "√", "∛", "²", "³" };
+
+// May follow an identifier as part of it (sin⁻¹, log₁₀, log₂)
+static const char *const kUDParserSuffixes[] = { "⁻¹", "₁₀", "₂" };
+
+#define UD_COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static const UDParserWord *UDParserLookup(const uint8_t *s, size_t len, BOOL operandExpected) {
+    for (size_t i = 0; i < UD_COUNT(kUDParserWords); i++) {
+        const UDParserWord *w = &kUDParserWords[i];
+        if ((w->kind >= UDWordPrefix) != operandExpected) continue;
+        if (strlen(w->spelling) == len && memcmp(w->spelling, s, len) == 0) return w;
+    }
+    return NULL;
+}
+
+static size_t UDParserMatch(const uint8_t *p, const uint8_t *end, const char *const *list, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        size_t len = strlen(list[i]);
+        if ((size_t)(end - p) >= len && memcmp(p, list[i], len) == 0) return len;
+    }
+    return 0;
+}
+
+static inline BOOL UDIsDigit(uint8_t c) { return c >= '0' && c <= '9'; }
+static inline BOOL UDIsIdentStart(uint8_t c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+
+static inline int UDDigitValue(uint8_t c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return 99;
+}
+
+@implementation UDParser {
+    const uint8_t *_start, *_p, *_end;
+
+    // Current token
+    UDTokenKind _token;
+    const uint8_t *_tokenStart;
+    size_t _tokenLength;
+    UDValue _tokenValue;
+
+    NSInteger _depth;
+    UDFrontend *_frontend;
+    UDFrontendContext *_context;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _frontend = [UDFrontend shared];
+        _context = [UDFrontendContext new];
+        _context.nodeStack = [NSMutableArray arrayWithCapacity:2];
+        _errorOffset = NSNotFound;
+    }
+    return self;
+}
+
+- (UDASTNode *)parseString:(NSString *)text {
+    const char *utf8 = text.UTF8String ?: "";
+    return [self parseUTF8:utf8 length:strlen(utf8)];
+}
+
+- (UDASTNode *)parseUTF8:(const char *)text length:(NSUInteger)length {
+    _start = _p = (const uint8_t *)text;
+    _end = _start + length;
+    _depth = 0;
+    _errorOffset = NSNotFound;
+    _context.isRadians = self.isRadians;
+    _context.memoryValue = self.memoryValue;
+
+    [self advance];
+    UDASTNode *root = [self parseExpression:0];
+    if (root && _token != UDTokenEnd) root = [self fail];
+
+    [_context.nodeStack removeAllObjects];
+    return root;
+}
+
+- (id)fail {
+    if (_errorOffset == NSNotFound) _errorOffset = (NSUInteger)(_tokenStart - _start);
+    return nil;
+}
+
+#pragma mark - Lexer
+
+- (void)advance {
+    while (_p < _end && (*_p == ' ' || *_p == '\t' || *_p == '\n' || *_p == '\r')) _p++;
+
+    _tokenStart = _p;
+    if (_p == _end) { _token = UDTokenEnd; _tokenLength = 0; return; }
+
+    uint8_t c = *_p;
+    size_t len;
+    if (UDIsDigit(c) || (c == '.' && _p + 1 < _end && UDIsDigit(_p[1]))) {
+        _token = [self lexNumber] ? UDTokenNumber : UDTokenInvalid;
+    }
+    else if (UDIsIdentStart(c)) {
+        while (_p < _end && (UDIsIdentStart(*_p) || UDIsDigit(*_p))) _p++;
+        while ((len = UDParserMatch(_p, _end, kUDParserSuffixes, UD_COUNT(kUDParserSuffixes)))) _p += len;
+        _token = UDTokenWord;
+    }
+    else if ((len = UDParserMatch(_p, _end, kUDParserSymbols, UD_COUNT(kUDParserSymbols)))) {
+        _p += len;
+        _token = UDTokenWord;
+    }
+    else if ((c == '<' || c == '>') && _p + 1 < _end && _p[1] == c) {
+        _p += 2;
+        _token = UDTokenWord;
+    }
+    else if (c && strchr("+-*/^&|~%!", c)) {
+        _p++;
+        _token = UDTokenWord;
+    }
+    else if (c == '(') { _p++; _token = UDTokenParenLeft; }
+    else if (c == ')') { _p++; _token = UDTokenParenRight; }
+    else if (c == ',') { _p++; _token = UDTokenComma; }
+    else {
+        _p++;
+        _token = UDTokenInvalid;
+    }
+    _tokenLength = (size_t)(_p - _tokenStart);
+}
+
+- (BOOL)lexNumber {
+    // 0x1F, 0o17, 0b101
+    if (*_p == '0' && _p + 1 < _end) {
+        unsigned base = 0;
+        switch (_p[1]) {
+            case 'x': case 'X': base = 16; break;
+            case 'o': case 'O': base = 8; break;
+            case 'b': case 'B': base = 2; break;
+        }
+        if (base) {
+            _p += 2;
+            const uint8_t *digits = _p;
+            unsigned long long acc = 0;
+            BOOL overflow = NO;
+            for (int d; _p < _end && (d = UDDigitValue(*_p)) < (int)base; _p++) {
+                if (acc > (ULLONG_MAX - d) / base) overflow = YES;
+                acc = acc * base + d;
+            }
+            if (_p == digits || overflow || (_p < _end && UDIsIdentStart(*_p))) return NO;
+            _tokenValue = self.integerMode ? UDValueMakeInt(acc) : UDValueMakeDouble((double)acc);
+            return YES;
+        }
+    }
+
+    const uint8_t *begin = _p;
+    BOOL isInteger = YES;
+    while (_p < _end && UDIsDigit(*_p)) _p++;
+    if (_p < _end && *_p == '.') {
+        isInteger = NO;
+        _p++;
+        while (_p < _end && UDIsDigit(*_p)) _p++;
+    }
+    // Only an exponent when digits follow. "2e" lexes as 2 then the word e,
+    // and since values never juxtapose, it fails to parse at the e.
+    if (_p < _end && (*_p == 'e' || *_p == 'E')) {
+        const uint8_t *q = _p + 1;
+        if (q < _end && (*q == '+' || *q == '-')) q++;
+        if (q < _end && UDIsDigit(*q)) {
+            isInteger = NO;
+            _p = q;
+            while (_p < _end && UDIsDigit(*_p)) _p++;
+        }
+    }
+
+    if (self.integerMode) {
+        if (!isInteger) return NO;
+        unsigned long long acc = 0;
+        for (const uint8_t *q = begin; q < _p; q++) {
+            if (acc > (ULLONG_MAX - (*q - '0')) / 10) return NO;
+            acc = acc * 10 + (*q - '0');
+        }
+        _tokenValue = UDValueMakeInt(acc);
+        return YES;
+    }
+
+    // Straight from the source text, rounded the same way as keypad input
+    double d;
+    if (!UDDoubleFromDecimalString((const char *)begin, (size_t)(_p - begin), &d)) return NO;
+    _tokenValue = UDValueMakeDouble(d);
+    return YES;
+}
+
+#pragma mark - Parser
+
+// Precedence climbing: parse an operand, then keep folding in operators
+// that bind at least as tightly as minPrecedence.
+- (UDASTNode *)parseExpression:(NSInteger)minPrecedence {
+    if (++_depth > kUDParserMaxDepth) return [self fail];
+
+    UDASTNode *left = [self parseOperand];
+    while (left && _token == UDTokenWord) {
+        const UDParserWord *w = UDParserLookup(_tokenStart, _tokenLength, NO);
+        if (!w) break;
+
+        UDOpInfo *info = [_frontend infoForOp:w->binding != UDOpNone ? w->binding : w->op];
+        if (info.precedence < minPrecedence) break;
+        [self advance];
+
+        if (w->kind == UDWordPostfix) {
+            left = [self apply:w->op child:left];
+            continue;
+        }
+
+        NSInteger next = info.associativity == UDOpAssocRight ? info.precedence : info.precedence + 1;
+        UDASTNode *right = [self parseExpression:next];
+        left = right ? [self apply:w->op left:left right:right] : nil;
+    }
+
+    _depth--;
+    return left;
+}
+
+- (UDASTNode *)parseOperand {
+    switch (_token) {
+        case UDTokenNumber: {
+            UDASTNode *n = [UDNumberNode value:_tokenValue];
+            [self advance];
+            return n;
+        }
+        case UDTokenParenLeft: {
+            // Kept in the tree, as the keypad does for a closed group
+            UDASTNode *inner = [self parseParenthesized];
+            return inner ? [UDParenNode wrap:inner] : nil;
+        }
+
+        case UDTokenWord: {
+            const UDParserWord *w = UDParserLookup(_tokenStart, _tokenLength, YES);
+            if (!w) return [self parseIdentifier];
+
+            UDOpInfo *info = [_frontend infoForOp:w->binding != UDOpNone ? w->binding : w->op];
+            [self advance];
+            switch (w->kind) {
+                case UDWordPrefix: {
+                    UDASTNode *child = [self parseExpression:info.precedence];
+                    if (!child || w->op == UDOpNone) return child;
+                    return [self apply:w->op child:child];
+                }
+                case UDWordFunction: {
+                    // Call parentheses are not a group: sin(30)^2 squares the sine,
+                    // sin 30^2 takes the sine of 900
+                    UDASTNode *arg = _token == UDTokenParenLeft ? [self parseParenthesized]
+                                                                : [self parseExpression:info.precedence];
+                    return arg ? [self apply:w->op child:arg] : nil;
+                }
+                case UDWordConstant:
+                    return w->op == UDOpConstPi
+                        ? [UDConstantNode value:UDValueMakeDouble(M_PI) symbol:@"π"]
+                        : [UDConstantNode value:UDValueMakeDouble(M_E) symbol:@"e"];
+                case UDWordNullary:
+                    return info.action(_context);
+                default:
+                    return [self fail];
+            }
+        }
+        default:
+            return [self fail];
+    }
+}
+
+- (UDASTNode *)parseParenthesized {
+    [self advance];
+    UDASTNode *inner = [self parseExpression:0];
+    if (!inner) return nil;
+    if (_token != UDTokenParenRight) return [self fail];
+    [self advance];
+    return inner;
+}
+
+// An input variable, or a call to any name in UD_FUNCTIONS: pow(2, 10),
+// sinD(30), flip_b(0x1234).
+- (UDASTNode *)parseIdentifier {
+    NSString *name = [[NSString alloc] initWithBytes:_tokenStart length:_tokenLength encoding:NSUTF8StringEncoding];
+    NSUInteger slot = [self.variables indexOfObject:name];
+    if (self.variables && slot != NSNotFound) {
+        [self advance];
+        return [UDVariableNode variable:name slot:slot];
+    }
+
+    UDFunctionID fid = UDFunctionIDForName(name);
+    if (fid == UDFunctionUnknown) return [self fail];
+
+    [self advance];
+    if (_token != UDTokenParenLeft) return [self fail];
+
+    NSUInteger arity = fid == UDFunctionPow ? 2 : 1;
+    NSMutableArray<UDASTNode *> *args = [NSMutableArray arrayWithCapacity:arity];
+    do {
+        [self advance];
+        UDASTNode *arg = [self parseExpression:0];
+        if (!arg) return nil;
+        [args addObject:arg];
+    } while (_token == UDTokenComma && args.count < arity);
+
+    if (args.count != arity || _token != UDTokenParenRight) return [self fail];
+    [self advance];
+    return [UDFunctionNode function:fid args:args];
+}
+
+#pragma mark - Node construction
+
+// Nodes come from the frontend's actions, exactly as for keypad input.
+- (UDASTNode *)apply:(UDOp)op child:(UDASTNode *)child {
+    [_context.nodeStack addObject:child];
+    return [_frontend infoForOp:op].action(_context);
+}
+
+- (UDASTNode *)apply:(UDOp)op left:(UDASTNode *)left right:(UDASTNode *)right {
+    UDOpInfo *info = [_frontend infoForOp:op];
+    if (info.placement != UDOpPlacementInfix) {
+        // rol/ror: the keypad action supplies its own count
+        return [UDBinaryOpNode info:info left:left right:right];
+    }
+    [_context.nodeStack addObject:left];
+    [_context.nodeStack addObject:right];
+    return info.action(_context);
+}
+
+@end
@@ -0,0 +1,91 @@
+//
+//  UDProgram.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "UDInstruction.h"
+#import "UDValueBox.h"
+
+@class UDJITCode;
+
+// One packed instruction record.
+// PUSH stores the index of its payload in the program's constant pool,
+// every other opcode ignores the operand.
+typedef struct {
+    uint8_t  opcode;        // UDOpcode
+    uint8_t  reserved[3];
+    uint32_t operand;
+} UDInsn;
+
+// Outcome of UDVM's stack-depth verifier.
+typedef NS_ENUM(NSInteger, UDProgramStatus) {
+    UDProgramStatusUnverified,
+    UDProgramStatusVerified,    // safe for the unchecked cores
+    UDProgramStatusRejected     // would underflow, overflow or hit a bad opcode
+};
+
+// A compiled program: a contiguous buffer of UDInsn records plus the
+// constant pool they refer to. Emitting an instruction never allocates
+// an Objective-C object; the buffers grow geometrically.
+@interface UDProgram : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) NSUInteger constantCount;
+@property (nonatomic, readonly) const UDInsn *code;
+// Boxed, 8 bytes per entry. A wide integer's box indexes wideConstants,
+// which stays NULL for a program without one.
+@property (nonatomic, readonly) const UDBox *constants;
+@property (nonatomic, readonly) const unsigned long long *wideConstants;
+
+// Unboxes one pool entry, for callers outside the VM.
+- (UDValue)constantAtIndex:(NSUInteger)index;
+
++ (instancetype)program;
++ (instancetype)programWithCapacity:(NSUInteger)capacity;
+
+// Bridge from the object-per-opcode representation.
++ (instancetype)programWithInstructions:(NSArray<UDInstruction *> *)instructions;
+
+- (void)emitPush:(UDValue)value;
+- (void)emitOp:(UDOpcode)opcode;
+// Opcode whose operand refers to a constant pool entry (PUSH, superinstructions).
+- (void)emitOp:(UDOpcode)opcode constant:(UDValue)value;
+- (void)emitLoad:(uint32_t)slot;
+
+// One more than the highest input slot a LOAD reads; 0 for a program
+// that only uses constants.
+@property (nonatomic, readonly) NSUInteger inputCount;
+
+// Set by +[UDVM verifyProgram:]; emitting another instruction resets the
+// program to unverified. Once emitting is done, a program may be verified
+// and executed from several threads at once.
+@property (nonatomic, readonly) UDProgramStatus status;
+@property (nonatomic, readonly) NSUInteger maxStackDepth;
+@property (nonatomic, readonly) UDValueErrorType rejectionError;
+
+- (void)markVerifiedWithMaxStackDepth:(NSUInteger)depth;
+- (void)markRejectedWithError:(UDValueErrorType)error;
+
+// Superinstruction form of this program, built and owned by UDVM's
+// threaded core on first use. Atomic: concurrent first runs may each
+// build one, and either result is fine.
+@property (atomic, strong) UDProgram *threadedForm;
+
+// Native code from UDJIT, built by UDVM once the program is hot or
+// native dispatch is asked for. nativeRejected marks a program the JIT
+// turned down, so it is not translated again.
+@property (atomic, strong) UDJITCode *nativeForm;
+@property (atomic, assign) BOOL nativeRejected;
+
+// Counts executions for UDVM's promotion to native code; returns the new
+// count. Relaxed: a race only moves the promotion by a run or two.
+- (NSUInteger)noteExecution;
+
+// Expands the program back into UDInstruction objects (tests, debugging).
+- (NSArray<UDInstruction *> *)instructions;
+
+- (NSString *)debugDescription;
+@end
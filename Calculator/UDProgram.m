@@ -0,0 +1,167 @@
+//
+//  UDProgram.m
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDProgram.h"
+#import <stdlib.h>
+
+__thread NSUInteger UDBoxWideTableAllocations;
+
+// Enough for the typical keypad expression without a single realloc.
+static const NSUInteger kUDProgramDefaultCapacity = 16;
+
+@implementation UDProgram {
+    UDInsn *_code;
+    NSUInteger _codeCapacity;
+    UDBox *_constants;
+    UDBoxWideTable _wideConstants;
+    NSUInteger _constantCapacity;
+    NSUInteger _executionCount;
+}
+
+@synthesize status = _status;
+
++ (instancetype)program {
+    return [self programWithCapacity:kUDProgramDefaultCapacity];
+}
+
++ (instancetype)programWithCapacity:(NSUInteger)capacity {
+    UDProgram *p = [[self alloc] init];
+    if (capacity == 0) capacity = 1;
+    p->_code = malloc(capacity * sizeof(UDInsn));
+    p->_codeCapacity = capacity;
+    p->_constants = malloc(capacity * sizeof(UDBox));
+    p->_constantCapacity = capacity;
+    return p;
+}
+
++ (instancetype)programWithInstructions:(NSArray<UDInstruction *> *)instructions {
+    UDProgram *p = [self programWithCapacity:instructions.count];
+    for (UDInstruction *inst in instructions) {
+        if (inst.opcode == UDOpcodePush) [p emitPush:inst.payload];
+        else if (inst.opcode == UDOpcodeLoad) [p emitLoad:(uint32_t)UDValueAsInt(inst.payload)];
+        else [p emitOp:inst.opcode];
+    }
+    return p;
+}
+
+- (void)dealloc {
+    free(_code);
+    free(_constants);
+    UDBoxWideTableFree(&_wideConstants);
+}
+
+#pragma mark - Emitting
+
+- (void)emitPush:(UDValue)value {
+    [self emitOp:UDOpcodePush constant:value];
+}
+
+- (void)emitOp:(UDOpcode)opcode constant:(UDValue)value {
+    if (_constantCount == _constantCapacity) {
+        _constantCapacity *= 2;
+        _constants = realloc(_constants, _constantCapacity * sizeof(UDBox));
+    }
+    _constants[_constantCount] = UDBoxFromValue(value, &_wideConstants);
+    [self emit:opcode operand:(uint32_t)_constantCount];
+    _constantCount++;
+}
+
+- (void)emitOp:(UDOpcode)opcode {
+    [self emit:opcode operand:0];
+}
+
+- (void)emitLoad:(uint32_t)slot {
+    if (slot >= _inputCount) _inputCount = (NSUInteger)slot + 1;
+    [self emit:UDOpcodeLoad operand:slot];
+}
+
+- (void)emit:(UDOpcode)opcode operand:(uint32_t)operand {
+    if (_count == _codeCapacity) {
+        _codeCapacity *= 2;
+        _code = realloc(_code, _codeCapacity * sizeof(UDInsn));
+    }
+    _status = UDProgramStatusUnverified;
+    _threadedForm = nil;
+    _nativeForm = nil;
+    _nativeRejected = NO;
+    _executionCount = 0;
+    UDInsn *insn = &_code[_count++];
+    insn->opcode = (uint8_t)opcode;
+    insn->reserved[0] = insn->reserved[1] = insn->reserved[2] = 0;
+    insn->operand = operand;
+}
+
+#pragma mark - Verification
+
+// The status is published last, with release ordering, and read with
+// acquire ordering: a thread that sees Verified also sees the depth the
+// unchecked cores size their stack with.
+- (void)markVerifiedWithMaxStackDepth:(NSUInteger)depth {
+    _maxStackDepth = depth;
+    __atomic_store_n(&_status, UDProgramStatusVerified, __ATOMIC_RELEASE);
+}
+
+- (void)markRejectedWithError:(UDValueErrorType)error {
+    _rejectionError = error;
+    __atomic_store_n(&_status, UDProgramStatusRejected, __ATOMIC_RELEASE);
+}
+
+- (UDProgramStatus)status {
+    return __atomic_load_n(&_status, __ATOMIC_ACQUIRE);
+}
+
+- (NSUInteger)noteExecution {
+    return __atomic_add_fetch(&_executionCount, 1, __ATOMIC_RELAXED);
+}
+
+#pragma mark - Accessors
+
+- (const UDInsn *)code {
+    return _code;
+}
+
+- (const UDBox *)constants {
+    return _constants;
+}
+
+- (const unsigned long long *)wideConstants {
+    return _wideConstants.values;
+}
+
+- (UDValue)constantAtIndex:(NSUInteger)index {
+    return UDBoxToValue(_constants[index], _wideConstants.values);
+}
+
+- (NSArray<UDInstruction *> *)instructions {
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity:_count];
+    for (NSUInteger i = 0; i < _count; i++) {
+        if (_code[i].opcode == UDOpcodePush) {
+            [result addObject:[UDInstruction push:[self constantAtIndex:_code[i].operand]]];
+        } else if (_code[i].opcode == UDOpcodeLoad) {
+            [result addObject:[UDInstruction load:_code[i].operand]];
+        } else {
+            [result addObject:[UDInstruction op:_code[i].opcode]];
+        }
+    }
+    return result;
+}
+
+- (NSString *)debugDescription {
+    NSMutableString *s = [NSMutableString string];
+    for (UDInstruction *inst in [self instructions]) {
+        if (inst.opcode == UDOpcodePush) {
+            UDValue v = inst.payload;
+            if (v.type == UDValueTypeDouble) [s appendFormat:@"PUSH %.17g\n", v.v.doubleValue];
+            else [s appendFormat:@"PUSH %llu\n", v.v.intValue];
+        } else {
+            [s appendFormat:@"%@\n", [inst debugDescription]];
+        }
+    }
+    return s;
+}
+
+@end
@@ -0,0 +1,41 @@
+//
+//  UDProgramCache.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "UDAST.h"
+#import "UDProgram.h"
+#import "UDASTArena.h"
+
+// Bounded LRU cache from an AST to its compiled program and result.
+// A tree is found by identity first, and an equal tree built separately
+// through its structural hash, confirmed with -isIdenticalTo:. Trees are
+// immutable, so a cached result stays valid until the owner calls
+// removeAllEntries, e.g. on a mode change.
+@interface UDProgramCache : NSObject
+
+@property (nonatomic, readonly) NSUInteger capacity;
+@property (nonatomic, readonly) NSUInteger count;
+
+// Lookup statistics, for tests and benchmarks.
+@property (nonatomic, readonly) NSUInteger hits;
+@property (nonatomic, readonly) NSUInteger misses;
+
+// Storage that misses are compiled through. Owned by the caller, which
+// empties it between expressions; nil uses a temporary arena per miss.
+@property (nonatomic, strong) UDASTArena *arena;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+// Returns the cached result, or compiles (optimized), executes and caches.
+- (UDValue)evaluateNode:(UDASTNode *)node integerMode:(BOOL)integerMode;
+
+// The compiled program behind evaluateNode:, or nil if not cached.
+- (UDProgram *)cachedProgramForNode:(UDASTNode *)node integerMode:(BOOL)integerMode;
+
+- (void)removeAllEntries;
+
+@end
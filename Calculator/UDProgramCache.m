@@ -0,0 +1,149 @@
+//
+//  UDProgramCache.m
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDProgramCache.h"
+#import "UDCompiler.h"
+#import "UDVM.h"
+
+// An RPN session can go a long time without a reset; start the arena
+// over rather than let imports accumulate forever.
+static const NSUInteger kUDProgramCacheArenaLimit = 4096;
+
+// --- ENTRIES ---
+// Entries form a doubly linked list in recency order, head first, so a
+// hit is moved to the front and the tail is evicted, both in O(1).
+
+@interface UDProgramCacheEntry : NSObject
+@property (nonatomic, strong) UDASTNode *node;
+@property (nonatomic, assign) BOOL integerMode;
+@property (nonatomic, strong) NSNumber *structureKey;
+@property (nonatomic, strong) UDProgram *program;
+@property (nonatomic, assign) UDValue result;
+@property (nonatomic, strong) UDProgramCacheEntry *next;
+@property (nonatomic, unsafe_unretained) UDProgramCacheEntry *prev;
+@end
+
+@implementation UDProgramCacheEntry
+@end
+
+@implementation UDProgramCache {
+    NSMapTable<UDASTNode *, UDProgramCacheEntry *> *_byIdentity;
+    NSMutableDictionary<NSNumber *, UDProgramCacheEntry *> *_byStructure;
+    UDProgramCacheEntry *_head;
+    __unsafe_unretained UDProgramCacheEntry *_tail;
+}
+
+- (instancetype)init {
+    return [self initWithCapacity:64];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        _capacity = capacity > 0 ? capacity : 1;
+        _byIdentity = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality
+                                                valueOptions:NSPointerFunctionsStrongMemory
+                                                    capacity:_capacity];
+        _byStructure = [NSMutableDictionary dictionaryWithCapacity:_capacity];
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return _byIdentity.count;
+}
+
+#pragma mark - Lookup
+
+- (UDProgramCacheEntry *)entryForNode:(UDASTNode *)node integerMode:(BOOL)integerMode structureKey:(NSNumber **)keyOut {
+    UDProgramCacheEntry *entry = [_byIdentity objectForKey:node];
+    if (entry && entry.integerMode == integerMode) return entry;
+
+    NSNumber *key = @(node.structuralHash ^ (NSUInteger)integerMode);
+    if (keyOut) *keyOut = key;
+    entry = _byStructure[key];
+    if (entry && entry.integerMode == integerMode && [entry.node isIdenticalTo:node]) return entry;
+    return nil;
+}
+
+- (UDValue)evaluateNode:(UDASTNode *)node integerMode:(BOOL)integerMode {
+    NSNumber *key = nil;
+    UDProgramCacheEntry *entry = [self entryForNode:node integerMode:integerMode structureKey:&key];
+    if (entry) {
+        _hits++;
+        [self moveToFront:entry];
+        return entry.result;
+    }
+
+    _misses++;
+    if (_arena.count > kUDProgramCacheArenaLimit) [_arena removeAllNodes];
+    UDProgram *program = _arena
+        ? [UDCompiler compileProgram:node inArena:_arena withIntegerMode:integerMode optimize:YES]
+        : [UDCompiler compileProgram:node withIntegerMode:integerMode optimize:YES];
+    UDValue result = [UDVM executeProgram:program];
+
+    // Same node cached under the other integer mode: replace it.
+    UDProgramCacheEntry *stale = [_byIdentity objectForKey:node];
+    if (stale) [self removeEntry:stale];
+    if (self.count >= _capacity) [self removeEntry:_tail];
+
+    entry = [UDProgramCacheEntry new];
+    entry.node = node;
+    entry.integerMode = integerMode;
+    entry.structureKey = key;
+    entry.program = program;
+    entry.result = result;
+    [_byIdentity setObject:entry forKey:node];
+    _byStructure[key] = entry;
+    [self moveToFront:entry];
+    return result;
+}
+
+- (UDProgram *)cachedProgramForNode:(UDASTNode *)node integerMode:(BOOL)integerMode {
+    return [self entryForNode:node integerMode:integerMode structureKey:NULL].program;
+}
+
+#pragma mark - Maintenance
+
+- (void)removeAllEntries {
+    [_byIdentity removeAllObjects];
+    [_byStructure removeAllObjects];
+    // Break the chain iteratively; releasing a long list from the head
+    // would otherwise recurse once per entry.
+    while (_head) {
+        UDProgramCacheEntry *next = _head.next;
+        _head.next = nil;
+        _head = next;
+    }
+    _tail = nil;
+}
+
+- (void)removeEntry:(UDProgramCacheEntry *)entry {
+    UDProgramCacheEntry *victim = entry; // the maps may hold the last reference
+    [self unlink:victim];
+    [_byIdentity removeObjectForKey:victim.node];
+    if (_byStructure[victim.structureKey] == victim) [_byStructure removeObjectForKey:victim.structureKey];
+}
+
+- (void)unlink:(UDProgramCacheEntry *)entry {
+    UDProgramCacheEntry *prev = entry.prev, *next = entry.next;
+    if (prev) prev.next = next; else if (_head == entry) _head = next;
+    if (next) next.prev = prev; else if (_tail == entry) _tail = prev;
+    entry.prev = nil;
+    entry.next = nil;
+}
+
+- (void)moveToFront:(UDProgramCacheEntry *)entry {
+    if (_head == entry) return;
+    [self unlink:entry];
+    entry.next = _head;
+    if (_head) _head.prev = entry;
+    _head = entry;
+    if (!_tail) _tail = entry;
+}
+
+@end
@@ -0,0 +1,46 @@
+//
+//  UDRegisterFile.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "UDAST.h"
+
+// The calculator's stack of trees, stored as a growable ring buffer.
+//
+// It is a real NSMutableArray, so the frontend's node actions and every
+// existing reader work on it unchanged, but the RPN register operations
+// are index arithmetic: swap, roll either way, duplicate and drop are O(1)
+// and allocate nothing.
+//
+// A slot holds either a tree or a bare value. pushValue: stores a typed
+// number without a node; the UDNumberNode is made the first time the slot
+// is read as an object (to build an operator over it, or for the tape)
+// and kept from then on.
+@interface UDRegisterFile : NSMutableArray<UDASTNode *>
+
+// Changes with every mutation, and no two register files share one, so a
+// reader can tell with one comparison whether the stack has changed since
+// it last looked: a swap or roll below the top included.
+@property (nonatomic, readonly) uint64_t version;
+
+- (void)pushValue:(UDValue)value;
+
+// The slot's value when it is a bare or literal number, without making a
+// node. NO for a tree, whose value comes from evaluating it.
+- (BOOL)getLiteral:(UDValue *)value atIndex:(NSUInteger)index;
+
+// Names the entry in a slot without making a node. It moves with the
+// entry through swaps, rolls and shifts, a duplicate shares it, and
+// anything stored anew gets one no register file has used before.
+- (uint64_t)identityAtIndex:(NSUInteger)index;
+
+// RPN register operations; each is a no-op when the stack is too short.
+- (void)duplicateTop;               // Enter with nothing typed
+- (void)swapTop;                    // x <-> y
+- (void)rollDown;                   // top becomes the bottom
+- (void)rollUp;                     // bottom becomes the top
+
+@end
@@ -0,0 +1,295 @@
+//
+//  UDRegisterFile.m
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDRegisterFile.h"
+#import <stdlib.h>
+
+// The four-level stack of a classic RPN calculator, doubled; deeper stacks
+// grow by doubling.
+static const NSUInteger kUDRegisterFileDefaultCapacity = 8;
+
+// Versions and identities come from one counter shared by every register
+// file. Batch workers each own a calculator, so it is bumped atomically.
+static uint64_t sUDRegisterFileStamp;
+
+static inline uint64_t UDNextStamp(void) {
+    return __atomic_add_fetch(&sUDRegisterFileStamp, 1, __ATOMIC_RELAXED);
+}
+
+@implementation UDRegisterFile {
+    // Parallel rings; capacity is a power of two so a slot is (head + i) & mask.
+    // A nil tree means the slot is the bare value beside it.
+    UDValue *_values;
+    __strong UDASTNode **_trees;
+    uint64_t *_ids;
+    NSUInteger _capacity;
+    NSUInteger _head;           // physical slot of index 0, the bottom
+    NSUInteger _count;
+}
+
+- (instancetype)init {
+    return [self initWithCapacity:kUDRegisterFileDefaultCapacity];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)numItems {
+    self = [super init];
+    if (self) {
+        _capacity = kUDRegisterFileDefaultCapacity;
+        while (_capacity < numItems) _capacity *= 2;
+        _values = malloc(_capacity * sizeof(UDValue));
+        _trees = (__strong UDASTNode **)calloc(_capacity, sizeof(UDASTNode *));
+        _ids = malloc(_capacity * sizeof(uint64_t));
+        _version = UDNextStamp();
+    }
+    return self;
+}
+
+- (instancetype)initWithObjects:(const id [])objects count:(NSUInteger)cnt {
+    self = [self initWithCapacity:cnt];
+    if (self) {
+        for (NSUInteger i = 0; i < cnt; i++) [self addObject:objects[i]];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < _capacity; i++) _trees[i] = nil;
+    free(_trees);
+    free(_values);
+    free(_ids);
+}
+
+#pragma mark - Slots
+
+static inline NSUInteger UDSlot(UDRegisterFile *file, NSUInteger index) {
+    return (file->_head + index) & (file->_capacity - 1);
+}
+
+- (void)grow {
+    NSUInteger capacity = _capacity * 2;
+    UDValue *values = malloc(capacity * sizeof(UDValue));
+    __strong UDASTNode **trees = (__strong UDASTNode **)calloc(capacity, sizeof(UDASTNode *));
+    uint64_t *ids = malloc(capacity * sizeof(uint64_t));
+
+    // Unwrap so the bottom is slot 0 again
+    for (NSUInteger i = 0; i < _count; i++) {
+        NSUInteger p = UDSlot(self, i);
+        values[i] = _values[p];
+        trees[i] = _trees[p];
+        ids[i] = _ids[p];
+        _trees[p] = nil;
+    }
+    free(_values);
+    free(_trees);
+    free(_ids);
+    _values = values;
+    _trees = trees;
+    _ids = ids;
+    _capacity = capacity;
+    _head = 0;
+}
+
+- (void)checkIndex:(NSUInteger)index limit:(NSUInteger)limit {
+    if (index >= limit) {
+        [NSException raise:NSRangeException format:@"index %lu beyond bounds [0 .. %ld]",
+                           (unsigned long)index, (long)limit - 1];
+    }
+}
+
+#pragma mark - NSArray primitives
+
+- (NSUInteger)count {
+    return _count;
+}
+
+- (UDASTNode *)objectAtIndex:(NSUInteger)index {
+    [self checkIndex:index limit:_count];
+    NSUInteger p = UDSlot(self, index);
+    if (!_trees[p]) _trees[p] = [UDNumberNode value:_values[p]];
+    return _trees[p];
+}
+
+#pragma mark - NSMutableArray primitives
+
+- (void)addObject:(UDASTNode *)anObject {
+    if (!anObject) [NSException raise:NSInvalidArgumentException format:@"nil object"];
+    if (_count == _capacity) [self grow];
+    NSUInteger p = UDSlot(self, _count);
+    _trees[p] = anObject;
+    _ids[p] = UDNextStamp();
+    _count++;
+    _version = UDNextStamp();
+}
+
+- (void)insertObject:(UDASTNode *)anObject atIndex:(NSUInteger)index {
+    if (!anObject) [NSException raise:NSInvalidArgumentException format:@"nil object"];
+    [self checkIndex:index limit:_count + 1];
+    if (_count == _capacity) [self grow];
+
+    if (index < _count - index) {
+        // Nearer the bottom: open the gap by moving the head down
+        _head = (_head - 1) & (_capacity - 1);
+        for (NSUInteger i = 0; i < index; i++) {
+            NSUInteger to = UDSlot(self, i), from = UDSlot(self, i + 1);
+            _values[to] = _values[from];
+            _trees[to] = _trees[from];
+            _ids[to] = _ids[from];
+        }
+    } else {
+        for (NSUInteger i = _count; i > index; i--) {
+            NSUInteger to = UDSlot(self, i), from = UDSlot(self, i - 1);
+            _values[to] = _values[from];
+            _trees[to] = _trees[from];
+            _ids[to] = _ids[from];
+        }
+    }
+    NSUInteger p = UDSlot(self, index);
+    _trees[p] = anObject;
+    _ids[p] = UDNextStamp();
+    _count++;
+    _version = UDNextStamp();
+}
+
+- (void)removeLastObject {
+    if (_count == 0) [NSException raise:NSRangeException format:@"removeLastObject on an empty register file"];
+    _count--;
+    _trees[UDSlot(self, _count)] = nil;
+    _version = UDNextStamp();
+}
+
+- (void)removeObjectAtIndex:(NSUInteger)index {
+    [self checkIndex:index limit:_count];
+    if (index < _count - 1 - index) {
+        for (NSUInteger i = index; i > 0; i--) {
+            NSUInteger to = UDSlot(self, i), from = UDSlot(self, i - 1);
+            _values[to] = _values[from];
+            _trees[to] = _trees[from];
+            _ids[to] = _ids[from];
+        }
+        _trees[_head] = nil;
+        _head = (_head + 1) & (_capacity - 1);
+    } else {
+        for (NSUInteger i = index; i + 1 < _count; i++) {
+            NSUInteger to = UDSlot(self, i), from = UDSlot(self, i + 1);
+            _values[to] = _values[from];
+            _trees[to] = _trees[from];
+            _ids[to] = _ids[from];
+        }
+        _trees[UDSlot(self, _count - 1)] = nil;
+    }
+    _count--;
+    _version = UDNextStamp();
+}
+
+- (void)replaceObjectAtIndex:(NSUInteger)index withObject:(UDASTNode *)anObject {
+    if (!anObject) [NSException raise:NSInvalidArgumentException format:@"nil object"];
+    [self checkIndex:index limit:_count];
+    NSUInteger p = UDSlot(self, index);
+    _trees[p] = anObject;
+    _ids[p] = UDNextStamp();
+    _version = UDNextStamp();
+}
+
+- (void)removeAllObjects {
+    for (NSUInteger i = 0; i < _count; i++) _trees[UDSlot(self, i)] = nil;
+    _count = 0;
+    _head = 0;
+    _version = UDNextStamp();
+}
+
+#pragma mark - Values
+
+- (void)pushValue:(UDValue)value {
+    if (_count == _capacity) [self grow];
+    NSUInteger p = UDSlot(self, _count);
+    _values[p] = value;
+    _trees[p] = nil;
+    _ids[p] = UDNextStamp();
+    _count++;
+    _version = UDNextStamp();
+}
+
+- (BOOL)getLiteral:(UDValue *)value atIndex:(NSUInteger)index {
+    [self checkIndex:index limit:_count];
+    NSUInteger p = UDSlot(self, index);
+    UDValue v;
+    if (!_trees[p]) v = _values[p];
+    else if ([_trees[p] isKindOfClass:[UDNumberNode class]]) v = ((UDNumberNode *)_trees[p]).value;
+    else return NO;
+
+    // An error literal is left to the evaluator, like a tree
+    if (v.type == UDValueTypeErr) return NO;
+    *value = v;
+    return YES;
+}
+
+- (uint64_t)identityAtIndex:(NSUInteger)index {
+    [self checkIndex:index limit:_count];
+    return _ids[UDSlot(self, index)];
+}
+
+#pragma mark - Register operations
+
+- (void)duplicateTop {
+    if (_count == 0) return;
+    if (_count == _capacity) [self grow];
+    NSUInteger from = UDSlot(self, _count - 1), to = UDSlot(self, _count);
+    // Trees are immutable, so the copy shares the original's
+    _values[to] = _values[from];
+    _trees[to] = _trees[from];
+    _ids[to] = _ids[from];
+    _count++;
+    _version = UDNextStamp();
+}
+
+- (void)swapTop {
+    if (_count < 2) return;
+    NSUInteger x = UDSlot(self, _count - 1), y = UDSlot(self, _count - 2);
+    UDValue value = _values[x];
+    _values[x] = _values[y];
+    _values[y] = value;
+    UDASTNode *tree = _trees[x];
+    _trees[x] = _trees[y];
+    _trees[y] = tree;
+    uint64_t identity = _ids[x];
+    _ids[x] = _ids[y];
+    _ids[y] = identity;
+    _version = UDNextStamp();
+}
+
+- (void)rollDown {
+    if (_count < 2) return;
+    _version = UDNextStamp();
+    if (_count == _capacity) {
+        // Full ring: the slot below the head is the top, so rotating is free
+        _head = (_head - 1) & (_capacity - 1);
+        return;
+    }
+    NSUInteger top = UDSlot(self, _count - 1);
+    _head = (_head - 1) & (_capacity - 1);
+    _values[_head] = _values[top];
+    _trees[_head] = _trees[top];
+    _ids[_head] = _ids[top];
+    _trees[top] = nil;
+}
+
+- (void)rollUp {
+    if (_count < 2) return;
+    _version = UDNextStamp();
+    if (_count == _capacity) {
+        _head = (_head + 1) & (_capacity - 1);
+        return;
+    }
+    NSUInteger bottom = _head, to = UDSlot(self, _count);
+    _values[to] = _values[bottom];
+    _trees[to] = _trees[bottom];
+    _ids[to] = _ids[bottom];
+    _trees[bottom] = nil;
+    _head = (_head + 1) & (_capacity - 1);
+}
+
+@end
@@ -8,14 +8,27 @@
 #import "UDCalc.h"
 
 // UDSettingsManager.h
+//
+// Settings live in memory. Setters only mark them dirty; at the end of the
+// run loop turn, one snapshot of all of them is written to a small file on
+// a background queue, however many changed. Startup reads that one file.
+// NSUserDefaults is read only when there is no snapshot yet, to carry the
+// settings of an older version over.
 @interface UDSettingsManager : NSObject
 
 + (instancetype)sharedManager;
 
+// For tests: a manager on its own snapshot file, reading defaults from
+// `defaults` when the file is missing.
+- (instancetype)initWithSnapshotPath:(NSString *)path defaults:(NSUserDefaults *)defaults;
+
+@property (nonatomic, readonly) NSString *snapshotPath;
+
 - (void)registerDefaults;
+// Writes any pending change now and waits for it
 - (void)forceSync;
 
-// Properties that automatically sync to NSUserDefaults
+// Properties that automatically sync to the snapshot
 @property (nonatomic, assign) UDCalcMode calcMode;
 @property (nonatomic, assign) BOOL isRPN;
 @property (nonatomic, assign) UDCalcEncodingMode encodingMode;
@@ -26,4 +39,10 @@
 @property (nonatomic, assign) BOOL showThousandsSeparators;
 @property (nonatomic, assign) NSInteger decimalPlaces;
 
+// Calculator state, restored with the settings
+@property (nonatomic, assign) double memoryRegister;
+
+// Snapshot writes since launch; coalesced changes count once.
+@property (nonatomic, readonly) NSUInteger writeCount;
+
 @end
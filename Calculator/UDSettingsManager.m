@@ -18,7 +18,53 @@ static NSString * const kUDKeyShowBinaryView            = @"UDShowBinaryView";
 static NSString * const kUDKeyShowThousandsSeparators   = @"UDShowThousandsSeparators";
 static NSString * const kUDKeyDecimalPlaces             = @"UDDecimalPlaces";
 
-@implementation UDSettingsManager
+// The snapshot file is this struct, as is. Fixed-width fields, so the
+// layout is the same on every build; a new field means a new version.
+#define UD_SETTINGS_MAGIC   0x31534455u    // "UDS1"
+#define UD_SETTINGS_VERSION 1u
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t calcMode;
+    int32_t encodingMode;
+    int32_t inputBase;
+    int32_t decimalPlaces;
+    uint8_t isRPN;
+    uint8_t isRadians;
+    uint8_t showTapeWindow;
+    uint8_t showBinaryView;
+    uint8_t showThousandsSeparators;
+    uint8_t reserved[3];
+    double memoryRegister;
+} UDSettings;
+
+static const UDSettings kUDDefaultSettings = {
+    .magic = UD_SETTINGS_MAGIC,
+    .version = UD_SETTINGS_VERSION,
+    .calcMode = UDCalcModeBasic,
+    .encodingMode = UDCalcEncodingModeNone, // Default to None
+    .inputBase = UDBaseDec,
+    .decimalPlaces = 15,
+    .isRPN = NO,
+    .isRadians = NO,                        // Default to Degrees
+    .showTapeWindow = NO,
+    .showBinaryView = YES,
+    .showThousandsSeparators = NO,
+    .memoryRegister = 0.0
+};
+
+@interface UDSettingsManager ()
+@property (nonatomic, strong) NSUserDefaults *defaults;
+// Serial, so snapshots land in order
+@property (nonatomic, strong) NSOperationQueue *writeQueue;
+@property (nonatomic, assign) BOOL flushScheduled;
+@property (nonatomic, assign) NSUInteger writeCount;
+@end
+
+@implementation UDSettingsManager {
+    UDSettings _settings;
+}
 
 #pragma mark - Singleton
 
@@ -26,129 +72,135 @@ static NSString * const kUDKeyDecimalPlaces             = @"UDDecimalPlaces";
     static UDSettingsManager *sharedInstance = nil;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
-        sharedInstance = [[self alloc] init];
+        sharedInstance = [[self alloc] initWithSnapshotPath:[self defaultSnapshotPath]
+                                                   defaults:[NSUserDefaults standardUserDefaults]];
     });
     return sharedInstance;
 }
 
-#pragma mark - Setup
-
-- (void)registerDefaults {
-    [[NSUserDefaults standardUserDefaults] registerDefaults:@{
-        kUDKeyCalcMode: @(UDCalcModeBasic),
-        kUDKeyRPNMode: @(NO),
-        kUDKeyEncodingMode: @(UDCalcEncodingModeNone), // Default to None
-        kUDKeyIsRadians: @(NO),     // Default to Degrees
-        kUDKeyInputBase: @(UDBaseDec),
-        kUDKeyShowTapeWindow: @(NO),
-        kUDKeyShowBinaryView: @(YES),
-        kUDKeyShowThousandsSeparators: @(NO),
-        kUDKeyDecimalPlaces: @(15)
-    }];
-}
-
-- (void)forceSync {
-    // Force Sync (Optional, modern macOS does this automatically, but safe to add)
-    [[NSUserDefaults standardUserDefaults] synchronize];
-}
-
-#pragma mark - Properties
-// We implement custom Getters and Setters to talk directly to NSUserDefaults.
-
-// --- Calc Mode ---
-- (UDCalcMode)calcMode {
-    NSInteger val = [[NSUserDefaults standardUserDefaults] integerForKey:kUDKeyCalcMode];
-    return (UDCalcMode)val;
-}
-
-- (void)setCalcMode:(UDCalcMode)calcMode {
-    [[NSUserDefaults standardUserDefaults] setInteger:calcMode forKey:kUDKeyCalcMode];
-}
-
-// --- RPN Mode ---
-- (BOOL)isRPN {
-    return [[NSUserDefaults standardUserDefaults] boolForKey:kUDKeyRPNMode];
-}
-
-- (void)setIsRPN:(BOOL)isRPN {
-    [[NSUserDefaults standardUserDefaults] setBool:isRPN forKey:kUDKeyRPNMode];
-}
-
-// --- Encoding Mode ---
-- (UDCalcEncodingMode)encodingMode {
-    // If the key doesn't exist, integerForKey returns 0.
-    // But we want our default to be -1 (None).
-    // Luckily, registerDefaults handles this.
-    // If for some reason defaults were wiped, we check explicitly:
-    if ([[NSUserDefaults standardUserDefaults] objectForKey:kUDKeyEncodingMode] == nil) {
-        return UDCalcEncodingModeNone;
-    }
-    return [[NSUserDefaults standardUserDefaults] integerForKey:kUDKeyEncodingMode];
-}
-
-- (void)setEncodingMode:(UDCalcEncodingMode)encodingMode {
-    [[NSUserDefaults standardUserDefaults] setInteger:encodingMode forKey:kUDKeyEncodingMode];
-}
-
-// --- Radians ---
-- (BOOL)isRadians {
-    return [[NSUserDefaults standardUserDefaults] boolForKey:kUDKeyIsRadians];
-}
-
-- (void)setIsRadians:(BOOL)isRadians {
-    [[NSUserDefaults standardUserDefaults] setBool:isRadians forKey:kUDKeyIsRadians];
-}
-
-// --- Input Base ---
-- (UDBase)inputBase {
-    NSInteger val = [[NSUserDefaults standardUserDefaults] integerForKey:kUDKeyInputBase];
-    if (!val) {
-        val = UDBaseDec;
++ (NSString *)defaultSnapshotPath {
+    NSString *support = NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES).firstObject
+                        ?: NSTemporaryDirectory();
+    NSString *app = [NSBundle mainBundle].bundleIdentifier ?: @"Calculator";
+    return [[support stringByAppendingPathComponent:app] stringByAppendingPathComponent:@"Settings.snapshot"];
+}
+
+- (instancetype)initWithSnapshotPath:(NSString *)path defaults:(NSUserDefaults *)defaults {
+    self = [super init];
+    if (self) {
+        _snapshotPath = [path copy];
+        _defaults = defaults;
+        _writeQueue = [[NSOperationQueue alloc] init];
+        _writeQueue.maxConcurrentOperationCount = 1;
+        if (![self loadSnapshot]) {
+            [self loadFromDefaults];
+            // Written once, so the next launch reads the snapshot instead
+            [self settingsDidChange];
+        }
     }
-    return (UDBase)val;
-}
-
-- (void)setInputBase:(UDBase)inputBase {
-    [[NSUserDefaults standardUserDefaults] setInteger:inputBase forKey:kUDKeyInputBase];
-}
-
-// --- Show Tape Window ---
-- (BOOL)showTapeWindow {
-    return [[NSUserDefaults standardUserDefaults] boolForKey:kUDKeyShowTapeWindow];
+    return self;
 }
 
-- (void)setShowTapeWindow:(BOOL)showTapeWindow {
-    [[NSUserDefaults standardUserDefaults] setBool:showTapeWindow forKey:kUDKeyShowTapeWindow];
-}
-
-// --- Show Binary View ---
-- (BOOL)showBinaryView {
-    return [[NSUserDefaults standardUserDefaults] boolForKey:kUDKeyShowBinaryView];
-}
+#pragma mark - Setup
 
-- (void)setShowBinaryView:(BOOL)showBinaryView {
-    [[NSUserDefaults standardUserDefaults] setBool:showBinaryView forKey:kUDKeyShowBinaryView];
+- (void)registerDefaults {
+    [self.defaults registerDefaults:@{
+        kUDKeyCalcMode: @(kUDDefaultSettings.calcMode),
+        kUDKeyRPNMode: @(kUDDefaultSettings.isRPN),
+        kUDKeyEncodingMode: @(kUDDefaultSettings.encodingMode),
+        kUDKeyIsRadians: @(kUDDefaultSettings.isRadians),
+        kUDKeyInputBase: @(kUDDefaultSettings.inputBase),
+        kUDKeyShowTapeWindow: @(kUDDefaultSettings.showTapeWindow),
+        kUDKeyShowBinaryView: @(kUDDefaultSettings.showBinaryView),
+        kUDKeyShowThousandsSeparators: @(kUDDefaultSettings.showThousandsSeparators),
+        kUDKeyDecimalPlaces: @(kUDDefaultSettings.decimalPlaces)
+    }];
 }
 
-// --- Show Thousands Separators ---
-- (BOOL)showThousandsSeparators {
-    return [[NSUserDefaults standardUserDefaults] boolForKey:kUDKeyShowThousandsSeparators];
+// One read; anything short, foreign or from another version is ignored
+- (BOOL)loadSnapshot {
+    NSData *data = [NSData dataWithContentsOfFile:self.snapshotPath];
+    if (data.length != sizeof(UDSettings)) return NO;
+
+    UDSettings s;
+    [data getBytes:&s length:sizeof(s)];
+    if (s.magic != UD_SETTINGS_MAGIC || s.version != UD_SETTINGS_VERSION) return NO;
+    _settings = s;
+    return YES;
+}
+
+// First launch of this version: carry the old settings over. Keys that
+// were never written keep their defaults.
+- (void)loadFromDefaults {
+    _settings = kUDDefaultSettings;
+    NSUserDefaults *d = self.defaults;
+    if ([d objectForKey:kUDKeyCalcMode]) _settings.calcMode = (int32_t)[d integerForKey:kUDKeyCalcMode];
+    if ([d objectForKey:kUDKeyRPNMode]) _settings.isRPN = [d boolForKey:kUDKeyRPNMode];
+    if ([d objectForKey:kUDKeyEncodingMode]) _settings.encodingMode = (int32_t)[d integerForKey:kUDKeyEncodingMode];
+    if ([d objectForKey:kUDKeyIsRadians]) _settings.isRadians = [d boolForKey:kUDKeyIsRadians];
+    if ([d integerForKey:kUDKeyInputBase]) _settings.inputBase = (int32_t)[d integerForKey:kUDKeyInputBase];
+    if ([d objectForKey:kUDKeyShowTapeWindow]) _settings.showTapeWindow = [d boolForKey:kUDKeyShowTapeWindow];
+    if ([d objectForKey:kUDKeyShowBinaryView]) _settings.showBinaryView = [d boolForKey:kUDKeyShowBinaryView];
+    if ([d objectForKey:kUDKeyShowThousandsSeparators]) _settings.showThousandsSeparators = [d boolForKey:kUDKeyShowThousandsSeparators];
+    if ([d objectForKey:kUDKeyDecimalPlaces]) _settings.decimalPlaces = (int32_t)[d integerForKey:kUDKeyDecimalPlaces];
+}
+
+#pragma mark - Persistence
+
+- (void)settingsDidChange {
+    if (self.flushScheduled) return;
+    self.flushScheduled = YES;
+    // Next run loop turn: a mode switch that sets five properties writes once
+    [self performSelector:@selector(flushAsync) withObject:nil afterDelay:0];
+}
+
+- (void)flushAsync {
+    if (!self.flushScheduled) return;
+    self.flushScheduled = NO;
+    self.writeCount++;
+
+    // Copied here, written there: the main thread never waits on the disk
+    NSData *snapshot = [NSData dataWithBytes:&_settings length:sizeof(_settings)];
+    NSString *path = self.snapshotPath;
+    [self.writeQueue addOperationWithBlock:^{
+        [[NSFileManager defaultManager] createDirectoryAtPath:[path stringByDeletingLastPathComponent]
+                                  withIntermediateDirectories:YES
+                                                   attributes:nil
+                                                        error:NULL];
+        [snapshot writeToFile:path atomically:YES];
+    }];
 }
 
-- (void)setShowThousandsSeparators:(BOOL)showThousandsSeparators {
-    [[NSUserDefaults standardUserDefaults] setBool:showThousandsSeparators forKey:kUDKeyShowThousandsSeparators];
+- (void)forceSync {
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(flushAsync) object:nil];
+    [self flushAsync];
+    [self.writeQueue waitUntilAllOperationsAreFinished];
 }
 
-// --- Decimal Places ---
-- (NSInteger)decimalPlaces {
-    if ([[NSUserDefaults standardUserDefaults] objectForKey:kUDKeyDecimalPlaces] == nil) {
-        return 15;
+#pragma mark - Properties
+// Plain reads of the struct; setters mark it for the next flush.
+
+#define UD_SETTING(getter, setter, type, field)     \
+    - (type)getter {                                \
+        return (type)_settings.field;               \
+    }                                               \
+    - (void)setter:(type)value {                    \
+        if ((type)_settings.field == value) return; \
+        _settings.field = value;                    \
+        [self settingsDidChange];                   \
     }
-    return [[NSUserDefaults standardUserDefaults] integerForKey:kUDKeyDecimalPlaces];
-}
 
-- (void)setDecimalPlaces:(NSInteger)places {
-    [[NSUserDefaults standardUserDefaults] setInteger:places forKey:kUDKeyDecimalPlaces];
-}
+UD_SETTING(calcMode, setCalcMode, UDCalcMode, calcMode)
+UD_SETTING(isRPN, setIsRPN, BOOL, isRPN)
+UD_SETTING(encodingMode, setEncodingMode, UDCalcEncodingMode, encodingMode)
+UD_SETTING(isRadians, setIsRadians, BOOL, isRadians)
+UD_SETTING(inputBase, setInputBase, UDBase, inputBase)
+UD_SETTING(showTapeWindow, setShowTapeWindow, BOOL, showTapeWindow)
+UD_SETTING(showBinaryView, setShowBinaryView, BOOL, showBinaryView)
+UD_SETTING(showThousandsSeparators, setShowThousandsSeparators, BOOL, showThousandsSeparators)
+UD_SETTING(decimalPlaces, setDecimalPlaces, NSInteger, decimalPlaces)
+UD_SETTING(memoryRegister, setMemoryRegister, double, memoryRegister)
+
+#undef UD_SETTING
 
 @end
@@ -0,0 +1,44 @@
+//
+//  UDStackModel.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+#import "UDRegisterFile.h"
+
+// Display rows for a register file, bottom first: each row's value and,
+// once asked for, its formatted string. Only those are kept; the trees
+// stay with the register file.
+//
+// syncWithRegisters: compares the stack with the rows it saw last, by
+// register identity, so no register is read as a node. Only the span
+// between the unchanged bottom and the unchanged top is touched, and an
+// entry that merely moved (swap, roll) keeps its value and string; only
+// entries new to the span are evaluated. Buffers are reused from sync to
+// sync. Rows whose contents changed accumulate until takeChangedRows, so a
+// view reloads just those.
+@interface UDStackModel : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+
+// evaluate gives the value of the register at index
+- (void)syncWithRegisters:(UDRegisterFile *)registers evaluator:(UDValue (^)(NSUInteger index))evaluate;
+
+// Whether the rows already show registers: its version is the one synced.
+- (BOOL)isInSyncWithRegisters:(UDRegisterFile *)registers;
+
+- (UDValue)valueAtRow:(NSUInteger)row;
+// Formatted on first request and kept until invalidateStrings
+- (NSString *)stringAtRow:(NSUInteger)row formatter:(NSString *(^)(UDValue value))format;
+
+// Every row is evaluated again on the next sync (e.g. integer mode changed)
+- (void)invalidateValues;
+// Every row is formatted again on request (e.g. base or separators changed)
+- (void)invalidateStrings;
+
+// Rows changed since the last call, in the current numbering.
+- (NSIndexSet *)takeChangedRows;
+
+@end
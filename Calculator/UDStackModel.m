@@ -0,0 +1,229 @@
+//
+//  UDStackModel.m
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDStackModel.h"
+#import <stdlib.h>
+#import <string.h>
+
+@implementation UDStackModel {
+    // One row per register, bottom first
+    uint64_t *_ids;             // register file identity of the row's entry
+    UDValue *_values;
+    __strong NSString **_strings; // nil until formatted
+    NSUInteger _count;
+    NSUInteger _capacity;
+
+    // Reused by every sync: the new span, built before it is spliced in,
+    // and an open-addressed table from old identity to old row.
+    uint64_t *_spanIds;
+    UDValue *_spanValues;
+    __strong NSString **_spanStrings;
+    NSUInteger _spanCapacity;
+    uint64_t *_tableKeys;       // 0 is empty; identities start at 1
+    NSUInteger *_tableRows;
+    NSUInteger _tableCapacity;
+    NSUInteger _tableSize;      // in use by the current sync, a power of two
+
+    NSMutableIndexSet *_changed;
+    BOOL _valuesStale;
+    uint64_t _syncedVersion;    // of the register file last synced
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _changed = [NSMutableIndexSet indexSet];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < _count; i++) _strings[i] = nil;
+    for (NSUInteger i = 0; i < _spanCapacity; i++) _spanStrings[i] = nil;
+    free(_ids);
+    free(_values);
+    free(_strings);
+    free(_spanIds);
+    free(_spanValues);
+    free(_spanStrings);
+    free(_tableKeys);
+    free(_tableRows);
+}
+
+- (NSUInteger)count {
+    return _count;
+}
+
+- (BOOL)isInSyncWithRegisters:(UDRegisterFile *)registers {
+    return !_valuesStale && registers.version == _syncedVersion;
+}
+
+#pragma mark - Storage
+
+static NSUInteger UDGrownCapacity(NSUInteger capacity, NSUInteger needed) {
+    NSUInteger grown = MAX(capacity, 16);
+    while (grown < needed) grown *= 2;
+    return grown;
+}
+
+static __strong NSString **UDGrowStrings(__strong NSString **strings, NSUInteger count, NSUInteger capacity) {
+    __strong NSString **grown = (__strong NSString **)calloc(capacity, sizeof(NSString *));
+    for (NSUInteger i = 0; i < count; i++) {
+        grown[i] = strings[i];
+        strings[i] = nil;
+    }
+    free(strings);
+    return grown;
+}
+
+- (void)reserveRows:(NSUInteger)rows {
+    if (rows <= _capacity) return;
+    NSUInteger capacity = UDGrownCapacity(_capacity, rows);
+    _ids = realloc(_ids, capacity * sizeof(uint64_t));
+    _values = realloc(_values, capacity * sizeof(UDValue));
+    _strings = UDGrowStrings(_strings, _count, capacity);
+    _capacity = capacity;
+}
+
+- (void)reserveSpan:(NSUInteger)rows {
+    if (rows <= _spanCapacity) return;
+    NSUInteger capacity = UDGrownCapacity(_spanCapacity, rows);
+    _spanIds = realloc(_spanIds, capacity * sizeof(uint64_t));
+    _spanValues = realloc(_spanValues, capacity * sizeof(UDValue));
+    _spanStrings = UDGrowStrings(_spanStrings, 0, capacity);
+    _spanCapacity = capacity;
+}
+
+static inline NSUInteger UDTableSlot(uint64_t identity, NSUInteger size) {
+    return (NSUInteger)((identity * 0x9E3779B97F4A7C15ull) >> 32) & (size - 1);
+}
+
+// Indexes the old rows of range by identity, at most half full
+- (void)indexRows:(NSRange)range {
+    NSUInteger size = 16;
+    while (size < range.length * 2) size *= 2;
+    if (size > _tableCapacity) {
+        _tableKeys = realloc(_tableKeys, size * sizeof(uint64_t));
+        _tableRows = realloc(_tableRows, size * sizeof(NSUInteger));
+        _tableCapacity = size;
+    }
+    _tableSize = size;
+    memset(_tableKeys, 0, size * sizeof(uint64_t));
+    for (NSUInteger row = range.location; row < NSMaxRange(range); row++) {
+        NSUInteger slot = UDTableSlot(_ids[row], size);
+        // A duplicate shares its original's identity and value; keep either
+        while (_tableKeys[slot] && _tableKeys[slot] != _ids[row]) slot = (slot + 1) & (size - 1);
+        _tableKeys[slot] = _ids[row];
+        _tableRows[slot] = row;
+    }
+}
+
+- (NSUInteger)indexedRowOf:(uint64_t)identity {
+    NSUInteger size = _tableSize;
+    for (NSUInteger slot = UDTableSlot(identity, size); _tableKeys[slot]; slot = (slot + 1) & (size - 1)) {
+        if (_tableKeys[slot] == identity) return _tableRows[slot];
+    }
+    return NSNotFound;
+}
+
+#pragma mark - Sync
+
+- (void)syncWithRegisters:(UDRegisterFile *)registers evaluator:(UDValue (^)(NSUInteger index))evaluate {
+    _syncedVersion = registers.version;
+    NSUInteger oldCount = _count, newCount = registers.count;
+
+    if (_valuesStale) {
+        // Nothing carries over; evaluate the whole stack once
+        _valuesStale = NO;
+        for (NSUInteger i = 0; i < _count; i++) _strings[i] = nil;
+        _count = oldCount = 0;
+    }
+
+    NSUInteger common = MIN(oldCount, newCount), prefix = 0, suffix = 0;
+    while (prefix < common && _ids[prefix] == [registers identityAtIndex:prefix]) prefix++;
+    while (suffix < common - prefix && _ids[oldCount - 1 - suffix] == [registers identityAtIndex:newCount - 1 - suffix]) suffix++;
+    NSRange oldRange = NSMakeRange(prefix, oldCount - suffix - prefix);
+    NSRange newRange = NSMakeRange(prefix, newCount - suffix - prefix);
+    if (oldRange.length == 0 && newRange.length == 0) return;
+
+    // Entries that moved within the span keep what was computed for them;
+    // only those new to it are evaluated.
+    BOOL canMove = oldRange.length > 0 && newRange.length > 0;
+    if (canMove) [self indexRows:oldRange];
+    [self reserveSpan:newRange.length];
+    for (NSUInteger i = 0; i < newRange.length; i++) {
+        uint64_t identity = [registers identityAtIndex:newRange.location + i];
+        NSUInteger from = canMove ? [self indexedRowOf:identity] : NSNotFound;
+        // Enter duplicates the row just below the span
+        if (from == NSNotFound && prefix > 0 && _ids[prefix - 1] == identity) from = prefix - 1;
+        _spanIds[i] = identity;
+        if (from != NSNotFound) {
+            _spanValues[i] = _values[from];
+            _spanStrings[i] = _strings[from];
+        } else {
+            _spanValues[i] = evaluate(newRange.location + i);
+            _spanStrings[i] = nil;
+        }
+    }
+
+    // Shift the unchanged top to its new place, then drop the span in
+    [self reserveRows:newCount];
+    NSUInteger oldTop = NSMaxRange(oldRange), newTop = NSMaxRange(newRange);
+    if (newTop != oldTop) {
+        memmove(_ids + newTop, _ids + oldTop, suffix * sizeof(uint64_t));
+        memmove(_values + newTop, _values + oldTop, suffix * sizeof(UDValue));
+        if (newTop > oldTop) {
+            for (NSUInteger i = suffix; i > 0; i--) _strings[newTop + i - 1] = _strings[oldTop + i - 1];
+        } else {
+            for (NSUInteger i = 0; i < suffix; i++) _strings[newTop + i] = _strings[oldTop + i];
+        }
+    }
+    for (NSUInteger i = newCount; i < oldCount; i++) _strings[i] = nil;
+    for (NSUInteger i = 0; i < newRange.length; i++) {
+        _ids[prefix + i] = _spanIds[i];
+        _values[prefix + i] = _spanValues[i];
+        _strings[prefix + i] = _spanStrings[i];
+        _spanStrings[i] = nil;
+    }
+    _count = newCount;
+
+    // A change in count shifts every row above the span
+    [_changed addIndexesInRange:newCount != oldCount ? NSMakeRange(prefix, newCount - prefix) : newRange];
+    [_changed removeIndexesInRange:NSMakeRange(newCount, NSNotFound - newCount)];
+}
+
+#pragma mark - Rows
+
+- (UDValue)valueAtRow:(NSUInteger)row {
+    if (row >= _count) return UDValueMakeDouble(0.0);
+    return _values[row];
+}
+
+- (NSString *)stringAtRow:(NSUInteger)row formatter:(NSString *(^)(UDValue value))format {
+    if (row >= _count) return @"";
+    if (!_strings[row]) _strings[row] = format(_values[row]);
+    return _strings[row];
+}
+
+#pragma mark - Invalidation
+
+- (void)invalidateValues {
+    _valuesStale = YES;
+}
+
+- (void)invalidateStrings {
+    for (NSUInteger i = 0; i < _count; i++) _strings[i] = nil;
+    [_changed addIndexesInRange:NSMakeRange(0, _count)];
+}
+
+- (NSIndexSet *)takeChangedRows {
+    NSIndexSet *rows = [_changed copy];
+    [_changed removeAllIndexes];
+    return rows;
+}
+
+@end
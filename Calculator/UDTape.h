@@ -6,14 +6,24 @@
 //
 
 #import <Foundation/Foundation.h>
-#import "UDTapeWindowController.h"
+#import "UDTapeLog.h"
 #import "UDAST.h" // Needs to know about Nodes to print them
 
+@class UDTapeWindowController;
+
 @interface UDTape : NSObject
 
 @property (nonatomic, strong) UDTapeWindowController *windowController;
 
-// The main action: Takes a completed tree and the result value
+// Every entry since launch, up to log.capacity; kept while the window is
+// closed, so opening the tape shows the session so far.
+@property (nonatomic, readonly) UDTapeLog *log;
+
+// The main action: Takes a completed tree and the result value.
+// The window catches up once per run loop turn, however many results
+// arrived in it.
 - (void)logTransaction:(UDASTNode *)rootNode result:(double)val;
 
+- (void)clear;
+
 @end
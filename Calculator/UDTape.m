@@ -6,24 +6,50 @@
 //
 
 #import "UDTape.h"
+#import "UDTapeWindowController.h"
+
+@interface UDTape ()
+@property (nonatomic, assign) BOOL updateScheduled;
+@end
 
 @implementation UDTape
 
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _log = [[UDTapeLog alloc] initWithCapacity:UDTapeLogDefaultCapacity];
+    }
+    return self;
+}
+
+- (void)setWindowController:(UDTapeWindowController *)windowController {
+    _windowController = windowController;
+    windowController.tape = self;
+}
+
 - (void)logTransaction:(UDASTNode *)rootNode result:(double)val {
-    if (!self.windowController) return;
-    
     // 1. Get the Math String (e.g., "(5 + 3) * 2")
     // We use the prettyPrint method we built in UDAST
-    NSString *equation = [rootNode prettyPrint];
-
-    // 2. Format the full line (Equation + Result)
-    // Standard Format:
-    // (5 + 3) * 2
-    // = 16
-    NSString *logEntry = [NSString stringWithFormat:@"%@\n= %.8g\n\n", equation, val];
-    
-    // 3. Send to UI
-    [self.windowController appendLog:logEntry];
+    [self.log appendEquation:[rootNode prettyPrint] result:val];
+
+    // 2. Send to UI, once for the whole burst
+    [self scheduleUpdate];
+}
+
+- (void)clear {
+    [self.log removeAllEntries];
+    [self scheduleUpdate];
+}
+
+- (void)scheduleUpdate {
+    if (self.updateScheduled) return;
+    self.updateScheduled = YES;
+    [self performSelector:@selector(flushUpdate) withObject:nil afterDelay:0];
+}
+
+- (void)flushUpdate {
+    self.updateScheduled = NO;
+    [self.windowController tapeDidChange];
 }
 
 @end
@@ -0,0 +1,38 @@
+//
+//  UDTapeLog.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <Foundation/Foundation.h>
+
+// A day of heavy use; older entries scroll off the tape for good.
+extern const NSUInteger UDTapeLogDefaultCapacity;
+
+// The paper tape's entries, oldest first: an equation and its result each,
+// in a ring that keeps the most recent `capacity`. Storage grows with use
+// up to the cap; past it, each new entry evicts the oldest.
+@interface UDTapeLog : NSObject
+
+// With UDTapeLogDefaultCapacity
+- (instancetype)init;
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+// Lowering it drops the oldest entries at once. At least 1.
+@property (nonatomic, assign) NSUInteger capacity;
+@property (nonatomic, readonly) NSUInteger count;
+// Entries evicted since creation, counting those removeAllEntries cleared.
+// A view that saw k evictions and now sees more knows its rows shifted.
+@property (nonatomic, readonly) NSUInteger evictedCount;
+
+- (void)appendEquation:(NSString *)equation result:(double)result;
+- (void)removeAllEntries;
+
+// Index 0 is the oldest entry kept
+- (NSString *)equationAtIndex:(NSUInteger)index;
+- (double)resultAtIndex:(NSUInteger)index;
+// "equation\n= result", as printed on the tape
+- (NSString *)textAtIndex:(NSUInteger)index;
+
+@end
@@ -0,0 +1,125 @@
+//
+//  UDTapeLog.m
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDTapeLog.h"
+#import <stdlib.h>
+
+const NSUInteger UDTapeLogDefaultCapacity = 10000;
+
+// First allocation; doubled as the tape fills, up to the cap.
+static const NSUInteger kUDTapeLogInitialSize = 64;
+
+@implementation UDTapeLog {
+    // Parallel rings of _size slots; entry i is at (_head + i) % _size.
+    __strong NSString **_equations;
+    double *_results;
+    NSUInteger _size;
+    NSUInteger _head;
+}
+
+- (instancetype)init {
+    return [self initWithCapacity:UDTapeLogDefaultCapacity];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    self = [super init];
+    if (self) {
+        _capacity = MAX(capacity, 1);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i < _size; i++) _equations[i] = nil;
+    free(_equations);
+    free(_results);
+}
+
+#pragma mark - Storage
+
+static inline NSUInteger UDTapeSlot(UDTapeLog *log, NSUInteger index) {
+    return (log->_head + index) % log->_size;
+}
+
+// Moves the newest `keep` entries into fresh storage of `size` slots.
+- (void)resize:(NSUInteger)size keeping:(NSUInteger)keep {
+    __strong NSString **equations = (__strong NSString **)calloc(size, sizeof(NSString *));
+    double *results = malloc(size * sizeof(double));
+
+    NSUInteger first = _count - keep;
+    for (NSUInteger i = 0; i < _count; i++) {
+        NSUInteger p = UDTapeSlot(self, i);
+        if (i >= first) {
+            equations[i - first] = _equations[p];
+            results[i - first] = _results[p];
+        }
+        _equations[p] = nil;
+    }
+    free(_equations);
+    free(_results);
+    _equations = equations;
+    _results = results;
+    _size = size;
+    _head = 0;
+    _evictedCount += first;
+    _count = keep;
+}
+
+- (void)setCapacity:(NSUInteger)capacity {
+    _capacity = MAX(capacity, 1);
+    if (_size > _capacity) [self resize:_capacity keeping:MIN(_count, _capacity)];
+}
+
+#pragma mark - Entries
+
+- (void)appendEquation:(NSString *)equation result:(double)result {
+    if (_count == _size && _size < _capacity) {
+        [self resize:MIN(MAX(_size * 2, kUDTapeLogInitialSize), _capacity) keeping:_count];
+    }
+
+    NSUInteger p;
+    if (_count == _capacity) {
+        // Full: the new entry takes the oldest's slot
+        p = _head;
+        _head = (_head + 1) % _size;
+        _evictedCount++;
+    } else {
+        p = UDTapeSlot(self, _count);
+        _count++;
+    }
+    _equations[p] = [equation copy];
+    _results[p] = result;
+}
+
+- (void)removeAllEntries {
+    for (NSUInteger i = 0; i < _count; i++) _equations[UDTapeSlot(self, i)] = nil;
+    _evictedCount += _count;
+    _count = 0;
+    _head = 0;
+}
+
+- (void)checkIndex:(NSUInteger)index {
+    if (index >= _count) {
+        [NSException raise:NSRangeException format:@"tape entry %lu beyond %lu", (unsigned long)index, (unsigned long)_count];
+    }
+}
+
+- (NSString *)equationAtIndex:(NSUInteger)index {
+    [self checkIndex:index];
+    return _equations[UDTapeSlot(self, index)];
+}
+
+- (double)resultAtIndex:(NSUInteger)index {
+    [self checkIndex:index];
+    return _results[UDTapeSlot(self, index)];
+}
+
+- (NSString *)textAtIndex:(NSUInteger)index {
+    return [NSString stringWithFormat:@"%@\n= %.8g", [self equationAtIndex:index], [self resultAtIndex:index]];
+}
+
+@end
@@ -7,10 +7,17 @@
 
 #import <AppKit/AppKit.h>
 
-@interface UDTapeWindowController : NSWindowController <NSWindowDelegate>
+@class UDTape;
 
-// Public method to append a line to the text view
-- (void)appendLog:(NSString *)logLine;
+@interface UDTapeWindowController : NSWindowController <NSWindowDelegate, NSTableViewDataSource, NSTableViewDelegate>
+
+// The entries shown; set by UDTape when it gets the controller.
+@property (nonatomic, weak) UDTape *tape;
+
+// Brings the table up to date with the tape: evicted rows are removed at
+// the top, new rows are added at the bottom, and only the visible ones
+// are laid out.
+- (void)tapeDidChange;
 
 // Method to clear the view (optional but good for UX)
 - (IBAction)clearLog:(id)sender;
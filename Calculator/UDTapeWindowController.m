@@ -8,14 +8,22 @@
 #import "UDTapeWindowController.h"
 #import "UDCalcViewController.h"
 #import "UDSettingsManager.h"
+#import "UDTape.h"
 
 @interface UDTapeWindowController ()
 
-// Connect this outlet to the NSTextView in Interface Builder
-@property (unsafe_unretained) IBOutlet NSTextView *textView;
+// Connect this outlet to the view-based NSTableView in Interface Builder
+@property (unsafe_unretained) IBOutlet NSTableView *tableView;
 
 @property (nonatomic, assign) BOOL isAppTerminating;
 
+// What the table showed at the last update, to tell an append from a shift
+@property (nonatomic, assign) NSUInteger shownCount;
+@property (nonatomic, assign) NSUInteger shownEvictedCount;
+
+// Shared by every row
+@property (nonatomic, strong) NSFont *entryFont;
+
 @end
 
 @implementation UDTapeWindowController
@@ -31,7 +39,14 @@
     ((NSPanel *)self.window).becomesKeyOnlyIfNeeded = YES;
 
     // Set a nice monospaced font so numbers align perfectly
-    //[self.textView setFont:[NSFont monospacedDigitSystemFontOfSize:14.0 weight:NSFontWeightRegular]];
+    self.entryFont = [NSFont monospacedDigitSystemFontOfSize:14.0 weight:NSFontWeightRegular];
+
+    // Two lines per entry, and every row the same height: the table can
+    // find the visible rows by arithmetic, however long the tape
+    self.tableView.rowHeight = ceil(2 * (self.entryFont.ascender - self.entryFont.descender + self.entryFont.leading)) + 8;
+    self.tableView.dataSource = self;
+    self.tableView.delegate = self;
+    [self reloadTable];
 
     [[NSNotificationCenter defaultCenter] addObserver:self
                                              selector:@selector(appWillTerminate:)
@@ -53,29 +68,81 @@
     }
 }
 
-- (void)appendLog:(NSString *)logLine {
-    // Ensure window is loaded before trying to write
-    if (!self.isWindowLoaded) {
-        [self loadWindow];
+#pragma mark - Updates
+
+- (void)tapeDidChange {
+    // Loaded on first show; windowDidLoad catches up then
+    if (!self.isWindowLoaded) return;
+
+    // Entry i of the log is the (evictedCount + i)th ever logged, so both
+    // states are ranges of that sequence: evicted entries leave at the
+    // top, new ones arrive at the bottom, and the rows in between stay.
+    UDTapeLog *log = self.tape.log;
+    NSUInteger oldStart = self.shownEvictedCount, oldEnd = oldStart + self.shownCount;
+    NSUInteger newStart = log.evictedCount, newEnd = newStart + log.count;
+    if (newStart == oldStart && newEnd == oldEnd) return;
+
+    NSUInteger removed = MIN(newStart, oldEnd) - oldStart;
+    NSUInteger kept = self.shownCount - removed;
+
+    self.shownCount = log.count;
+    self.shownEvictedCount = log.evictedCount;
+    [self.tableView beginUpdates];
+    if (removed > 0) {
+        [self.tableView removeRowsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, removed)]
+                              withAnimation:NSTableViewAnimationEffectNone];
     }
-    
-    // Create attributes dictionary with Font and Color
-    NSDictionary *attrs = @{
-        NSFontAttributeName: [NSFont monospacedDigitSystemFontOfSize:14.0 weight:NSFontWeightRegular],
-        NSForegroundColorAttributeName: [NSColor controlTextColor]
-    };
-    
-    NSAttributedString *attrStr = [[NSAttributedString alloc] initWithString:logLine attributes:attrs];
+    if (log.count > kept) {
+        [self.tableView insertRowsAtIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(kept, log.count - kept)]
+                              withAnimation:NSTableViewAnimationEffectNone];
+    }
+    [self.tableView endUpdates];
+    [self scrollToNewest];
+}
 
-    // Append to the text storage
-    [[self.textView textStorage] appendAttributedString:attrStr];
-    
-    // Scroll to the bottom so the newest entry is visible
-    [self.textView scrollRangeToVisible:NSMakeRange([[self.textView string] length], 0)];
+- (void)reloadTable {
+    self.shownCount = self.tape.log.count;
+    self.shownEvictedCount = self.tape.log.evictedCount;
+    [self.tableView reloadData];
+    [self scrollToNewest];
+}
+
+// Scroll to the bottom so the newest entry is visible
+- (void)scrollToNewest {
+    if (self.shownCount > 0) [self.tableView scrollRowToVisible:(NSInteger)self.shownCount - 1];
 }
 
 - (IBAction)clearLog:(id)sender {
-    [self.textView setString:@""];
+    [self.tape clear];
+}
+
+#pragma mark - Table
+
+- (NSInteger)numberOfRowsInTableView:(NSTableView *)tableView {
+    return (NSInteger)self.shownCount;
+}
+
+- (NSView *)tableView:(NSTableView *)tableView viewForTableColumn:(NSTableColumn *)tableColumn row:(NSInteger)row {
+    NSTableCellView *cell = [tableView makeViewWithIdentifier:@"TapeCell" owner:self];
+
+    if (!cell) {
+        cell = [[NSTableCellView alloc] initWithFrame:NSMakeRect(0, 0, 100, tableView.rowHeight)];
+        cell.identifier = @"TapeCell";
+        NSTextField *tf = [NSTextField labelWithString:@""];
+        tf.font = self.entryFont;
+        tf.textColor = [NSColor controlTextColor];
+        tf.translatesAutoresizingMaskIntoConstraints = NO;
+        [cell addSubview:tf];
+        cell.textField = tf;
+
+        // Pin text field to cell edges
+        [cell addConstraints:[NSLayoutConstraint constraintsWithVisualFormat:@"H:|[tf]|" options:0 metrics:nil views:@{@"tf":tf}]];
+        [cell addConstraints:[NSLayoutConstraint constraintsWithVisualFormat:@"V:|-4-[tf]-4-|" options:0 metrics:nil views:@{@"tf":tf}]];
+    }
+
+    // Equation, then "= result"
+    cell.textField.stringValue = [self.tape.log textAtIndex:(NSUInteger)row];
+    return cell;
 }
 
 @end
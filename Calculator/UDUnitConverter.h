@@ -29,4 +29,14 @@
               fromUnit:(NSUnit *)fromUnit
                 toUnit:(NSUnit *)toUnit;
 
+/**
+ Converts a column of values in place, with the same results as
+ convertValue:fromUnit:toUnit: on each. Values are left as they are if
+ conversion is impossible.
+ */
+- (void)convertValues:(double *)values
+                count:(NSUInteger)count
+                 from:(NSUnit *)fromUnit
+                   to:(NSUnit *)toUnit;
+
 @end
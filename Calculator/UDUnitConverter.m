@@ -7,12 +7,29 @@
 
 #import "UDUnitConverter.h"
 #import "UDConstants.h"
+#import <stdlib.h>
+
+// to = from * scale + offset
+typedef struct {
+    double scale;
+    double offset;
+} UDAffine;
 
 @interface UDUnitConverter()
 @property (strong) NSDictionary<NSString *, NSArray<NSUnit *> *> *unitData;
+@property (strong) NSArray<NSString *> *sortedCategories;
+// Unit -> its pair table row; see setupTables
+@property (strong) NSDictionary<NSUnit *, NSNumber *> *unitSlots;
+@property (strong) NSDictionary<NSString *, NSDictionary<NSString *, NSUnit *> *> *symbolIndex;
+@property (strong) NSMutableDictionary<NSUnit *, NSString *> *unitNames;
+@property (strong) NSMeasurementFormatter *nameFormatter;
 @end
 
-@implementation UDUnitConverter
+@implementation UDUnitConverter {
+    // One dense n x n table per category, laid end to end: the map from
+    // unit i to unit j of a category is _pairs[base + i * n + j].
+    UDAffine *_pairs;
+}
 
 - (instancetype)init {
     self = [super init];
@@ -22,8 +39,12 @@
     return self;
 }
 
+- (void)dealloc {
+    free(_pairs);
+}
+
 - (NSArray<NSString *> *)availableCategories {
-    return [self.unitData.allKeys sortedArrayUsingSelector:@selector(compare:)];
+    return self.sortedCategories;
 }
 
 - (NSArray<NSUnit *> *)unitsForCategory:(NSString *)category {
@@ -34,35 +55,50 @@
     return NSLocalizedString(categoryKey, @"Unit conversion category");
 }
 
+// Formatted once per unit; the menus ask for every name on each rebuild
 - (NSString *)localizedNameForUnit:(NSUnit *)unit {
-    NSMeasurementFormatter *fmt = [[NSMeasurementFormatter alloc] init];
-    // This ensures we get the full name (e.g. "meters") instead of just "m"
-    fmt.unitOptions = NSMeasurementFormatterUnitOptionsProvidedUnit;
-    return [fmt stringFromUnit:unit];
+    if (!unit) return nil;
+    NSString *name = self.unitNames[unit];
+    if (name) return name;
+
+    if (!self.nameFormatter) {
+        self.nameFormatter = [[NSMeasurementFormatter alloc] init];
+        // This ensures we get the full name (e.g. "meters") instead of just "m"
+        self.nameFormatter.unitOptions = NSMeasurementFormatterUnitOptionsProvidedUnit;
+    }
+    name = [self.nameFormatter stringFromUnit:unit];
+    if (name) self.unitNames[unit] = name;
+    return name;
 }
 
 - (NSUnit *)unitForSymbol:(NSString *)symbol ofCategory:(NSString *)category {
-    NSArray<NSUnit *> *units = self.unitData[category];
-    if (!units) return nil;
-    
-    for (NSInteger i = 0; i < units.count; i++) {
-        NSUnit *u = units[i];
-
-        if ([u.symbol isEqualToString:symbol]) {
-            return u;
-        }
-    }
-
-    return nil;
+    if (!symbol) return nil;
+    return self.symbolIndex[category][symbol];
 }
 
 - (NSString *)symbolForUnit:(NSUnit *)unit {
     return unit.symbol;
 }
 
+// The table entry for a pair of units of one category, or NULL
+- (const UDAffine *)affineFrom:(NSUnit *)fromUnit to:(NSUnit *)toUnit {
+    if (!fromUnit || !toUnit) return NULL;
+    NSNumber *from = self.unitSlots[fromUnit], *to = self.unitSlots[toUnit];
+    if (!from || !to) return NULL;
+
+    // Slot: category base in the high half, ordinal and row length below
+    uint64_t f = from.unsignedLongLongValue, t = to.unsignedLongLongValue;
+    if ((f >> 32) != (t >> 32)) return NULL;
+    uint64_t n = (f >> 16) & 0xFFFF;
+    return &_pairs[(f >> 32) + (f & 0xFFFF) * n + (t & 0xFFFF)];
+}
+
 - (double)convertValue:(double)value fromUnit:(NSUnit *)fromUnit toUnit:(NSUnit *)toUnit {
     if (!fromUnit || !toUnit) return value;
 
+    const UDAffine *map = [self affineFrom:fromUnit to:toUnit];
+    if (map) return value * map->scale + map->offset;
+
 #ifdef GNUSTEP
     // Fix for GNUstep: NSMeasurement conversion is currently limited.
     // We manually use the NSDimension converters.
@@ -82,6 +118,22 @@
     return value;
 }
 
+- (void)convertValues:(double *)values count:(NSUInteger)count from:(NSUnit *)fromUnit to:(NSUnit *)toUnit {
+    const UDAffine *map = [self affineFrom:fromUnit to:toUnit];
+    if (!map) {
+        for (NSUInteger i = 0; i < count; i++) {
+            values[i] = [self convertValue:values[i] fromUnit:fromUnit toUnit:toUnit];
+        }
+        return;
+    }
+
+    // Locals, so the loop body is one multiply-add the compiler vectorizes
+    const double scale = map->scale, offset = map->offset;
+    for (NSUInteger i = 0; i < count; i++) {
+        values[i] = values[i] * scale + offset;
+    }
+}
+
 - (void)setupUnits {
     // Populate with all standard Apple NSUnit types
     self.unitData = @{
@@ -127,6 +179,66 @@
             [NSUnitDuration seconds], [NSUnitDuration minutes], [NSUnitDuration hours]
         ]
     };
+    [self setupTables];
+}
+
+// Every unit here converts linearly to its base unit, base = v * c + k, so
+// unit i to unit j is one affine map: v * (c_i / c_j) + (k_i - k_j) / c_j.
+// The offset is what makes temperature work. A unit without a linear
+// converter gets no slot and converts through Foundation.
+- (void)setupTables {
+    self.sortedCategories = [self.unitData.allKeys sortedArrayUsingSelector:@selector(compare:)];
+    self.unitNames = [NSMutableDictionary dictionary];
+
+    NSUInteger total = 0;
+    for (NSString *category in self.sortedCategories) {
+        NSUInteger n = self.unitData[category].count;
+        total += n * n;
+    }
+    free(_pairs);
+    _pairs = malloc(MAX(total, 1) * sizeof(UDAffine));
+
+    NSMutableDictionary<NSUnit *, NSNumber *> *slots = [NSMutableDictionary dictionary];
+    NSMutableDictionary *symbols = [NSMutableDictionary dictionary];
+    uint64_t base = 0;
+    for (NSString *category in self.sortedCategories) {
+        NSArray<NSUnit *> *units = self.unitData[category];
+        NSUInteger n = units.count;
+
+        NSMutableDictionary<NSString *, NSUnit *> *bySymbol = [NSMutableDictionary dictionaryWithCapacity:n];
+        double *c = malloc(MAX(n, 1) * sizeof(double));
+        double *k = malloc(MAX(n, 1) * sizeof(double));
+        BOOL *linear = malloc(MAX(n, 1) * sizeof(BOOL));
+        for (NSUInteger i = 0; i < n; i++) {
+            NSUnit *u = units[i];
+            // First one wins, as with the scan this replaces
+            if (!bySymbol[u.symbol]) bySymbol[u.symbol] = u;
+
+            NSUnitConverter *conv = [u isKindOfClass:[NSDimension class]] ? [(NSDimension *)u converter] : nil;
+            linear[i] = [conv isKindOfClass:[NSUnitConverterLinear class]] && ((NSUnitConverterLinear *)conv).coefficient != 0;
+            c[i] = linear[i] ? ((NSUnitConverterLinear *)conv).coefficient : 1;
+            k[i] = linear[i] ? ((NSUnitConverterLinear *)conv).constant : 0;
+        }
+
+        for (NSUInteger i = 0; i < n; i++) {
+            for (NSUInteger j = 0; j < n; j++) {
+                UDAffine *map = &_pairs[base + i * n + j];
+                if (i == j) {
+                    *map = (UDAffine){ 1, 0 };   // exact
+                } else {
+                    *map = (UDAffine){ c[i] / c[j], (k[i] - k[j]) / c[j] };
+                }
+            }
+            if (linear[i]) slots[units[i]] = @((base << 32) | ((uint64_t)n << 16) | i);
+        }
+        symbols[category] = [bySymbol copy];
+        base += n * n;
+        free(c);
+        free(k);
+        free(linear);
+    }
+    self.unitSlots = [slots copy];
+    self.symbolIndex = [symbols copy];
 }
 
 @end
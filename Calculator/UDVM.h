@@ -6,7 +6,81 @@
 //
 
 #import "UDInstruction.h"
+#import "UDProgram.h"
+
+// Execution cores. They produce identical results; the choice only
+// affects speed, so they can be benchmarked and cross-checked.
+typedef NS_ENUM(NSInteger, UDVMDispatch) {
+    UDVMDispatchSwitch,     // one switch per opcode
+    UDVMDispatchThreaded,   // computed goto over fused superinstructions
+    UDVMDispatchNative      // UDJIT machine code; the switch core where it cannot translate
+};
+
+// The calculator's x^y: an odd root of a negative number stays real.
+// Shared with UDJIT so both tiers compute it the same way.
+double UDVMPow(double base, double power);
 
 @interface UDVM : NSObject
+
+// Execution is reentrant: the stack lives on the caller's C stack and a
+// program is only read, so any number of threads may run programs, the
+// same one included.
+//
+// Core used by executeProgram:. Defaults to threaded when the compiler
+// supports computed goto; otherwise stays on the switch core. Set it
+// before starting other threads, not while they run.
+@property (class, nonatomic, assign) UDVMDispatch dispatch;
+@property (class, nonatomic, readonly) BOOL isThreadedDispatchAvailable;
+
+// executeProgram: and executeProgram:inputs:count: hand a program to UDJIT
+// once it has run this many times, and use the native code from then on.
+// 0 keeps every program in the interpreter. Defaults to 256.
+@property (class, nonatomic, assign) NSUInteger jitThreshold;
+
+// Checks stack discipline once and records the outcome on the program
+// (status, maxStackDepth, rejectionError). executeProgram: calls this
+// itself; a rejected program evaluates to its rejection error without
+// running a single instruction.
++ (BOOL)verifyProgram:(UDProgram *)program;
+
++ (UDValue)executeProgram:(UDProgram *)program;
++ (UDValue)executeProgram:(UDProgram *)program dispatch:(UDVMDispatch)dispatch;
+
+// For programs with input slots: inputs[i] is what LOAD i pushes. A
+// program that reads more slots than count evaluates to an error.
++ (UDValue)executeProgram:(UDProgram *)program inputs:(const UDValue *)inputs count:(NSUInteger)count;
++ (UDValue)executeProgram:(UDProgram *)program inputs:(const UDValue *)inputs count:(NSUInteger)count
+                 dispatch:(UDVMDispatch)dispatch;
+
+// One input column for batch execution: count values of one type.
+typedef struct {
+    UDValueType type;       // UDValueTypeDouble or UDValueTypeInteger
+    const void *values;     // double or unsigned long long
+} UDVMColumn;
+
+// Evaluates program once per row, over columns of inputs: on row r,
+// LOAD i pushes element r of columns[i]. Rows are processed in blocks,
+// one opcode at a time across the block, which suits long columns far
+// better than one executeProgram:inputs: call per row. results[r] is the
+// value of row r; an error such as a zero divisor only affects its row.
++ (void)executeProgram:(UDProgram *)program
+               columns:(const UDVMColumn *)columns
+           columnCount:(NSUInteger)columnCount
+                 count:(NSUInteger)count
+               results:(UDValue *)results;
+
+// Compile-time evaluation for the optimizer. operands holds
+// operandCountForOpcode: values, bottom of the stack first. Returns NO,
+// leaving result untouched, when the opcode cannot be folded or its
+// result would be an error value; such opcodes must run at run time.
++ (NSUInteger)operandCountForOpcode:(UDOpcode)opcode;
++ (BOOL)foldOpcode:(UDOpcode)opcode operands:(const UDValue *)operands result:(UDValue *)result;
+
+// The same single step at run time: the value the opcode leaves on the
+// stack, or the error it stops the program with. An opcode foldOpcode:
+// would never accept yields UDValueErrorTypeUnknown.
++ (UDValue)applyOpcode:(UDOpcode)opcode operands:(const UDValue *)operands;
+
+// Convenience for hand-built programs; packs the instructions first.
 + (UDValue)execute:(NSArray<UDInstruction *> *)program;
 @end
@@ -6,7 +6,9 @@
 //
 
 #import "UDVM.h"
+#import "UDJIT.h"
 #import <math.h>
+#import <string.h>
 
 #define MAX_STACK_DEPTH 1024
 
@@ -25,6 +27,10 @@ static inline double Pow(double base, double power) {
     return pow(base, power);
 }
 
+double UDVMPow(double base, double power) {
+    return Pow(base, power);
+}
+
 static inline uint64_t RotL64(uint64_t value, int shift) {
     // FIXME: incorrect
     if ((shift &= 63) == 0) return value;
@@ -63,425 +69,638 @@ static inline uint64_t WordFlip(uint64_t v, int bitWidth) {
     return (v >> 32) | (v << 32);
 }
 
-@implementation UDVM
+// Heuristic: Guess size based on magnitude
+static inline int FlipBWidth(uint64_t v) {
+    if (v <= 0xFF) return 8;
+    if (v <= 0xFFFF) return 16;
+    if (v <= 0xFFFFFFFF) return 32;
+    return 64;
+}
 
-+ (UDValue)execute:(NSArray<UDInstruction *> *)program {
-    UDValue stack[MAX_STACK_DEPTH];
+static inline int FlipWWidth(uint64_t v) {
+    if (v <= 0xFFFF) return 16;
+    if (v <= 0xFFFFFFFF) return 32;
+    return 64;
+}
+
+// Operand stack helpers shared by every opcode body below.
+// No bounds checks: only verified programs reach the cores.
+// The scalar cores keep the stack as UDBox values. A wide integer at
+// stack index k lives in wides[k], a slot of the run's own fixed table;
+// one in the constant pool lives in the program's, constantWides.
+#define POP_D()         (--sp, UDBoxAsDouble(stack[sp], wides))
+#define POP_I()         (--sp, UDBoxAsInt(stack[sp], wides))
+#define PUSH_D(x)       stack[sp++] = UDBoxMakeDouble(x)
+#define PUSH_I(x)       { unsigned long long i_ = (x); stack[sp] = UDBoxMakeIntInSlot(i_, wides, sp); sp++; }
+#define CONST_D()       UDBoxAsDouble(constants[ip->operand], constantWides)
+#define CONST_I()       UDBoxAsInt(constants[ip->operand], constantWides)
+
+#define BINARY_D(expr)  { double b = POP_D(); double a = POP_D(); PUSH_D(expr); }
+#define BINARY_I(expr)  { unsigned long long b = POP_I(); unsigned long long a = POP_I(); PUSH_I(expr); }
+#define UNARY_D(expr)   { double a = POP_D(); PUSH_D(expr); }
+#define UNARY_I(expr)   { unsigned long long a = POP_I(); PUSH_I(expr); }
+#define CONST_BINARY_D(expr) { double b = CONST_D(); double a = POP_D(); PUSH_D(expr); }
+#define CONST_BINARY_I(expr) { unsigned long long b = CONST_I(); unsigned long long a = POP_I(); PUSH_I(expr); }
+#define PUSH_CONST()    { \
+    UDBox k = constants[ip->operand]; \
+    if (UDBoxIsWide(k)) k = UDBoxMakeIntInSlot(constantWides[k & UDBOX_PAYLOAD_MASK], wides, sp); \
+    stack[sp++] = k; \
+}
+#define PUSH_INPUT()    { stack[sp] = UDBoxFromValueInSlot(inputs[ip->operand], wides, sp); sp++; }
+
+// Everything a run uses is in the core's frame, so it can just return.
+#define FAIL(error)     return UDValueMakeError(error)
+
+#define DIVIDE_D()       DIVIDE_BY_D(POP_D())
+#define DIVIDE_I()       DIVIDE_BY_I(POP_I())
+#define CONST_DIVIDE_D() DIVIDE_BY_D(CONST_D())
+#define CONST_DIVIDE_I() DIVIDE_BY_I(CONST_I())
+#define DIVIDE_BY_D(b_expr) { \
+    double b = (b_expr); \
+    double a = POP_D(); \
+    if (b == 0) FAIL(UDValueErrorTypeDivideByZero); \
+    PUSH_D(a / b); \
+}
+#define DIVIDE_BY_I(b_expr) { \
+    unsigned long long b = (b_expr); \
+    unsigned long long a = POP_I(); \
+    if (b == 0) FAIL(UDValueErrorTypeDivideByZero); \
+    PUSH_I(a / b); \
+}
+
+// Every opcode the VM understands: name, operands popped, results pushed,
+// body. Both dispatch cores, the lane core and the verifier expand this
+// one table, so they cannot drift apart.
+#define UDVM_OPCODES(X) \
+    X(Push,         0, 1, PUSH_CONST()) \
+    X(Add,          2, 1, BINARY_D(a + b)) \
+    X(Sub,          2, 1, BINARY_D(a - b)) \
+    X(Mul,          2, 1, BINARY_D(a * b)) \
+    X(Div,          2, 1, DIVIDE_D()) \
+    X(Neg,          1, 1, UNARY_D(-a)) \
+    X(Call,         0, 0, {}) \
+    X(Load,         0, 1, PUSH_INPUT()) \
+    X(AddI,         2, 1, BINARY_I(a + b)) \
+    X(SubI,         2, 1, BINARY_I(a - b)) \
+    X(MulI,         2, 1, BINARY_I(a * b)) \
+    X(DivI,         2, 1, DIVIDE_I()) \
+    X(NegI,         1, 1, UNARY_I(-a)) \
+    X(BitAnd,       2, 1, BINARY_I(a & b)) \
+    X(BitOr,        2, 1, BINARY_I(a | b)) \
+    X(BitXor,       2, 1, BINARY_I(a ^ b)) \
+    X(BitNot,       1, 1, UNARY_I(~a)) \
+    X(ShiftLeft,    2, 1, BINARY_I(a << b)) \
+    X(ShiftRight,   2, 1, BINARY_I(a >> b)) \
+    X(RotateLeft,   2, 1, BINARY_I(RotL64(a, (int)b))) \
+    X(RotateRight,  2, 1, BINARY_I(RotR64(a, (int)b))) \
+    X(Pow,          2, 1, BINARY_D(Pow(a, b))) \
+    X(Sqrt,         1, 1, UNARY_D(sqrt(a))) \
+    X(Ln,           1, 1, UNARY_D(log(a))) \
+    X(Sin,          1, 1, UNARY_D(sin(a))) \
+    X(SinD,         1, 1, UNARY_D(sin(a * M_PI / 180.0))) \
+    X(ASin,         1, 1, UNARY_D(asin(a))) \
+    X(ASinD,        1, 1, UNARY_D(asin(a * M_PI / 180.0))) \
+    X(Cos,          1, 1, UNARY_D(cos(a))) \
+    X(CosD,         1, 1, UNARY_D(cos(a * M_PI / 180.0))) \
+    X(ACos,         1, 1, UNARY_D(acos(a))) \
+    X(ACosD,        1, 1, UNARY_D(acos(a * M_PI / 180.0))) \
+    X(Tan,          1, 1, UNARY_D(tan(a))) \
+    X(TanD,         1, 1, UNARY_D(tan(a * M_PI / 180.0))) \
+    X(ATan,         1, 1, UNARY_D(atan(a))) \
+    X(ATanD,        1, 1, UNARY_D(atan(a * M_PI / 180.0))) \
+    X(SinH,         1, 1, UNARY_D(sinh(a))) \
+    X(ASinH,        1, 1, UNARY_D(asinh(a))) \
+    X(CosH,         1, 1, UNARY_D(cosh(a))) \
+    X(ACosH,        1, 1, UNARY_D(acosh(a))) \
+    X(TanH,         1, 1, UNARY_D(tanh(a))) \
+    X(ATanH,        1, 1, UNARY_D(atanh(a))) \
+    X(Log10,        1, 1, UNARY_D(log10(a))) \
+    X(Log2,         1, 1, UNARY_D(log2(a))) \
+    X(Fact,         1, 1, UNARY_D(tgamma(a + 1))) \
+    X(FlipB,        1, 1, UNARY_I(ByteFlip(a, FlipBWidth(a)))) \
+    X(FlipW,        1, 1, UNARY_I(WordFlip(a, FlipWWidth(a)))) \
+    X(AddK,         1, 1, CONST_BINARY_D(a + b)) \
+    X(SubK,         1, 1, CONST_BINARY_D(a - b)) \
+    X(MulK,         1, 1, CONST_BINARY_D(a * b)) \
+    X(DivK,         1, 1, CONST_DIVIDE_D()) \
+    X(AddIK,        1, 1, CONST_BINARY_I(a + b)) \
+    X(SubIK,        1, 1, CONST_BINARY_I(a - b)) \
+    X(MulIK,        1, 1, CONST_BINARY_I(a * b)) \
+    X(DivIK,        1, 1, CONST_DIVIDE_I()) \
+    X(Square,       1, 1, UNARY_D(Pow(a, 2.0))) \
+    X(ShiftLeft1,   1, 1, UNARY_I(a << 1)) \
+    X(ShiftRight1,  1, 1, UNARY_I(a >> 1)) \
+    X(RotateLeft1,  1, 1, UNARY_I(RotL64(a, 1))) \
+    X(RotateRight1, 1, 1, UNARY_I(RotR64(a, 1)))
+
+// --- VERIFIER ---
+// Abstract interpretation over stack depth. Control flow is straight-line,
+// so a single pass yields the exact maximum depth, and every opcode's
+// pop/push counts come from the table above. A program that would
+// underflow, overflow or contain a bad opcode is rejected before it runs,
+// which is what lets both cores drop their per-instruction checks.
+static const uint8_t kUDVMPops[UDOpcodeCount] = {
+#define UDVM_POPS(name, in, out, body) [UDOpcode##name] = in,
+    UDVM_OPCODES(UDVM_POPS)
+#undef UDVM_POPS
+};
+static const uint8_t kUDVMPushes[UDOpcodeCount] = {
+#define UDVM_PUSHES(name, in, out, body) [UDOpcode##name] = out,
+    UDVM_OPCODES(UDVM_PUSHES)
+#undef UDVM_PUSHES
+};
+static const BOOL kUDVMKnown[UDOpcodeCount] = {
+#define UDVM_KNOWN(name, in, out, body) [UDOpcode##name] = YES,
+    UDVM_OPCODES(UDVM_KNOWN)
+#undef UDVM_KNOWN
+};
+
+static BOOL UDVMVerify(const UDInsn *code, NSUInteger count, NSUInteger constantCount,
+                       NSUInteger inputCount, NSUInteger *maxDepth, UDValueErrorType *error) {
+    NSUInteger depth = 0, max = 0;
+
+    for (NSUInteger i = 0; i < count; i++) {
+        uint8_t op = code[i].opcode;
+        if (op >= UDOpcodeCount || !kUDVMKnown[op]) {
+            *error = UDValueErrorTypeUnknown;
+            return NO;
+        }
+        // PUSH and the PUSH k; OP superinstructions index the constant pool.
+        BOOL readsConstant = op == UDOpcodePush || (op >= UDOpcodeAddK && op <= UDOpcodeDivIK);
+        if (readsConstant && code[i].operand >= constantCount) {
+            *error = UDValueErrorTypeUnknown;
+            return NO;
+        }
+        if (op == UDOpcodeLoad && code[i].operand >= inputCount) {
+            *error = UDValueErrorTypeUnknown;
+            return NO;
+        }
+        if (depth < kUDVMPops[op]) {
+            *error = UDValueErrorTypeUnderflow;
+            return NO;
+        }
+        depth = depth - kUDVMPops[op] + kUDVMPushes[op];
+        if (depth > MAX_STACK_DEPTH) {
+            *error = UDValueErrorTypeOverflow;
+            return NO;
+        }
+        if (depth > max) max = depth;
+    }
+
+    if (depth < 1) {
+        *error = UDValueErrorTypeUnderflow;
+        return NO;
+    }
+    *maxDepth = max;
+    return YES;
+}
+
+// --- SWITCH CORE ---
+// Walks the packed records in order; PUSH payloads are fetched from the
+// constant pool by index. The program must have been verified: the stack
+// and its wide slots are sized to its proven maximum depth, and nothing
+// is bounds-checked.
+// The result is unboxed on the way out.
+static UDValue UDVMRunSwitch(const UDInsn *code, NSUInteger count, const UDBox *constants,
+                             const unsigned long long *constantWides, const UDValue *inputs,
+                             NSUInteger maxDepth) {
+    UDBox stack[maxDepth];
+    unsigned long long wides[maxDepth];
     int sp = 0;
-    
-    for (UDInstruction *inst in program) {
-        switch (inst.opcode) {
-            case UDOpcodePush:
-                if (sp >= MAX_STACK_DEPTH)
-                    return UDValueMakeError(UDValueErrorTypeOverflow);
-                stack[sp++] = inst.payload;
-                break;
-                
-            case UDOpcodeAdd: {
-                if (sp - 2 < 0)
-                    goto err;
-                double b = UDValueAsDouble(stack[--sp]);
-                double a = UDValueAsDouble(stack[--sp]);
-                stack[sp++] = UDValueMakeDouble(a + b);
-            } break;
-                
-            case UDOpcodeMul: {
-                if (sp - 2 < 0)
-                    goto err;
-                double b = UDValueAsDouble(stack[--sp]);
-                double a = UDValueAsDouble(stack[--sp]);
-                stack[sp++] = UDValueMakeDouble(a * b);
-            } break;
-                
-            case UDOpcodeSub: {
-                if (sp - 2 < 0)
-                    goto err;
-                double b = UDValueAsDouble(stack[--sp]);
-                double a = UDValueAsDouble(stack[--sp]);
-                stack[sp++] = UDValueMakeDouble(a - b);
-            } break;
-                
-            case UDOpcodeDiv: {
-                if (sp - 2 < 0)
-                    goto err;
-                double b = UDValueAsDouble(stack[--sp]);
-                double a = UDValueAsDouble(stack[--sp]);
-                
-                if (b == 0) {
-                    return UDValueMakeError(UDValueErrorTypeDivideByZero);
-                }
-
-                stack[sp++] = UDValueMakeDouble(a / b);
-            } break;
-
-            case UDOpcodeAddI: {
-                if (sp - 2 < 0)
-                    goto err;
-                unsigned long long b = UDValueAsInt(stack[--sp]);
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-                stack[sp++] = UDValueMakeInt(a + b);
-            } break;
-                
-            case UDOpcodeMulI: {
-                if (sp - 2 < 0)
-                    goto err;
-                unsigned long long b = UDValueAsInt(stack[--sp]);
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-                stack[sp++] = UDValueMakeInt(a * b);
-            } break;
-                
-            case UDOpcodeSubI: {
-                if (sp - 2 < 0)
-                    goto err;
-                unsigned long long b = UDValueAsInt(stack[--sp]);
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-                stack[sp++] = UDValueMakeInt(a - b);
-            } break;
-                
-            case UDOpcodeDivI: {
-                if (sp - 2 < 0)
-                    goto err;
-                unsigned long long b = UDValueAsInt(stack[--sp]);
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-
-                if (b == 0) {
-                    return UDValueMakeError(UDValueErrorTypeDivideByZero);
-                }
-
-                stack[sp++] = UDValueMakeInt(a / b);
-            } break;
-                
-            case UDOpcodeNegI: {
-                if (sp - 1 < 0)
-                    goto err;
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeInt(-a);
-            } break;
-                
-            case UDOpcodeBitAnd: {
-                if (sp - 2 < 0)
-                    goto err;
-                unsigned long long b = UDValueAsInt(stack[--sp]);
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-
-                stack[sp++] = UDValueMakeInt(a & b);
-            } break;
-                
-            case UDOpcodeBitOr: {
-                if (sp - 2 < 0)
-                    goto err;
-                unsigned long long b = UDValueAsInt(stack[--sp]);
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-
-                stack[sp++] = UDValueMakeInt(a | b);
-            } break;
-
-            case UDOpcodeBitXor: {
-                if (sp - 2 < 0)
-                    goto err;
-                unsigned long long b = UDValueAsInt(stack[--sp]);
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-
-                stack[sp++] = UDValueMakeInt(a ^ b);
-            } break;
-
-            case UDOpcodeBitNot: {
-                if (sp - 1 < 0)
-                    goto err;
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-
-                stack[sp++] = UDValueMakeInt(~a);
-            } break;
-
-            case UDOpcodeShiftLeft: {
-                if (sp - 2 < 0)
-                    goto err;
-                unsigned long long b = UDValueAsInt(stack[--sp]);
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-
-                stack[sp++] = UDValueMakeInt(a << b);
-            } break;
-            
-            case UDOpcodeShiftRight: {
-                if (sp - 2 < 0)
-                    goto err;
-                unsigned long long b = UDValueAsInt(stack[--sp]);
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-
-                stack[sp++] = UDValueMakeInt(a >> b);
-            } break;
-            
-            case UDOpcodeRotateLeft: {
-                if (sp - 1 < 0)
-                    goto err;
-                unsigned long long b = UDValueAsInt(stack[--sp]);
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-
-                stack[sp++] = UDValueMakeInt(RotL64(a, (int)b));
-            } break;
-
-            case UDOpcodeRotateRight: {
-                if (sp - 1 < 0)
-                    goto err;
-                unsigned long long b = UDValueAsInt(stack[--sp]);
-                unsigned long long a = UDValueAsInt(stack[--sp]);
-
-                stack[sp++] = UDValueMakeInt(RotR64(a, (int)b));
-            } break;
-
-            case UDOpcodePow: {
-                if (sp - 2 < 0)
-                    goto err;
-                
-                double power = UDValueAsDouble(stack[--sp]);
-                double base  = UDValueAsDouble(stack[--sp]);
-
-                stack[sp++] = UDValueMakeDouble(Pow(base, power));
-            } break;
-
-            case UDOpcodeSqrt: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(sqrt(val));
-            } break;
-
-            case UDOpcodeLn: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(log(val));
-            } break;
-
-            case UDOpcodeSin: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(sin(val));
-            } break;
-
-            case UDOpcodeSinD: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(sin(val * M_PI / 180.0));
-            } break;
-
-            case UDOpcodeASin: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(asin(val));
-            } break;
-
-            case UDOpcodeASinD: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(asin(val * M_PI / 180.0));
-            } break;
-
-            case UDOpcodeCos: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(cos(val));
-            } break;
-
-            case UDOpcodeCosD: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(cos(val * M_PI / 180.0));
-            } break;
-
-            case UDOpcodeACos: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(acos(val));
-            } break;
-
-            case UDOpcodeACosD: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(acos(val * M_PI / 180.0));
-            } break;
-
-            case UDOpcodeTan: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(tan(val));
-            } break;
-
-            case UDOpcodeTanD: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(tan(val * M_PI / 180.0));
-            } break;
-
-            case UDOpcodeATan: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(atan(val));
-            } break;
-
-            case UDOpcodeATanD: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(atan(val * M_PI / 180.0));
-            } break;
-
-            case UDOpcodeSinH: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(sinh(val));
-            } break;
-
-            case UDOpcodeASinH: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(asinh(val));
-            } break;
-
-            case UDOpcodeCosH: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(cosh(val));
-            } break;
-
-            case UDOpcodeACosH: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(acosh(val));
-            } break;
-
-            case UDOpcodeTanH: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(tanh(val));
-            } break;
-
-            case UDOpcodeATanH: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(atanh(val));
-            } break;
-
-            case UDOpcodeLog10: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(log10(val));
-            } break;
-
-            case UDOpcodeLog2: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(log2(val));
-            } break;
-
-            case UDOpcodeFact: {
-                if (sp - 1 < 0)
-                    goto err;
-
-                double val = UDValueAsDouble(stack[--sp]);
-                
-                stack[sp++] = UDValueMakeDouble(tgamma(val + 1));
-            } break;
-
-            case UDOpcodeFlipB: {
-                if (sp - 1 < 0) goto err;
-                                
-                unsigned long long val = UDValueAsInt(stack[--sp]);
-
-                // Heuristic: Guess size based on magnitude
-                int width = 64;
-                if (val <= 0xFF) width = 8;
-                else if (val <= 0xFFFF) width = 16;
-                else if (val <= 0xFFFFFFFF) width = 32;
-                
-                stack[sp++] = UDValueMakeInt(ByteFlip(val, width));
-
-            } break;
-
-            case UDOpcodeFlipW: {
-                if (sp - 1 < 0) goto err;
-
-                unsigned long long val = UDValueAsInt(stack[--sp]);
-                int width = 64;
-                if (val <= 0xFFFF) width = 16;
-                else if (val <= 0xFFFFFFFF) width = 32;
-                
-                stack[sp++] = UDValueMakeInt(WordFlip(val, width));
-            } break;
 
+    for (const UDInsn *ip = code, *end = code + count; ip < end; ip++) {
+        switch ((UDOpcode)ip->opcode) {
+#define UDVM_CASE(name, in, out, body) case UDOpcode##name: body break;
+            UDVM_OPCODES(UDVM_CASE)
+#undef UDVM_CASE
             default: break;
         }
     }
-    
-    return stack[--sp];
 
-err:
-    return UDValueMakeError(UDValueErrorTypeUnderflow);
+    return UDBoxToValue(stack[sp - 1], wides);
+}
+
+// --- THREADED CORE ---
+// Computed-goto dispatch over the superinstruction form of a program.
+// Every handler ends in its own indirect jump, and the HALT sentinel
+// replaces the end-of-program bounds check. Same verification contract
+// as the switch core.
+#if defined(__GNUC__)
+#define UDVM_HAS_THREADED_DISPATCH 1
+
+static UDValue UDVMRunThreaded(const UDInsn *code, const UDBox *constants,
+                               const unsigned long long *constantWides, const UDValue *inputs,
+                               NSUInteger maxDepth) {
+    static const void *const handlers[UDOpcodeCount] = {
+#define UDVM_LABEL(name, in, out, body) [UDOpcode##name] = &&op_##name,
+        UDVM_OPCODES(UDVM_LABEL)
+#undef UDVM_LABEL
+        [UDOpcodeHalt] = &&op_Halt,
+    };
+
+    UDBox stack[maxDepth];
+    unsigned long long wides[maxDepth];
+    int sp = 0;
+    const UDInsn *ip = code;
+
+    goto *handlers[ip->opcode];
+
+#define UDVM_HANDLER(name, in, out, body) op_##name: body goto *handlers[(++ip)->opcode];
+    UDVM_OPCODES(UDVM_HANDLER)
+#undef UDVM_HANDLER
+
+op_Halt:
+    return UDBoxToValue(stack[sp - 1], wides);
+}
+#endif
+
+// --- LANE CORE ---
+// Batch execution over input columns. The program runs one opcode at a
+// time over a block of rows: every stack slot is a row of UDVM_LANES
+// values, so each opcode body becomes a plain loop over arrays that the
+// compiler can vectorize. The opcode table is expanded once more, with
+// the body macros redefined to work on rows.
+//
+// A stack row holds doubles or integers as a whole, since every opcode
+// produces one type whatever the row. A row is converted in place when an
+// opcode wants the other type, as UDValueAsDouble/UDValueAsInt do for a
+// single value. Errors are tracked per lane: the first one a lane hits is
+// its result, and the other lanes carry on. An error constant is pushed as
+// a row of its code, as the scalar cores push its box: an opcode reads
+// the code as a number, and only a run that ends on it fails.
+#define UDVM_LANES 256
+
+typedef union {
+    double d[UDVM_LANES];
+    unsigned long long i[UDVM_LANES];
+} UDVMLaneRow;
+
+static inline double *UDVMLanesAsDouble(UDVMLaneRow *row, uint8_t *type, int n) {
+    if (*type != UDValueTypeDouble) {
+        for (int l = 0; l < n; l++) row->d[l] = (double)row->i[l];
+        *type = UDValueTypeDouble;
+    }
+    return row->d;
+}
+
+static inline unsigned long long *UDVMLanesAsInt(UDVMLaneRow *row, uint8_t *type, int n) {
+    if (*type == UDValueTypeDouble) {
+        for (int l = 0; l < n; l++) row->i[l] = (unsigned long long)row->d[l];
+    }
+    *type = UDValueTypeInteger;
+    return row->i;
+}
+
+// A lane's error slot holds 0, or 1 + the UDValueErrorType it hit first.
+static inline void UDVMLanesFail(uint8_t *errors, int n, UDValueErrorType error) {
+    for (int l = 0; l < n; l++) errors[l] = errors[l] ? errors[l] : (uint8_t)(1 + error);
+}
+
+#undef BINARY_D
+#undef BINARY_I
+#undef UNARY_D
+#undef UNARY_I
+#undef CONST_BINARY_D
+#undef CONST_BINARY_I
+#undef PUSH_CONST
+#undef PUSH_INPUT
+#undef DIVIDE_D
+#undef DIVIDE_I
+#undef CONST_DIVIDE_D
+#undef CONST_DIVIDE_I
+#undef CONST_D
+#undef CONST_I
+#undef FAIL
+
+#define CONST_D()       UDBoxAsDouble(constants[ip->operand], constantWides)
+#define CONST_I()       UDBoxAsInt(constants[ip->operand], constantWides)
+
+// Row k from the top, as doubles or integers.
+#define LANES_D(k)      UDVMLanesAsDouble(&rows[sp - (k)], &types[sp - (k)], n)
+#define LANES_I(k)      UDVMLanesAsInt(&rows[sp - (k)], &types[sp - (k)], n)
+
+#define BINARY_D(expr) { \
+    double *restrict x = LANES_D(2); const double *restrict y = LANES_D(1); \
+    for (int l = 0; l < n; l++) { double a = x[l], b = y[l]; x[l] = (expr); } \
+    sp--; \
+}
+#define BINARY_I(expr) { \
+    unsigned long long *restrict x = LANES_I(2); const unsigned long long *restrict y = LANES_I(1); \
+    for (int l = 0; l < n; l++) { unsigned long long a = x[l], b = y[l]; x[l] = (expr); } \
+    sp--; \
+}
+#define UNARY_D(expr) { \
+    double *restrict x = LANES_D(1); \
+    for (int l = 0; l < n; l++) { double a = x[l]; x[l] = (expr); } \
+}
+#define UNARY_I(expr) { \
+    unsigned long long *restrict x = LANES_I(1); \
+    for (int l = 0; l < n; l++) { unsigned long long a = x[l]; x[l] = (expr); } \
+}
+#define CONST_BINARY_D(expr) { \
+    const double b = CONST_D(); double *restrict x = LANES_D(1); \
+    for (int l = 0; l < n; l++) { double a = x[l]; x[l] = (expr); } \
+}
+#define CONST_BINARY_I(expr) { \
+    const unsigned long long b = CONST_I(); unsigned long long *restrict x = LANES_I(1); \
+    for (int l = 0; l < n; l++) { unsigned long long a = x[l]; x[l] = (expr); } \
+}
+#define PUSH_CONST() { \
+    UDValue k = UDBoxToValue(constants[ip->operand], constantWides); \
+    if (k.type == UDValueTypeDouble) { for (int l = 0; l < n; l++) rows[sp].d[l] = k.v.doubleValue; } \
+    else { for (int l = 0; l < n; l++) rows[sp].i[l] = k.v.intValue; } \
+    types[sp++] = (uint8_t)k.type; \
+}
+#define PUSH_INPUT() { \
+    const UDVMColumn *c = &columns[ip->operand]; \
+    memcpy(rows[sp].i, (const char *)c->values + row * sizeof(uint64_t), (size_t)n * sizeof(uint64_t)); \
+    types[sp++] = (uint8_t)c->type; \
+}
+
+// The quotient is computed for every lane (by 1 instead of 0 for
+// integers, which would trap); lanes with a zero divisor are marked.
+#define DIVIDE_D() { \
+    double *restrict x = LANES_D(2); const double *restrict y = LANES_D(1); \
+    for (int l = 0; l < n; l++) { \
+        double b = y[l]; \
+        x[l] = x[l] / b; \
+        errors[l] = errors[l] ? errors[l] : (uint8_t)((b == 0) * (1 + UDValueErrorTypeDivideByZero)); \
+    } \
+    sp--; \
+}
+#define DIVIDE_I() { \
+    unsigned long long *restrict x = LANES_I(2); const unsigned long long *restrict y = LANES_I(1); \
+    for (int l = 0; l < n; l++) { \
+        unsigned long long b = y[l]; \
+        x[l] = x[l] / (b ? b : 1); \
+        errors[l] = errors[l] ? errors[l] : (uint8_t)((b == 0) * (1 + UDValueErrorTypeDivideByZero)); \
+    } \
+    sp--; \
 }
+#define CONST_DIVIDE_D() { \
+    const double b = CONST_D(); double *restrict x = LANES_D(1); \
+    if (b == 0) UDVMLanesFail(errors, n, UDValueErrorTypeDivideByZero); \
+    for (int l = 0; l < n; l++) x[l] = x[l] / b; \
+}
+#define CONST_DIVIDE_I() { \
+    const unsigned long long b = CONST_I(); unsigned long long *restrict x = LANES_I(1); \
+    if (b == 0) UDVMLanesFail(errors, n, UDValueErrorTypeDivideByZero); \
+    else { for (int l = 0; l < n; l++) x[l] = x[l] / b; } \
+}
+
+static void UDVMRunLanes(const UDInsn *code, NSUInteger count, const UDBox *constants,
+                         const unsigned long long *constantWides, const UDVMColumn *columns, NSUInteger rowCount, NSUInteger maxDepth,
+                         UDValue *results) {
+    UDVMLaneRow *rows = malloc(maxDepth * sizeof(UDVMLaneRow));
+    uint8_t types[maxDepth];        // UDValueType of each stack row
+    uint8_t errors[UDVM_LANES];
+
+    for (NSUInteger row = 0; row < rowCount; row += UDVM_LANES) {
+        int n = (int)MIN((NSUInteger)UDVM_LANES, rowCount - row);
+        int sp = 0;
+        memset(errors, 0, sizeof(errors));
+
+        for (const UDInsn *ip = code, *end = code + count; ip < end; ip++) {
+            switch ((UDOpcode)ip->opcode) {
+#define UDVM_LANE_CASE(name, in, out, body) case UDOpcode##name: body break;
+                UDVM_OPCODES(UDVM_LANE_CASE)
+#undef UDVM_LANE_CASE
+                default: break;
+            }
+        }
 
+        const UDVMLaneRow *top = &rows[sp - 1];
+        uint8_t type = types[sp - 1];
+        for (int l = 0; l < n; l++) {
+            results[row + l] = errors[l] ? UDValueMakeError((UDValueErrorType)(errors[l] - 1))
+                             : type == UDValueTypeDouble ? UDValueMakeDouble(top->d[l])
+                             : type == UDValueTypeErr ? UDValueMakeError((UDValueErrorType)top->i[l])
+                             : UDValueMakeInt(top->i[l]);
+        }
+    }
+
+    free(rows);
+}
+
+#undef LANES_D
+#undef LANES_I
+
+// Rewrites PUSH k; OP pairs into single superinstructions and appends
+// the HALT sentinel. UDOpcodeHalt means "no fusion for this pair".
+static UDOpcode UDVMSuperinstruction(UDOpcode op, UDValue k) {
+    if (k.type == UDValueTypeErr) return UDOpcodeHalt;
+
+    switch (op) {
+        case UDOpcodeAdd:  return UDOpcodeAddK;
+        case UDOpcodeSub:  return UDOpcodeSubK;
+        case UDOpcodeMul:  return UDOpcodeMulK;
+        case UDOpcodeDiv:  return UDOpcodeDivK;   // includes the percent rewrite, PUSH 100; DIV
+        case UDOpcodeAddI: return UDOpcodeAddIK;
+        case UDOpcodeSubI: return UDOpcodeSubIK;
+        case UDOpcodeMulI: return UDOpcodeMulIK;
+        case UDOpcodeDivI: return UDOpcodeDivIK;
+        case UDOpcodePow:
+            return UDValueAsDouble(k) == 2.0 ? UDOpcodeSquare : UDOpcodeHalt;
+        case UDOpcodeShiftLeft:
+            return UDValueAsInt(k) == 1 ? UDOpcodeShiftLeft1 : UDOpcodeHalt;
+        case UDOpcodeShiftRight:
+            return UDValueAsInt(k) == 1 ? UDOpcodeShiftRight1 : UDOpcodeHalt;
+        case UDOpcodeRotateLeft:
+            return UDValueAsInt(k) == 1 ? UDOpcodeRotateLeft1 : UDOpcodeHalt;
+        case UDOpcodeRotateRight:
+            return UDValueAsInt(k) == 1 ? UDOpcodeRotateRight1 : UDOpcodeHalt;
+        default:
+            return UDOpcodeHalt;
+    }
+}
+
+static UDProgram *UDVMFuse(UDProgram *program) {
+    const UDInsn *code = program.code;
+    NSUInteger n = program.count;
+
+    UDProgram *fused = [UDProgram programWithCapacity:n + 1];
+    for (NSUInteger i = 0; i < n; i++) {
+        if (code[i].opcode == UDOpcodePush && i + 1 < n) {
+            UDValue k = [program constantAtIndex:code[i].operand];
+            UDOpcode super = UDVMSuperinstruction((UDOpcode)code[i + 1].opcode, k);
+            if (super != UDOpcodeHalt) {
+                [fused emitOp:super constant:k];
+                i++;
+                continue;
+            }
+        }
+        if (code[i].opcode == UDOpcodePush) [fused emitPush:[program constantAtIndex:code[i].operand]];
+        else if (code[i].opcode == UDOpcodeLoad) [fused emitLoad:code[i].operand];
+        else [fused emitOp:(UDOpcode)code[i].opcode];
+    }
+    [fused emitOp:UDOpcodeHalt];
+    return fused;
+}
+
+#ifdef UDVM_HAS_THREADED_DISPATCH
+static UDVMDispatch sDispatch = UDVMDispatchThreaded;
+#else
+static UDVMDispatch sDispatch = UDVMDispatchSwitch;
+#endif
+
+static NSUInteger sJITThreshold = 256;
+
+@implementation UDVM
+
++ (UDVMDispatch)dispatch {
+    return sDispatch;
+}
+
++ (void)setDispatch:(UDVMDispatch)dispatch {
+    sDispatch = dispatch;
+}
+
++ (NSUInteger)jitThreshold {
+    return sJITThreshold;
+}
+
++ (void)setJitThreshold:(NSUInteger)jitThreshold {
+    sJITThreshold = jitThreshold;
+}
+
++ (BOOL)isThreadedDispatchAvailable {
+#ifdef UDVM_HAS_THREADED_DISPATCH
+    return YES;
+#else
+    return NO;
+#endif
+}
+
++ (UDValue)execute:(NSArray<UDInstruction *> *)program {
+    return [self executeProgram:[UDProgram programWithInstructions:program]];
+}
+
++ (UDValue)executeProgram:(UDProgram *)program {
+    return [self executeProgram:program inputs:NULL count:0];
+}
+
++ (NSUInteger)operandCountForOpcode:(UDOpcode)opcode {
+    return opcode < UDOpcodeCount ? kUDVMPops[opcode] : 0;
+}
+
++ (UDValue)applyOpcode:(UDOpcode)opcode operands:(const UDValue *)operands {
+    // Plain single-result opcodes only: PUSH, LOAD and CALL have nothing to
+    // fold, and superinstructions carry their own constant operand.
+    if (opcode == UDOpcodePush || opcode == UDOpcodeLoad || opcode >= UDOpcodeAddK || !kUDVMKnown[opcode] || kUDVMPushes[opcode] != 1) {
+        return UDValueMakeError(UDValueErrorTypeUnknown);
+    }
+
+    NSUInteger n = kUDVMPops[opcode];
+    UDInsn code[3];
+    UDBox constants[2];
+    UDBoxWideTable wides = { NULL, 0, 0 };
+    for (NSUInteger i = 0; i < n; i++) {
+        constants[i] = UDBoxFromValue(operands[i], &wides);
+        code[i] = (UDInsn){ .opcode = UDOpcodePush, .operand = (uint32_t)i };
+    }
+    code[n] = (UDInsn){ .opcode = (uint8_t)opcode };
+
+    UDValue result = UDVMRunSwitch(code, n + 1, constants, wides.values, NULL, n > 0 ? n : 1);
+    UDBoxWideTableFree(&wides);
+    return result;
+}
+
++ (BOOL)foldOpcode:(UDOpcode)opcode operands:(const UDValue *)operands result:(UDValue *)result {
+    UDValue value = [self applyOpcode:opcode operands:operands];
+    if (value.type == UDValueTypeErr) return NO;
+    *result = value;
+    return YES;
+}
+
++ (BOOL)verifyProgram:(UDProgram *)program {
+    if (program.status == UDProgramStatusUnverified) {
+        NSUInteger maxDepth = 0;
+        UDValueErrorType error = UDValueErrorTypeUnknown;
+        if (UDVMVerify(program.code, program.count, program.constantCount, program.inputCount, &maxDepth, &error)) {
+            [program markVerifiedWithMaxStackDepth:maxDepth];
+        } else {
+            [program markRejectedWithError:error];
+        }
+    }
+    return program.status == UDProgramStatusVerified;
+}
+
++ (UDValue)executeProgram:(UDProgram *)program dispatch:(UDVMDispatch)dispatch {
+    return [self executeProgram:program inputs:NULL count:0 dispatch:dispatch];
+}
+
+// Tiering: interpreted until hot, then native if UDJIT can translate it.
++ (UDValue)executeProgram:(UDProgram *)program inputs:(const UDValue *)inputs count:(NSUInteger)count {
+    UDJITCode *native = program.nativeForm;
+    if (native && count >= program.inputCount) return [native runWithInputs:inputs];
+
+    if (sJITThreshold > 0 && [program noteExecution] == sJITThreshold) {
+        [self nativeFormOfProgram:program];
+    }
+    return [self executeProgram:program inputs:inputs count:count dispatch:sDispatch];
+}
+
++ (UDJITCode *)nativeFormOfProgram:(UDProgram *)program {
+    UDJITCode *native = program.nativeForm;
+    if (native || program.nativeRejected || !UDJIT.enabled) return native;
+
+    native = [UDJIT compileProgram:program];
+    if (native) program.nativeForm = native;
+    else program.nativeRejected = YES;
+    return native;
+}
+
++ (UDValue)executeProgram:(UDProgram *)program inputs:(const UDValue *)inputs count:(NSUInteger)count
+                 dispatch:(UDVMDispatch)dispatch {
+    if (![self verifyProgram:program]) {
+        return UDValueMakeError(program.rejectionError);
+    }
+    // A program reading an input nobody supplied has nothing to run on
+    if (count < program.inputCount) {
+        return UDValueMakeError(UDValueErrorTypeUnknown);
+    }
+    if (dispatch == UDVMDispatchNative) {
+        UDJITCode *native = [self nativeFormOfProgram:program];
+        if (native) return [native runWithInputs:inputs];
+        dispatch = UDVMDispatchSwitch;
+    }
+
+    NSUInteger maxDepth = program.maxStackDepth;
+#ifdef UDVM_HAS_THREADED_DISPATCH
+    if (dispatch == UDVMDispatchThreaded) {
+        UDProgram *threaded = program.threadedForm;
+        if (!threaded) {
+            // Fusion only ever shrinks the stack, so the depth proven for
+            // the source program bounds the fused one too.
+            threaded = UDVMFuse(program);
+            program.threadedForm = threaded;
+        }
+        return UDVMRunThreaded(threaded.code, threaded.constants, threaded.wideConstants, inputs, maxDepth);
+    }
+#endif
+    return UDVMRunSwitch(program.code, program.count, program.constants, program.wideConstants, inputs, maxDepth);
+}
+
++ (void)executeProgram:(UDProgram *)program
+               columns:(const UDVMColumn *)columns
+           columnCount:(NSUInteger)columnCount
+                 count:(NSUInteger)count
+               results:(UDValue *)results {
+    UDValueErrorType error = UDValueErrorTypeUnknown;
+    BOOL runnable = [self verifyProgram:program];
+    if (!runnable) error = program.rejectionError;
+    if (columnCount < program.inputCount) runnable = NO;
+    for (NSUInteger i = 0; i < columnCount && runnable; i++) {
+        if (columns[i].type != UDValueTypeDouble && columns[i].type != UDValueTypeInteger) runnable = NO;
+    }
+
+    if (!runnable) {
+        for (NSUInteger r = 0; r < count; r++) results[r] = UDValueMakeError(error);
+        return;
+    }
+    if (count == 0) return;
+    UDVMRunLanes(program.code, program.count, program.constants, program.wideConstants,
+                 columns, count, program.maxStackDepth, results);
+}
 
 @end
@@ -0,0 +1,139 @@
+//
+//  UDValueBox.h
+//  Calculator
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import "UDValue.h"
+#include <stdlib.h>
+#include <string.h>
+
+// The VM's internal 8-byte encoding of a UDValue, NaN-boxed.
+//
+// A double is stored as its own bits. Everything else lives in the
+// negative quiet-NaN space, with the top 16 bits as the tag and the low
+// 48 bits as the payload:
+//
+//   FFF9 | error code
+//   FFFA | integer below 2^48
+//   FFFB | wide integer, index into its owner's UDBoxWideTable
+//
+// NaNs are canonicalized when a UDValue is boxed, so a tag pattern never
+// comes in from outside, and the hardware only ever produces NaNs with
+// an empty payload (or propagates a canonical one). Arithmetic results
+// are therefore stored without a check.
+//
+// A wide integer does not fit the payload. Its 64-bit value goes into a
+// side table owned by whoever holds the box and the box carries its
+// index. A program's constant pool grows a UDBoxWideTable, which starts
+// empty and only allocates for the first one. A VM run instead has one
+// fixed slot per stack index, sized from the program's maximum depth
+// before the first instruction: a box never moves once pushed, so the
+// wide box at stack index k lives in slot k and running never allocates.
+typedef uint64_t UDBox;
+
+#define UDBOX_TAG_ERROR     0xFFF9000000000000ULL
+#define UDBOX_TAG_INTEGER   0xFFFA000000000000ULL
+#define UDBOX_TAG_WIDE      0xFFFB000000000000ULL
+#define UDBOX_TAG_MASK      0xFFFF000000000000ULL
+#define UDBOX_PAYLOAD_MASK  0x0000FFFFFFFFFFFFULL
+#define UDBOX_CANONICAL_NAN 0x7FF8000000000000ULL
+
+static inline BOOL UDBoxIsDouble(UDBox b) {
+    return b < UDBOX_TAG_ERROR;
+}
+
+static inline BOOL UDBoxIsWide(UDBox b) {
+    return (b & UDBOX_TAG_MASK) == UDBOX_TAG_WIDE;
+}
+
+// Wide integers by index. A zeroed table is empty and owns no memory.
+typedef struct {
+    unsigned long long *values;
+    NSUInteger count;
+    NSUInteger capacity;
+} UDBoxWideTable;
+
+// Times a UDBoxWideTable grew on the calling thread. For tests: a VM run
+// must leave it unchanged.
+extern __thread NSUInteger UDBoxWideTableAllocations;
+
+static inline UDBox UDBoxWideTableAdd(UDBoxWideTable *table, unsigned long long i) {
+    if (table->count == table->capacity) {
+        UDBoxWideTableAllocations++;
+        table->capacity = table->capacity ? table->capacity * 2 : 8;
+        table->values = realloc(table->values, table->capacity * sizeof(unsigned long long));
+    }
+    table->values[table->count] = i;
+    return UDBOX_TAG_WIDE | table->count++;
+}
+
+static inline void UDBoxWideTableFree(UDBoxWideTable *table) {
+    free(table->values);
+    *table = (UDBoxWideTable){ NULL, 0, 0 };
+}
+
+static inline UDBox UDBoxMakeDouble(double d) {
+    UDBox b;
+    memcpy(&b, &d, sizeof(b));
+    return b;
+}
+
+static inline UDBox UDBoxMakeInt(unsigned long long i, UDBoxWideTable *wides) {
+    if (i <= UDBOX_PAYLOAD_MASK) return UDBOX_TAG_INTEGER | i;
+    return UDBoxWideTableAdd(wides, i);
+}
+
+// As UDBoxMakeInt, into the fixed slot of a VM run's stack index.
+static inline UDBox UDBoxMakeIntInSlot(unsigned long long i, unsigned long long *wides, NSUInteger slot) {
+    if (i <= UDBOX_PAYLOAD_MASK) return UDBOX_TAG_INTEGER | i;
+    wides[slot] = i;
+    return UDBOX_TAG_WIDE | slot;
+}
+
+// Same conversions as UDValueAsDouble and UDValueAsInt. wides is the
+// values of the box's table, only read for a wide integer.
+static inline double UDBoxAsDouble(UDBox b, const unsigned long long *wides) {
+    if (UDBoxIsDouble(b)) {
+        double d;
+        memcpy(&d, &b, sizeof(d));
+        return d;
+    }
+    return (double)(UDBoxIsWide(b) ? wides[b & UDBOX_PAYLOAD_MASK] : (b & UDBOX_PAYLOAD_MASK));
+}
+
+static inline unsigned long long UDBoxAsInt(UDBox b, const unsigned long long *wides) {
+    if (UDBoxIsDouble(b)) {
+        double d;
+        memcpy(&d, &b, sizeof(d));
+        return (unsigned long long)d; // Truncate
+    }
+    return UDBoxIsWide(b) ? wides[b & UDBOX_PAYLOAD_MASK] : (b & UDBOX_PAYLOAD_MASK);
+}
+
+// API boundary, both ways.
+static inline UDBox UDBoxFromValue(UDValue v, UDBoxWideTable *wides) {
+    switch (v.type) {
+        case UDValueTypeDouble:
+            return v.v.doubleValue != v.v.doubleValue ? UDBOX_CANONICAL_NAN : UDBoxMakeDouble(v.v.doubleValue);
+        case UDValueTypeInteger:
+            return UDBoxMakeInt(v.v.intValue, wides);
+        default:
+            return UDBOX_TAG_ERROR | (v.v.intValue & UDBOX_PAYLOAD_MASK);
+    }
+}
+
+static inline UDBox UDBoxFromValueInSlot(UDValue v, unsigned long long *wides, NSUInteger slot) {
+    if (v.type == UDValueTypeInteger) return UDBoxMakeIntInSlot(v.v.intValue, wides, slot);
+    return UDBoxFromValue(v, NULL);
+}
+
+static inline UDValue UDBoxToValue(UDBox b, const unsigned long long *wides) {
+    if (UDBoxIsDouble(b)) return UDValueMakeDouble(UDBoxAsDouble(b, wides));
+    switch (b & UDBOX_TAG_MASK) {
+        case UDBOX_TAG_ERROR:   return UDValueMakeError((UDValueErrorType)(b & UDBOX_PAYLOAD_MASK));
+        case UDBOX_TAG_INTEGER: return UDValueMakeInt(b & UDBOX_PAYLOAD_MASK);
+        default:                return UDValueMakeInt(wides[b & UDBOX_PAYLOAD_MASK]);
+    }
+}
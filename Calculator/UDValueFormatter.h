@@ -9,6 +9,26 @@
 #import "UDValue.h" // Needs access to your Tagged Union
 #import "UDInputBuffer.h" // Needs access to UDBase enum
 
+// Allocation-free formatting core. Each function writes a NUL-terminated
+// UTF-8 string into buf and returns its length, or 0 (and an empty
+// string) if it does not fit in size bytes. UDFormatBufferSize always
+// fits.
+//
+// Doubles print from their shortest round-trip digits, rounded half to
+// even like NSNumberFormatter. The locale's separators and symbols are
+// looked up once, on first use. Reentrant: that lookup is the only
+// shared state, and it is read-only afterwards.
+#define UDFormatBufferSize 1024
+
+// What stringForValue: prints
+size_t UDFormatValue(char *buf, size_t size, UDValue value, UDBase base, BOOL showThousandsSeparators,
+                     NSInteger decimalPlaces, BOOL forceScientific);
+size_t UDFormatLong(char *buf, size_t size, unsigned long long value, UDBase base, BOOL showThousandsSeparators);
+// Plain decimal notation at any magnitude, at most maxFractionDigits decimals
+size_t UDFormatDecimal(char *buf, size_t size, double value, BOOL showThousandsSeparators,
+                       NSInteger maxFractionDigits);
+
+// NSString at the edge: the same, with one string allocated per call.
 @interface UDValueFormatter : NSObject
 
 // Main method: Converts a UDValue to a string in the given base
@@ -23,4 +43,8 @@
                        base:(UDBase)base
     showThousandsSeparators:(BOOL)showThousandsSeparators;
 
++ (NSString *)stringForDecimal:(double)value
+       showThousandsSeparators:(BOOL)showThousandsSeparators
+         maximumFractionDigits:(NSInteger)digits;
+
 @end
@@ -6,126 +6,494 @@
 //
 
 #import "UDValueFormatter.h"
+#include <stdio.h>
+#include <string.h>
 
-@implementation UDValueFormatter
+// --- LOCALE ---
+// The current locale's symbols, as UTF-8. Resolved from one
+// NSNumberFormatter on first use and only read after that.
+typedef struct {
+    char decimal[8];
+    char grouping[8];
+    char minus[8];
+    char nan[16];
+    char positiveInfinity[16];
+    char negativeInfinity[16];
+    int groupingSize;
+    int secondaryGroupingSize;
+} UDFormatSymbols;
 
-+ (NSString *)stringForValue:(UDValue)val base:(UDBase)base showThousandsSeparators:(BOOL)showThousandsSeparators decimalPlaces:(NSInteger)places forceScientific:(BOOL)forceScientific {
-    // 1. Handle Errors
-    if (val.type == UDValueTypeErr) {
-        return @"Error";
+static void UDCopySymbol(char *dst, size_t size, NSString *symbol, const char *fallback) {
+    if (!symbol.length || ![symbol getCString:dst maxLength:size encoding:NSUTF8StringEncoding]) {
+        strncpy(dst, fallback, size - 1);
+        dst[size - 1] = '\0';
     }
+}
 
-    // 2. Handle Doubles (Scientific Mode)
-    // Doubles ignore the 'base' and always print as Decimal
-    if (val.type == UDValueTypeDouble) {
-        double dbl = val.v.doubleValue;
-        double absDbl = fabs(dbl);
-        
+static const UDFormatSymbols *UDFormatCurrentSymbols(void) {
+    static UDFormatSymbols symbols;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
         NSNumberFormatter *fmt = [[NSNumberFormatter alloc] init];
-        fmt.usesGroupingSeparator = showThousandsSeparators;
-        fmt.minimumFractionDigits = 0;
-        
-        // Threshold check: Should we use Scientific Notation?
-        // Apple usually flips to scientific for numbers >= 1 billion
-        // or smaller than 0.001 (excluding zero).
-        BOOL useScientific = forceScientific || (absDbl >= 1e10 || (absDbl < 1e-4 && absDbl > 0));
-
-        if (useScientific) {
-            fmt.numberStyle = NSNumberFormatterScientificStyle;
-            fmt.positiveFormat = @"0.######E0";
-            fmt.exponentSymbol = @" e ";
+        fmt.numberStyle = NSNumberFormatterDecimalStyle;
+        UDCopySymbol(symbols.decimal, sizeof(symbols.decimal), fmt.decimalSeparator, ".");
+        UDCopySymbol(symbols.grouping, sizeof(symbols.grouping), fmt.groupingSeparator, ",");
+        UDCopySymbol(symbols.minus, sizeof(symbols.minus), fmt.minusSign, "-");
+        UDCopySymbol(symbols.nan, sizeof(symbols.nan), fmt.notANumberSymbol, "NaN");
+        UDCopySymbol(symbols.positiveInfinity, sizeof(symbols.positiveInfinity), fmt.positiveInfinitySymbol, "\u221E");
+        UDCopySymbol(symbols.negativeInfinity, sizeof(symbols.negativeInfinity), fmt.negativeInfinitySymbol, "-\u221E");
+        symbols.groupingSize = fmt.groupingSize > 0 ? (int)fmt.groupingSize : 3;
+        symbols.secondaryGroupingSize = fmt.secondaryGroupingSize > 0 ? (int)fmt.secondaryGroupingSize : symbols.groupingSize;
+    });
+    return &symbols;
+}
+
+// --- OUTPUT ---
+// Bounded writer over the caller's buffer. Running out of room is
+// recorded rather than checked at every call site.
+typedef struct {
+    char *p, *end;
+    BOOL overflow;
+} UDFormatWriter;
+
+static inline void UDPutChar(UDFormatWriter *w, char c) {
+    if (w->p < w->end) *w->p++ = c;
+    else w->overflow = YES;
+}
+
+static inline void UDPutString(UDFormatWriter *w, const char *s) {
+    while (*s) UDPutChar(w, *s++);
+}
+
+static size_t UDFinish(UDFormatWriter *w, char *buf, size_t size) {
+    if (size == 0) return 0;
+    if (w->overflow || w->p >= buf + size) {
+        buf[0] = '\0';
+        return 0;
+    }
+    *w->p = '\0';
+    return (size_t)(w->p - buf);
+}
+
+// --- SHORTEST DIGITS ---
+// Grisu3 (Loitsch, "Printing Floating-Point Numbers Quickly and
+// Accurately with Integers"): shortest digits that read back as the same
+// double, closest to it among those, with 64-bit integer arithmetic.
+// For the ~0.5% of doubles where it cannot prove its answer it says so,
+// and the digits are found by trying precisions with snprintf/strtod
+// instead. Neither path allocates.
+typedef struct {
+    uint64_t f;
+    int e;
+} UDDiyFp;
+
+static const struct { uint64_t f; int16_t e; } kUDCachedPowers[] = {
+    { 0xFA8FD5A0081C0288ULL, -1220 }, { 0xBAAEE17FA23EBF76ULL, -1193 }, { 0x8B16FB203055AC76ULL, -1166 },
+    { 0xCF42894A5DCE35EAULL, -1140 }, { 0x9A6BB0AA55653B2DULL, -1113 }, { 0xE61ACF033D1A45DFULL, -1087 },
+    { 0xAB70FE17C79AC6CAULL, -1060 }, { 0xFF77B1FCBEBCDC4FULL, -1034 }, { 0xBE5691EF416BD60CULL, -1007 },
+    { 0x8DD01FAD907FFC3CULL,  -980 }, { 0xD3515C2831559A83ULL,  -954 }, { 0x9D71AC8FADA6C9B5ULL,  -927 },
+    { 0xEA9C227723EE8BCBULL,  -901 }, { 0xAECC49914078536DULL,  -874 }, { 0x823C12795DB6CE57ULL,  -847 },
+    { 0xC21094364DFB5637ULL,  -821 }, { 0x9096EA6F3848984FULL,  -794 }, { 0xD77485CB25823AC7ULL,  -768 },
+    { 0xA086CFCD97BF97F4ULL,  -741 }, { 0xEF340A98172AACE5ULL,  -715 }, { 0xB23867FB2A35B28EULL,  -688 },
+    { 0x84C8D4DFD2C63F3BULL,  -661 }, { 0xC5DD44271AD3CDBAULL,  -635 }, { 0x936B9FCEBB25C996ULL,  -608 },
+    { 0xDBAC6C247D62A584ULL,  -582 }, { 0xA3AB66580D5FDAF6ULL,  -555 }, { 0xF3E2F893DEC3F126ULL,  -529 },
+    { 0xB5B5ADA8AAFF80B8ULL,  -502 }, { 0x87625F056C7C4A8BULL,  -475 }, { 0xC9BCFF6034C13053ULL,  -449 },
+    { 0x964E858C91BA2655ULL,  -422 }, { 0xDFF9772470297EBDULL,  -396 }, { 0xA6DFBD9FB8E5B88FULL,  -369 },
+    { 0xF8A95FCF88747D94ULL,  -343 }, { 0xB94470938FA89BCFULL,  -316 }, { 0x8A08F0F8BF0F156BULL,  -289 },
+    { 0xCDB02555653131B6ULL,  -263 }, { 0x993FE2C6D07B7FACULL,  -236 }, { 0xE45C10C42A2B3B06ULL,  -210 },
+    { 0xAA242499697392D3ULL,  -183 }, { 0xFD87B5F28300CA0EULL,  -157 }, { 0xBCE5086492111AEBULL,  -130 },
+    { 0x8CBCCC096F5088CCULL,  -103 }, { 0xD1B71758E219652CULL,   -77 }, { 0x9C40000000000000ULL,   -50 },
+    { 0xE8D4A51000000000ULL,   -24 }, { 0xAD78EBC5AC620000ULL,     3 }, { 0x813F3978F8940984ULL,    30 },
+    { 0xC097CE7BC90715B3ULL,    56 }, { 0x8F7E32CE7BEA5C70ULL,    83 }, { 0xD5D238A4ABE98068ULL,   109 },
+    { 0x9F4F2726179A2245ULL,   136 }, { 0xED63A231D4C4FB27ULL,   162 }, { 0xB0DE65388CC8ADA8ULL,   189 },
+    { 0x83C7088E1AAB65DBULL,   216 }, { 0xC45D1DF942711D9AULL,   242 }, { 0x924D692CA61BE758ULL,   269 },
+    { 0xDA01EE641A708DEAULL,   295 }, { 0xA26DA3999AEF774AULL,   322 }, { 0xF209787BB47D6B85ULL,   348 },
+    { 0xB454E4A179DD1877ULL,   375 }, { 0x865B86925B9BC5C2ULL,   402 }, { 0xC83553C5C8965D3DULL,   428 },
+    { 0x952AB45CFA97A0B3ULL,   455 }, { 0xDE469FBD99A05FE3ULL,   481 }, { 0xA59BC234DB398C25ULL,   508 },
+    { 0xF6C69A72A3989F5CULL,   534 }, { 0xB7DCBF5354E9BECEULL,   561 }, { 0x88FCF317F22241E2ULL,   588 },
+    { 0xCC20CE9BD35C78A5ULL,   614 }, { 0x98165AF37B2153DFULL,   641 }, { 0xE2A0B5DC971F303AULL,   667 },
+    { 0xA8D9D1535CE3B396ULL,   694 }, { 0xFB9B7CD9A4A7443CULL,   720 }, { 0xBB764C4CA7A44410ULL,   747 },
+    { 0x8BAB8EEFB6409C1AULL,   774 }, { 0xD01FEF10A657842CULL,   800 }, { 0x9B10A4E5E9913129ULL,   827 },
+    { 0xE7109BFBA19C0C9DULL,   853 }, { 0xAC2820D9623BF429ULL,   880 }, { 0x80444B5E7AA7CF85ULL,   907 },
+    { 0xBF21E44003ACDD2DULL,   933 }, { 0x8E679C2F5E44FF8FULL,   960 }, { 0xD433179D9C8CB841ULL,   986 },
+    { 0x9E19DB92B4E31BA9ULL,  1013 }, { 0xEB96BF6EBADF77D9ULL,  1039 }, { 0xAF87023B9BF0EE6BULL,  1066 },
+};
+
+static const uint64_t kUDPow10[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+static inline UDDiyFp UDDiyFpMultiply(UDDiyFp a, UDDiyFp b) {
+    unsigned __int128 p = (unsigned __int128)a.f * b.f;
+    uint64_t h = (uint64_t)(p >> 64);
+    uint64_t l = (uint64_t)p;
+    if (l & (1ULL << 63)) h++;  // round
+    return (UDDiyFp){ h, a.e + b.e + 64 };
+}
+
+static inline UDDiyFp UDDiyFpNormalize(UDDiyFp x) {
+    int s = __builtin_clzll(x.f);
+    return (UDDiyFp){ x.f << s, x.e - s };
+}
+
+// Moves the last digit down while that gets closer to the exact value,
+// then reports whether the result is provably the closest shortest one.
+static BOOL UDRoundWeed(char *digits, int n, uint64_t distanceTooHighW, uint64_t unsafeInterval,
+                        uint64_t rest, uint64_t tenKappa, uint64_t unit) {
+    uint64_t small = distanceTooHighW - unit;
+    uint64_t big = distanceTooHighW + unit;
+    while (rest < small && unsafeInterval - rest >= tenKappa &&
+           (rest + tenKappa < small || small - rest >= rest + tenKappa - small)) {
+        digits[n - 1]--;
+        rest += tenKappa;
+    }
+    if (rest < big && unsafeInterval - rest >= tenKappa &&
+        (rest + tenKappa < big || big - rest > rest + tenKappa - big)) {
+        return NO;
+    }
+    return 2 * unit <= rest && rest <= unsafeInterval - 4 * unit;
+}
+
+static int UDDigitCount(uint32_t n) {
+    int count = 1;
+    while (count < 10 && n >= kUDPow10[count]) count++;
+    return count;
+}
+
+static BOOL UDGrisu3(double v, char digits[20], int *count, int *exponent) {
+    const uint64_t hidden = 1ULL << 52;
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    int biased = (int)((bits >> 52) & 0x7FF);
+    uint64_t significand = bits & (hidden - 1);
+    UDDiyFp w = biased ? (UDDiyFp){ significand + hidden, biased - 1075 } : (UDDiyFp){ significand, -1074 };
+
+    // Boundaries halfway to the neighbouring doubles; the lower one is
+    // closer at a power of two, except next to the subnormals.
+    UDDiyFp plus = UDDiyFpNormalize((UDDiyFp){ (w.f << 1) + 1, w.e - 1 });
+    UDDiyFp minus = (w.f == hidden && biased > 1) ? (UDDiyFp){ (w.f << 2) - 1, w.e - 2 }
+                                                  : (UDDiyFp){ (w.f << 1) - 1, w.e - 1 };
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+    w = UDDiyFpNormalize(w);
+
+    // Scale by a cached power of ten into the exponent window [-60, -32]
+    double dk = (-61 - plus.e) * 0.30102999566398114 + 347;
+    int k = (int)dk;
+    if (dk - k > 0.0) k++;
+    unsigned index = (unsigned)((k >> 3) + 1);
+    int K = -(-348 + (int)index * 8);
+    UDDiyFp c = { kUDCachedPowers[index].f, kUDCachedPowers[index].e };
+
+    UDDiyFp W = UDDiyFpMultiply(w, c);
+    UDDiyFp low = UDDiyFpMultiply(minus, c);
+    UDDiyFp high = UDDiyFpMultiply(plus, c);
+
+    // Each product is off by at most one unit, so the digits are generated
+    // over the interval widened by that much and checked against it.
+    uint64_t unit = 1;
+    uint64_t tooHigh = high.f + unit;
+    uint64_t unsafeInterval = tooHigh - (low.f - unit);
+    UDDiyFp one = { 1ULL << -W.e, W.e };
+    uint32_t integrals = (uint32_t)(tooHigh >> -one.e);
+    uint64_t fractionals = tooHigh & (one.f - 1);
+    int kappa = UDDigitCount(integrals);
+    int n = 0;
+
+    while (kappa > 0) {
+        uint64_t divisor = kUDPow10[kappa - 1];
+        digits[n++] = (char)('0' + integrals / divisor);
+        integrals %= divisor;
+        kappa--;
+        uint64_t rest = ((uint64_t)integrals << -one.e) + fractionals;
+        if (rest < unsafeInterval) {
+            *count = n;
+            *exponent = K + kappa;
+            return UDRoundWeed(digits, n, tooHigh - W.f, unsafeInterval, rest, divisor << -one.e, unit);
+        }
+    }
+    for (;;) {
+        fractionals *= 10;
+        unit *= 10;
+        unsafeInterval *= 10;
+        digits[n++] = (char)('0' + (fractionals >> -one.e));
+        fractionals &= one.f - 1;
+        kappa--;
+        if (fractionals < unsafeInterval) {
+            *count = n;
+            *exponent = K + kappa;
+            return UDRoundWeed(digits, n, (tooHigh - W.f) * unit, unsafeInterval, fractionals, one.f, unit);
+        }
+    }
+}
+
+// v positive and finite. digits gets the decimal digits, without a
+// terminator; the value is digits * 10^*exponent. Returns the count.
+static int UDShortestDigits(double v, char digits[20], int *exponent) {
+    int n;
+    if (UDGrisu3(v, digits, &n, exponent)) return n;
+
+    char text[32];
+    for (int precision = 0; precision < 17; precision++) {
+        snprintf(text, sizeof(text), "%.*e", precision, v);
+        if (strtod(text, NULL) == v) break;
+    }
+    // d.ddddde±x
+    n = 0;
+    const char *p = text;
+    for (; *p != 'e'; p++) {
+        if (*p != '.') digits[n++] = *p;
+    }
+    *exponent = atoi(p + 1) - (n - 1);
+    return n;
+}
+
+// --- DECIMAL ---
+// A digit string d[0..n) with the decimal point after `point` digits
+// (possibly outside the string). Trailing zeros never appear in it.
+typedef struct {
+    char d[24];
+    int n;
+    int point;
+} UDDecimal;
+
+static void UDDecimalTrim(UDDecimal *x) {
+    while (x->n > 0 && x->d[x->n - 1] == '0') x->n--;
+    if (x->n == 0) x->point = 1;
+}
+
+static void UDDecimalFromDouble(UDDecimal *x, double v) {
+    if (v == 0) {
+        x->n = 0;
+        x->point = 1;
+        return;
+    }
+    int exponent;
+    x->n = UDShortestDigits(v, x->d, &exponent);
+    x->point = x->n + exponent;
+    UDDecimalTrim(x);
+}
+
+// Keeps the first `keep` digits, rounding half to even as NSNumberFormatter does.
+static void UDDecimalRound(UDDecimal *x, int keep) {
+    if (keep >= x->n) return;
+    if (keep < 0) {
+        x->n = 0;
+        UDDecimalTrim(x);
+        return;
+    }
+
+    char first = x->d[keep];
+    BOOL up = first > '5';
+    if (first == '5') {
+        BOOL beyond = x->n > keep + 1;    // trimmed, so any further digit is nonzero
+        BOOL odd = keep > 0 && ((x->d[keep - 1] - '0') & 1);
+        up = beyond || odd;
+    }
+    x->n = keep;
+    if (up) {
+        int i = keep - 1;
+        while (i >= 0 && x->d[i] == '9') x->d[i--] = '0';
+        if (i >= 0) {
+            x->d[i]++;
         } else {
-            fmt.numberStyle = NSNumberFormatterDecimalStyle;
-            if (places == -1) {
-                fmt.maximumFractionDigits = 10;
-            } else {
-                fmt.maximumFractionDigits = places;
-            }
+            // 9...9 carried out, or nothing was kept: now a single 1
+            x->d[0] = '1';
+            x->n = 1;
+            x->point++;
         }
+    }
+    UDDecimalTrim(x);
+}
 
-        return [fmt stringFromNumber:@(dbl)];
+// Integer digits with grouping: a separator wherever the digits still to
+// come number primary + k * secondary.
+static void UDWriteGrouped(UDFormatWriter *w, const UDFormatSymbols *sym, const char *digits, int n,
+                           int count, BOOL separators) {
+    int primary = sym->groupingSize, secondary = sym->secondaryGroupingSize;
+    for (int i = 0; i < count; i++) {
+        int remaining = count - i;
+        if (separators && i > 0 && primary > 0 && remaining >= primary &&
+            (remaining - primary) % (secondary > 0 ? secondary : primary) == 0) {
+            UDPutString(w, sym->grouping);
+        }
+        UDPutChar(w, i < n ? digits[i] : '0');
     }
+}
+
+static void UDWriteFixed(UDFormatWriter *w, const UDFormatSymbols *sym, double v, BOOL separators, int places) {
+    if (signbit(v)) UDPutString(w, sym->minus);
+    UDDecimal x;
+    UDDecimalFromDouble(&x, fabs(v));
+    UDDecimalRound(&x, x.point + places);
+
+    if (x.point > 0) UDWriteGrouped(w, sym, x.d, x.n, x.point, separators);
+    else UDPutChar(w, '0');
 
-    // 3. Handle Integers (Programmer Mode)
-    if (val.type == UDValueTypeInteger) {
-        return [self stringForLong:val.v.intValue base:base showThousandsSeparators:showThousandsSeparators];
+    if (x.n > x.point) {
+        UDPutString(w, sym->decimal);
+        for (int i = x.point; i < 0; i++) UDPutChar(w, '0');
+        for (int i = x.point > 0 ? x.point : 0; i < x.n; i++) UDPutChar(w, x.d[i]);
     }
-    
-    return @"0";
 }
 
-+ (NSString *)stringForLong:(unsigned long long)val base:(UDBase)base showThousandsSeparators:(BOOL)showThousandsSeparators {
+static void UDWriteUnsigned(UDFormatWriter *w, unsigned long long value) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n) UDPutChar(w, digits[--n]);
+}
+
+// "0.######E0" with " e " for the E: seven significant digits.
+static void UDWriteScientific(UDFormatWriter *w, const UDFormatSymbols *sym, double v) {
+    if (signbit(v)) UDPutString(w, sym->minus);
+    UDDecimal x;
+    UDDecimalFromDouble(&x, fabs(v));
+    UDDecimalRound(&x, 7);
+
+    int exponent = 0;
+    if (x.n == 0) {
+        UDPutChar(w, '0');
+    } else {
+        exponent = x.point - 1;
+        UDPutChar(w, x.d[0]);
+        if (x.n > 1) {
+            UDPutString(w, sym->decimal);
+            for (int i = 1; i < x.n; i++) UDPutChar(w, x.d[i]);
+        }
+    }
+    UDPutString(w, " e ");
+    if (exponent < 0) UDPutString(w, sym->minus);
+    UDWriteUnsigned(w, (unsigned long long)(exponent < 0 ? -exponent : exponent));
+}
+
+static BOOL UDWriteNonFinite(UDFormatWriter *w, const UDFormatSymbols *sym, double v) {
+    if (isnan(v)) UDPutString(w, sym->nan);
+    else if (isinf(v)) UDPutString(w, v < 0 ? sym->negativeInfinity : sym->positiveInfinity);
+    else return NO;
+    return YES;
+}
+
+// --- INTEGERS ---
+static const char kUDDigitChars[] = "0123456789ABCDEF";
+
+// Power-of-two bases: bitsPerDigit bits per digit, most significant first.
+static void UDWriteRadix(UDFormatWriter *w, unsigned long long value, int bitsPerDigit) {
+    int shift = 0;
+    while (shift + bitsPerDigit < 64 && (value >> (shift + bitsPerDigit)) != 0) shift += bitsPerDigit;
+    unsigned long long mask = (1ULL << bitsPerDigit) - 1;
+    for (; shift >= 0; shift -= bitsPerDigit) UDPutChar(w, kUDDigitChars[(value >> shift) & mask]);
+}
+
+static void UDWriteLong(UDFormatWriter *w, const UDFormatSymbols *sym, unsigned long long value, UDBase base,
+                        BOOL separators) {
     switch (base) {
         case UDBaseDec: {
-            unsigned long long temp = val;
-            
-            // Fast-path for zero
-            if (temp == 0) return @"0";
-
-            // A 64-bit max unsigned integer is 18,446,744,073,709,551,615.
-            // That's 20 digits + 6 separators + 1 null terminator = 27 characters.
-            // A 32-byte buffer gives us plenty of room.
-            char buffer[32];
-            int index = 31;
-            buffer[index] = '\0'; // Null-terminate the end of the string
-            
-            // Figure out the local separator (default to comma)
-            NSString *sepStr = [[NSLocale currentLocale] objectForKey:NSLocaleGroupingSeparator];
-            char separator = (sepStr.length > 0) ? (char)[sepStr characterAtIndex:0] : ',';
-            int digitCount = 0;
-            
-            // Loop mathematically to extract digits right-to-left
-            while (temp > 0) {
-                // Add the separator every 3 digits
-                if (digitCount > 0 && digitCount % 3 == 0 && showThousandsSeparators) {
-                    index--;
-                    buffer[index] = separator;
-                }
-                
-                // Extract lowest digit, convert to ASCII, and move to next
-                char digitChar = (char)(temp % 10) + '0';
-                index--;
-                buffer[index] = digitChar;
-                
-                temp /= 10;
-                digitCount++;
-            }
-            
-            // Return an NSString starting from wherever our index ended up
-            return [NSString stringWithUTF8String:&buffer[index]];
+            char digits[20];
+            int n = 0;
+            do {
+                digits[19 - n++] = (char)('0' + value % 10);
+                value /= 10;
+            } while (value);
+            UDWriteGrouped(w, sym, digits + 20 - n, n, n, separators);
+            break;
         }
-            
         case UDBaseHex:
-            // %llX formats as uppercase Hex
-            return [NSString stringWithFormat:@"0x%llX", val];
-            
+            UDPutString(w, "0x");
+            UDWriteRadix(w, value, 4);
+            break;
         case UDBaseOct:
-            // %llo formats as Octal
-            return [NSString stringWithFormat:@"%llo", val];
-            
+            UDWriteRadix(w, value, 3);
+            break;
         case UDBaseBin:
-            return [self binaryStringForLong:val];
-    }
-    return @"0";
-}
-
-// Private Helper for Binary (Objective-C doesn't have a %b formatter)
-+ (NSString *)binaryStringForLong:(long long)val {
-    if (val == 0) return @"0";
-    
-    NSMutableString *str = [NSMutableString string];
-    unsigned long long uVal = (unsigned long long)val; // Use unsigned to handle bit shifts safely
-    
-    // Simple algorithm: Read the last bit, prepend it, shift right.
-    // Limit to 64 bits to prevent infinite loops if something goes wrong,
-    // though 'uVal > 0' usually catches it.
-    int bits = 0;
-    while (uVal > 0 && bits < 64) {
-        [str insertString:((uVal & 1) ? @"1" : @"0") atIndex:0];
-        uVal >>= 1;
-        bits++;
-    }
-    return str;
+            UDWriteRadix(w, value, 1);
+            break;
+        default:
+            UDPutChar(w, '0');
+            break;
+    }
+}
+
+// --- ENTRY POINTS ---
+
+size_t UDFormatLong(char *buf, size_t size, unsigned long long value, UDBase base, BOOL showThousandsSeparators) {
+    UDFormatWriter w = { buf, buf + (size ? size - 1 : 0), NO };
+    UDWriteLong(&w, UDFormatCurrentSymbols(), value, base, showThousandsSeparators);
+    return UDFinish(&w, buf, size);
+}
+
+size_t UDFormatDecimal(char *buf, size_t size, double value, BOOL showThousandsSeparators, NSInteger maxFractionDigits) {
+    const UDFormatSymbols *sym = UDFormatCurrentSymbols();
+    UDFormatWriter w = { buf, buf + (size ? size - 1 : 0), NO };
+    if (!UDWriteNonFinite(&w, sym, value)) {
+        UDWriteFixed(&w, sym, value, showThousandsSeparators, (int)MAX(0, MIN(maxFractionDigits, 400)));
+    }
+    return UDFinish(&w, buf, size);
+}
+
+size_t UDFormatValue(char *buf, size_t size, UDValue value, UDBase base, BOOL showThousandsSeparators,
+                     NSInteger decimalPlaces, BOOL forceScientific) {
+    const UDFormatSymbols *sym = UDFormatCurrentSymbols();
+    UDFormatWriter w = { buf, buf + (size ? size - 1 : 0), NO };
+
+    switch (value.type) {
+        case UDValueTypeErr:
+            UDPutString(&w, "Error");
+            break;
+
+        case UDValueTypeDouble: {
+            // Doubles ignore the base and always print as decimal
+            double dbl = value.v.doubleValue;
+            double absDbl = fabs(dbl);
+            if (UDWriteNonFinite(&w, sym, dbl)) break;
+
+            // Apple usually flips to scientific for numbers >= 1 billion
+            // or smaller than 0.001 (excluding zero).
+            if (forceScientific || absDbl >= 1e10 || (absDbl < 1e-4 && absDbl > 0)) {
+                UDWriteScientific(&w, sym, dbl);
+            } else {
+                UDWriteFixed(&w, sym, dbl, showThousandsSeparators, decimalPlaces == -1 ? 10 : (int)MAX(0, MIN(decimalPlaces, 400)));
+            }
+            break;
+        }
+
+        case UDValueTypeInteger:
+            UDWriteLong(&w, sym, value.v.intValue, base, showThousandsSeparators);
+            break;
+
+        default:
+            UDPutChar(&w, '0');
+            break;
+    }
+    return UDFinish(&w, buf, size);
+}
+
+static inline NSString *UDFormatString(const char *buf, size_t length) {
+    return [[NSString alloc] initWithBytes:buf length:length encoding:NSUTF8StringEncoding];
+}
+
+@implementation UDValueFormatter
+
++ (NSString *)stringForValue:(UDValue)val base:(UDBase)base showThousandsSeparators:(BOOL)showThousandsSeparators decimalPlaces:(NSInteger)places forceScientific:(BOOL)forceScientific {
+    char buf[UDFormatBufferSize];
+    size_t length = UDFormatValue(buf, sizeof(buf), val, base, showThousandsSeparators, places, forceScientific);
+    return UDFormatString(buf, length);
+}
+
++ (NSString *)stringForLong:(unsigned long long)val base:(UDBase)base showThousandsSeparators:(BOOL)showThousandsSeparators {
+    char buf[UDFormatBufferSize];
+    return UDFormatString(buf, UDFormatLong(buf, sizeof(buf), val, base, showThousandsSeparators));
+}
+
++ (NSString *)stringForDecimal:(double)value showThousandsSeparators:(BOOL)showThousandsSeparators maximumFractionDigits:(NSInteger)digits {
+    char buf[UDFormatBufferSize];
+    return UDFormatString(buf, UDFormatDecimal(buf, sizeof(buf), value, showThousandsSeparators, digits));
 }
 
 @end
@@ -6,10 +6,12 @@
 //
 
 #import <AppKit/AppKit.h>
+#import "AppDelegate.h"
 
 int main(int argc, const char * argv[]) {
     @autoreleasepool {
         // Setup code that might create autoreleased objects goes here.
+        UDLaunchStartTime = [NSProcessInfo processInfo].systemUptime;
     }
     return NSApplicationMain(argc, argv);
 }
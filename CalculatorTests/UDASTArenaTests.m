@@ -0,0 +1,181 @@
+//
+//  UDASTArenaTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDASTArena.h"
+#import "UDCompiler.h"
+#import "UDConstants.h"
+#import "UDFrontend.h"
+#import "UDVM.h"
+
+@interface UDASTArenaTests : XCTestCase
+@property (nonatomic, strong) UDASTArena *arena;
+@property (nonatomic, strong) XCTestExpectation *imported;
+@property (nonatomic, assign) UDASTRef importedRef;
+@property (nonatomic, strong) UDASTNode *rebuilt;
+@end
+
+@implementation UDASTArenaTests
+
+- (void)setUp {
+    [super setUp];
+    self.arena = [[UDASTArena alloc] init];
+}
+
+// --- HELPERS ---
+
+- (UDNumberNode *)num:(double)val {
+    return [UDNumberNode value:UDValueMakeDouble(val)];
+}
+
+- (UDASTNode *)sampleTree {
+    // sqrt(100 + 5%) * -2
+    UDFrontend *fe = [UDFrontend shared];
+    UDASTNode *percent = [UDPostfixOpNode info:[fe infoForOp:UDOpPercent] child:[self num:5]];
+    UDASTNode *sum = [UDBinaryOpNode info:[fe infoForOp:UDOpAdd] left:[self num:100] right:percent];
+    UDASTNode *root = [UDFunctionNode func:UDConstSqrt args:@[ sum ]];
+    UDASTNode *neg = [UDUnaryOpNode info:[fe infoForOp:UDOpNegate] child:[self num:2]];
+    return [UDBinaryOpNode info:[fe infoForOp:UDOpMul] left:[UDParenNode wrap:root] right:neg];
+}
+
+- (void)importOnThread:(UDASTNode *)tree {
+    self.importedRef = [self.arena importNode:tree];
+    [self.imported fulfill];
+}
+
+- (void)rebuildOnThread:(id)unused {
+    @autoreleasepool {
+        self.rebuilt = [self.arena nodeForRef:self.importedRef];
+    }
+    [self.imported fulfill];
+}
+
+// --- TESTS ---
+
+- (void)testImportRoundTrips {
+    UDASTNode *tree = [self sampleTree];
+    UDASTRef ref = [self.arena importNode:tree];
+
+    XCTAssertEqual(self.arena.count, 9);
+    XCTAssertTrue([[self.arena nodeForRef:ref] isIdenticalTo:tree]);
+}
+
+- (void)testImportReusesKnownSubtrees {
+    UDASTNode *tree = [self sampleTree];
+    [self.arena importNode:tree];
+    NSUInteger before = self.arena.count;
+
+    // The grown expression only adds its new root and operand
+    UDASTNode *grown = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpSub] left:tree right:[self num:1]];
+    [self.arena importNode:grown];
+    XCTAssertEqual(self.arena.count, before + 2);
+}
+
+- (void)testArenaCompileMatchesTreeCompile {
+    UDASTNode *tree = [self sampleTree];
+    for (int integerMode = 0; integerMode <= 1; integerMode++) {
+        NSString *expected = [[UDCompiler compileProgram:tree withIntegerMode:integerMode] debugDescription];
+        UDASTRef ref = [self.arena importNode:tree];
+        NSString *actual = [[UDCompiler compileArena:self.arena root:ref withIntegerMode:integerMode] debugDescription];
+        XCTAssertEqualObjects(actual, expected);
+    }
+}
+
+- (void)testDeepTreeCompilesWithoutRecursion {
+    // ((1 + 1) + 1) + ... built straight into the arena
+    UDASTRef acc = [self.arena addNumber:UDValueMakeDouble(1)];
+    for (int i = 0; i < 10000; i++) {
+        acc = [self.arena addBinary:UDOpAdd left:acc right:[self.arena addNumber:UDValueMakeDouble(1)]];
+    }
+
+    UDProgram *prog = [UDCompiler compileArena:self.arena root:acc withIntegerMode:NO];
+    XCTAssertEqual(prog.count, 20001);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([UDVM executeProgram:prog]), 10001.0, 0.0001);
+}
+
+- (void)testDeepTreeImportsWithoutRecursion {
+    // ((1 + 1) + 1) + ... as objects, imported on a thread whose stack
+    // could not hold one frame per level
+    UDOpInfo *add = [[UDFrontend shared] infoForOp:UDOpAdd];
+    UDASTNode *tree = [self num:1];
+    for (int i = 0; i < 10000; i++) {
+        tree = [UDBinaryOpNode info:add left:tree right:[self num:1]];
+    }
+
+    self.imported = [self expectationWithDescription:@"imported"];
+    NSThread *thread = [[NSThread alloc] initWithTarget:self selector:@selector(importOnThread:) object:tree];
+    thread.stackSize = 64 * 1024;
+    [thread start];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    XCTAssertEqual(self.arena.count, 20001);
+    XCTAssertEqual(self.importedRef, 20000);
+    UDProgram *prog = [UDCompiler compileArena:self.arena root:self.importedRef withIntegerMode:NO];
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([UDVM executeProgram:prog]), 10001.0, 0.0001);
+}
+
+- (void)testDeepRowRebuildsWithoutRecursion {
+    // The same chain built as rows, turned back into objects on a small stack
+    UDASTRef acc = [self.arena addNumber:UDValueMakeDouble(1)];
+    for (int i = 0; i < 10000; i++) {
+        acc = [self.arena addBinary:UDOpAdd left:acc right:[self.arena addNumber:UDValueMakeDouble(1)]];
+    }
+    self.importedRef = acc;
+
+    self.imported = [self expectationWithDescription:@"rebuilt"];
+    NSThread *thread = [[NSThread alloc] initWithTarget:self selector:@selector(rebuildOnThread:) object:nil];
+    thread.stackSize = 64 * 1024;
+    [thread start];
+    [self waitForExpectationsWithTimeout:10 handler:nil];
+
+    XCTAssertTrue([self.rebuilt isKindOfClass:[UDBinaryOpNode class]]);
+    UDProgram *prog = [UDCompiler compileProgram:self.rebuilt withIntegerMode:NO];
+    XCTAssertEqual(prog.count, 20001);
+}
+
+- (void)testRebuildSharesRowsUsedTwice {
+    UDASTRef x = [self.arena addNumber:UDValueMakeDouble(3)];
+    UDASTRef sum = [self.arena addBinary:UDOpAdd left:x right:x];
+    UDBinaryOpNode *node = (UDBinaryOpNode *)[self.arena nodeForRef:sum];
+    XCTAssertTrue(node.left == node.right);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([UDVM executeProgram:[UDCompiler compileProgram:node withIntegerMode:NO]]), 6.0, 0.0001);
+}
+
+- (void)testImportDoesNotKeepTreesAlive {
+    __weak UDASTNode *weakTree = nil;
+    @autoreleasepool {
+        UDASTNode *tree = [self sampleTree];
+        weakTree = tree;
+        [self.arena importNode:tree];
+    }
+    XCTAssertNil(weakTree);
+
+    // The rows stay until removeAllNodes
+    XCTAssertEqual(self.arena.count, 9);
+}
+
+- (void)testSharedSubtreeImportsOnce {
+    // x + x with the same object on both sides
+    UDASTNode *x = [self sampleTree];
+    UDASTNode *sum = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpAdd] left:x right:x];
+    UDASTRef ref = [self.arena importNode:sum];
+
+    XCTAssertEqual(self.arena.count, 10);
+    XCTAssertTrue([[self.arena nodeForRef:ref] isIdenticalTo:sum]);
+}
+
+- (void)testRemoveAllNodesEmptiesTheArena {
+    UDASTNode *tree = [self sampleTree];
+    [self.arena importNode:tree];
+    [self.arena removeAllNodes];
+    XCTAssertEqual(self.arena.count, 0);
+
+    // Nothing is remembered: importing again starts from row 0
+    XCTAssertEqual([self.arena importNode:[self num:1]], 0);
+}
+
+@end
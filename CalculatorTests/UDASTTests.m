@@ -186,4 +186,55 @@
     XCTAssertEqualObjects([func prettyPrint], @"sin(x + 1)");
 }
 
+#pragma mark - 8. Structural Hashing & Interning
+
+- (UDASTNode *)sampleTree {
+    // (1 + 2)! * sin(3)
+    UDASTNode *sum = [UDBinaryOpNode info:self.addOp left:[UDNumberNode value:UDValueMakeInt(1)] right:[UDNumberNode value:UDValueMakeInt(2)]];
+    UDASTNode *fact = [UDPostfixOpNode info:self.factOp child:[UDParenNode wrap:sum]];
+    UDASTNode *sine = [UDFunctionNode func:@"sin" args:@[ [UDNumberNode value:UDValueMakeDouble(3)] ]];
+    return [UDBinaryOpNode info:self.mulOp left:fact right:sine];
+}
+
+- (void)testStructuralHashMatchesForEqualTrees {
+    UDASTNode *a = [self sampleTree];
+    UDASTNode *b = [self sampleTree];
+
+    XCTAssertNotEqual(a, b);
+    XCTAssertEqual(a.structuralHash, b.structuralHash);
+    XCTAssertEqual(a.hash, b.hash);
+    XCTAssertTrue([a isIdenticalTo:b]);
+    XCTAssertEqualObjects(a, b);
+}
+
+- (void)testIdenticalIsExactForNumbers {
+    UDASTNode *a = [UDNumberNode value:UDValueMakeDouble(0.1 + 0.2)];
+    UDASTNode *b = [UDNumberNode value:UDValueMakeDouble(0.3)];
+
+    XCTAssertEqualObjects(a, b);          // within epsilon
+    XCTAssertFalse([a isIdenticalTo:b]);  // not the same bits
+}
+
+- (void)testCopySharesTheNode {
+    UDASTNode *tree = [self sampleTree];
+    XCTAssertEqual([tree copy], tree);
+}
+
+- (void)testInternerSharesIdenticalSubtrees {
+    UDASTInterner *interner = [UDASTInterner new];
+    UDBinaryOpNode *a = [interner intern:[self sampleTree]];
+    UDBinaryOpNode *b = [interner intern:[self sampleTree]];
+
+    XCTAssertEqual(a, b);
+    XCTAssertEqual(interner.count, 8);
+
+    // A different tree reuses the shared sin(3) subtree
+    UDBinaryOpNode *c = [interner intern:[UDBinaryOpNode info:self.addOp
+                                                         left:[UDNumberNode value:UDValueMakeInt(1)]
+                                                        right:[UDFunctionNode func:@"sin" args:@[ [UDNumberNode value:UDValueMakeDouble(3)] ]]]];
+    XCTAssertEqual(c.right, a.right);
+    XCTAssertEqual(c.left, ((UDBinaryOpNode *)((UDParenNode *)((UDPostfixOpNode *)a.left).child).child).left);
+    XCTAssertEqual(interner.count, 9);
+}
+
 @end
@@ -0,0 +1,75 @@
+//
+//  UDBatchEvaluatorTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDBatchEvaluator.h"
+
+@interface UDBatchEvaluatorTests : XCTestCase
+@property (nonatomic, strong) UDBatchEvaluator *evaluator;
+@end
+
+@implementation UDBatchEvaluatorTests
+
+- (void)setUp {
+    [super setUp];
+    self.evaluator = [[UDBatchEvaluator alloc] init];
+}
+
+- (void)testTextLines {
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self.evaluator evaluateLine:@"2 + 3 * 4"]), 14.0, 0.0001);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self.evaluator evaluateLine:@"(2 + 3) * 4"]), 20.0, 0.0001);
+
+    // Nothing carries over from the previous line
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self.evaluator evaluateLine:@"1"]), 1.0, 0.0001);
+}
+
+- (void)testKeyLinesMatchText {
+    self.evaluator.inputFormat = UDBatchInputFormatKeys;
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self.evaluator evaluateLine:@"2 Add 3 Mul 4 Eq"]), 14.0, 0.0001);
+    // Trailing Eq is implied; the keypad's postfix keys apply to the value before them
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self.evaluator evaluateLine:@"1.5 Add 16 Sqrt"]), 5.5, 0.0001);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self.evaluator evaluateLine:@"ParenLeft 2 Add 3 ParenRight Mul 4"]), 20.0, 0.0001);
+}
+
+- (void)testProgrammerBaseOutput {
+    self.evaluator.integerMode = YES;
+    self.evaluator.base = UDBaseHex;
+
+    UDValue text = [self.evaluator evaluateLine:@"0xF0 or 0x0F"];
+    XCTAssertEqualObjects([self.evaluator stringForValue:text], @"0xFF");
+
+    // Keys are typed in the input base
+    self.evaluator.inputFormat = UDBatchInputFormatKeys;
+    UDValue keys = [self.evaluator evaluateLine:@"F0 BitwiseOr 0F"];
+    XCTAssertEqualObjects([self.evaluator stringForValue:keys], @"0xFF");
+}
+
+- (void)testHexDigitsWinOverKeyNames {
+    self.evaluator.integerMode = YES;
+    self.evaluator.base = UDBaseHex;
+    self.evaluator.inputFormat = UDBatchInputFormatKeys;
+
+    // EE and Add are hex numbers, not the EE and Add keys
+    XCTAssertEqualObjects([self.evaluator stringForValue:[self.evaluator evaluateLine:@"EE"]], @"0xEE");
+    XCTAssertEqualObjects([self.evaluator stringForValue:[self.evaluator evaluateLine:@"Add"]], @"0xADD");
+    // A ':' prefix makes them keys again
+    XCTAssertEqualObjects([self.evaluator stringForValue:[self.evaluator evaluateLine:@"EE :Add 1"]], @"0xEF");
+    XCTAssertEqualObjects([self.evaluator stringForValue:[self.evaluator evaluateLine:@"F0 :BitwiseOr 0F"]], @"0xFF");
+    XCTAssertEqual([self.evaluator evaluateLine:@"1 :Frobnicate 1"].type, UDValueTypeErr);
+}
+
+- (void)testBadLinesAreErrors {
+    XCTAssertEqual([self.evaluator evaluateLine:@"2 +"].type, UDValueTypeErr);
+    XCTAssertEqualObjects([self.evaluator stringForValue:[self.evaluator evaluateLine:@"1 / 0"]], @"Error");
+
+    self.evaluator.inputFormat = UDBatchInputFormatKeys;
+    XCTAssertEqual([self.evaluator evaluateLine:@"2 Frobnicate 3"].type, UDValueTypeErr);
+    // Not a decimal digit
+    XCTAssertEqual([self.evaluator evaluateLine:@"1F Add 1"].type, UDValueTypeErr);
+}
+
+@end
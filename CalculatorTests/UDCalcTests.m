@@ -7,6 +7,7 @@
 
 #import <XCTest/XCTest.h>
 #import "UDCalc.h"
+#import "UDCompiler.h"
 #import "UDFrontend.h"
 #import "UDConstants.h"
 
@@ -915,6 +916,95 @@
     XCTAssertEqualWithAccuracy(UDValueAsDouble([self.calculator evaluateCurrentExpression]), 46.0, 0.0001);
 }
 
+#pragma mark - Incremental evaluation
+
+- (void)testGrowingExpressionMemoizesSubtrees {
+    // (1 + 2) * 4 = 12; the left operand was evaluated once and kept
+    [self.calculator performOperation:UDOpParenLeft];
+    [self.calculator inputDigit:1];
+    [self.calculator performOperation:UDOpAdd];
+    [self.calculator inputDigit:2];
+    [self.calculator performOperation:UDOpParenRight];
+    [self.calculator performOperation:UDOpMul];
+    [self.calculator inputDigit:4];
+    [self.calculator performOperation:UDOpEq];
+
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self.calculator evaluateCurrentExpression]), 12.0, 0.0001);
+    UDBinaryOpNode *root = (UDBinaryOpNode *)self.calculator.nodeStack.lastObject;
+    XCTAssertTrue([root isKindOfClass:[UDBinaryOpNode class]]);
+    UDValue left, whole;
+    XCTAssertTrue([self.calculator.evaluationMemo getValue:&left forNode:root.left]);
+    XCTAssertTrue([self.calculator.evaluationMemo getValue:&whole forNode:root]);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(left), 3.0, 0.0001);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(whole), 12.0, 0.0001);
+}
+
+- (void)testModeChangeInvalidatesMemos {
+    // 7 / 2 = 3.5, then 3 in programmer (integer) mode
+    [self.calculator inputDigit:7];
+    [self.calculator performOperation:UDOpDiv];
+    [self.calculator inputDigit:2];
+    [self.calculator performOperation:UDOpEq];
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self.calculator evaluateCurrentExpression]), 3.5, 0.0001);
+
+    UDASTNode *root = self.calculator.nodeStack.lastObject;
+    UDValue v;
+    XCTAssertTrue([self.calculator.evaluationMemo getValue:&v forNode:root]);
+    self.calculator.mode = UDCalcModeProgrammer;
+    XCTAssertFalse([self.calculator.evaluationMemo getValue:&v forNode:root]);
+    XCTAssertEqual(UDValueAsInt([self.calculator evaluateCurrentExpression]), 3);
+    XCTAssertTrue([self.calculator.evaluationMemo getValue:&v forNode:root]);
+    XCTAssertEqual(v.type, UDValueTypeInteger);
+}
+
+- (void)testRunningPreview {
+    // 2 + 3 × -> 5 while the × waits for its operand
+    [self.calculator inputDigit:2];
+    [self.calculator performOperation:UDOpAdd];
+    [self.calculator inputDigit:3];
+    [self.calculator performOperation:UDOpMul];
+
+    UDValue preview;
+    XCTAssertTrue([self.calculator runningPreview:&preview]);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(preview), 5.0, 0.0001);
+    XCTAssertEqualObjects(self.calculator.currentDisplayValue, @"0");   // off by default
+
+    self.calculator.showsRunningPreview = YES;
+    XCTAssertEqualObjects(self.calculator.currentDisplayValue, @"5");
+
+    // While typing: 2 + 3 × 4 -> 14; nothing was reduced for real
+    [self.calculator inputDigit:4];
+    XCTAssertTrue([self.calculator runningPreview:&preview]);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(preview), 14.0, 0.0001);
+    XCTAssertEqual(self.calculator.nodeStack.count, 2);
+
+    [self.calculator performOperation:UDOpEq];
+    XCTAssertFalse([self.calculator runningPreview:&preview]);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self.calculator evaluateCurrentExpression]), 14.0, 0.0001);
+}
+
+- (void)testCalculatorsSharingATreeKeepTheirOwnValues {
+    // 7 / 2, the same node object evaluated by calculators in different
+    // modes on different threads at once
+    UDASTNode *tree = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpDiv]
+                                      left:[UDNumberNode value:UDValueMakeDouble(7)]
+                                     right:[UDNumberNode value:UDValueMakeDouble(2)]];
+    enum { kThreads = 4 };
+    __block NSUInteger wrong[kThreads] = { 0 };
+    dispatch_apply(kThreads, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t t) {
+        UDCalc *calc = [[UDCalc alloc] init];
+        BOOL programmer = t % 2;
+        if (programmer) calc.mode = UDCalcModeProgrammer;
+        for (int i = 0; i < 2000; i++) {
+            UDValue v = [calc evaluateNode:tree];
+            BOOL ok = programmer ? v.type == UDValueTypeInteger && v.v.intValue == 3
+                                 : v.type == UDValueTypeDouble && v.v.doubleValue == 3.5;
+            if (!ok) wrong[t]++;
+        }
+    });
+    for (int t = 0; t < kThreads; t++) XCTAssertEqual(wrong[t], 0, @"thread %d", t);
+}
+
 #pragma mark - Exponent notation
 
 - (void)testExponentInput {
@@ -11,6 +11,7 @@
 #import "UDInstruction.h"
 #import "UDConstants.h"
 #import "UDFrontend.h"
+#import "UDVM.h"
 
 @interface UDCompilerTests : XCTestCase
 @end
@@ -219,4 +220,175 @@
     [self assertOpcode:UDOpcodeSqrt atIndex:i++ inProgram:prog];
 }
 
+- (void)testFunctionIdentifierIsResolvedOnce {
+    // Name and identifier describe the same function, whichever factory built it
+    UDFunctionNode *byName = [UDFunctionNode func:UDConstCosD args:@[[self num:60]]];
+    UDFunctionNode *byID = [UDFunctionNode function:UDFunctionCosD args:@[[self num:60]]];
+
+    XCTAssertEqual(byName.functionID, UDFunctionCosD);
+    XCTAssertEqualObjects(byID.name, UDConstCosD);
+    XCTAssertTrue([byName isIdenticalTo:byID]);
+
+    NSArray *prog = [UDCompiler compile:byID withIntegerMode:NO];
+    [self assertOpcode:UDOpcodeCosD atIndex:1 inProgram:prog];
+}
+
+- (void)testUnknownFunctionIsRejected {
+    // Used to compile silently as sqrt
+    UDFunctionNode *root = [UDFunctionNode func:@"frobnicate" args:@[[self num:4]]];
+    XCTAssertEqual(root.functionID, UDFunctionUnknown);
+
+    UDProgram *prog = [UDCompiler compileProgram:root withIntegerMode:NO optimize:YES];
+    XCTAssertEqual(prog.status, UDProgramStatusRejected);
+    XCTAssertEqual(UDValueAsError([UDVM executeProgram:prog]), UDValueErrorTypeUnknown);
+}
+
+- (void)testCompileProgramIsPacked {
+    // AST: (3 + 4) * 5 -> one record per opcode, constants pooled
+    UDASTNode *addNode = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpAdd] left:[self num:3] right:[self num:4]];
+    UDASTNode *root = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpMul] left:addNode right:[self num:5]];
+
+    UDProgram *prog = [UDCompiler compileProgram:root withIntegerMode:NO];
+
+    XCTAssertEqual(prog.count, 5);
+    XCTAssertEqual(prog.constantCount, 3);
+    XCTAssertEqual(prog.code[0].opcode, UDOpcodePush);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([prog constantAtIndex:prog.code[0].operand]), 3.0, 0.0001);
+    XCTAssertEqual(prog.code[2].opcode, UDOpcodeAdd);
+    XCTAssertEqual(prog.code[3].opcode, UDOpcodePush);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([prog constantAtIndex:prog.code[3].operand]), 5.0, 0.0001);
+    XCTAssertEqual(prog.code[4].opcode, UDOpcodeMul);
+}
+
+// --- CONSTANT FOLDING ---
+
+- (void)testOptimizeFoldsConstantTree {
+    // AST: (3 + 4) * 5 -> PUSH 35
+    UDASTNode *addNode = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpAdd] left:[self num:3] right:[self num:4]];
+    UDASTNode *root = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpMul] left:[UDParenNode wrap:addNode] right:[self num:5]];
+
+    UDProgram *prog = [UDCompiler compileProgram:root withIntegerMode:NO optimize:YES];
+
+    XCTAssertEqual(prog.count, 1);
+    XCTAssertEqual(prog.code[0].opcode, UDOpcodePush);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([prog constantAtIndex:0]), 35.0, 0.0001);
+}
+
+- (void)testOptimizeKeepsDivideByZeroForRuntime {
+    // AST: 1 / 0 + 2 * 3 -> PUSH 1, PUSH 0, DIV, PUSH 6, ADD
+    UDASTNode *divNode = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpDiv] left:[self num:1] right:[self num:0]];
+    UDASTNode *mulNode = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpMul] left:[self num:2] right:[self num:3]];
+    UDASTNode *root = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpAdd] left:divNode right:mulNode];
+
+    NSArray *prog = [[UDCompiler compileProgram:root withIntegerMode:NO optimize:YES] instructions];
+
+    XCTAssertEqual(prog.count, 5);
+    [self assertPush:1 atIndex:0 inProgram:prog];
+    [self assertPush:0 atIndex:1 inProgram:prog];
+    [self assertOpcode:UDOpcodeDiv atIndex:2 inProgram:prog];
+    [self assertPush:6 atIndex:3 inProgram:prog];
+    [self assertOpcode:UDOpcodeAdd atIndex:4 inProgram:prog];
+
+    UDValue res = [UDVM executeProgram:[UDCompiler compileProgram:root withIntegerMode:NO optimize:YES]];
+    XCTAssertEqual(UDValueAsError(res), UDValueErrorTypeDivideByZero);
+}
+
+- (void)testOptimizedResultIsBitExact {
+    UDFrontend *fe = [UDFrontend shared];
+    // 100 + 5%, sqrt(2) ^ 2, sin(0.5) / 3, 10 - 1/3
+    UDASTNode *percent = [UDPostfixOpNode info:[fe infoForOp:UDOpPercent] child:[self num:5]];
+    NSArray<UDASTNode *> *trees = @[
+        [UDBinaryOpNode info:[fe infoForOp:UDOpAdd] left:[self num:100] right:percent],
+        [UDFunctionNode func:UDConstPow args:@[ [UDFunctionNode func:UDConstSqrt args:@[ [self num:2] ]], [self num:2] ]],
+        [UDBinaryOpNode info:[fe infoForOp:UDOpDiv] left:[UDFunctionNode func:UDConstSin args:@[ [self num:0.5] ]] right:[self num:3]],
+        [UDBinaryOpNode info:[fe infoForOp:UDOpSub] left:[self num:10]
+                       right:[UDBinaryOpNode info:[fe infoForOp:UDOpDiv] left:[self num:1] right:[self num:3]]],
+    ];
+
+    for (UDASTNode *tree in trees) {
+        UDValue plain = [UDVM executeProgram:[UDCompiler compileProgram:tree withIntegerMode:NO]];
+        UDProgram *optimized = [UDCompiler compileProgram:tree withIntegerMode:NO optimize:YES];
+        UDValue folded = [UDVM executeProgram:optimized];
+        XCTAssertEqual(optimized.count, 1, @"%@", [tree prettyPrint]);
+        XCTAssertEqual(plain.type, folded.type);
+        XCTAssertEqual(plain.v.intValue, folded.v.intValue, @"%@", [tree prettyPrint]);
+    }
+}
+
+- (void)testIncrementalEvaluationMatchesProgram {
+    UDFrontend *fe = [UDFrontend shared];
+    UDASTNode *percent = [UDPostfixOpNode info:[fe infoForOp:UDOpPercent] child:[self num:5]];
+    UDASTNode *divByZero = [UDBinaryOpNode info:[fe infoForOp:UDOpDiv] left:[self num:1] right:[self num:0]];
+    NSArray<UDASTNode *> *trees = @[
+        [UDBinaryOpNode info:[fe infoForOp:UDOpAdd] left:[self num:100] right:percent],
+        [UDBinaryOpNode info:[fe infoForOp:UDOpSub] left:[self num:100] right:[UDParenNode wrap:percent]],
+        [UDFunctionNode func:UDConstPow args:@[ [UDFunctionNode func:UDConstSqrt args:@[ [self num:2] ]], [self num:2] ]],
+        [UDUnaryOpNode info:[fe infoForOp:UDOpNegate] child:[UDPostfixOpNode info:[fe infoForOp:UDOpFactorial] child:[self num:5]]],
+        [UDBinaryOpNode info:[fe infoForOp:UDOpMul] left:divByZero right:[self num:3]],
+        [UDBinaryOpNode info:[fe infoForOp:UDOpDiv] left:[self num:7] right:[self num:2]],
+    ];
+
+    for (NSNumber *integerMode in @[ @NO, @YES ]) {
+        // The other mode must not see these memos
+        UDEvaluationMemo *memo = [[UDEvaluationMemo alloc] init];
+        for (UDASTNode *tree in trees) {
+            UDValue expected = [UDVM executeProgram:[UDCompiler compileProgram:tree withIntegerMode:integerMode.boolValue]];
+            UDValue actual, memoized;
+            XCTAssertTrue([UDCompiler evaluateIncrementally:tree integerMode:integerMode.boolValue memo:memo result:&actual]);
+            XCTAssertEqual(actual.type, expected.type, @"%@", [tree prettyPrint]);
+            XCTAssertEqual(actual.v.intValue, expected.v.intValue, @"%@", [tree prettyPrint]);
+            XCTAssertTrue([memo getValue:&memoized forNode:tree]);
+            XCTAssertEqual(memoized.v.intValue, actual.v.intValue);
+        }
+    }
+}
+
+- (void)testIncrementalEvaluationReusesMemos {
+    UDFrontend *fe = [UDFrontend shared];
+    UDASTNode *left = [UDBinaryOpNode info:[fe infoForOp:UDOpAdd] left:[self num:2] right:[self num:3]];
+    UDEvaluationMemo *memo = [[UDEvaluationMemo alloc] init];
+    UDValue v;
+    XCTAssertTrue([UDCompiler evaluateIncrementally:left integerMode:NO memo:memo result:&v]);
+
+    // A planted memo proves the parent read it instead of re-evaluating
+    [memo setValue:UDValueMakeDouble(10) forNode:left];
+    UDASTNode *root = [UDBinaryOpNode info:[fe infoForOp:UDOpMul] left:left right:[self num:4]];
+    XCTAssertTrue([UDCompiler evaluateIncrementally:root integerMode:NO memo:memo result:&v]);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(v), 40.0, 0.0001);
+
+    // Another evaluator's memo, or this one emptied, does not have it
+    XCTAssertTrue([UDCompiler evaluateIncrementally:root integerMode:NO memo:[[UDEvaluationMemo alloc] init] result:&v]);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(v), 20.0, 0.0001);
+    [memo removeAllValues];
+    XCTAssertEqual(memo.count, 0);
+    XCTAssertTrue([UDCompiler evaluateIncrementally:root integerMode:NO memo:memo result:&v]);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(v), 20.0, 0.0001);
+}
+
+- (void)testMemoDropsNodesThatWentAway {
+    UDEvaluationMemo *memo = [[UDEvaluationMemo alloc] init];
+    UDASTNode *kept = [self num:1];
+    @autoreleasepool {
+        // Enough dead entries to make the memo pack its storage
+        for (int i = 0; i < 1000; i++) [memo setValue:UDValueMakeInt(i) forNode:[self num:i]];
+        [memo setValue:UDValueMakeDouble(42) forNode:kept];
+    }
+    for (int i = 0; i < 1000; i++) [memo setValue:UDValueMakeInt(i) forNode:[self num:i]];
+
+    UDValue v;
+    XCTAssertTrue([memo getValue:&v forNode:kept]);
+    XCTAssertEqual(UDValueAsDouble(v), 42.0);
+    XCTAssertFalse([memo getValue:&v forNode:[self num:1]]);
+}
+
+- (void)testIncrementalEvaluationDeclinesVariables {
+    UDASTNode *root = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpAdd]
+                                      left:[UDVariableNode variable:@"x" slot:0] right:[self num:1]];
+    UDEvaluationMemo *memo = [[UDEvaluationMemo alloc] init];
+    UDValue v;
+    XCTAssertFalse([UDCompiler evaluateIncrementally:root integerMode:NO memo:memo result:&v]);
+    XCTAssertFalse([UDCompiler evaluateIncrementally:[UDFunctionNode func:@"nope" args:@[ [self num:1] ]]
+                                         integerMode:NO memo:memo result:&v]);
+}
+
 @end
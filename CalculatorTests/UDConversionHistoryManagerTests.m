@@ -9,6 +9,22 @@
 #import "UDConversionHistoryManager.h"
 #import "UDConstants.h"
 
+// Counts the history writes that reach the defaults
+@interface UDCountingDefaults : NSUserDefaults
+@property (atomic, assign) NSUInteger writes;
+@end
+
+@implementation UDCountingDefaults
+- (void)setObject:(id)value forKey:(NSString *)defaultName {
+    if ([defaultName isEqualToString:@"ConversionHistory"]) self.writes++;
+    [super setObject:value forKey:defaultName];
+}
+- (void)removeObjectForKey:(NSString *)defaultName {
+    if ([defaultName isEqualToString:@"ConversionHistory"]) self.writes++;
+    [super removeObjectForKey:defaultName];
+}
+@end
+
 @interface UDConversionHistoryManagerTests : XCTestCase
 @property (nonatomic, strong) UDUnitConverter *converter;
 @property (nonatomic, strong) UDConversionHistoryManager *mgr;
@@ -81,4 +97,98 @@
     XCTAssertEqual(self.mgr.history.count, 0);
 }
 
+- (NSDictionary *)entryFrom:(NSUnit *)from to:(NSUnit *)to category:(NSString *)cat {
+    return @{ @"cat": cat, @"from": from, @"to": to };
+}
+
+- (void)testMostRecentFirst {
+    NSDictionary *a = [self entryFrom:[NSUnitMass kilograms] to:[NSUnitMass grams] category:UDConstMass];
+    NSDictionary *b = [self entryFrom:[NSUnitLength meters] to:[NSUnitLength feet] category:UDConstLength];
+    [self.mgr addConversion:a];
+    [self.mgr addConversion:b];
+    [self.mgr addConversion:a];   // back to the top
+
+    XCTAssertEqual(self.mgr.history.count, 2);
+    XCTAssertEqualObjects(self.mgr.history[0], a);
+    XCTAssertEqualObjects(self.mgr.history[1], b);
+}
+
+- (void)testCapDropsOldest {
+    self.mgr.maxItems = 3;
+    NSArray<NSUnit *> *units = [self.converter unitsForCategory:UDConstLength];
+    for (NSUInteger i = 0; i + 1 < units.count; i++) {
+        [self.mgr addConversion:[self entryFrom:units[i] to:units[i + 1] category:UDConstLength]];
+    }
+    XCTAssertEqual(self.mgr.history.count, 3);
+    XCTAssertEqualObjects(self.mgr.history.lastObject[@"from"], units[units.count - 4]);
+}
+
+- (void)testFlushPersists {
+    NSDictionary *a = [self entryFrom:[NSUnitMass kilograms] to:[NSUnitMass grams] category:UDConstMass];
+    NSDictionary *b = [self entryFrom:[NSUnitLength meters] to:[NSUnitLength feet] category:UDConstLength];
+    [self.mgr addConversion:a];
+    [self.mgr addConversion:b];
+    [self.mgr flush];
+
+    UDConversionHistoryManager *reloaded = [[UDConversionHistoryManager alloc] initWithDefaults:self.testDefaults
+                                                                                      converter:self.converter];
+    XCTAssertEqualObjects(reloaded.history, self.mgr.history);
+
+    [self.mgr clearHistory];
+    [self.mgr flush];
+    XCTAssertNil([self.testDefaults arrayForKey:@"ConversionHistory"]);
+}
+
+// Changes closer together than the write delay, spanning more than it:
+// one write, of the final list, once the last change has settled.
+- (void)testBurstOfChangesIsWrittenOnce {
+    // An empty domain of its own
+    UDCountingDefaults *defaults = [[UDCountingDefaults alloc] initWithSuiteName:@"UDConversionHistoryManagerTests"];
+    [defaults removePersistentDomainForName:@"UDConversionHistoryManagerTests"];
+    UDConversionHistoryManager *mgr = [[UDConversionHistoryManager alloc] initWithDefaults:defaults
+                                                                                 converter:self.converter];
+    NSArray<NSUnit *> *units = [self.converter unitsForCategory:UDConstLength];
+    for (NSUInteger i = 0; i < 5; i++) {
+        [mgr addConversion:[self entryFrom:units[i] to:units[i + 1] category:UDConstLength]];
+        [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.3]];
+    }
+    XCTAssertEqual(defaults.writes, 0);
+
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:1.5]];
+    [mgr flush];
+    XCTAssertEqual(defaults.writes, 1);
+    NSArray *stored = [defaults arrayForKey:@"ConversionHistory"];
+    XCTAssertEqual(stored.count, 5);
+    XCTAssertEqualObjects(stored.firstObject[@"from"], units[4].symbol);
+    [defaults removePersistentDomainForName:@"UDConversionHistoryManagerTests"];
+}
+
+// Thousands of entries, added round after round: the cap, the order and
+// the deduplication hold as with ten.
+- (void)testLargeCapKeepsMostRecentDistinctEntries {
+    self.mgr.maxItems = 5000;
+    NSMutableArray<NSDictionary *> *entries = [NSMutableArray array];
+    for (NSString *cat in [self.converter availableCategories]) {
+        for (NSUnit *from in [self.converter unitsForCategory:cat]) {
+            for (NSUnit *to in [self.converter unitsForCategory:cat]) {
+                [entries addObject:[self entryFrom:from to:to category:cat]];
+            }
+        }
+    }
+    for (int round = 0; round < 20; round++) {
+        for (NSDictionary *entry in entries) [self.mgr addConversion:entry];
+    }
+
+    NSArray<NSDictionary *> *history = self.mgr.history;
+    NSUInteger kept = MIN(entries.count, (NSUInteger)5000);
+    XCTAssertEqual(history.count, kept);
+    for (NSUInteger i = 0; i < kept; i++) {
+        XCTAssertEqualObjects(history[i], entries[entries.count - 1 - i]);
+    }
+
+    self.mgr.maxItems = 10;
+    XCTAssertEqual(self.mgr.history.count, 10);
+    XCTAssertEqualObjects(self.mgr.history.firstObject, entries.lastObject);
+}
+
 @end
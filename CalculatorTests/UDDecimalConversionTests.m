@@ -0,0 +1,144 @@
+//
+//  UDDecimalConversionTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDDecimalConversion.h"
+#import "UDInputBuffer.h"
+#import "UDParser.h"
+
+@interface UDDecimalConversionTests : XCTestCase
+@end
+
+@implementation UDDecimalConversionTests {
+    uint64_t _seed;
+}
+
+- (void)setUp {
+    _seed = 88172645463325252ULL;
+}
+
+// xorshift: the same inputs on every run, so a failure reproduces
+- (uint64_t)random {
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 7;
+    _seed ^= _seed << 17;
+    return _seed;
+}
+
+- (double)strtod:(NSString *)literal {
+    return strtod(literal.UTF8String, NULL);
+}
+
+- (void)assertDouble:(double)actual isBitwise:(double)expected label:(NSString *)label {
+    XCTAssertEqual(memcmp(&actual, &expected, sizeof(double)), 0, @"%@: %.17g, expected %.17g", label, actual, expected);
+}
+
+// --- CORRECTNESS ---
+// strtod is the spec: correctly rounded, ties to even.
+
+- (void)testMatchesStrtodOnRandomInputs {
+    for (int n = 0; n < 200000; n++) {
+        unsigned long long mantissa = [self random] >> ([self random] % 64);
+        long exponent = (long)([self random] % 700) - 360;
+        if (n % 4 == 0) exponent = (long)([self random] % 46) - 23;   // the exact fast path
+
+        NSString *literal = [NSString stringWithFormat:@"%llue%ld", mantissa, exponent];
+        [self assertDouble:UDDoubleFromDecimal(mantissa, exponent, NO) isBitwise:[self strtod:literal] label:literal];
+    }
+}
+
+- (void)testHardCases {
+    NSArray<NSString *> *cases = @[
+        @"9007199254740993",                         // halfway, rounds to even
+        @"9007199254740995",
+        @"9007199254740993.0000000000000000001",     // just past halfway
+        @"2.2250738585072011e-308",                  // largest subnormal
+        @"2.2250738585072014e-308",                  // smallest normal
+        @"4.9406564584124654e-324",
+        @"2.4703282292062327e-324",                  // just under half the smallest subnormal
+        @"2.4703282292062328e-324",
+        @"1.7976931348623157e308",
+        @"1.7976931348623159e308",                   // overflows
+        @"1e-400", @"1e400", @"0.1", @"0.3", @"123.456", @"6.02214076e23",
+        @"123456789012345678901234567890",
+        @"0.000000000000000000000000000001234567890123456789012345"
+    ];
+    for (NSString *literal in cases) {
+        double d = -1;
+        XCTAssertTrue(UDDoubleFromDecimalString(literal.UTF8String, strlen(literal.UTF8String), &d), @"%@", literal);
+        [self assertDouble:d isBitwise:[self strtod:literal] label:literal];
+    }
+}
+
+- (void)testRejectsMalformedLiterals {
+    double d;
+    for (NSString *literal in @[ @"", @".", @"e5", @"1e", @"1e+", @"1.2.3", @"1x" ]) {
+        XCTAssertFalse(UDDoubleFromDecimalString(literal.UTF8String, strlen(literal.UTF8String), &d), @"%@", literal);
+    }
+}
+
+- (void)testSignedZero {
+    double d = UDDoubleFromDecimal(0, 5, YES);
+    XCTAssertEqual(d, 0.0);
+    XCTAssertTrue(signbit(d));
+}
+
+- (void)testSignIsAppliedAfterRounding {
+    // Ties to even is symmetric, so a negative value is its positive mirrored
+    for (int n = 0; n < 20000; n++) {
+        unsigned long long mantissa = [self random] >> ([self random] % 64);
+        long exponent = (long)([self random] % 700) - 360;
+        double positive = UDDoubleFromDecimal(mantissa, exponent, NO);
+        [self assertDouble:UDDoubleFromDecimal(mantissa, exponent, YES) isBitwise:-positive
+                     label:[NSString stringWithFormat:@"-%llue%ld", mantissa, exponent]];
+    }
+}
+
+- (void)testStringFormsAgreeWithParts {
+    // Where the point sits and how many zeros pad the digits only move the exponent
+    NSDictionary<NSString *, NSArray *> *forms = @{
+        @"0.00123":      @[ @123, @-5 ],
+        @".00123e2":     @[ @123, @-3 ],
+        @"123000e-8":    @[ @123, @-5 ],
+        @"00012.3E+1":   @[ @123, @0 ],
+        @"1.2300":       @[ @123, @-2 ],
+        @"98765432109876543.21e-300": @[ @9876543210987654321ULL, @-302 ],
+    };
+    for (NSString *literal in forms) {
+        double d = -1;
+        XCTAssertTrue(UDDoubleFromDecimalString(literal.UTF8String, strlen(literal.UTF8String), &d), @"%@", literal);
+        double parts = UDDoubleFromDecimal([forms[literal][0] unsignedLongLongValue], [forms[literal][1] longValue], NO);
+        [self assertDouble:d isBitwise:parts label:literal];
+    }
+}
+
+// Keypad entry lands on the same double as the literal typed into a parser
+- (void)testInputBufferIsCorrectlyRounded {
+    NSArray<NSString *> *typed = @[ @"0.3", @"0.1", @"1.5e-7", @"123.456e-300", @"7e22", @"8.9e307", @"4.9e-324" ];
+    for (NSString *literal in typed) {
+        UDInputBuffer *buffer = [[UDInputBuffer alloc] init];
+        for (NSUInteger i = 0; i < literal.length; i++) {
+            unichar c = [literal characterAtIndex:i];
+            if (c == '.') [buffer handleDecimalPoint];
+            else if (c == 'e') [buffer handleEE];
+            else if (c == '-') [buffer toggleSign];
+            else [buffer handleDigit:c - '0'];
+        }
+        [self assertDouble:UDValueAsDouble([buffer finalizeValue]) isBitwise:[self strtod:literal] label:literal];
+    }
+}
+
+- (void)testParserLiteralsAreCorrectlyRounded {
+    UDParser *parser = [[UDParser alloc] init];
+    for (NSString *literal in @[ @"0.3", @"2.2250738585072011e-308", @"9007199254740993", @"1e23" ]) {
+        UDNumberNode *node = (UDNumberNode *)[parser parseString:literal];
+        XCTAssertTrue([node isKindOfClass:[UDNumberNode class]], @"%@", literal);
+        [self assertDouble:UDValueAsDouble(node.value) isBitwise:[self strtod:literal] label:literal];
+    }
+}
+
+@end
@@ -0,0 +1,214 @@
+//
+//  UDJITTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDJIT.h"
+#import "UDVM.h"
+
+@interface UDJITTests : XCTestCase
+@end
+
+@implementation UDJITTests {
+    uint64_t _seed;
+    BOOL _wasEnabled;
+}
+
+- (void)setUp {
+    _seed = 88172645463325252ULL;
+    // Off by default; these tests are about what it does when on
+    _wasEnabled = UDJIT.enabled;
+    UDJIT.enabled = YES;
+}
+
+- (void)tearDown {
+    UDJIT.enabled = _wasEnabled;
+}
+
+- (void)assertValue:(UDValue)actual equals:(UDValue)expected program:(UDProgram *)prog {
+    XCTAssertEqual(actual.type, expected.type, @"%@", [prog debugDescription]);
+    if (expected.type == UDValueTypeDouble && isnan(expected.v.doubleValue)) {
+        XCTAssertTrue(isnan(actual.v.doubleValue), @"%@", [prog debugDescription]);
+    } else {
+        XCTAssertEqual(actual.v.intValue, expected.v.intValue, @"%@", [prog debugDescription]); // bit-exact
+    }
+}
+
+// xorshift: the same programs on every run, so a failure reproduces
+- (uint32_t)random {
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 7;
+    _seed ^= _seed << 17;
+    return (uint32_t)_seed;
+}
+
+- (double)randomOperand {
+    if ([self random] % 5 == 0) return 0;   // divide by zero now and then
+    return ((int)([self random] % 2000) - 1000) / 37.0;
+}
+
+// A random well-formed program over the JIT's subset, reading inputs 0...2.
+// Deep enough that some stack slots spill out of registers.
+- (UDProgram *)randomProgram {
+    static const UDOpcode binary[] = { UDOpcodeAdd, UDOpcodeSub, UDOpcodeMul, UDOpcodeDiv, UDOpcodePow };
+    static const UDOpcode constant[] = { UDOpcodeAddK, UDOpcodeSubK, UDOpcodeMulK, UDOpcodeDivK };
+    static const UDOpcode unary[] = {
+        UDOpcodeNeg, UDOpcodeSqrt, UDOpcodeLn, UDOpcodeSin, UDOpcodeSinD, UDOpcodeASin, UDOpcodeCos,
+        UDOpcodeACosD, UDOpcodeTan, UDOpcodeATan, UDOpcodeSinH, UDOpcodeACosH, UDOpcodeTanH,
+        UDOpcodeLog10, UDOpcodeLog2, UDOpcodeFact, UDOpcodeSquare
+    };
+
+    UDProgram *prog = [UDProgram program];
+    NSUInteger depth = 0;
+    NSUInteger length = 1 + [self random] % 120;
+    for (NSUInteger i = 0; i < length; i++) {
+        uint32_t r = [self random] % 10;
+        if (depth < 2 || r < 3) {
+            if ([self random] % 2) [prog emitLoad:[self random] % 3];
+            else [prog emitPush:UDValueMakeDouble([self randomOperand])];
+            depth++;
+        } else if (r < 6) {
+            [prog emitOp:binary[[self random] % 5]];
+            depth--;
+        } else if (r < 7) {
+            [prog emitOp:constant[[self random] % 4] constant:UDValueMakeDouble([self randomOperand])];
+        } else {
+            [prog emitOp:unary[[self random] % (sizeof(unary) / sizeof(unary[0]))]];
+        }
+    }
+    while (depth-- > 1) [prog emitOp:UDOpcodeAdd];
+    [prog emitOp:UDOpcodeAddK constant:UDValueMakeDouble(0.5)];     // a bare LOAD is left to the interpreter
+    return prog;
+}
+
+- (void)testMatchesInterpreterOnRandomPrograms {
+    if (!UDJIT.isSupported) return;
+
+    for (NSUInteger n = 0; n < 2000; n++) {
+        UDProgram *prog = [self randomProgram];
+        UDJITCode *native = [UDJIT compileProgram:prog];
+        XCTAssertNotNil(native, @"%@", [prog debugDescription]);
+
+        UDValue inputs[] = { UDValueMakeDouble([self randomOperand]), UDValueMakeDouble([self random] % 100 / 3.0),
+                             UDValueMakeInt([self random] % 50) };
+        UDValue expected = [UDVM executeProgram:prog inputs:inputs count:3 dispatch:UDVMDispatchSwitch];
+        UDValue actual = [native runWithInputs:inputs];
+
+        [self assertValue:actual equals:expected program:prog];
+    }
+}
+
+- (void)testMatchesInterpreterOnEveryOpcode {
+    if (!UDJIT.isSupported) return;
+
+    static const UDOpcode binary[] = {
+        UDOpcodeAdd, UDOpcodeSub, UDOpcodeMul, UDOpcodeDiv, UDOpcodeAddI, UDOpcodeSubI, UDOpcodeMulI,
+        UDOpcodeDivI, UDOpcodeBitAnd, UDOpcodeBitOr, UDOpcodeBitXor, UDOpcodeShiftLeft, UDOpcodeShiftRight,
+        UDOpcodeRotateLeft, UDOpcodeRotateRight, UDOpcodePow,
+    };
+    static const UDOpcode constant[] = {
+        UDOpcodeAddK, UDOpcodeSubK, UDOpcodeMulK, UDOpcodeDivK,
+        UDOpcodeAddIK, UDOpcodeSubIK, UDOpcodeMulIK, UDOpcodeDivIK,
+    };
+    static const UDOpcode unary[] = {
+        UDOpcodeNeg, UDOpcodeNegI, UDOpcodeBitNot, UDOpcodeSqrt, UDOpcodeLn, UDOpcodeSin, UDOpcodeSinD,
+        UDOpcodeASin, UDOpcodeASinD, UDOpcodeCos, UDOpcodeCosD, UDOpcodeACos, UDOpcodeACosD, UDOpcodeTan,
+        UDOpcodeTanD, UDOpcodeATan, UDOpcodeATanD, UDOpcodeSinH, UDOpcodeASinH, UDOpcodeCosH, UDOpcodeACosH,
+        UDOpcodeTanH, UDOpcodeATanH, UDOpcodeLog10, UDOpcodeLog2, UDOpcodeFact, UDOpcodeFlipB, UDOpcodeFlipW,
+        UDOpcodeSquare, UDOpcodeShiftLeft1, UDOpcodeShiftRight1, UDOpcodeRotateLeft1, UDOpcodeRotateRight1,
+    };
+    const size_t binaryCount = sizeof(binary) / sizeof(binary[0]);
+    const size_t constantCount = sizeof(constant) / sizeof(constant[0]);
+    const size_t unaryCount = sizeof(unary) / sizeof(unary[0]);
+    // Everything but PUSH, LOAD, CALL and HALT, which the operands use or
+    // no program ends on
+    XCTAssertEqual(binaryCount + constantCount + unaryCount + 4, (size_t)UDOpcodeCount);
+
+    static const double operands[] = { 0, 1, -1, 0.5, 2.5, -7.25, 90, 1e300 };
+    const size_t operandCount = sizeof(operands) / sizeof(operands[0]);
+
+    NSUInteger compiled = 0;
+    for (size_t i = 0; i < binaryCount + constantCount + unaryCount; i++) {
+        for (size_t a = 0; a < operandCount; a++) {
+            for (size_t b = 0; b < operandCount; b++) {
+                UDProgram *prog = [UDProgram program];
+                [prog emitLoad:0];
+                if (i < binaryCount) {
+                    [prog emitLoad:1];
+                    [prog emitOp:binary[i]];
+                } else if (i < binaryCount + constantCount) {
+                    [prog emitOp:constant[i - binaryCount] constant:UDValueMakeDouble(operands[b])];
+                } else {
+                    if (b > 0) continue;
+                    [prog emitOp:unary[i - binaryCount - constantCount]];
+                }
+
+                UDValue inputs[] = { UDValueMakeDouble(operands[a]), UDValueMakeDouble(operands[b]) };
+                UDValue expected = [UDVM executeProgram:prog inputs:inputs count:2 dispatch:UDVMDispatchSwitch];
+                // An opcode outside the subset is left to the interpreter
+                UDJITCode *native = [UDJIT compileProgram:prog];
+                if (native) {
+                    compiled++;
+                    [self assertValue:[native runWithInputs:inputs] equals:expected program:prog];
+                }
+                UDValue tiered = [UDVM executeProgram:prog inputs:inputs count:2 dispatch:UDVMDispatchNative];
+                [self assertValue:tiered equals:expected program:prog];
+            }
+        }
+    }
+    XCTAssertGreaterThan(compiled, 0);
+}
+
+- (void)testLeavesIntegerProgramsToTheInterpreter {
+    UDProgram *prog = [UDProgram program];
+    [prog emitPush:UDValueMakeInt(6)];
+    [prog emitPush:UDValueMakeInt(3)];
+    [prog emitOp:UDOpcodeBitXor];
+    XCTAssertNil([UDJIT compileProgram:prog]);
+
+    // Still runs, natively dispatched or not
+    XCTAssertEqual(UDValueAsInt([UDVM executeProgram:prog dispatch:UDVMDispatchNative]), 5);
+    XCTAssertEqual(prog.nativeRejected, UDJIT.enabled);
+}
+
+- (void)testDisabledJITFallsBack {
+    BOOL enabled = UDJIT.enabled;
+    UDJIT.enabled = NO;
+
+    UDProgram *prog = [UDProgram program];
+    [prog emitPush:UDValueMakeDouble(10)];
+    [prog emitPush:UDValueMakeDouble(4)];
+    [prog emitOp:UDOpcodeDiv];
+    XCTAssertNil([UDJIT compileProgram:prog]);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([UDVM executeProgram:prog dispatch:UDVMDispatchNative]), 2.5, 0.0001);
+    XCTAssertNil(prog.nativeForm);
+
+    UDJIT.enabled = enabled;
+}
+
+- (void)testHotProgramIsPromoted {
+    if (!UDJIT.isSupported) return;
+    NSUInteger threshold = UDVM.jitThreshold;
+    UDVM.jitThreshold = 8;
+
+    UDProgram *prog = [UDProgram program];
+    [prog emitLoad:0];
+    [prog emitPush:UDValueMakeDouble(0)];
+    [prog emitOp:UDOpcodeDiv];
+    UDValue x = UDValueMakeDouble(1);
+    for (int i = 0; i < 7; i++) [UDVM executeProgram:prog inputs:&x count:1];
+    XCTAssertNil(prog.nativeForm);
+    [UDVM executeProgram:prog inputs:&x count:1];
+    XCTAssertNotNil(prog.nativeForm);
+
+    // Errors come back the same from native code
+    UDValue res = [UDVM executeProgram:prog inputs:&x count:1];
+    XCTAssertEqual(UDValueAsError(res), UDValueErrorTypeDivideByZero);
+
+    UDVM.jitThreshold = threshold;
+}
+
+@end
@@ -0,0 +1,79 @@
+//
+//  UDParallelBatchTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDParallelBatch.h"
+
+@interface UDParallelBatchTests : XCTestCase
+@end
+
+@implementation UDParallelBatchTests
+
+// Enough lines that every worker has chunks to pop and to steal
+- (NSArray<NSString *> *)numberedLines:(NSUInteger)count {
+    NSMutableArray *lines = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [lines addObject:[NSString stringWithFormat:@"%lu * 2 + 1", (unsigned long)i]];
+    }
+    return lines;
+}
+
+- (void)testOutputKeepsInputOrder {
+    UDParallelBatch *batch = [[UDParallelBatch alloc] initWithWorkerCount:4];
+    NSArray<NSString *> *results = [batch evaluateLines:[self numberedLines:5000]];
+
+    XCTAssertEqual(results.count, 5000);
+    for (NSUInteger i = 0; i < results.count; i++) {
+        XCTAssertEqualObjects(results[i], ([NSString stringWithFormat:@"%lu", (unsigned long)(i * 2 + 1)]));
+    }
+}
+
+- (void)testMatchesSerialEvaluation {
+    NSArray<NSString *> *lines = @[ @"2 + 3 * 4", @"sin(π / 2)", @"2^10", @"5!", @"1 / 0",
+                                    @"sqrt 16 + cbrt 27", @"(1 + 2) * (3 + 4)", @"2 +" ];
+    NSMutableArray *many = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 200; i++) [many addObjectsFromArray:lines];
+
+    UDBatchEvaluator *serial = [[UDBatchEvaluator alloc] init];
+    UDParallelBatch *batch = [[UDParallelBatch alloc] initWithWorkerCount:0];
+    XCTAssertGreaterThan(batch.workerCount, 0);
+
+    NSArray<NSString *> *results = [batch evaluateLines:many];
+    for (NSUInteger i = 0; i < many.count; i++) {
+        XCTAssertEqualObjects(results[i], [serial stringForValue:[serial evaluateLine:many[i]]]);
+    }
+}
+
+- (void)testUTF8LinesWithLatencies {
+    const char *lines[] = { "1 + 1", "oops", "0xF0 or 0x0F" };
+    NSUInteger lengths[] = { 5, 4, 12 };
+    UDValue results[3];
+    uint64_t latencies[3] = { 0, 0, 0 };
+
+    UDParallelBatch *batch = [[UDParallelBatch alloc] initWithWorkerCount:2];
+    batch.integerMode = YES;
+    batch.base = UDBaseHex;
+    [batch evaluateUTF8Lines:lines lengths:lengths count:3 results:results latencies:latencies];
+
+    XCTAssertEqualObjects([batch stringForValue:results[0]], @"0x2");
+    // A bad line is an error in its own slot only
+    XCTAssertEqual(results[1].type, UDValueTypeErr);
+    XCTAssertEqualObjects([batch stringForValue:results[2]], @"0xFF");
+    XCTAssertGreaterThan(latencies[0], 0);
+}
+
+- (void)testKeyLines {
+    UDParallelBatch *batch = [[UDParallelBatch alloc] initWithWorkerCount:3];
+    batch.inputFormat = UDBatchInputFormatKeys;
+    NSArray<NSString *> *results = [batch evaluateLines:@[ @"2 Add 3 Mul 4 Eq", @"16 Sqrt", @"1 Frobnicate" ]];
+
+    XCTAssertEqualObjects(results[0], @"14");
+    XCTAssertEqualObjects(results[1], @"4");
+    XCTAssertEqualObjects(results[2], @"Error");
+}
+
+@end
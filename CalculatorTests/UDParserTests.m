@@ -0,0 +1,135 @@
+//
+//  UDParserTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDParser.h"
+#import "UDCompiler.h"
+#import "UDFrontend.h"
+#import "UDVM.h"
+
+@interface UDParserTests : XCTestCase
+@property (nonatomic, strong) UDParser *parser;
+@end
+
+@implementation UDParserTests
+
+- (void)setUp {
+    [super setUp];
+    self.parser = [[UDParser alloc] init];
+}
+
+// --- HELPERS ---
+
+- (UDNumberNode *)num:(double)val {
+    return [UDNumberNode value:UDValueMakeDouble(val)];
+}
+
+- (UDASTNode *)bin:(UDOp)op left:(UDASTNode *)l right:(UDASTNode *)r {
+    return [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:op] left:l right:r];
+}
+
+- (UDValue)eval:(NSString *)text {
+    UDASTNode *tree = [self.parser parseString:text];
+    XCTAssertNotNil(tree, @"'%@' failed at %lu", text, (unsigned long)self.parser.errorOffset);
+    return [UDVM executeProgram:[UDCompiler compileProgram:tree withIntegerMode:self.parser.integerMode]];
+}
+
+// --- TESTS ---
+
+- (void)testPrecedenceMatchesFrontendTable {
+    // 2 + 3 * 4 -> +(2, *(3, 4))
+    UDASTNode *expected = [self bin:UDOpAdd left:[self num:2] right:[self bin:UDOpMul left:[self num:3] right:[self num:4]]];
+    XCTAssertTrue([[self.parser parseString:@"2 + 3 * 4"] isIdenticalTo:expected]);
+
+    // Left associative: 10 - 4 - 3 = 3
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"10 - 4 - 3"]), 3.0, 0.0001);
+    // Right associative: 2 ^ 3 ^ 2 = 2 ^ 9
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"2 ^ 3 ^ 2"]), 512.0, 0.0001);
+}
+
+- (void)testParenthesesAreKeptLikeKeypadGroups {
+    // Same tree as keying ( 2 + 3 ) x²
+    UDASTNode *group = [UDParenNode wrap:[self bin:UDOpAdd left:[self num:2] right:[self num:3]]];
+    UDASTNode *expected = [UDFunctionNode function:UDFunctionPow args:@[ group, [self num:2] ]];
+    XCTAssertEqualObjects([self.parser parseString:@"(2 + 3)²"], expected);
+}
+
+- (void)testUnaryMinusAndPercent {
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"-2 ^ 2"]), -4.0, 0.0001);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"3 - -2"]), 5.0, 0.0001);
+    // Same percent rewrite as the keypad: 100 + 5%
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"100 + 5%"]), 105.0, 0.0001);
+}
+
+- (void)testFunctionsAndConstants {
+    self.parser.isRadians = NO;
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"sin(30) * 2"]), 1.0, 0.0001);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"√16 + log 100"]), 6.0, 0.0001);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"pow(2, 10)"]), 1024.0, 0.0001);
+
+    self.parser.isRadians = YES;
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"cos(π)"]), -1.0, 0.0001);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"ln e"]), 1.0, 0.0001);
+}
+
+- (void)testProgrammerLiteralsAndOperators {
+    self.parser.integerMode = YES;
+    XCTAssertEqual(UDValueAsInt([self eval:@"0xFF and ~0b1010"]), 0xF5ULL);
+    XCTAssertEqual(UDValueAsInt([self eval:@"1 << 4 | 0o17"]), 31ULL);
+    XCTAssertEqual(UDValueAsInt([self eval:@"0x12 xor 0x30"]), 0x22ULL);
+    XCTAssertEqual(UDValueAsInt([self eval:@"1 rol 3"]), 8ULL);
+
+    // No fractions among integers
+    XCTAssertNil([self.parser parseString:@"1.5 + 1"]);
+}
+
+- (void)testVariablesBecomeInputSlots {
+    self.parser.variables = @[ @"price", @"qty" ];
+    UDASTNode *tree = [self.parser parseString:@"price * qty * 1.2"];
+    XCTAssertNotNil(tree);
+
+    UDProgram *prog = [UDCompiler compileProgram:tree withIntegerMode:NO optimize:YES];
+    XCTAssertEqual(prog.inputCount, 2);
+    UDValue inputs[] = { UDValueMakeDouble(2.5), UDValueMakeDouble(4) };
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([UDVM executeProgram:prog inputs:inputs count:2]), 12.0, 0.0001);
+
+    // Built-in names win
+    self.parser.variables = @[ @"e" ];
+    XCTAssertTrue([[self.parser parseString:@"e"] isKindOfClass:[UDConstantNode class]]);
+    XCTAssertNil([self.parser parseString:@"price"]);
+}
+
+- (void)testSyntaxErrorsReportTheirOffset {
+    XCTAssertNil([self.parser parseString:@"2 + * 3"]);
+    XCTAssertEqual(self.parser.errorOffset, 4);
+
+    XCTAssertNil([self.parser parseString:@"(1 + 2"]);
+    XCTAssertEqual(self.parser.errorOffset, 6);
+
+    XCTAssertNil([self.parser parseString:@"frobnicate(1)"]);
+    XCTAssertEqual(self.parser.errorOffset, 0);
+
+    XCTAssertNil([self.parser parseString:@""]);
+
+    XCTAssertNotNil([self.parser parseString:@"1"]);
+    XCTAssertEqual(self.parser.errorOffset, NSNotFound);
+}
+
+- (void)testExponentNeedsDigits {
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"2e3"]), 2000.0, 0.0001);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"2.5E-1"]), 0.25, 0.0001);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self eval:@"2 * e"]), 2 * M_E, 0.0001);
+
+    // Without digits the e is a separate word, and two values in a row
+    // are an error at the second
+    XCTAssertNil([self.parser parseString:@"2e"]);
+    XCTAssertEqual(self.parser.errorOffset, 1);
+    XCTAssertNil([self.parser parseString:@"2e+"]);
+    XCTAssertEqual(self.parser.errorOffset, 1);
+}
+
+@end
@@ -0,0 +1,101 @@
+//
+//  UDProgramCacheTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDProgramCache.h"
+#import "UDFrontend.h"
+
+@interface UDProgramCacheTests : XCTestCase
+@property (nonatomic, strong) UDProgramCache *cache;
+@end
+
+@implementation UDProgramCacheTests
+
+- (void)setUp {
+    [super setUp];
+    self.cache = [[UDProgramCache alloc] initWithCapacity:2];
+}
+
+// --- HELPERS ---
+
+- (UDNumberNode *)num:(double)val {
+    return [UDNumberNode value:UDValueMakeDouble(val)];
+}
+
+- (UDASTNode *)add:(UDASTNode *)l to:(UDASTNode *)r {
+    return [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpAdd] left:l right:r];
+}
+
+// --- TESTS ---
+
+- (void)testSameNodeHitsByIdentity {
+    UDASTNode *tree = [self add:[self num:2] to:[self num:3]];
+
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self.cache evaluateNode:tree integerMode:NO]), 5.0, 0.0001);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([self.cache evaluateNode:tree integerMode:NO]), 5.0, 0.0001);
+
+    XCTAssertEqual(self.cache.misses, 1);
+    XCTAssertEqual(self.cache.hits, 1);
+    XCTAssertNotNil([self.cache cachedProgramForNode:tree integerMode:NO]);
+}
+
+- (void)testEqualTreeHitsByStructure {
+    [self.cache evaluateNode:[self add:[self num:2] to:[self num:3]] integerMode:NO];
+    [self.cache evaluateNode:[self add:[self num:2] to:[self num:3]] integerMode:NO];
+
+    XCTAssertEqual(self.cache.misses, 1);
+    XCTAssertEqual(self.cache.hits, 1);
+}
+
+- (void)testNearlyEqualNumbersDoNotShareAnEntry {
+    // -isEqual: treats these as equal; the cache must not
+    [self.cache evaluateNode:[self num:1.0] integerMode:NO];
+    UDValue res = [self.cache evaluateNode:[self num:1.0 + 1e-9] integerMode:NO];
+
+    XCTAssertEqual(self.cache.misses, 2);
+    XCTAssertEqual(UDValueAsDouble(res), 1.0 + 1e-9);
+}
+
+- (void)testIntegerModeIsPartOfTheKey {
+    UDASTNode *tree = [self add:[self num:2] to:[self num:3]];
+    [self.cache evaluateNode:tree integerMode:NO];
+    UDValue res = [self.cache evaluateNode:tree integerMode:YES];
+
+    XCTAssertEqual(self.cache.misses, 2);
+    XCTAssertEqual(res.type, UDValueTypeInteger);
+    XCTAssertEqual(self.cache.count, 1);
+}
+
+- (void)testEvictsLeastRecentlyUsed {
+    UDASTNode *a = [self num:1], *b = [self num:2], *c = [self num:3];
+    [self.cache evaluateNode:a integerMode:NO];
+    [self.cache evaluateNode:b integerMode:NO];
+    [self.cache evaluateNode:a integerMode:NO];   // b is now the oldest
+    [self.cache evaluateNode:c integerMode:NO];
+
+    XCTAssertEqual(self.cache.count, 2);
+    XCTAssertNotNil([self.cache cachedProgramForNode:a integerMode:NO]);
+    XCTAssertNil([self.cache cachedProgramForNode:b integerMode:NO]);
+    XCTAssertNotNil([self.cache cachedProgramForNode:c integerMode:NO]);
+}
+
+- (void)testErrorResultsAreCached {
+    UDASTNode *tree = [UDBinaryOpNode info:[[UDFrontend shared] infoForOp:UDOpDiv] left:[self num:1] right:[self num:0]];
+    [self.cache evaluateNode:tree integerMode:NO];
+    UDValue res = [self.cache evaluateNode:tree integerMode:NO];
+
+    XCTAssertEqual(self.cache.hits, 1);
+    XCTAssertEqual(UDValueAsError(res), UDValueErrorTypeDivideByZero);
+}
+
+- (void)testRemoveAllEntries {
+    [self.cache evaluateNode:[self num:1] integerMode:NO];
+    [self.cache removeAllEntries];
+    XCTAssertEqual(self.cache.count, 0);
+}
+
+@end
@@ -0,0 +1,195 @@
+//
+//  UDRegisterFileTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDRegisterFile.h"
+
+@interface UDRegisterFileTests : XCTestCase
+@end
+
+@implementation UDRegisterFileTests {
+    uint64_t _seed;
+}
+
+- (void)setUp {
+    _seed = 88172645463325252ULL;
+}
+
+// xorshift: the same operations on every run, so a failure reproduces
+- (uint32_t)random {
+    _seed ^= _seed << 13;
+    _seed ^= _seed >> 7;
+    _seed ^= _seed << 17;
+    return (uint32_t)_seed;
+}
+
+- (UDASTNode *)number:(double)d {
+    return [UDNumberNode value:UDValueMakeDouble(d)];
+}
+
+// --- CORRECTNESS ---
+// NSMutableArray is the spec, wrapped around the ring in every position.
+
+- (void)testMatchesMutableArrayOnRandomOperations {
+    UDRegisterFile *registers = [UDRegisterFile array];
+    NSMutableArray<UDASTNode *> *expected = [NSMutableArray array];
+
+    for (int n = 0; n < 20000; n++) {
+        uint32_t r = [self random] % 9;
+        if (expected.count < 3 || r == 0) {
+            UDASTNode *node = [self number:n];
+            [registers addObject:node];
+            [expected addObject:node];
+        } else if (r == 1) {
+            NSUInteger index = [self random] % (expected.count + 1);
+            UDASTNode *node = [self number:n];
+            [registers insertObject:node atIndex:index];
+            [expected insertObject:node atIndex:index];
+        } else if (r == 2) {
+            NSUInteger index = [self random] % expected.count;
+            [registers removeObjectAtIndex:index];
+            [expected removeObjectAtIndex:index];
+        } else if (r == 3) {
+            [registers duplicateTop];
+            [expected addObject:expected.lastObject];
+        } else if (r == 4) {
+            [registers swapTop];
+            [expected exchangeObjectAtIndex:expected.count - 1 withObjectAtIndex:expected.count - 2];
+        } else if (r == 5) {
+            [registers rollDown];
+            UDASTNode *top = expected.lastObject;
+            [expected removeLastObject];
+            [expected insertObject:top atIndex:0];
+        } else if (r == 6) {
+            [registers rollUp];
+            UDASTNode *bottom = expected.firstObject;
+            [expected removeObjectAtIndex:0];
+            [expected addObject:bottom];
+        } else if (expected.count > 40) {
+            [registers removeLastObject];
+            [expected removeLastObject];
+        }
+        XCTAssertEqual(registers.count, expected.count);
+        XCTAssertTrue(registers.lastObject == expected.lastObject, @"step %d", n);
+    }
+    XCTAssertEqualObjects([registers copy], [expected copy]);
+}
+
+// Deep stacks, both with free slots and filling the ring to the last
+// one, where rolling only moves the head.
+- (void)testRollingDeepStacksKeepsEveryEntry {
+    static const NSUInteger kDepths[] = { 8192, 10000 };
+    for (int d = 0; d < 2; d++) {
+        NSUInteger depth = kDepths[d];
+        UDRegisterFile *registers = [UDRegisterFile array];
+        NSMutableArray<NSNumber *> *expected = [NSMutableArray array];
+        for (NSUInteger i = 0; i < depth; i++) {
+            [registers pushValue:UDValueMakeDouble(i)];
+            [expected addObject:@(i)];
+        }
+        for (int n = 0; n < 1000; n++) {
+            [registers rollDown];
+            NSNumber *top = expected.lastObject;
+            [expected removeLastObject];
+            [expected insertObject:top atIndex:0];
+            [registers swapTop];
+            [expected exchangeObjectAtIndex:depth - 1 withObjectAtIndex:depth - 2];
+            if (n % 3) {
+                [registers rollUp];
+                NSNumber *bottom = expected.firstObject;
+                [expected removeObjectAtIndex:0];
+                [expected addObject:bottom];
+            }
+        }
+        XCTAssertEqual(registers.count, depth);
+        UDValue v;
+        for (NSUInteger i = 0; i < depth; i++) {
+            XCTAssertTrue([registers getLiteral:&v atIndex:i]);
+            XCTAssertEqual(UDValueAsDouble(v), expected[i].doubleValue, @"depth %lu, index %lu",
+                           (unsigned long)depth, (unsigned long)i);
+        }
+    }
+}
+
+- (void)testBareValuesBecomeNodesOnDemand {
+    UDRegisterFile *registers = [UDRegisterFile array];
+    [registers pushValue:UDValueMakeDouble(3)];
+    [registers pushValue:UDValueMakeInt(7)];
+
+    UDValue v;
+    XCTAssertTrue([registers getLiteral:&v atIndex:0]);
+    XCTAssertEqual(UDValueAsDouble(v), 3);
+
+    // Read as an object, a bare value is a number node, made once
+    UDASTNode *node = registers[1];
+    XCTAssertTrue([node isKindOfClass:[UDNumberNode class]]);
+    XCTAssertEqual(((UDNumberNode *)node).value.v.intValue, 7);
+    XCTAssertTrue(registers[1] == node);
+    XCTAssertTrue([registers getLiteral:&v atIndex:1]);
+}
+
+- (void)testTreesAndErrorsAreNotLiterals {
+    UDRegisterFile *registers = [UDRegisterFile array];
+    [registers addObject:[UDParenNode wrap:[self number:1]]];
+    [registers pushValue:UDValueMakeError(UDValueErrorTypeDivideByZero)];
+
+    UDValue v;
+    XCTAssertFalse([registers getLiteral:&v atIndex:0]);
+    XCTAssertFalse([registers getLiteral:&v atIndex:1]);
+}
+
+- (void)testDuplicateSharesTheTree {
+    UDRegisterFile *registers = [UDRegisterFile array];
+    UDASTNode *tree = [UDParenNode wrap:[self number:2]];
+    [registers addObject:tree];
+    [registers duplicateTop];
+    XCTAssertEqual(registers.count, 2);
+    XCTAssertTrue(registers[0] == tree && registers[1] == tree);
+}
+
+- (void)testIdentitiesFollowTheirEntries {
+    UDRegisterFile *registers = [UDRegisterFile array];
+    for (int i = 0; i < 4; i++) [registers pushValue:UDValueMakeDouble(i)];
+    uint64_t ids[4];
+    for (int i = 0; i < 4; i++) ids[i] = [registers identityAtIndex:i];
+
+    [registers rollDown];
+    [registers swapTop];
+    XCTAssertEqual([registers identityAtIndex:0], ids[3]);
+    XCTAssertEqual([registers identityAtIndex:2], ids[2]);
+    XCTAssertEqual([registers identityAtIndex:3], ids[1]);
+
+    [registers duplicateTop];
+    XCTAssertEqual([registers identityAtIndex:4], ids[1]);
+
+    // Reading a bare value as a node keeps its identity; storing does not
+    (void)registers[0];
+    XCTAssertEqual([registers identityAtIndex:0], ids[3]);
+    [registers replaceObjectAtIndex:0 withObject:[self number:9]];
+    XCTAssertNotEqual([registers identityAtIndex:0], ids[3]);
+}
+
+- (void)testShortStacksIgnoreRegisterOperations {
+    UDRegisterFile *registers = [UDRegisterFile array];
+    [registers swapTop];
+    [registers rollUp];
+    [registers duplicateTop];
+    XCTAssertEqual(registers.count, 0);
+
+    [registers pushValue:UDValueMakeDouble(1)];
+    [registers swapTop];
+    [registers rollDown];
+    XCTAssertEqual(registers.count, 1);
+}
+
+- (void)testOutOfRangeRaises {
+    UDRegisterFile *registers = [UDRegisterFile array];
+    XCTAssertThrowsSpecificNamed(registers[0], NSException, NSRangeException);
+    XCTAssertThrowsSpecificNamed([registers removeLastObject], NSException, NSRangeException);
+}
+
+@end
@@ -0,0 +1,115 @@
+//
+//  UDSettingsManagerTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDSettingsManager.h"
+
+@interface UDSettingsManagerTests : XCTestCase
+@property (nonatomic, strong) NSString *path;
+@property (nonatomic, strong) NSUserDefaults *defaults;
+@end
+
+@implementation UDSettingsManagerTests
+
+- (void)setUp {
+    [super setUp];
+    self.path = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                 [NSString stringWithFormat:@"UDSettingsManagerTests-%@/Settings.snapshot", [NSUUID UUID].UUIDString]];
+    // An empty domain: nothing to migrate unless a test puts it there
+    self.defaults = [[NSUserDefaults alloc] initWithSuiteName:@"UDSettingsManagerTests"];
+    [self.defaults removePersistentDomainForName:@"UDSettingsManagerTests"];
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtPath:[self.path stringByDeletingLastPathComponent] error:NULL];
+    [self.defaults removePersistentDomainForName:@"UDSettingsManagerTests"];
+    [super tearDown];
+}
+
+- (UDSettingsManager *)manager {
+    return [[UDSettingsManager alloc] initWithSnapshotPath:self.path defaults:self.defaults];
+}
+
+- (void)testDefaultsWithoutSnapshot {
+    UDSettingsManager *settings = [self manager];
+    XCTAssertEqual(settings.calcMode, UDCalcModeBasic);
+    XCTAssertEqual(settings.encodingMode, UDCalcEncodingModeNone);
+    XCTAssertEqual(settings.inputBase, UDBaseDec);
+    XCTAssertEqual(settings.decimalPlaces, 15);
+    XCTAssertTrue(settings.showBinaryView);
+    XCTAssertFalse(settings.isRPN);
+}
+
+- (void)testSnapshotRoundTrip {
+    UDSettingsManager *settings = [self manager];
+    settings.calcMode = UDCalcModeProgrammer;
+    settings.isRPN = YES;
+    settings.inputBase = UDBaseHex;
+    settings.decimalPlaces = 4;
+    settings.encodingMode = UDCalcEncodingModeASCII;
+    settings.memoryRegister = 42.5;
+    [settings forceSync];
+
+    UDSettingsManager *restored = [self manager];
+    XCTAssertEqual(restored.calcMode, UDCalcModeProgrammer);
+    XCTAssertTrue(restored.isRPN);
+    XCTAssertEqual(restored.inputBase, UDBaseHex);
+    XCTAssertEqual(restored.decimalPlaces, 4);
+    XCTAssertEqual(restored.encodingMode, UDCalcEncodingModeASCII);
+    XCTAssertEqual(restored.memoryRegister, 42.5);
+}
+
+- (void)testChangesInOneTurnWriteOnce {
+    UDSettingsManager *settings = [self manager];
+    settings.calcMode = UDCalcModeScientific;
+    settings.isRadians = YES;
+    settings.showThousandsSeparators = YES;
+    settings.decimalPlaces = 2;
+    XCTAssertEqual(settings.writeCount, 0);
+
+    // Written behind, on the next turn
+    [[NSRunLoop currentRunLoop] runUntilDate:[NSDate dateWithTimeIntervalSinceNow:0.05]];
+    XCTAssertEqual(settings.writeCount, 1);
+
+    // Setting what is already there writes nothing
+    settings.decimalPlaces = 2;
+    [settings forceSync];
+    XCTAssertEqual(settings.writeCount, 1);
+    XCTAssertEqual([self manager].decimalPlaces, 2);
+}
+
+- (void)testMigratesFromDefaults {
+    [self.defaults setInteger:UDCalcModeScientific forKey:@"UDCalcMode"];
+    [self.defaults setBool:YES forKey:@"UDRPNMode"];
+    [self.defaults setInteger:7 forKey:@"UDDecimalPlaces"];
+
+    UDSettingsManager *settings = [self manager];
+    XCTAssertEqual(settings.calcMode, UDCalcModeScientific);
+    XCTAssertTrue(settings.isRPN);
+    XCTAssertEqual(settings.decimalPlaces, 7);
+    XCTAssertEqual(settings.inputBase, UDBaseDec);
+}
+
+- (void)testMigrationWritesTheSnapshot {
+    [self.defaults setInteger:9 forKey:@"UDDecimalPlaces"];
+    [[self manager] forceSync];
+    XCTAssertTrue([[NSFileManager defaultManager] fileExistsAtPath:self.path]);
+
+    // Later launches no longer need the old domain
+    [self.defaults removePersistentDomainForName:@"UDSettingsManagerTests"];
+    XCTAssertEqual([self manager].decimalPlaces, 9);
+}
+
+- (void)testIgnoresForeignSnapshot {
+    [[NSFileManager defaultManager] createDirectoryAtPath:[self.path stringByDeletingLastPathComponent]
+                              withIntermediateDirectories:YES attributes:nil error:NULL];
+    [[@"not a snapshot" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:self.path atomically:YES];
+
+    XCTAssertEqual([self manager].decimalPlaces, 15);
+}
+
+@end
@@ -0,0 +1,235 @@
+//
+//  UDStackModelTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDStackModel.h"
+#import "UDCalc.h"
+
+@interface UDStackModelTests : XCTestCase
+@property (nonatomic, strong) UDStackModel *model;
+@property (nonatomic, assign) NSUInteger evaluations;
+@end
+
+@implementation UDStackModelTests
+
+- (void)setUp {
+    [super setUp];
+    self.model = [[UDStackModel alloc] init];
+    self.evaluations = 0;
+}
+
+- (UDASTNode *)number:(double)d {
+    return [UDNumberNode value:UDValueMakeDouble(d)];
+}
+
+- (void)sync:(UDRegisterFile *)nodes {
+    [self.model syncWithRegisters:nodes evaluator:^UDValue(NSUInteger index) {
+        self.evaluations++;
+        UDValue value = UDValueMakeDouble(0);
+        [nodes getLiteral:&value atIndex:index];
+        return value;
+    }];
+}
+
+- (UDRegisterFile *)stackOf:(NSUInteger)count {
+    UDRegisterFile *nodes = [UDRegisterFile array];
+    for (NSUInteger i = 0; i < count; i++) [nodes addObject:[self number:i]];
+    return nodes;
+}
+
+// --- DIFFING ---
+
+- (void)testPushTouchesOnlyTheNewRow {
+    UDRegisterFile *nodes = [self stackOf:5];
+    [self sync:nodes];
+    [self.model takeChangedRows];
+    self.evaluations = 0;
+
+    [nodes addObject:[self number:42]];
+    [self sync:nodes];
+    XCTAssertEqual(self.evaluations, 1);
+    XCTAssertEqualObjects([self.model takeChangedRows], [NSIndexSet indexSetWithIndex:5]);
+    XCTAssertEqual(UDValueAsDouble([self.model valueAtRow:5]), 42);
+}
+
+- (void)testPopTouchesNothingBelow {
+    UDRegisterFile *nodes = [self stackOf:5];
+    [self sync:nodes];
+    [self.model takeChangedRows];
+    self.evaluations = 0;
+
+    [nodes removeLastObject];
+    [self sync:nodes];
+    XCTAssertEqual(self.evaluations, 0);
+    XCTAssertEqual(self.model.count, 4);
+    XCTAssertEqual([self.model takeChangedRows].count, 0);
+}
+
+- (void)testSwapKeepsValuesOfMovedNodes {
+    UDRegisterFile *nodes = [self stackOf:5];
+    [self sync:nodes];
+    [self.model takeChangedRows];
+    self.evaluations = 0;
+
+    [nodes swapTop];
+    [self sync:nodes];
+    XCTAssertEqual(self.evaluations, 0);
+    XCTAssertEqualObjects([self.model takeChangedRows], [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(3, 2)]);
+    XCTAssertEqual(UDValueAsDouble([self.model valueAtRow:3]), 4);
+    XCTAssertEqual(UDValueAsDouble([self.model valueAtRow:4]), 3);
+}
+
+- (void)testRollRenumbersWithoutEvaluating {
+    UDRegisterFile *nodes = [self stackOf:6];
+    [self sync:nodes];
+    [self.model takeChangedRows];
+    self.evaluations = 0;
+
+    // Top goes to the bottom
+    [nodes rollDown];
+    [self sync:nodes];
+    XCTAssertEqual(self.evaluations, 0);
+    XCTAssertEqual([self.model takeChangedRows].count, 6);
+    for (NSUInteger row = 0; row < 6; row++) {
+        XCTAssertEqual(UDValueAsDouble([self.model valueAtRow:row]), (row + 5) % 6);
+    }
+}
+
+- (void)testBinaryOperatorEvaluatesOnlyTheResult {
+    UDRegisterFile *nodes = [self stackOf:5];
+    [self sync:nodes];
+    [self.model takeChangedRows];
+    self.evaluations = 0;
+
+    // x + y replaces the top two with one new node
+    [nodes removeLastObject];
+    [nodes removeLastObject];
+    [nodes addObject:[self number:7]];
+    [self sync:nodes];
+    XCTAssertEqual(self.evaluations, 1);
+    XCTAssertEqualObjects([self.model takeChangedRows], [NSIndexSet indexSetWithIndex:3]);
+}
+
+- (void)testChangeBelowTheTopIsNotInSync {
+    UDRegisterFile *nodes = [self stackOf:4];
+    [self sync:nodes];
+    XCTAssertTrue([self.model isInSyncWithRegisters:nodes]);
+
+    // Same count, same top: only the version tells
+    [nodes exchangeObjectAtIndex:0 withObjectAtIndex:1];
+    XCTAssertFalse([self.model isInSyncWithRegisters:nodes]);
+    [self sync:nodes];
+    XCTAssertEqual(UDValueAsDouble([self.model valueAtRow:0]), 1);
+    XCTAssertTrue([self.model isInSyncWithRegisters:nodes]);
+
+    // Nor does a fresh register file count as the one synced
+    XCTAssertFalse([self.model isInSyncWithRegisters:[self stackOf:4]]);
+}
+
+- (void)testDuplicateAndBareValuesNeedNoNodes {
+    UDRegisterFile *nodes = [UDRegisterFile array];
+    [nodes pushValue:UDValueMakeDouble(1)];
+    [nodes pushValue:UDValueMakeDouble(2)];
+    [self sync:nodes];
+    self.evaluations = 0;
+
+    // A duplicate is the same entry: nothing to evaluate
+    [nodes duplicateTop];
+    [self sync:nodes];
+    XCTAssertEqual(self.evaluations, 0);
+    XCTAssertEqual(UDValueAsDouble([self.model valueAtRow:2]), 2);
+
+    // A stored value is a new entry, even when equal to an old one
+    [nodes removeLastObject];
+    [nodes pushValue:UDValueMakeDouble(2)];
+    [self sync:nodes];
+    XCTAssertEqual(self.evaluations, 1);
+}
+
+- (void)testSwapOnADeepStackTouchesOnlyTheTopTwo {
+    UDRegisterFile *nodes = [self stackOf:10000];
+    [self sync:nodes];
+    [self.model takeChangedRows];
+    self.evaluations = 0;
+
+    NSIndexSet *top = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(9998, 2)];
+    for (int i = 0; i < 1001; i++) {
+        [nodes swapTop];
+        [self sync:nodes];
+        XCTAssertEqualObjects([self.model takeChangedRows], top);
+    }
+    XCTAssertEqual(self.evaluations, 0);
+    XCTAssertEqual(self.model.count, 10000);
+    // An odd number of swaps leaves them swapped; the rest never moved
+    XCTAssertEqual(UDValueAsDouble([self.model valueAtRow:9998]), 9999);
+    XCTAssertEqual(UDValueAsDouble([self.model valueAtRow:9999]), 9998);
+    XCTAssertEqual(UDValueAsDouble([self.model valueAtRow:0]), 0);
+    XCTAssertEqual(UDValueAsDouble([self.model valueAtRow:9997]), 9997);
+}
+
+// --- CACHING ---
+
+- (void)testStringsAreFormattedOnceUntilInvalidated {
+    UDRegisterFile *nodes = [self stackOf:3];
+    [self sync:nodes];
+    __block NSUInteger formats = 0;
+    NSString *(^format)(UDValue) = ^NSString *(UDValue value) {
+        formats++;
+        return [NSString stringWithFormat:@"%g", UDValueAsDouble(value)];
+    };
+
+    XCTAssertEqualObjects([self.model stringAtRow:2 formatter:format], @"2");
+    XCTAssertEqualObjects([self.model stringAtRow:2 formatter:format], @"2");
+    XCTAssertEqual(formats, 1);
+
+    // A moved row keeps its string
+    [nodes swapTop];
+    [self sync:nodes];
+    XCTAssertEqualObjects([self.model stringAtRow:1 formatter:format], @"2");
+    XCTAssertEqual(formats, 1);
+
+    [self.model takeChangedRows];
+    [self.model invalidateStrings];
+    XCTAssertEqual([self.model takeChangedRows].count, 3);
+    XCTAssertEqualObjects([self.model stringAtRow:1 formatter:format], @"2");
+    XCTAssertEqual(formats, 2);
+}
+
+- (void)testInvalidateValuesReevaluatesEveryRow {
+    UDRegisterFile *nodes = [self stackOf:4];
+    [self sync:nodes];
+    self.evaluations = 0;
+    XCTAssertTrue([self.model isInSyncWithRegisters:nodes]);
+
+    [self.model invalidateValues];
+    XCTAssertFalse([self.model isInSyncWithRegisters:nodes]);
+    [self sync:nodes];
+    XCTAssertEqual(self.evaluations, 4);
+}
+
+// The calculator's rows read the same as currentStackValues
+- (void)testCalculatorRowsMatchStackValues {
+    UDCalc *calc = [[UDCalc alloc] init];
+    calc.isRPNMode = YES;
+    [calc inputNumber:UDValueMakeDouble(3)];
+    [calc performOperation:UDOpEnter];
+    [calc inputNumber:UDValueMakeDouble(4)];
+    [calc performOperation:UDOpEnter];
+    [calc inputNumber:UDValueMakeDouble(5)];
+    [calc performOperation:UDOpAdd];
+    [calc inputNumber:UDValueMakeDouble(2)];
+
+    NSArray<UDNumberNode *> *values = [calc currentStackValues];
+    XCTAssertEqual(calc.stackRowCount, values.count);
+    for (NSUInteger row = 0; row < values.count; row++) {
+        XCTAssertEqual(UDValueAsDouble([calc stackValueAtRow:row]), UDValueAsDouble(values[row].value));
+        XCTAssertEqualObjects([calc stackStringAtRow:row], [calc stringForValue:values[row].value]);
+    }
+    XCTAssertTrue([[calc takeChangedStackRows] containsIndex:values.count - 1]);
+}
+
+@end
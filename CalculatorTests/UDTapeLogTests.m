@@ -0,0 +1,86 @@
+//
+//  UDTapeLogTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDTapeLog.h"
+
+@interface UDTapeLogTests : XCTestCase
+@end
+
+@implementation UDTapeLogTests
+
+- (void)fill:(UDTapeLog *)log from:(NSUInteger)first count:(NSUInteger)count {
+    for (NSUInteger i = first; i < first + count; i++) {
+        [log appendEquation:[NSString stringWithFormat:@"%lu + 1", (unsigned long)i] result:i + 1];
+    }
+}
+
+- (void)testKeepsEntriesInOrder {
+    UDTapeLog *log = [[UDTapeLog alloc] initWithCapacity:100];
+    [self fill:log from:0 count:3];
+    XCTAssertEqual(log.count, 3);
+    XCTAssertEqualObjects([log equationAtIndex:0], @"0 + 1");
+    XCTAssertEqual([log resultAtIndex:2], 3);
+    XCTAssertEqualObjects([log textAtIndex:1], @"1 + 1\n= 2");
+}
+
+- (void)testDefaultCapacity {
+    XCTAssertEqual([[UDTapeLog alloc] init].capacity, UDTapeLogDefaultCapacity);
+}
+
+- (void)testEvictsOldestPastTheCap {
+    UDTapeLog *log = [[UDTapeLog alloc] initWithCapacity:100];
+    [self fill:log from:0 count:250];
+    XCTAssertEqual(log.count, 100);
+    XCTAssertEqual(log.evictedCount, 150);
+    for (NSUInteger i = 0; i < 100; i++) {
+        XCTAssertEqual([log resultAtIndex:i], 151 + i);
+    }
+}
+
+// A long session: the ring wraps many times over and stays in order
+- (void)testLongSessionAtTheCap {
+    UDTapeLog *log = [[UDTapeLog alloc] initWithCapacity:10000];
+    [self fill:log from:0 count:60000];
+    XCTAssertEqual(log.count, 10000);
+    XCTAssertEqual(log.evictedCount, 50000);
+    for (NSUInteger i = 0; i < 10000; i += 997) {
+        XCTAssertEqual([log resultAtIndex:i], 50001 + i);
+    }
+    XCTAssertEqualObjects([log equationAtIndex:0], @"50000 + 1");
+    XCTAssertEqualObjects([log textAtIndex:9999], @"59999 + 1\n= 60000");
+}
+
+- (void)testChangingTheCap {
+    UDTapeLog *log = [[UDTapeLog alloc] initWithCapacity:100];
+    [self fill:log from:0 count:130];
+
+    log.capacity = 10;
+    XCTAssertEqual(log.count, 10);
+    XCTAssertEqualObjects([log equationAtIndex:0], @"120 + 1");
+    XCTAssertEqualObjects([log equationAtIndex:9], @"129 + 1");
+
+    log.capacity = 20;
+    [self fill:log from:130 count:15];
+    XCTAssertEqual(log.count, 20);
+    XCTAssertEqualObjects([log equationAtIndex:0], @"125 + 1");
+    XCTAssertEqualObjects([log equationAtIndex:19], @"144 + 1");
+}
+
+- (void)testClearCountsAsEviction {
+    UDTapeLog *log = [[UDTapeLog alloc] initWithCapacity:100];
+    [self fill:log from:0 count:5];
+    [log removeAllEntries];
+    XCTAssertEqual(log.count, 0);
+    XCTAssertEqual(log.evictedCount, 5);
+
+    [self fill:log from:5 count:1];
+    XCTAssertEqualObjects([log equationAtIndex:0], @"5 + 1");
+    XCTAssertThrowsSpecificNamed([log equationAtIndex:1], NSException, NSRangeException);
+}
+
+@end
@@ -30,4 +30,86 @@
     XCTAssertEqualWithAccuracy(result, 32.0, 0.0001);
 }
 
+// Foundation's two-step conversion, through the base unit
+- (double)referenceConvert:(double)value from:(NSDimension *)from to:(NSDimension *)to {
+    return [to.converter valueFromBaseUnitValue:[from.converter baseUnitValueFromValue:value]];
+}
+
+- (void)testTablesMatchFoundationForEveryPair {
+    double samples[] = { 0, 1, -40, 37.5, 1e6, -273.15, 1e-3 };
+    for (NSString *category in [self.converter availableCategories]) {
+        NSArray<NSUnit *> *units = [self.converter unitsForCategory:category];
+        for (NSUnit *from in units) {
+            for (NSUnit *to in units) {
+                for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+                    double expected = [self referenceConvert:samples[i] from:(NSDimension *)from to:(NSDimension *)to];
+                    double actual = [self.converter convertValue:samples[i] fromUnit:from toUnit:to];
+                    XCTAssertEqualWithAccuracy(actual, expected, 1e-9 * MAX(1.0, fabs(expected)),
+                                               @"%g %@ -> %@", samples[i], from.symbol, to.symbol);
+                }
+            }
+        }
+    }
+}
+
+- (void)testSameUnitIsExact {
+    double v = 0.1;
+    XCTAssertEqual([self.converter convertValue:v fromUnit:[NSUnitTemperature fahrenheit] toUnit:[NSUnitTemperature fahrenheit]], v);
+}
+
+- (void)testBulkMatchesScalar {
+    NSArray<NSUnit *> *units = [self.converter unitsForCategory:[self.converter availableCategories].firstObject];
+    double values[100], expected[100];
+    for (int i = 0; i < 100; i++) values[i] = i * 1.25 - 40;
+
+    NSUnit *from = units.firstObject, *to = units.lastObject;
+    for (int i = 0; i < 100; i++) expected[i] = [self.converter convertValue:values[i] fromUnit:from toUnit:to];
+    [self.converter convertValues:values count:100 from:from to:to];
+    for (int i = 0; i < 100; i++) XCTAssertEqual(values[i], expected[i]);
+}
+
+// Offsets as well as scales, over a column long enough for the
+// vectorized loop and its odd tail
+- (void)testBulkTemperatureMatchesScalar {
+    enum { kCount = 1003 };
+    NSUnit *celsius = [NSUnitTemperature celsius], *fahrenheit = [NSUnitTemperature fahrenheit];
+    NSUnit *kelvin = [NSUnitTemperature kelvin];
+    double values[kCount], expected[kCount];
+    for (int i = 0; i < kCount; i++) values[i] = i * 0.5 - 300;   // -40 at 520, 0 at 600
+
+    for (int i = 0; i < kCount; i++) expected[i] = [self.converter convertValue:values[i] fromUnit:celsius toUnit:fahrenheit];
+    [self.converter convertValues:values count:kCount from:celsius to:fahrenheit];
+    for (int i = 0; i < kCount; i++) XCTAssertEqual(values[i], expected[i], @"index %d", i);
+    XCTAssertEqualWithAccuracy(values[520], -40.0, 1e-9);
+
+    for (int i = 0; i < kCount; i++) expected[i] = [self.converter convertValue:values[i] fromUnit:fahrenheit toUnit:kelvin];
+    [self.converter convertValues:values count:kCount from:fahrenheit to:kelvin];
+    for (int i = 0; i < kCount; i++) XCTAssertEqual(values[i], expected[i], @"index %d", i);
+    XCTAssertEqualWithAccuracy(values[600], 273.15, 1e-9);
+}
+
+- (void)testBulkLeavesIncompatibleUnitsAlone {
+    double values[] = { 1, 2, 3 };
+    [self.converter convertValues:values count:3 from:[NSUnitLength meters] to:[NSUnitMass kilograms]];
+    XCTAssertEqual(values[0], 1);
+    XCTAssertEqual(values[2], 3);
+}
+
+- (void)testSymbolLookup {
+    for (NSString *category in [self.converter availableCategories]) {
+        for (NSUnit *unit in [self.converter unitsForCategory:category]) {
+            XCTAssertEqual([self.converter unitForSymbol:unit.symbol ofCategory:category], unit);
+        }
+    }
+    XCTAssertNil([self.converter unitForSymbol:@"no such unit" ofCategory:[self.converter availableCategories].firstObject]);
+    XCTAssertNil([self.converter unitForSymbol:@"m" ofCategory:@"no such category"]);
+}
+
+- (void)testUnitNamesAreCached {
+    NSUnit *unit = [self.converter unitsForCategory:[self.converter availableCategories].firstObject].firstObject;
+    NSString *name = [self.converter localizedNameForUnit:unit];
+    XCTAssertTrue(name.length > 0);
+    XCTAssertEqual([self.converter localizedNameForUnit:unit], name);
+}
+
 @end
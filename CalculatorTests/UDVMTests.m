@@ -8,6 +8,7 @@
 #import <XCTest/XCTest.h>
 #import "UDVM.h"
 #import "UDInstruction.h"
+#import "UDProgram.h"
 #import "UDConstants.h"
 
 @interface UDVMTests : XCTestCase
@@ -269,4 +270,372 @@
     XCTAssertEqual(UDValueAsInt(res), 0x3333444411112222ULL, @"Should swap high/low 32-bit halves");
 }
 
+// --- PACKED PROGRAMS ---
+
+- (void)testPackedProgramMatchesInstructionArray {
+    // (2 + 3) * 4 = 20, built directly into the packed buffer
+    UDProgram *prog = [UDProgram program];
+    [prog emitPush:UDValueMakeDouble(2)];
+    [prog emitPush:UDValueMakeDouble(3)];
+    [prog emitOp:UDOpcodeAdd];
+    [prog emitPush:UDValueMakeDouble(4)];
+    [prog emitOp:UDOpcodeMul];
+
+    XCTAssertEqual(prog.count, 5);
+    XCTAssertEqual(prog.constantCount, 3);
+
+    UDValue packed = [UDVM executeProgram:prog];
+    UDValue boxed = [self run:[prog instructions]];
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(packed), 20.0, 0.0001);
+    XCTAssertEqual(UDValueAsDouble(packed), UDValueAsDouble(boxed));
+}
+
+- (void)testPackedProgramGrowsPastInitialCapacity {
+    // 1 + 1 + ... + 1 (100 terms)
+    UDProgram *prog = [UDProgram programWithCapacity:1];
+    [prog emitPush:UDValueMakeInt(1)];
+    for (int i = 1; i < 100; i++) {
+        [prog emitPush:UDValueMakeInt(1)];
+        [prog emitOp:UDOpcodeAddI];
+    }
+    UDValue res = [UDVM executeProgram:prog];
+    XCTAssertEqual(UDValueAsInt(res), 100);
+}
+
+- (void)testEmptyProgramUnderflows {
+    UDValue res = [UDVM executeProgram:[UDProgram program]];
+    XCTAssertEqual(res.type, UDValueTypeErr);
+    XCTAssertEqual(UDValueAsError(res), UDValueErrorTypeUnderflow);
+}
+
+- (void)testNegate {
+    // -(2.5)
+    NSArray *prog = @[ [self push:2.5], [self op:UDOpcodeNeg] ];
+    UDValue res = [self run:prog];
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(res), -2.5, 0.0001);
+}
+
+- (void)testRotateUnderflowChecksBothOperands {
+    // ROL needs two operands; a single value must not be read past the stack
+    NSArray *prog = @[ [self pushInt:1], [self op:UDOpcodeRotateLeft] ];
+    UDValue res = [self run:prog];
+    XCTAssertEqual(res.type, UDValueTypeErr);
+    XCTAssertEqual(UDValueAsError(res), UDValueErrorTypeUnderflow);
+}
+
+// --- VERIFIER ---
+
+- (void)testVerifierComputesMaxStackDepth {
+    // 1 2 3 + +  peaks at three operands
+    UDProgram *prog = [UDProgram programWithInstructions:@[
+        [self push:1], [self push:2], [self push:3], [self op:UDOpcodeAdd], [self op:UDOpcodeAdd]
+    ]];
+    XCTAssertEqual(prog.status, UDProgramStatusUnverified);
+    XCTAssertTrue([UDVM verifyProgram:prog]);
+    XCTAssertEqual(prog.status, UDProgramStatusVerified);
+    XCTAssertEqual(prog.maxStackDepth, 3);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([UDVM executeProgram:prog]), 6.0, 0.0001);
+}
+
+- (void)testVerifierRejectsUnderflowBeforeRunning {
+    // The division by zero is never reached: the trailing ADD is caught up front
+    UDProgram *prog = [UDProgram programWithInstructions:@[
+        [self push:1], [self push:0], [self op:UDOpcodeDiv], [self op:UDOpcodeAdd]
+    ]];
+    XCTAssertFalse([UDVM verifyProgram:prog]);
+    XCTAssertEqual(prog.status, UDProgramStatusRejected);
+    XCTAssertEqual(prog.rejectionError, UDValueErrorTypeUnderflow);
+    XCTAssertEqual(UDValueAsError([UDVM executeProgram:prog]), UDValueErrorTypeUnderflow);
+}
+
+- (void)testVerifierRejectsUnknownOpcode {
+    // HALT is only valid at the end of a fused program
+    UDProgram *prog = [UDProgram programWithInstructions:@[ [self push:1], [self op:UDOpcodeHalt] ]];
+    XCTAssertFalse([UDVM verifyProgram:prog]);
+    XCTAssertEqual(prog.rejectionError, UDValueErrorTypeUnknown);
+}
+
+- (void)testEmittingResetsVerification {
+    UDProgram *prog = [UDProgram program];
+    [prog emitPush:UDValueMakeDouble(2)];
+    XCTAssertTrue([UDVM verifyProgram:prog]);
+    [prog emitOp:UDOpcodeAdd];
+    XCTAssertEqual(prog.status, UDProgramStatusUnverified);
+    XCTAssertEqual(UDValueAsError([UDVM executeProgram:prog]), UDValueErrorTypeUnderflow);
+}
+
+// --- DISPATCH CORES ---
+
+- (NSArray<NSArray<UDInstruction *> *> *)crossCheckPrograms {
+    return @[
+        @[ [self push:10], [self push:20], [self op:UDOpcodeAdd] ],
+        @[ [self push:10], [self push:4], [self op:UDOpcodeSub], [self push:3], [self op:UDOpcodeMul] ],
+        @[ [self push:50], [self push:100], [self op:UDOpcodeDiv] ],                 // percent
+        @[ [self push:10], [self push:0], [self op:UDOpcodeDiv] ],                   // divide by zero
+        @[ [self push:-3], [self push:2], [self op:UDOpcodePow] ],                   // x²
+        @[ [self push:-8], [self push:1.0/3.0], [self op:UDOpcodePow] ],
+        @[ [self pushInt:7], [self pushInt:0], [self op:UDOpcodeDivI] ],
+        @[ [self pushInt:100], [self pushInt:7], [self op:UDOpcodeMulI], [self pushInt:3], [self op:UDOpcodeSubI] ],
+        @[ [self pushInt:1ULL << 63], [self push:1], [self op:UDOpcodeRotateLeft] ],  // frontend pushes doubles
+        @[ [self pushInt:1], [self push:1], [self op:UDOpcodeRotateRight] ],
+        @[ [self pushInt:0xF0], [self push:1], [self op:UDOpcodeShiftLeft] ],
+        @[ [self pushInt:0xF0], [self push:1], [self op:UDOpcodeShiftRight] ],
+        @[ [self push:90], [self op:UDOpcodeSinD], [self op:UDOpcodeNeg] ],
+        @[ [self push:5], [self op:UDOpcodeFact] ],
+        @[ [self op:UDOpcodeAdd] ],
+        @[ [self pushInt:1], [self op:UDOpcodeRotateLeft] ],
+    ];
+}
+
+- (void)testThreadedDispatchMatchesSwitch {
+    if (!UDVM.isThreadedDispatchAvailable) return;
+
+    for (NSArray *insts in [self crossCheckPrograms]) {
+        UDProgram *prog = [UDProgram programWithInstructions:insts];
+        UDValue a = [UDVM executeProgram:prog dispatch:UDVMDispatchSwitch];
+        UDValue b = [UDVM executeProgram:prog dispatch:UDVMDispatchThreaded];
+
+        XCTAssertEqual(a.type, b.type, @"%@", [prog debugDescription]);
+        XCTAssertEqual(a.v.intValue, b.v.intValue, @"%@", [prog debugDescription]); // bit-exact
+    }
+}
+
+- (void)testThreadedFormFusesConstantOperands {
+    if (!UDVM.isThreadedDispatchAvailable) return;
+
+    // (((1.5 + 1) * 2) / 100)², every operator with a constant right operand
+    UDProgram *prog = [UDProgram programWithInstructions:@[
+        [self push:1.5], [self push:1], [self op:UDOpcodeAdd], [self push:2], [self op:UDOpcodeMul],
+        [self push:100], [self op:UDOpcodeDiv], [self push:2], [self op:UDOpcodePow] ]];
+    UDValue res = [UDVM executeProgram:prog dispatch:UDVMDispatchThreaded];
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(res), 0.0025, 1e-12);
+
+    UDProgram *fused = prog.threadedForm;
+    const UDOpcode expected[] = { UDOpcodePush, UDOpcodeAddK, UDOpcodeMulK, UDOpcodeDivK, UDOpcodeSquare, UDOpcodeHalt };
+    XCTAssertEqual(fused.count, sizeof(expected) / sizeof(expected[0]));
+    for (NSUInteger i = 0; i < fused.count; i++) XCTAssertEqual(fused.code[i].opcode, expected[i]);
+    XCTAssertEqual(UDValueAsDouble([fused constantAtIndex:fused.code[3].operand]), 100.0);
+
+    // Emitting again drops the fused form
+    [prog emitOp:UDOpcodeNeg];
+    XCTAssertNil(prog.threadedForm);
+}
+
+// --- BOXED STACK ---
+
+- (void)testWideIntegersSurviveTheStack {
+    // Past the 48-bit inline payload, both as constants and as results
+    unsigned long long big = 0xFFFFFFFFFFFFULL;
+    NSArray *prog = @[ [self pushInt:big], [self pushInt:3], [self op:UDOpcodeAddI],
+                       [self pushInt:~0ULL], [self op:UDOpcodeBitXor] ];
+    for (NSNumber *dispatch in @[ @(UDVMDispatchSwitch), @(UDVMDispatchThreaded) ]) {
+        UDValue res = [UDVM executeProgram:[UDProgram programWithInstructions:prog] dispatch:dispatch.integerValue];
+        XCTAssertEqual(res.type, UDValueTypeInteger);
+        XCTAssertEqual(UDValueAsInt(res), ~(big + 3));
+    }
+
+    UDValue input = UDValueMakeInt(1ULL << 63);
+    UDProgram *load = [UDProgram programWithInstructions:@[ [UDInstruction load:0], [self pushInt:1], [self op:UDOpcodeShiftRight] ]];
+    XCTAssertEqual(UDValueAsInt([UDVM executeProgram:load inputs:&input count:1]), 1ULL << 62);
+}
+
+- (void)testBoxRoundTrip {
+    UDValue values[] = { UDValueMakeDouble(-0.0), UDValueMakeDouble(INFINITY), UDValueMakeDouble(1e-310),
+                         UDValueMakeInt(0), UDValueMakeInt(1ULL << 48), UDValueMakeInt(~0ULL),
+                         UDValueMakeError(UDValueErrorTypeOverflow) };
+    UDBoxWideTable wides = { NULL, 0, 0 };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        UDBox box = UDBoxFromValue(values[i], &wides);
+        UDValue back = UDBoxToValue(box, wides.values);
+        XCTAssertEqual(back.type, values[i].type);
+        XCTAssertEqual(back.v.intValue, values[i].v.intValue); // bit-exact
+    }
+    // Only the two integers past the payload took table entries
+    XCTAssertEqual(wides.count, 2);
+    UDBoxWideTableFree(&wides);
+
+    // Any NaN comes in canonical, so it cannot pass for a tag
+    UDValue nan = UDValueMakeDouble(-NAN);
+    XCTAssertTrue(UDBoxIsDouble(UDBoxFromValue(nan, &wides)));
+    XCTAssertTrue(isnan(UDValueAsDouble([UDVM executeProgram:[UDProgram programWithInstructions:@[
+        [UDInstruction load:0], [self push:1], [self op:UDOpcodeAdd] ]] inputs:&nan count:1])));
+}
+
+- (void)testConstantPoolHoldsBoxesOnly {
+    UDProgram *prog = [UDProgram programWithInstructions:@[ [self push:1.5], [self pushInt:7], [self op:UDOpcodeAdd] ]];
+    XCTAssertEqual(sizeof(prog.constants[0]), 8);
+    XCTAssertTrue(prog.wideConstants == NULL);
+    XCTAssertEqual(UDValueAsDouble([prog constantAtIndex:0]), 1.5);
+
+    [prog emitPush:UDValueMakeInt(~0ULL)];
+    XCTAssertTrue(prog.wideConstants != NULL);
+    UDValue wide = [prog constantAtIndex:3];
+    XCTAssertEqual(wide.type, UDValueTypeInteger);
+    XCTAssertEqual(wide.v.intValue, ~0ULL);
+}
+
+- (void)testManyWideResultsOnOneStack {
+    // Each step leaves a new wide value in the same stack slot
+    UDProgram *prog = [UDProgram program];
+    [prog emitPush:UDValueMakeInt(1ULL << 60)];
+    for (int i = 0; i < 100; i++) {
+        [prog emitPush:UDValueMakeInt(1)];
+        [prog emitOp:UDOpcodeAddI];
+    }
+    for (NSNumber *dispatch in @[ @(UDVMDispatchSwitch), @(UDVMDispatchThreaded) ]) {
+        UDValue res = [UDVM executeProgram:prog dispatch:dispatch.integerValue];
+        XCTAssertEqual(UDValueAsInt(res), (1ULL << 60) + 100);
+    }
+
+    // A divide by zero leaves the core early, table and all
+    [prog emitPush:UDValueMakeInt(0)];
+    [prog emitOp:UDOpcodeDivI];
+    XCTAssertEqual([UDVM executeProgram:prog dispatch:UDVMDispatchSwitch].type, UDValueTypeErr);
+}
+
+- (void)testWideIntegersInEveryStackSlot {
+    // 2^50 + i at every depth of a deep stack, then summed from the top
+    UDProgram *prog = [UDProgram program];
+    unsigned long long expected = 0;
+    for (int i = 0; i < 1000; i++) {
+        [prog emitPush:UDValueMakeInt((1ULL << 50) + i)];
+        expected += (1ULL << 50) + i;
+    }
+    for (int i = 0; i < 999; i++) [prog emitOp:UDOpcodeAddI];
+    XCTAssertTrue([UDVM verifyProgram:prog]);
+    XCTAssertEqual(prog.maxStackDepth, 1000);
+
+    for (NSNumber *dispatch in @[ @(UDVMDispatchSwitch), @(UDVMDispatchThreaded) ]) {
+        UDValue res = [UDVM executeProgram:prog dispatch:dispatch.integerValue];
+        XCTAssertEqual(res.type, UDValueTypeInteger);
+        XCTAssertEqual(res.v.intValue, expected);
+    }
+}
+
+- (void)testWidePushesDoNotAllocate {
+    // Wide constants, wide inputs and wide results, over and over
+    UDProgram *prog = [UDProgram program];
+    [prog emitLoad:0];
+    for (int i = 0; i < 200; i++) {
+        [prog emitPush:UDValueMakeInt((1ULL << 50) + i)];
+        [prog emitOp:UDOpcodeBitXor];
+        [prog emitLoad:0];
+        [prog emitOp:UDOpcodeBitOr];
+    }
+    UDValue input = UDValueMakeInt(1ULL << 63);
+    unsigned long long expected = input.v.intValue;
+    for (int i = 0; i < 200; i++) expected = (expected ^ ((1ULL << 50) + i)) | input.v.intValue;
+
+    for (NSNumber *dispatch in @[ @(UDVMDispatchSwitch), @(UDVMDispatchThreaded) ]) {
+        // The first run verifies and, for the threaded core, builds the
+        // fused program with its own constant pool
+        [UDVM executeProgram:prog inputs:&input count:1 dispatch:dispatch.integerValue];
+
+        NSUInteger before = UDBoxWideTableAllocations;
+        for (int run = 0; run < 1000; run++) {
+            UDValue res = [UDVM executeProgram:prog inputs:&input count:1 dispatch:dispatch.integerValue];
+            if (res.v.intValue != expected) XCTFail(@"run %d: %llx", run, res.v.intValue);
+        }
+        XCTAssertEqual(UDBoxWideTableAllocations, before);
+    }
+}
+
+// --- BATCH EXECUTION ---
+
+- (void)testLoadReadsInputSlots {
+    // x / y + 1.5 * x
+    UDProgram *prog = [UDProgram program];
+    [prog emitLoad:0];
+    [prog emitLoad:1];
+    [prog emitOp:UDOpcodeDiv];
+    [prog emitPush:UDValueMakeDouble(1.5)];
+    [prog emitLoad:0];
+    [prog emitOp:UDOpcodeMul];
+    [prog emitOp:UDOpcodeAdd];
+    XCTAssertEqual(prog.inputCount, 2);
+
+    UDValue inputs[] = { UDValueMakeDouble(8), UDValueMakeDouble(2) };
+    XCTAssertEqualWithAccuracy(UDValueAsDouble([UDVM executeProgram:prog inputs:inputs count:2]), 16.0, 0.0001);
+
+    // Not enough inputs
+    XCTAssertEqual([UDVM executeProgram:prog].type, UDValueTypeErr);
+    XCTAssertEqual([UDVM executeProgram:prog inputs:inputs count:1].type, UDValueTypeErr);
+}
+
+- (void)testColumnsMatchRowByRowExecution {
+    // (x / y + 1.5 * x) and ((y << 3) xor y) / 2, over more rows than one block
+    UDProgram *real = [UDProgram programWithInstructions:@[
+        [UDInstruction load:0], [UDInstruction load:1], [self op:UDOpcodeDiv],
+        [self push:1.5], [UDInstruction load:0], [self op:UDOpcodeMul], [self op:UDOpcodeAdd] ]];
+    UDProgram *bits = [UDProgram programWithInstructions:@[
+        [UDInstruction load:1], [self pushInt:3], [self op:UDOpcodeShiftLeft],
+        [UDInstruction load:1], [self op:UDOpcodeBitXor], [self pushInt:2], [self op:UDOpcodeDivI] ]];
+
+    const NSUInteger n = 1000;
+    double x[n];
+    unsigned long long y[n];
+    for (NSUInteger i = 0; i < n; i++) { x[i] = i * 0.5; y[i] = i % 7; }
+    UDVMColumn columns[] = { { UDValueTypeDouble, x }, { UDValueTypeInteger, y } };
+
+    UDValue results[n];
+    for (UDProgram *prog in @[ real, bits ]) {
+        [UDVM executeProgram:prog columns:columns columnCount:2 count:n results:results];
+        for (NSUInteger i = 0; i < n; i++) {
+            UDValue inputs[] = { UDValueMakeDouble(x[i]), UDValueMakeInt(y[i]) };
+            UDValue expected = [UDVM executeProgram:prog inputs:inputs count:2 dispatch:UDVMDispatchSwitch];
+            XCTAssertEqual(results[i].type, expected.type, @"row %lu", (unsigned long)i);
+            XCTAssertEqual(results[i].v.intValue, expected.v.intValue, @"row %lu", (unsigned long)i); // bit-exact
+        }
+    }
+}
+
+- (void)testColumnErrorsStayInTheirRow {
+    // 10 / y
+    UDProgram *prog = [UDProgram programWithInstructions:@[ [self push:10], [UDInstruction load:0], [self op:UDOpcodeDiv] ]];
+    double y[] = { 2, 0, 5 };
+    UDVMColumn column = { UDValueTypeDouble, y };
+    UDValue results[3];
+    [UDVM executeProgram:prog columns:&column columnCount:1 count:3 results:results];
+
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(results[0]), 5.0, 0.0001);
+    XCTAssertEqual(results[1].type, UDValueTypeErr);
+    XCTAssertEqual(UDValueAsError(results[1]), UDValueErrorTypeDivideByZero);
+    XCTAssertEqualWithAccuracy(UDValueAsDouble(results[2]), 2.0, 0.0001);
+
+    // A column short: every row is an error
+    [UDVM executeProgram:prog columns:&column columnCount:0 count:3 results:results];
+    XCTAssertEqual(results[0].type, UDValueTypeErr);
+}
+
+- (void)testColumnsTreatErrorConstantsLikeTheScalarCores {
+    // An operand reads an error constant's code as a number; a program
+    // that ends on one returns it
+    UDValue err = UDValueMakeError(UDValueErrorTypeOverflow);
+    NSArray<NSArray<UDInstruction *> *> *programs = @[
+        @[ [UDInstruction push:err] ],
+        @[ [UDInstruction push:err], [UDInstruction load:0], [self op:UDOpcodeAdd] ],
+        @[ [UDInstruction load:0], [UDInstruction push:err], [self op:UDOpcodeMul] ],
+        @[ [UDInstruction push:err], [self pushInt:1], [self op:UDOpcodeShiftLeft] ],
+        @[ [UDInstruction load:0], [UDInstruction push:err], [self op:UDOpcodeDivI] ],
+        @[ [UDInstruction load:0], [self op:UDOpcodeNeg], [UDInstruction push:err] ],
+    ];
+
+    const NSUInteger n = 300;
+    double x[n];
+    for (NSUInteger i = 0; i < n; i++) x[i] = i * 0.75;
+    UDVMColumn column = { UDValueTypeDouble, x };
+
+    UDValue results[n];
+    for (NSArray *insts in programs) {
+        UDProgram *prog = [UDProgram programWithInstructions:insts];
+        [UDVM executeProgram:prog columns:&column columnCount:1 count:n results:results];
+        for (NSUInteger i = 0; i < n; i++) {
+            UDValue input = UDValueMakeDouble(x[i]);
+            UDValue expected = [UDVM executeProgram:prog inputs:&input count:1 dispatch:UDVMDispatchSwitch];
+            XCTAssertEqual(results[i].type, expected.type, @"%@ row %lu", [prog debugDescription], (unsigned long)i);
+            XCTAssertEqual(results[i].v.intValue, expected.v.intValue, @"%@ row %lu", [prog debugDescription], (unsigned long)i);
+        }
+    }
+}
+
 @end
@@ -0,0 +1,147 @@
+//
+//  UDValueFormatterTests.m
+//  CalculatorTests
+//
+//  Created by Artyom Shalkhakov on 16.10.2026.
+//
+
+#import <XCTest/XCTest.h>
+#import "UDValueFormatter.h"
+
+@interface UDValueFormatterTests : XCTestCase
+@end
+
+@implementation UDValueFormatterTests
+
+// --- REFERENCE ---
+// The NSNumberFormatter implementation the core replaced, kept as the
+// spec for the differential tests. CalculatorBench times its decimal
+// path as format.dec.reference.
+
+- (NSString *)referenceStringForValue:(UDValue)val base:(UDBase)base separators:(BOOL)separators
+                                places:(NSInteger)places scientific:(BOOL)forceScientific {
+    if (val.type == UDValueTypeErr) return @"Error";
+    if (val.type == UDValueTypeDouble) {
+        double absDbl = fabs(val.v.doubleValue);
+        NSNumberFormatter *fmt = [[NSNumberFormatter alloc] init];
+        fmt.usesGroupingSeparator = separators;
+        fmt.minimumFractionDigits = 0;
+        if (forceScientific || absDbl >= 1e10 || (absDbl < 1e-4 && absDbl > 0)) {
+            fmt.numberStyle = NSNumberFormatterScientificStyle;
+            fmt.positiveFormat = @"0.######E0";
+            fmt.exponentSymbol = @" e ";
+        } else {
+            fmt.numberStyle = NSNumberFormatterDecimalStyle;
+            fmt.maximumFractionDigits = places == -1 ? 10 : places;
+        }
+        return [fmt stringFromNumber:@(val.v.doubleValue)];
+    }
+
+    unsigned long long v = val.v.intValue;
+    switch (base) {
+        case UDBaseDec: {
+            NSNumberFormatter *fmt = [[NSNumberFormatter alloc] init];
+            fmt.numberStyle = NSNumberFormatterDecimalStyle;
+            fmt.usesGroupingSeparator = separators;
+            return [fmt stringFromNumber:@(v)];
+        }
+        case UDBaseHex: return [NSString stringWithFormat:@"0x%llX", v];
+        case UDBaseOct: return [NSString stringWithFormat:@"%llo", v];
+        case UDBaseBin: {
+            if (v == 0) return @"0";
+            NSMutableString *str = [NSMutableString string];
+            for (; v > 0; v >>= 1) [str insertString:((v & 1) ? @"1" : @"0") atIndex:0];
+            return str;
+        }
+    }
+    return @"0";
+}
+
+- (NSArray<NSNumber *> *)sampleDoubles {
+    return @[ @0.0, @1.0, @-1.0, @0.1, @(1.0 / 3.0), @(2.0 / 3.0), @123456.789, @-98765.4321, @9999999999.0,
+              @1e10, @1.5e-5, @0.00012345, @6.02214076e23, @-1.602176634e-19, @0.125, @2.5, @1234.5,
+              @0.99999999999, @(M_PI), @(M_E * 1e6), @5e-324, @1.7976931348623157e308 ];
+}
+
+// --- CORRECTNESS ---
+
+- (void)testDoublesMatchNumberFormatter {
+    for (NSNumber *n in [self sampleDoubles]) {
+        UDValue v = UDValueMakeDouble(n.doubleValue);
+        for (NSNumber *places in @[ @-1, @0, @2, @15 ]) {
+            for (NSNumber *separators in @[ @NO, @YES ]) {
+                NSString *expected = [self referenceStringForValue:v base:UDBaseDec separators:separators.boolValue
+                                                            places:places.integerValue scientific:NO];
+                NSString *actual = [UDValueFormatter stringForValue:v base:UDBaseDec showThousandsSeparators:separators.boolValue
+                                                      decimalPlaces:places.integerValue forceScientific:NO];
+                XCTAssertEqualObjects(actual, expected, @"%.17g places %@", n.doubleValue, places);
+            }
+        }
+        NSString *expected = [self referenceStringForValue:v base:UDBaseDec separators:NO places:-1 scientific:YES];
+        XCTAssertEqualObjects([UDValueFormatter stringForValue:v base:UDBaseDec showThousandsSeparators:NO
+                                                 decimalPlaces:-1 forceScientific:YES], expected, @"%.17g", n.doubleValue);
+    }
+}
+
+- (void)testRoundsHalfToEven {
+    UDValue v = UDValueMakeDouble(2.5);
+    XCTAssertEqualObjects([UDValueFormatter stringForValue:v base:UDBaseDec showThousandsSeparators:NO decimalPlaces:0 forceScientific:NO], @"2");
+    v = UDValueMakeDouble(3.5);
+    XCTAssertEqualObjects([UDValueFormatter stringForValue:v base:UDBaseDec showThousandsSeparators:NO decimalPlaces:0 forceScientific:NO], @"4");
+}
+
+- (void)testIntegersInEveryBase {
+    unsigned long long samples[] = { 0, 1, 7, 8, 255, 1000, 123456789, 1ULL << 63, ~0ULL };
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        for (NSNumber *base in @[ @(UDBaseDec), @(UDBaseHex), @(UDBaseOct), @(UDBaseBin) ]) {
+            for (NSNumber *separators in @[ @NO, @YES ]) {
+                UDValue v = UDValueMakeInt(samples[i]);
+                NSString *expected = [self referenceStringForValue:v base:base.integerValue separators:separators.boolValue
+                                                            places:-1 scientific:NO];
+                XCTAssertEqualObjects([UDValueFormatter stringForLong:samples[i] base:base.integerValue
+                                              showThousandsSeparators:separators.boolValue], expected,
+                                      @"%llu base %@", samples[i], base);
+            }
+        }
+    }
+}
+
+- (void)assertBufferHoldsValue:(UDValue)v base:(UDBase)base {
+    NSString *expected = [UDValueFormatter stringForValue:v base:base showThousandsSeparators:YES
+                                            decimalPlaces:-1 forceScientific:NO];
+    char buf[UDFormatBufferSize];
+    size_t length = UDFormatValue(buf, sizeof(buf), v, base, YES, -1, NO);
+    XCTAssertEqual(length, strlen(expected.UTF8String));
+    XCTAssertEqual(strcmp(buf, expected.UTF8String), 0, @"%@", expected);
+
+    // Exactly the string and its NUL fit; one byte less does not
+    char *exact = malloc(length + 1);
+    XCTAssertEqual(UDFormatValue(exact, length + 1, v, base, YES, -1, NO), length);
+    XCTAssertEqual(strcmp(exact, buf), 0);
+    XCTAssertEqual(UDFormatValue(exact, length, v, base, YES, -1, NO), 0);
+    XCTAssertEqual(exact[0], '\0');
+    free(exact);
+}
+
+- (void)testCallerBufferHoldsWhatStringForValuePrints {
+    for (NSNumber *n in [self sampleDoubles]) {
+        [self assertBufferHoldsValue:UDValueMakeDouble(n.doubleValue) base:UDBaseDec];
+    }
+    unsigned long long samples[] = { 0, 7, 1000, 123456789, 1ULL << 63, ~0ULL };
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        for (NSNumber *base in @[ @(UDBaseDec), @(UDBaseHex), @(UDBaseOct), @(UDBaseBin) ]) {
+            [self assertBufferHoldsValue:UDValueMakeInt(samples[i]) base:base.integerValue];
+        }
+    }
+    [self assertBufferHoldsValue:UDValueMakeError(UDValueErrorTypeDivideByZero) base:UDBaseDec];
+}
+
+- (void)testSmallBufferIsRejected {
+    char buf[4];
+    XCTAssertEqual(UDFormatLong(buf, sizeof(buf), 255, UDBaseHex, NO), 3);
+    XCTAssertEqual(strcmp(buf, "0xF"), 0);
+    XCTAssertEqual(UDFormatLong(buf, sizeof(buf), 4096, UDBaseHex, NO), 0);
+    XCTAssertEqual(buf[0], '\0');
+}
+
+@end